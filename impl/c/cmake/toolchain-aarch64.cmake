@@ -0,0 +1,48 @@
+# cmake/toolchain-aarch64.cmake
+# Cross-compilation toolchain for AArch64 Linux.
+#
+# Usage:
+#   cmake -B build-arm -DCMAKE_TOOLCHAIN_FILE=cmake/toolchain-aarch64.cmake
+#   cmake --build build-arm
+#   qemu-aarch64 -cpu max -L /usr/aarch64-linux-gnu build-arm/test/test_keccak_arm64
+#
+# CTest runs the binaries under qemu-aarch64 with -cpu max, which exposes
+# the ARMv8.2 SHA3 extension.  Override XMSS_QEMU_AARCH64_CPU (e.g.
+# cortex-a72) to exercise the portable Keccak fallback instead.
+
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR aarch64)
+
+# Adjust prefix if your toolchain uses a different naming convention
+set(CROSS_PREFIX "aarch64-linux-gnu-")
+
+find_program(CMAKE_C_COMPILER   "${CROSS_PREFIX}gcc")
+find_program(CMAKE_CXX_COMPILER "${CROSS_PREFIX}g++")
+find_program(CMAKE_AR           "${CROSS_PREFIX}ar")
+find_program(CMAKE_RANLIB       "${CROSS_PREFIX}ranlib")
+find_program(CMAKE_STRIP        "${CROSS_PREFIX}strip")
+
+# As for RISC-V: Ubuntu's cross-libc under /usr/aarch64-linux-gnu is not a
+# proper sysroot, so pass include and library paths explicitly.
+set(CMAKE_C_FLAGS_INIT
+    "-march=armv8-a \
+     -I/usr/aarch64-linux-gnu/include \
+     -L/usr/aarch64-linux-gnu/lib"
+)
+set(CMAKE_EXE_LINKER_FLAGS_INIT
+    "-Wl,-rpath-link,/usr/aarch64-linux-gnu/lib"
+)
+
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_PACKAGE ONLY)
+
+# QEMU emulator for CTest — allows `ctest` to run cross-compiled tests.
+set(XMSS_QEMU_AARCH64_CPU "max" CACHE STRING "qemu-aarch64 -cpu model for CTest")
+find_program(QEMU_AARCH64 qemu-aarch64)
+if(QEMU_AARCH64)
+    set(CMAKE_CROSSCOMPILING_EMULATOR
+        "${QEMU_AARCH64};-cpu;${XMSS_QEMU_AARCH64_CPU};-L;/usr/aarch64-linux-gnu"
+        CACHE STRING "Emulator for cross-compiled test binaries")
+endif()
@@ -0,0 +1,101 @@
+/**
+ * arena.h - Hugepage-backed, NUMA-placed arena for key states (Linux)
+ *
+ * Optional companion to the core library (CMake option XMSS_BUILD_ARENA,
+ * library xmss_arena).  The core never allocates (Jasmin rule J3); this
+ * module gives applications holding many resident keys one place to put
+ * their xmss_bds_state / xmss_mt_state objects, SK bytes and signature
+ * buffers so that BDS updates touch a few 2 MB pages instead of hundreds
+ * of scattered 4 KB ones.
+ *
+ * An arena is a single mapping, carved up by a bump allocator:
+ *   - backed by explicit hugepages (MAP_HUGETLB) when the system has them
+ *     reserved, otherwise by a 2 MB-aligned normal mapping advised for
+ *     transparent hugepages;
+ *   - bound (preferred policy) to one NUMA node, by default the node of
+ *     the calling thread, so create the arena on the thread that will sign
+ *     with the keys it holds;
+ *   - prefaulted, so every page is placed at creation time rather than on
+ *     first touch from whichever thread happens to get there first.
+ *
+ * NUMA placement uses the raw mbind/getcpu system calls; no libnuma.
+ * Not thread-safe: one arena per signing thread.
+ */
+#ifndef XMSS_ARENA_H
+#define XMSS_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xmss.h"
+
+/** Hugepage size the arena rounds to and aligns on. */
+#define XMSS_ARENA_HUGEPAGE ((size_t)2 * 1024 * 1024)
+
+/** Node argument to xmss_arena_init(): the calling thread's node. */
+#define XMSS_ARENA_NODE_LOCAL (-1)
+/** Node argument to xmss_arena_init(): no NUMA binding. */
+#define XMSS_ARENA_NODE_ANY   (-2)
+
+/** How the arena's mapping is backed. */
+#define XMSS_ARENA_BACKING_HUGETLB 1   /* explicit 2 MB hugepages */
+#define XMSS_ARENA_BACKING_THP     2   /* normal pages, THP advised */
+
+/** Allocation statistics (see xmss_arena_stats()). */
+typedef struct {
+    size_t   mapped;      /* bytes mapped (multiple of XMSS_ARENA_HUGEPAGE) */
+    size_t   used;        /* bytes handed out, including alignment padding */
+    size_t   peak;        /* high-water mark of used across resets */
+    uint64_t allocs;      /* successful xmss_arena_alloc() calls */
+    uint64_t failed;      /* calls that returned NULL (arena full) */
+    int      backing;     /* XMSS_ARENA_BACKING_* */
+    int      node;        /* NUMA node the mapping is bound to, or -1 */
+} xmss_arena_stats_t;
+
+/** Arena handle.  Treat fields as private; read them via xmss_arena_stats(). */
+typedef struct {
+    uint8_t           *base;
+    xmss_arena_stats_t st;
+} xmss_arena;
+
+/**
+ * xmss_arena_init() - Map a new arena.
+ *
+ * @a:     Arena to initialise.
+ * @size:  Minimum capacity in bytes; rounded up to XMSS_ARENA_HUGEPAGE.
+ * @node:  NUMA node, XMSS_ARENA_NODE_LOCAL or XMSS_ARENA_NODE_ANY.  If the
+ *         kernel refuses the binding (no NUMA, bad node) the arena is still
+ *         usable and stats.node reads -1.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_PARAMS if size is 0 or nothing could be mapped.
+ */
+int xmss_arena_init(xmss_arena *a, size_t size, int node);
+
+/**
+ * xmss_arena_alloc() - Carve size bytes aligned to align (a power of two,
+ * 0 meaning 64) from the arena.  Memory is zeroed.
+ *
+ * Returns NULL if the arena is full or align is not a power of two.
+ */
+void *xmss_arena_alloc(xmss_arena *a, size_t size, size_t align);
+
+/** Allocate and zero one xmss_bds_state / xmss_mt_state (NULL if full). */
+xmss_bds_state *xmss_arena_bds_state(xmss_arena *a);
+xmss_mt_state  *xmss_arena_mt_state(xmss_arena *a);
+
+/**
+ * xmss_arena_reset() - Wipe and release every allocation; the mapping, its
+ * placement and the counters are kept (peak is not reset).
+ */
+void xmss_arena_reset(xmss_arena *a);
+
+/** xmss_arena_destroy() - Wipe and unmap.  Safe on a zeroed arena. */
+void xmss_arena_destroy(xmss_arena *a);
+
+/** xmss_arena_stats() - Copy the arena's statistics into *out. */
+void xmss_arena_stats(const xmss_arena *a, xmss_arena_stats_t *out);
+
+/** xmss_arena_current_node() - NUMA node of the calling thread, or -1. */
+int xmss_arena_current_node(void);
+
+#endif /* XMSS_ARENA_H */
@@ -0,0 +1,223 @@
+/**
+ * flashlog.h - Append-only key-state log for NOR flash
+ *
+ * Optional companion to the core library (CMake option XMSS_BUILD_FLASHLOG,
+ * library xmss_flashlog).  Portable C99 with no OS calls: the log reaches
+ * storage through xmss_flash_dev, three callbacks over erase sectors.
+ *
+ * Rewriting SK || serialised state after every signature costs a sector
+ * erase and a few KB of programming per signature, which wears NOR flash
+ * out and puts the erase time on the signing path.  The log appends
+ * instead, round robin over the sectors, so wear is spread evenly:
+ *
+ *   index record     8 bytes (rounded up to prog_bytes): "every index
+ *                    below V may have been used".  Written before a
+ *                    signature when its index is not yet covered, and
+ *                    reserves the next @reserve indices, so it is written
+ *                    once every @reserve signatures.
+ *   snapshot record  SK || serialised state (xmss_bds_serialize() or
+ *                    xmss_mt_state_serialize()) and the current V; every
+ *                    @snap_interval signatures and first in every sector.
+ *
+ * A sector is erased only when the log moves into it, and the sector
+ * being left keeps its leading snapshot and every reservation made since,
+ * so a power cut at any point (torn record, torn sector header, erase
+ * half done) leaves a valid snapshot and the highest V on flash.
+ * Recovery (xmss_flashlog_load()) takes the newest valid snapshot and
+ * replays it with xmss_skip() / xmss_mt_skip() up to the highest V
+ * anywhere: reserved but unused indices are given up, none is reused.
+ * Nothing is ever programmed over a partly written area.
+ *
+ * Sector:   header(16: "XFL1" | seq | OID | CRC-32) | records | 0xFF...
+ * Index:    'I' | V - base (u32) | CRC-32 low 24 bits
+ * Snapshot: 'S' | 0(3) | len (u32) | V (u64) | payload CRC | header CRC,
+ *           then SK || state
+ * (base = SK index of the sector's first snapshot; big-endian fields.)
+ *
+ * Not thread-safe: one log per key, driven by its signing thread.
+ */
+#ifndef XMSS_FLASHLOG_H
+#define XMSS_FLASHLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xmss.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest program unit xmss_flashlog_init() takes. */
+#define XMSS_FLASH_MAX_PROG 64U
+
+/**
+ * xmss_flash_dev - Storage driver.
+ *
+ * Addresses are byte offsets into the log area, sector s starting at
+ * s * sector_bytes.  prog() is only ever called on erased, prog_bytes-
+ * aligned ranges and must be durable when it returns; NOR semantics
+ * (program clears bits, erase sets a sector to 0xFF) are all that is
+ * assumed.  Each callback returns 0 on success.
+ */
+typedef struct {
+    void    *ctx;
+    uint32_t sector_bytes;   /* erase unit, a multiple of prog_bytes */
+    uint32_t sectors;        /* >= 2 */
+    uint32_t prog_bytes;     /* program unit, power of two <= XMSS_FLASH_MAX_PROG */
+    int (*read)(void *ctx, uint32_t addr, uint8_t *buf, uint32_t len);
+    int (*prog)(void *ctx, uint32_t addr, const uint8_t *buf, uint32_t len);
+    int (*erase)(void *ctx, uint32_t sector);
+} xmss_flash_dev;
+
+/** Write statistics (see xmss_flashlog_stats()). */
+typedef struct {
+    uint64_t signatures;      /* signed through this handle */
+    uint64_t prog_bytes;      /* bytes programmed, padding included */
+    uint64_t index_records;
+    uint64_t snapshots;
+    uint64_t erases;
+    uint64_t replayed;        /* indices skipped forward by the last load */
+} xmss_flashlog_stats_t;
+
+/** Log handle.  Treat fields as private. */
+typedef struct {
+    xmss_params           p;
+    const xmss_flash_dev *dev;
+    uint8_t              *work;          /* caller buffer, one snapshot record */
+    uint32_t              bds_k;
+    uint32_t              reserve;
+    uint32_t              snap_interval;
+    uint32_t              state_bytes;   /* serialised state */
+    uint32_t              snap_area;     /* snapshot record, padded */
+    uint32_t              hdr_area;      /* sector header, padded */
+    uint32_t              idx_area;      /* index record, padded */
+    uint32_t              sector;        /* current sector */
+    uint32_t              seq;           /* its sequence number */
+    uint32_t              cursor;        /* next free offset; sector_bytes = full */
+    uint32_t              since_snap;    /* signatures since the last snapshot */
+    int                   has_base;      /* current sector's first snapshot valid */
+    uint64_t              base;          /* its SK index */
+    uint64_t              reserved;      /* V: indices below are recorded as used */
+    int                   error;         /* sticky XMSS_ERR_IO */
+    xmss_flashlog_stats_t st;
+} xmss_flashlog;
+
+/**
+ * xmss_flashlog_work_bytes() - Size of the work buffer for a parameter set.
+ *
+ * One snapshot record: the largest single write the log makes.
+ */
+uint32_t xmss_flashlog_work_bytes(const xmss_params *p, uint32_t bds_k);
+
+/**
+ * xmss_flashlog_init() - Bind a log to a device and key type (no I/O).
+ *
+ * @fl:            Handle to initialise.
+ * @dev:           Storage driver; must outlive @fl.
+ * @p:             Parameter set of the key (XMSS or XMSS-MT).
+ * @bds_k:         BDS retain parameter of the key.
+ * @reserve:       Indices covered per index record, >= 1.  A power cut
+ *                 gives up at most this many unused indices.
+ * @snap_interval: Signatures between snapshots; 0 = only when entering a
+ *                 sector.  Bounds the replay at load time.
+ * @work:          xmss_flashlog_work_bytes() bytes, owned by @fl.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_PARAMS if the geometry is unusable (fewer
+ * than two sectors, or a sector too small for a header, a snapshot and an
+ * index record).
+ */
+int xmss_flashlog_init(xmss_flashlog *fl, const xmss_flash_dev *dev,
+                       const xmss_params *p, uint32_t bds_k,
+                       uint32_t reserve, uint32_t snap_interval, uint8_t *work);
+
+/**
+ * xmss_flashlog_format() / xmss_mt_flashlog_format() - Start a new log.
+ *
+ * Erases every sector and writes the first sector with a snapshot of @sk
+ * and @state (normally straight after keygen).  Destroys any earlier log.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS (wrong key type for @fl) or XMSS_ERR_IO.
+ */
+int xmss_flashlog_format(xmss_flashlog *fl, const uint8_t *sk,
+                         const xmss_bds_state *state);
+int xmss_mt_flashlog_format(xmss_flashlog *fl, const uint8_t *sk,
+                            const xmss_mt_state *state);
+
+/**
+ * xmss_flashlog_load() / xmss_mt_flashlog_load() - Recover after a restart.
+ *
+ * Scans the device, restores @sk and @state from the newest valid
+ * snapshot and advances them past every index any record says may have
+ * been used.  The handle is then positioned to append.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS if no valid snapshot of this parameter
+ * set and bds_k is found, or XMSS_ERR_IO.
+ */
+int xmss_flashlog_load(xmss_flashlog *fl, uint8_t *sk, xmss_bds_state *state);
+int xmss_mt_flashlog_load(xmss_flashlog *fl, uint8_t *sk, xmss_mt_state *state);
+
+/**
+ * xmss_flashlog_sign() / xmss_mt_flashlog_sign() - Sign with the index
+ * made durable first.
+ *
+ * When the index is not yet covered by a reservation, an index record is
+ * programmed before signing; a snapshot follows every @snap_interval
+ * signatures.  On return XMSS_OK the signature may be released at once.
+ *
+ * Returns as xmss_sign() / xmss_mt_sign(), plus XMSS_ERR_IO: a write
+ * failed, no signature is returned (@sig is zeroed) and the handle stays
+ * failed until reloaded.
+ */
+int xmss_flashlog_sign(xmss_flashlog *fl, uint8_t *sig,
+                       const uint8_t *msg, size_t msglen,
+                       uint8_t *sk, xmss_bds_state *state);
+int xmss_mt_flashlog_sign(xmss_flashlog *fl, uint8_t *sig,
+                          const uint8_t *msg, size_t msglen,
+                          uint8_t *sk, xmss_mt_state *state);
+
+/** xmss_flashlog_stats() - Copy out the write statistics. */
+void xmss_flashlog_stats(const xmss_flashlog *fl, xmss_flashlog_stats_t *out);
+
+/* ====================================================================
+ * File-backed stand-in for a NOR device (hosted builds, tests)
+ * ==================================================================== */
+
+/** Most sectors xmss_flash_file_open() takes. */
+#define XMSS_FLASH_FILE_MAX_SECTORS 256U
+
+/**
+ * xmss_flash_file - NOR flash emulated in a file.
+ *
+ * Erase fills a sector with 0xFF; prog() refuses ranges that are
+ * misaligned or not erased, the mistakes real NOR would punish silently.
+ * Setting cut_after simulates a power cut: once that many more bytes
+ * have been programmed, the write in progress stops part way and every
+ * later prog() and erase() fails until cut_after is reset.
+ */
+typedef struct {
+    xmss_flash_dev dev;          /* pass &f.dev to the log */
+    void          *fp;           /* FILE * */
+    uint64_t       cut_after;    /* UINT64_MAX = no power cut */
+    uint32_t       erase_count[XMSS_FLASH_FILE_MAX_SECTORS];
+} xmss_flash_file;
+
+/**
+ * xmss_flash_file_open() - Open or create @path as a device.
+ *
+ * A new or short file is extended with erased (0xFF) bytes.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS for a bad geometry or XMSS_ERR_IO.
+ */
+int xmss_flash_file_open(xmss_flash_file *f, const char *path,
+                         uint32_t sector_bytes, uint32_t sectors,
+                         uint32_t prog_bytes);
+
+/** xmss_flash_file_close() - Close the file (zeroed handle: no-op). */
+void xmss_flash_file_close(xmss_flash_file *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XMSS_FLASHLOG_H */
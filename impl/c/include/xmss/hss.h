@@ -0,0 +1,179 @@
+/**
+ * hss.h - LMS / HSS hash-based signatures (RFC 8554, NIST SP 800-208)
+ *
+ * A second scheme on the same engine.  LMS trees are Merkle trees over
+ * LM-OTS leaves with plain prefixed SHA-256: no bitmasks and no keyed PRF
+ * per hash, so a chain step is one SHA-256 compression where XMSS's F
+ * needs four (three with the shared-SEED midstate), and verification is
+ * cheaper by about that factor.  HSS stacks L LMS trees the way XMSS-MT
+ * stacks XMSS trees.
+ *
+ * Shared with XMSS: the SHA-256 core and its lane kernels (LM-OTS chains
+ * and key expansion run XMSS_HASH_LANES leaves at once), treehash and the
+ * BDS traversal (bds.c, one current and one next tree per level, built
+ * incrementally during signing exactly as in xmss_mt_sign()), BDS
+ * serialisation and the SK layout.  Only hashing differs; it is selected
+ * by func = XMSS_FUNC_LMS_SHA256 in the xmss_params filled in by
+ * xmss_hss_params().
+ *
+ * Wire formats are RFC 8554's: the public key is u32str(L) || LMS public
+ * key of the top tree, the signature u32str(L-1) || (LMS signature ||
+ * LMS public key) per lower level || LMS signature of the message.
+ *
+ * Supported: LMS_SHA256_M32_H5..H20 with LMOTS_SHA256_N32_W2/W4/W8,
+ * 1 <= L <= 8 and L * H <= 60.  H25 and W1 exceed the static bounds
+ * XMSS_MAX_H and XMSS_MAX_WOTS_LEN.  Keys generated here use one type
+ * pair for every level (the single-type restriction: an xmss_params
+ * describes one pair), and xmss_hss_verify() holds signatures to it;
+ * xmss_hss_verify_any() takes each level's types from the key and
+ * signature, as RFC 8554 allows, and verifies any HSS signature of the
+ * supported types.
+ *
+ * Every tree below the top one is keyed from the master SEED: its SEED
+ * and I are SHA-256 of (top I, level, tree index, SEED), so the SK stays
+ * 4 + 8 + 4n bytes however many trees the key spans.
+ */
+#ifndef XMSS_HSS_H
+#define XMSS_HSS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xmss.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** RFC 8554 LMS and LM-OTS typecodes (SHA-256, n = 32). */
+#define LMS_SHA256_M32_H5     0x00000005U
+#define LMS_SHA256_M32_H10    0x00000006U
+#define LMS_SHA256_M32_H15    0x00000007U
+#define LMS_SHA256_M32_H20    0x00000008U
+#define LMOTS_SHA256_N32_W2   0x00000002U
+#define LMOTS_SHA256_N32_W4   0x00000003U
+#define LMOTS_SHA256_N32_W8   0x00000004U
+
+/** Most HSS levels (RFC 8554 §6). */
+#define XMSS_HSS_MAX_LEVELS   8U
+
+/** Largest LM-OTS signature body C || y[p] kept per level (W2: p = 133). */
+#define XMSS_HSS_OTS_MAX      (32U + XMSS_MAX_WOTS_LEN * 32U)
+
+/** LMS public key: u32str(type) || u32str(otstype) || I || T[1]. */
+#define XMSS_HSS_LMS_PUB_BYTES 56U
+
+/** Internal OID of an HSS parameter set (SK header; not an IANA value). */
+#define XMSS_HSS_OID(levels, lms_type, ots_type) \
+    (0x4C000000U | ((uint32_t)(levels) << 16) | ((uint32_t)(lms_type) << 8) | (uint32_t)(ots_type))
+
+/**
+ * xmss_hss_state - HSS traversal state.
+ *
+ * Laid out like xmss_mt_state: bds[0..L-1] are the current trees (level
+ * 0 = bottom), bds[L..2L-2] the next trees of levels 0..L-2.  ots_sigs[i]
+ * and roots[i] hold the LM-OTS signature (C || y) by level i+1 of level
+ * i's current public key and that tree's root.
+ * Allocated by the caller; initialised by xmss_hss_keygen().
+ */
+typedef struct xmss_hss_state {
+    xmss_bds_state bds[2 * XMSS_HSS_MAX_LEVELS - 1];
+    uint8_t        ots_sigs[XMSS_HSS_MAX_LEVELS - 1][XMSS_HSS_OTS_MAX];
+    uint8_t        roots[XMSS_HSS_MAX_LEVELS - 1][32];
+} xmss_hss_state;
+
+/**
+ * xmss_hss_params() - Parameter set for L levels of one LMS/LM-OTS type.
+ *
+ * @p:         Output parameters (func = XMSS_FUNC_LMS_SHA256, d = levels,
+ *             tree_height = LMS H, len = LM-OTS p).
+ * @levels:    1..XMSS_HSS_MAX_LEVELS; 1 is a single LMS tree.
+ * @lms_type:  LMS_SHA256_M32_H*.
+ * @ots_type:  LMOTS_SHA256_N32_W*.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_PARAMS if the combination is unsupported
+ * (p is untouched).
+ */
+int xmss_hss_params(xmss_params *p, uint32_t levels,
+                    uint32_t lms_type, uint32_t ots_type);
+
+/**
+ * xmss_hss_keygen() - Generate an HSS key pair with traversal state.
+ *
+ * @p:           Parameter set from xmss_hss_params().
+ * @pk:          Output public key (p->pk_bytes bytes).
+ * @sk:          Output secret key (p->sk_bytes bytes).
+ * @state:       Output traversal state (caller-allocated).
+ * @bds_k:       BDS retain parameter (even, 0 <= bds_k <= tree_height).
+ * @randombytes: Caller-supplied entropy function.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS or XMSS_ERR_ENTROPY.
+ */
+int xmss_hss_keygen(const xmss_params *p, uint8_t *pk, uint8_t *sk,
+                    xmss_hss_state *state, uint32_t bds_k,
+                    xmss_randombytes_fn randombytes);
+
+/**
+ * xmss_hss_sign() - Sign a message; see xmss_mt_sign().
+ *
+ * @sig:  Output signature (p->sig_bytes bytes).
+ * @sk:   Secret key; index incremented in place before anything else.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS or XMSS_ERR_EXHAUSTED.
+ */
+int xmss_hss_sign(const xmss_params *p, uint8_t *sig,
+                  const uint8_t *msg, size_t msglen,
+                  uint8_t *sk, xmss_hss_state *state, uint32_t bds_k);
+
+/**
+ * xmss_hss_verify() - Verify an HSS signature (RFC 8554 §6.3).
+ *
+ * @sig:  Signature (p->sig_bytes bytes).
+ * @pk:   Public key (p->pk_bytes bytes).
+ *
+ * Single-type restriction: every level's LMS and LM-OTS typecodes must
+ * be those of @p, as for keys from xmss_hss_keygen().  Returns XMSS_OK
+ * or XMSS_ERR_VERIFY.  Stateless.
+ */
+int xmss_hss_verify(const xmss_params *p,
+                    const uint8_t *msg, size_t msglen,
+                    const uint8_t *sig, const uint8_t *pk);
+
+/**
+ * xmss_hss_verify_any() - Verify an HSS signature whose levels may use
+ * different LMS / LM-OTS types (RFC 8554 §6.3, any supported types).
+ *
+ * @sig:    Signature, @siglen bytes; each level's length follows from
+ *          the types it carries, and the total must equal @siglen.
+ * @pk:     Public key, @pklen bytes (4 + XMSS_HSS_LMS_PUB_BYTES).
+ *
+ * Returns XMSS_OK, or XMSS_ERR_VERIFY for an invalid signature, a
+ * malformed or truncated one, or a type outside the supported set.
+ * Stateless.
+ */
+int xmss_hss_verify_any(const uint8_t *msg, size_t msglen,
+                        const uint8_t *sig, size_t siglen,
+                        const uint8_t *pk, size_t pklen);
+
+/** xmss_hss_remaining_sigs() - As xmss_mt_remaining_sigs(). */
+uint64_t xmss_hss_remaining_sigs(const xmss_params *p, const uint8_t *sk);
+
+/**
+ * xmss_hss_state_bytes() - Size of a serialised xmss_hss_state.
+ * xmss_hss_state_serialize() / xmss_hss_state_deserialize() - Flat,
+ * platform-independent form: every BDS state through
+ * xmss_bds_serialize(), then the cached LM-OTS signatures and roots.
+ *
+ * Both return XMSS_OK, or XMSS_ERR_PARAMS for a non-HSS p or a bad bds_k.
+ */
+uint32_t xmss_hss_state_bytes(const xmss_params *p, uint32_t bds_k);
+int xmss_hss_state_serialize(const xmss_params *p, uint8_t *buf,
+                             const xmss_hss_state *state, uint32_t bds_k);
+int xmss_hss_state_deserialize(const xmss_params *p, xmss_hss_state *state,
+                               const uint8_t *buf, uint32_t bds_k);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XMSS_HSS_H */
@@ -0,0 +1,360 @@
+/**
+ * mt_builder.hpp - Background next-tree builder for XMSS-MT (C++17)
+ *
+ * xmss_mt_sign() grows each layer's next tree by about one leaf per
+ * signature and, when a layer's tree is used up, swaps the next one in
+ * and WOTS+-signs its root at the layer above.  mt_builder moves both
+ * onto a helper: it builds each layer's next tree, leaf_batch leaves per
+ * step with xmss_mt_next_step(), while signing continues on the current
+ * one, and the boundary signature only copies the finished tree and its
+ * precomputed root signature in (xmss_mt_sign_ext()).
+ *
+ * The helper is either a thread of its own or step tasks on a shared
+ * priority_pool (pool.hpp) at priority::advance, where signing and
+ * verification on the same pool take precedence at every step.
+ *
+ *   signer:  sign idx ... boundary: wait slot.ready == T+1, copy slot
+ *            --> publish epoch = idx + 1
+ *   builder: read epoch --> T = current tree + 1 per layer
+ *            --> build into slot --> slot.ready = T+1 (release)
+ *
+ * Handoff is lock-free, one slot per layer: the builder writes a slot
+ * only while slot.ready differs from its target, and the target moves on
+ * only when the signer publishes an epoch past the boundary, i.e. after
+ * the slot was copied out.  The mutex and condition variable just park
+ * an idle builder thread; on a pool, an idle builder has no task queued
+ * and the next signature posts one.
+ *
+ * Signatures are byte-identical to xmss_mt_sign()'s.  stop() (also run
+ * by the destructor) hands every layer back to inline building with
+ * xmss_mt_next_install(), so the key carries on with plain
+ * mt_private_key::sign().
+ */
+#ifndef XMSS_MT_BUILDER_HPP
+#define XMSS_MT_BUILDER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pool.hpp"
+#include "xmss.hpp"
+
+namespace xmss {
+
+class mt_builder {
+public:
+    /**
+     * Start building next trees for key's layers in @layers (bit i =
+     * layer i; layers >= d-1 are ignored).  The key must outlive the
+     * builder and must only be signed through it until stop().  Throws
+     * xmss::error if the key's bds_k could not begin a next tree.
+     */
+    explicit mt_builder(mt_private_key &key, std::uint32_t layers = ~0u)
+        : key_(key), p_(key.parameters().c_ptr()),
+          sk_(new std::uint8_t[key.parameters().sk_bytes()],
+              detail::wiping_delete<std::uint8_t[]>{ key.parameters().sk_bytes() }),
+          slots_(p_->d - 1)
+    {
+        check_bds_k();
+        layers_ = layers & ((1u << (p_->d - 1)) - 1u);
+        std::copy(key.sk_bytes().begin(), key.sk_bytes().end(), sk_.get());
+        for (slot &s : slots_) {
+            s.nt.reset(new xmss_mt_next_tree);
+        }
+        epoch_.store(p_->idx_max + 1 - key.remaining(), std::memory_order_relaxed);
+        worker_ = std::thread([this] { run(); });
+    }
+
+    /**
+     * As above, building on @pool's workers at @prio instead of a thread
+     * of its own.  @pool must outlive the builder.
+     */
+    mt_builder(mt_private_key &key, priority_pool &pool, std::uint32_t layers = ~0u,
+               priority prio = priority::advance)
+        : key_(key), p_(key.parameters().c_ptr()),
+          sk_(new std::uint8_t[key.parameters().sk_bytes()],
+              detail::wiping_delete<std::uint8_t[]>{ key.parameters().sk_bytes() }),
+          slots_(p_->d - 1), pool_(&pool), prio_(prio)
+    {
+        check_bds_k();
+        layers_ = layers & ((1u << (p_->d - 1)) - 1u);
+        std::copy(key.sk_bytes().begin(), key.sk_bytes().end(), sk_.get());
+        for (slot &s : slots_) {
+            s.nt.reset(new xmss_mt_next_tree);
+        }
+        epoch_.store(p_->idx_max + 1 - key.remaining(), std::memory_order_relaxed);
+        kick();
+    }
+
+    mt_builder(const mt_builder &) = delete;
+    mt_builder &operator=(const mt_builder &) = delete;
+
+    ~mt_builder() { stop(); }
+
+    /**
+     * Sign msg into a caller-provided buffer; see
+     * basic_private_key::sign().  At a tree boundary this waits for the
+     * builder if it has fallen behind (counted in stalls()); on a pool it
+     * finishes the tree itself instead.  Throws xmss::error, without
+     * signing, if the builder could not begin the tree it waits for.
+     */
+    std::size_t sign(bytes_view msg, mutable_bytes sig)
+    {
+        const xmss_mt_next_tree *next[XMSS_MAX_D - 1] = {};
+        std::uint64_t idx = epoch_.load(std::memory_order_relaxed);
+
+        if (sig.size() < p_->sig_bytes) {
+            throw error(XMSS_ERR_PARAMS, "signature buffer too small");
+        }
+        for (std::uint32_t i = 0; i + 1 < p_->d; i++) {
+            if (!((layers_ >> i) & 1u) || !boundary(idx, i)) {
+                continue;
+            }
+            std::uint64_t want = ((idx + 1) >> shift(i)) + 1;
+            if (want - 1 >= trees(i)) {
+                continue;
+            }
+            if (slots_[i].ready.load(std::memory_order_acquire) != want) {
+                stalls_.fetch_add(1, std::memory_order_relaxed);
+                if (pool_ != nullptr) {
+                    /* The pool may be busy with work above the builder's
+                     * class, this signature included: finish it here */
+                    std::lock_guard<std::mutex> lock(build_mu_);
+                    while (slots_[i].ready.load(std::memory_order_acquire) != want &&
+                           work(idx)) {
+                    }
+                }
+                while (slots_[i].ready.load(std::memory_order_acquire) != want) {
+                    if (slots_[i].failed.load(std::memory_order_acquire) == want) {
+                        throw error(slots_[i].err, "next tree build failed");
+                    }
+                    std::this_thread::yield();
+                }
+            }
+            next[i] = slots_[i].nt.get();
+        }
+
+        detail::check(xmss_mt_sign_ext(p_, sig.data(), msg.data(), msg.size(),
+                                       key_.sk_data(), key_.state_data(),
+                                       key_.bds_k(), layers_, next),
+                      "signing failed");
+
+        /* Publish: slots copied above may now be rebuilt */
+        epoch_.store(idx + 1, std::memory_order_seq_cst);
+        if (pool_ != nullptr) {
+            if (layers_ != 0) {
+                kick();
+            }
+        } else if (sleeping_.load(std::memory_order_seq_cst)) {
+            { std::lock_guard<std::mutex> lock(mu_); }
+            cv_.notify_one();
+        }
+        return p_->sig_bytes;
+    }
+
+    /** Sign msg into a freshly allocated buffer. */
+    std::vector<std::uint8_t> sign(bytes_view msg)
+    {
+        std::vector<std::uint8_t> sig(p_->sig_bytes);
+        sign(msg, mutable_bytes(sig.data(), sig.size()));
+        return sig;
+    }
+
+    /**
+     * Join the builder and hand every layer back to xmss_mt_sign(),
+     * finishing any next tree the builder had not got to.  Idempotent.
+     */
+    void stop()
+    {
+        if (pool_ != nullptr) {
+            std::unique_lock<std::mutex> lock(mu_);
+            bool first = !stopping_.exchange(true, std::memory_order_seq_cst);
+            cv_.wait(lock, [this] { return !queued_.load(std::memory_order_seq_cst); });
+            if (!first) {
+                return;
+            }
+        } else {
+            if (!worker_.joinable()) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                stopping_.store(true, std::memory_order_release);
+            }
+            cv_.notify_one();
+            worker_.join();
+        }
+
+        std::uint64_t idx = epoch_.load(std::memory_order_relaxed);
+        for (std::uint32_t i = 0; i + 1 < p_->d; i++) {
+            if (!((layers_ >> i) & 1u)) {
+                continue;
+            }
+            std::uint64_t want = (idx >> shift(i)) + 1;
+            if (want >= trees(i)) {
+                continue;
+            }
+            slot &s = slots_[i];
+            if (s.ready.load(std::memory_order_acquire) != want + 1) {
+                if (s.building != want + 1) {
+                    detail::check(xmss_mt_next_begin(p_, i, want, key_.bds_k(), s.nt.get()),
+                                  "next tree build failed");
+                }
+                (void)xmss_mt_next_step(p_, sk_.get(), key_.bds_k(), s.nt.get(),
+                                        std::uint32_t(1) << p_->tree_height);
+            }
+            xmss_mt_next_install(p_, key_.state_data(), slots_[i].nt.get());
+        }
+        layers_ = 0;
+    }
+
+    /** Boundary signatures that had to wait for the builder. */
+    std::uint64_t stalls() const noexcept { return stalls_.load(std::memory_order_relaxed); }
+
+private:
+    struct slot {
+        std::unique_ptr<xmss_mt_next_tree, detail::wiping_delete<xmss_mt_next_tree>> nt;
+        std::atomic<std::uint64_t> ready{ 0 };   /* tree index + 1; 0 = empty */
+        std::atomic<std::uint64_t> failed{ 0 };  /* tree index + 1 begin refused */
+        int           err      = XMSS_OK;        /* its code, published by failed */
+        std::uint64_t building = 0;              /* tree in nt, + 1 (builder only) */
+    };
+
+    /* xmss_mt_next_begin() would refuse every tree */
+    void check_bds_k() const
+    {
+        if ((key_.bds_k() & 1u) || key_.bds_k() > p_->tree_height) {
+            throw error(XMSS_ERR_PARAMS, "invalid bds_k");
+        }
+    }
+
+    std::uint32_t shift(std::uint32_t layer) const
+    {
+        return (layer + 1) * p_->tree_height;
+    }
+    /* Trees in a layer */
+    std::uint64_t trees(std::uint32_t layer) const
+    {
+        return std::uint64_t(1) << (p_->h - shift(layer));
+    }
+    /* Signing idx uses up the layer's current tree */
+    bool boundary(std::uint64_t idx, std::uint32_t layer) const
+    {
+        return ((idx + 1) & ((std::uint64_t(1) << shift(layer)) - 1)) == 0;
+    }
+
+    /* One step for epoch e: leaf_batch leaves of the lowest layer whose
+     * next tree is not ready (its boundary comes soonest).  false = all
+     * ready. */
+    bool work(std::uint64_t e)
+    {
+        for (std::uint32_t i = 0; i + 1 < p_->d; i++) {
+            std::uint64_t target = (e >> shift(i)) + 1;
+            slot         &s      = slots_[i];
+            if (!((layers_ >> i) & 1u) || target >= trees(i) ||
+                s.ready.load(std::memory_order_relaxed) == target + 1) {
+                continue;
+            }
+            if (s.building != target + 1) {
+                int rc = xmss_mt_next_begin(p_, i, target, key_.bds_k(), s.nt.get());
+                if (rc != XMSS_OK) {
+                    /* The boundary signature throws rather than waiting */
+                    s.err = rc;
+                    s.failed.store(target + 1, std::memory_order_release);
+                    continue;
+                }
+                s.building = target + 1;
+            }
+            if (xmss_mt_next_step(p_, sk_.get(), key_.bds_k(), s.nt.get(), leaf_batch) == 0) {
+                s.ready.store(target + 1, std::memory_order_release);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void run()
+    {
+        for (;;) {
+            std::uint64_t e = epoch_.load(std::memory_order_acquire);
+
+            if (stopping_.load(std::memory_order_acquire)) {
+                return;
+            }
+            if (!work(e)) {
+                std::unique_lock<std::mutex> lock(mu_);
+                sleeping_.store(true, std::memory_order_seq_cst);
+                cv_.wait(lock, [this, e] {
+                    return stopping_.load(std::memory_order_acquire) ||
+                           epoch_.load(std::memory_order_seq_cst) != e;
+                });
+                sleeping_.store(false, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /* Pool mode: queued_ is set while a step task is queued or running,
+     * so there is at most one. */
+    void kick()
+    {
+        if (!queued_.exchange(true, std::memory_order_seq_cst)) {
+            pool_->post_steps(prio_, [this] { return pool_step(); });
+        }
+    }
+
+    bool pool_step()
+    {
+        std::uint64_t e = epoch_.load(std::memory_order_acquire);
+
+        if (!stopping_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(build_mu_);
+            /* Reload under the lock: while we waited, sign() may have
+             * finished trees itself and moved past a whole tree, and
+             * work() on the old epoch would rebuild a slot it now reads */
+            e = epoch_.load(std::memory_order_acquire);
+            if (work(e)) {
+                return true;
+            }
+        }
+        /* Going idle.  A signature that published an epoch after the
+         * load above but saw queued_ still set posted nothing: take its
+         * work on here.  Under mu_ so stop() cannot return in between. */
+        std::lock_guard<std::mutex> lock(mu_);
+        queued_.store(false, std::memory_order_seq_cst);
+        if (!stopping_.load(std::memory_order_seq_cst) &&
+            epoch_.load(std::memory_order_seq_cst) != e &&
+            !queued_.exchange(true, std::memory_order_seq_cst)) {
+            return true;
+        }
+        cv_.notify_all();
+        return false;
+    }
+
+    mt_private_key                                                        &key_;
+    const xmss_params                                                     *p_;
+    std::unique_ptr<std::uint8_t[], detail::wiping_delete<std::uint8_t[]>> sk_;
+    std::vector<slot>                                                      slots_;
+    std::uint32_t                                                          layers_ = 0;
+    std::atomic<std::uint64_t>                                             epoch_{ 0 };
+    std::atomic<bool>                                                      stopping_{ false };
+    std::atomic<bool>                                                      sleeping_{ false };
+    std::atomic<bool>                                                      queued_{ false };
+    priority_pool                                                         *pool_ = nullptr;
+    priority                                                               prio_ = priority::advance;
+    std::atomic<std::uint64_t>                                             stalls_{ 0 };
+    std::mutex                                                             mu_;
+    std::mutex                                                             build_mu_;   /* pool mode: work() */
+    std::condition_variable                                                cv_;
+    std::thread                                                            worker_;
+};
+
+} // namespace xmss
+
+#endif /* XMSS_MT_BUILDER_HPP */
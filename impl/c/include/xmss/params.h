@@ -8,6 +8,10 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* Maximums for static buffer sizing (Jasmin Rule J1: no VLAs) */
 #define XMSS_MAX_N        64U
 #define XMSS_MAX_H        20U   /* max per-tree height (BDS arrays sized by this) */
@@ -17,14 +21,24 @@
  *   len1 = ceil(8*64/log2(16)) = ceil(512/4) = 128
  *   len2 = floor(log2(128*15)/4) + 1 = floor(10.9/4) + 1 = 3
  *   len  = 131
+ * Custom sets with n=32, w=4 need len1 = 128, len2 = 5, len = 133;
+ * n=64, w=4 (len 261) is out of range.
  */
-#define XMSS_MAX_WOTS_LEN 131U
+#define XMSS_MAX_WOTS_LEN 133U
 #define XMSS_MAX_BDS_K    4U   /* max BDS retain parameter (must be even, ≤ XMSS_MAX_H) */
 
+/* Hash lanes processed together by the word-interleaved leaf pipeline
+ * (WOTS+ keygen, chaining, L-tree).  Override with -DXMSS_HASH_LANES=N;
+ * 1 keeps the layout but hashes one leaf at a time. */
+#ifndef XMSS_HASH_LANES
+#define XMSS_HASH_LANES   4U
+#endif
+
 /* Hash function identifiers */
 #define XMSS_FUNC_SHA2    0
 #define XMSS_FUNC_SHAKE128 1
 #define XMSS_FUNC_SHAKE256 2
+#define XMSS_FUNC_LMS_SHA256 3   /* LMS/HSS sets (hss.h), RFC 8554 hashing */
 
 /**
  * xmss_params - all derived parameters for one XMSS/XMSS-MT instance.
@@ -40,8 +54,8 @@ typedef struct {
     uint32_t oid;
     uint8_t  func;        /* XMSS_FUNC_* */
     uint32_t n;           /* hash output / private key element size in bytes */
-    uint32_t w;           /* Winternitz parameter (4 or 16) */
-    uint32_t log2_w;      /* log2(w): 2 for w=4, 4 for w=16 */
+    uint32_t w;           /* Winternitz parameter (16; 4 or 256 for custom sets) */
+    uint32_t log2_w;      /* log2(w): 2 for w=4, 4 for w=16, 8 for w=256 */
     uint32_t len1;        /* ceil(8*n / log2(w)) */
     uint32_t len2;        /* floor(log2(len1*(w-1)) / log2(w)) + 1 */
     uint32_t len;         /* len1 + len2 */
@@ -89,6 +103,27 @@ int xmss_mt_params_from_oid(xmss_params *p, uint32_t oid);
  */
 int xmss_mt_params_from_name(xmss_params *p, const char *name);
 
+/**
+ * xmss_params_custom() - populate params for a private, non-RFC set.
+ *
+ * For internal deployments that trade signature size against CPU (e.g.
+ * short-lived tokens with h=8).  Keys and signatures are not interoperable:
+ * the OID written into them must come from the private-use range
+ * [OID_XMSS_PRIVATE_MIN, 0xFFFFFFFF], and signer and verifier must both
+ * call this with the same tuple - there is no registry lookup.
+ *
+ * func/n: XMSS_FUNC_SHA2 with n = 32 or 64, SHAKE128 with 32, SHAKE256 with 64.
+ * w:      4, 16 or 256 (n = 64 with w = 4 exceeds XMSS_MAX_WOTS_LEN).
+ * h, d:   1 <= d <= XMSS_MAX_D, h <= XMSS_MAX_FULL_H, d divides h and
+ *         h/d <= XMSS_MAX_H.  d = 1 is used with the xmss_* API, d > 1 with
+ *         xmss_mt_*; for d > 1 also h/d >= 2 and h not a multiple of 8
+ *         (the ceil(h/8)-byte index could not hold the exhausted value).
+ *
+ * Returns 0 on success, -1 if any field is out of range (p is untouched).
+ */
+int xmss_params_custom(xmss_params *p, uint32_t oid, uint8_t func,
+                       uint32_t n, uint32_t w, uint32_t h, uint32_t d);
+
 /* RFC 8391 Appendix A — XMSS OID values */
 #define OID_XMSS_SHA2_10_256   0x00000001U
 #define OID_XMSS_SHA2_16_256   0x00000002U
@@ -103,6 +138,10 @@ int xmss_mt_params_from_name(xmss_params *p, const char *name);
 #define OID_XMSS_SHAKE_16_512  0x0000000BU
 #define OID_XMSS_SHAKE_20_512  0x0000000CU
 
+/* RFC 8391 §9: 0xDDDDDDDD-0xFFFFFFFF are reserved for private use in both
+ * the XMSS and XMSS-MT registries (see xmss_params_custom()) */
+#define OID_XMSS_PRIVATE_MIN   0xDDDDDDDDU
+
 /*
  * RFC 8391 Appendix B — XMSS-MT OID values.
  *
@@ -152,4 +191,8 @@ int xmss_mt_params_from_name(xmss_params *p, const char *name);
 #define OID_XMSS_MT_SHAKE_60_6_512   0x0100001FU
 #define OID_XMSS_MT_SHAKE_60_12_512  0x01000020U
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* XMSS_PARAMS_H */
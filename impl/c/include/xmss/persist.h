@@ -0,0 +1,169 @@
+/**
+ * persist.h - Pipelined sign-and-persist of key state (Linux)
+ *
+ * Optional companion to the core library (CMake option XMSS_BUILD_PERSIST,
+ * library xmss_persist).  A signature may only be released once the SK
+ * index it advanced to is on stable storage; done synchronously, the
+ * fdatasync() dominates sign latency.  This module overlaps the two:
+ * signing index i+1 runs while the record for index i is written and
+ * flushed, and each signature is released as soon as its index is
+ * durable.
+ *
+ *   sign i   --> record(idx = i+1) --> write ==link==> fdatasync
+ *   sign i+1 --> record(idx = i+2) --> write ==link==> fdatasync
+ *   ...            at most depth records in flight
+ *   xmss_persist_durable() = highest idx whose fdatasync completed
+ *   release signature i once i < xmss_persist_durable()
+ *
+ * Records go to io_uring as a write linked to a datasync, so neither
+ * needs a thread.  When io_uring is unavailable (old kernel, seccomp) or
+ * XMSS_PERSIST_SYNC is given, each record is written with pwrite() and
+ * fdatasync() before xmss_persist_sign() returns, i.e. depth 1.
+ *
+ * File layout: depth + 1 fixed slots of one record each, used in turn.  A
+ * record is a 32-byte header (magic, idx, length, CRC-32) and SK || state,
+ * the state in its serialised form (xmss_bds_serialize() or
+ * xmss_mt_state_serialize()).
+ * The slot holding the newest durable record is never rewritten while
+ * later ones are in flight, so after a crash at any point the newest valid
+ * slot is at least as far along as every released signature;
+ * xmss_persist_load() picks it.
+ *
+ * Not thread-safe: one persister per key, driven by its signing thread.
+ */
+#ifndef XMSS_PERSIST_H
+#define XMSS_PERSIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xmss.h"
+
+/** Largest pipeline depth (records in flight) xmss_persist_open() takes. */
+#define XMSS_PERSIST_MAX_DEPTH 32U
+
+/** Flag for xmss_persist_open(): skip io_uring, write synchronously. */
+#define XMSS_PERSIST_SYNC 1
+
+/** How records reach the disk. */
+#define XMSS_PERSIST_BACKEND_URING 1   /* write + linked datasync, async */
+#define XMSS_PERSIST_BACKEND_SYNC  2   /* pwrite() + fdatasync() inline */
+
+/** Pipeline statistics (see xmss_persist_stats()). */
+typedef struct {
+    uint64_t records;     /* records submitted */
+    uint64_t durable;     /* records whose datasync completed */
+    uint64_t stalls;      /* signs that waited for a free slot */
+    uint32_t depth;       /* records allowed in flight */
+    uint32_t in_flight;   /* records submitted, not yet durable */
+    int      backend;     /* XMSS_PERSIST_BACKEND_* */
+} xmss_persist_stats_t;
+
+/** Persister handle.  Treat fields as private. */
+typedef struct {
+    xmss_params p;
+    uint32_t    bds_k;
+    int         fd;
+    uint32_t    state_bytes;    /* serialised state in a record */
+    uint32_t    slot_bytes;     /* record rounded up to the page size */
+    uint32_t    nslots;         /* depth + 1 */
+    uint8_t    *buf;            /* nslots record buffers */
+    uint64_t    slot_idx[XMSS_PERSIST_MAX_DEPTH + 1];
+    uint8_t     slot_busy[XMSS_PERSIST_MAX_DEPTH + 1];
+    uint32_t    cursor;         /* next slot to try */
+    uint32_t    durable_slot;   /* slot of the newest durable record */
+    uint64_t    durable_idx;    /* its idx, 0 = none yet */
+    int         error;          /* sticky XMSS_ERR_IO */
+    /* io_uring (opaque; ring_fd < 0 on the sync backend) */
+    int         ring_fd;
+    void       *sq_ring, *cq_ring, *sqes;
+    size_t      sq_ring_len, cq_ring_len, sqes_len;
+    uint32_t    sq_off[4], cq_off[4];
+    uint32_t    sqes_out;       /* SQEs the kernel took, CQE not yet reaped */
+    xmss_persist_stats_t st;
+} xmss_persist;
+
+/**
+ * xmss_persist_open() - Start a pipeline writing to fd.
+ *
+ * @ps:     Persister to initialise.
+ * @fd:     File opened for reading and writing; left open by
+ *          xmss_persist_close().  Records own the first
+ *          (depth + 1) * slot size bytes.
+ * @p:      Parameter set of the key (XMSS or XMSS-MT).
+ * @bds_k:  BDS retain parameter the key signs with.
+ * @depth:  Records allowed in flight, 1..XMSS_PERSIST_MAX_DEPTH.
+ * @flags:  0 or XMSS_PERSIST_SYNC.
+ *
+ * Falls back to the sync backend if io_uring cannot be set up.
+ * Returns XMSS_OK, or XMSS_ERR_PARAMS on bad arguments (including an odd
+ * bds_k or one above the tree height) or if the record buffers could not
+ * be mapped.
+ */
+int xmss_persist_open(xmss_persist *ps, int fd, const xmss_params *p,
+                      uint32_t bds_k, uint32_t depth, int flags);
+
+/**
+ * xmss_persist_sign() - xmss_sign(), then queue the advanced SK and state.
+ *
+ * @idx:  Receives the index of the signature.  Hold the signature until
+ *        *idx < xmss_persist_durable(ps).
+ *
+ * Waits for completions only when the pipeline is full.  Returns
+ * xmss_sign()'s error, or XMSS_ERR_IO once any write has failed (the
+ * persister is then unusable; keys must be reloaded from the file).
+ */
+int xmss_persist_sign(xmss_persist *ps, uint8_t *sig,
+                      const uint8_t *msg, size_t msglen,
+                      uint8_t *sk, xmss_bds_state *state, uint64_t *idx);
+
+/** xmss_mt_persist_sign() - As xmss_persist_sign(), for XMSS-MT keys. */
+int xmss_mt_persist_sign(xmss_persist *ps, uint8_t *sig,
+                         const uint8_t *msg, size_t msglen,
+                         uint8_t *sk, xmss_mt_state *state, uint64_t *idx);
+
+/**
+ * xmss_persist_poll() - Reap finished writes without submitting.
+ *
+ * @wait:  Non-zero to block until at least one record completes (returns
+ *         at once if nothing is in flight).
+ *
+ * Returns XMSS_OK or XMSS_ERR_IO.
+ */
+int xmss_persist_poll(xmss_persist *ps, int wait);
+
+/**
+ * xmss_persist_durable() - SK index of the newest durable record.
+ *
+ * Every signature with a smaller index may be released.  0 until the
+ * first record completes.  Advanced by sign, poll and drain.
+ */
+uint64_t xmss_persist_durable(const xmss_persist *ps);
+
+/** xmss_persist_drain() - Wait for every record in flight.  XMSS_OK or XMSS_ERR_IO. */
+int xmss_persist_drain(xmss_persist *ps);
+
+/** xmss_persist_close() - Drain, tear down the ring and wipe the buffers. */
+void xmss_persist_close(xmss_persist *ps);
+
+/** xmss_persist_stats() - Copy the pipeline statistics into *out. */
+void xmss_persist_stats(const xmss_persist *ps, xmss_persist_stats_t *out);
+
+/**
+ * xmss_persist_load() - Restore an XMSS key from the newest valid record.
+ *
+ * @fd:     File written by a persister with the same p and bds_k (any depth).
+ * @sk:     Output SK (p->sk_bytes).
+ * @state:  Output BDS state.
+ *
+ * Torn or foreign slots are skipped.  Returns XMSS_OK, XMSS_ERR_PARAMS if
+ * no slot holds a valid record for p, or XMSS_ERR_IO on a read error.
+ */
+int xmss_persist_load(int fd, const xmss_params *p, uint32_t bds_k,
+                      uint8_t *sk, xmss_bds_state *state);
+
+/** xmss_mt_persist_load() - As xmss_persist_load(), for XMSS-MT keys. */
+int xmss_mt_persist_load(int fd, const xmss_params *p, uint32_t bds_k,
+                         uint8_t *sk, xmss_mt_state *state);
+
+#endif /* XMSS_PERSIST_H */
@@ -0,0 +1,303 @@
+/**
+ * pool.hpp - Priority worker pool for signing, advancement and keygen (C++17)
+ *
+ * When live signing, background tree building and bulk key generation
+ * share cores through a FIFO pool (xmss::thread_pool), a signature
+ * queued behind a keygen waits for the whole keygen.  priority_pool
+ * keeps one queue per class and always takes from the highest non-empty
+ * one:
+ *
+ *   interactive   signing, verification someone is waiting on
+ *   advance       next-tree building (mt_builder)
+ *   bulk          key generation (generate_async())
+ *
+ * Long work is posted as a step task: a callable that does one bounded
+ * unit (leaf_batch leaves: xmss_keygen_step(), xmss_mt_next_step()) and
+ * returns whether more remains.  After each step the task goes back to
+ * the front of its class, so it carries on unless higher-class work has
+ * arrived, which then runs first: long work is preempted at leaf-batch
+ * boundaries, and a task never waits for more than one step per worker.
+ * Lower classes get every cycle the higher ones leave idle.  A step task
+ * runs on one worker at a time.
+ *
+ * Strict priority: a saturated higher class starves the lower ones.
+ * The pool is also a duck-typed Executor (see xmss.hpp); execute() and
+ * at(priority) post one-shot tasks, e.g. for verify_batch().
+ */
+#ifndef XMSS_POOL_HPP
+#define XMSS_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "xmss.hpp"
+
+namespace xmss {
+
+/** Task classes, highest first. */
+enum class priority : unsigned { interactive = 0, advance = 1, bulk = 2 };
+
+constexpr std::size_t priority_classes = 3;
+
+/** Leaves per step of stepped work: one lane group. */
+constexpr std::uint32_t leaf_batch = XMSS_HASH_LANES;
+
+class priority_pool {
+public:
+    /** Executor posting one-shot tasks at a fixed class. */
+    class executor {
+    public:
+        void execute(std::function<void()> task) const { pool_->post(prio_, std::move(task)); }
+
+    private:
+        friend class priority_pool;
+        executor(priority_pool *pool, priority prio) : pool_(pool), prio_(prio) {}
+
+        priority_pool *pool_;
+        priority       prio_;
+    };
+
+    explicit priority_pool(unsigned nthreads = std::thread::hardware_concurrency())
+    {
+        if (nthreads == 0) {
+            nthreads = 1;
+        }
+        workers_.reserve(nthreads);
+        for (unsigned i = 0; i < nthreads; i++) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    priority_pool(const priority_pool &) = delete;
+    priority_pool &operator=(const priority_pool &) = delete;
+
+    /** Runs every queued task, step tasks to completion, then joins. */
+    ~priority_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread &t : workers_) {
+            t.join();
+        }
+    }
+
+    /**
+     * Post a one-shot task at @prio.  An exception it throws has nowhere
+     * to go: the pool counts it in failures(), keeps it for last_error()
+     * and drops the task.
+     */
+    void post(priority prio, std::function<void()> task)
+    {
+        enqueue(prio, job{ [t = std::move(task)] { t(); return false; }, nullptr, false });
+    }
+
+    /**
+     * Post a step task at @prio: @step is called until it returns false.
+     * The future becomes ready after the last step, or carries the
+     * exception a step threw (no further steps are run).
+     */
+    std::future<void> post_steps(priority prio, std::function<bool()> step)
+    {
+        auto done = std::make_shared<std::promise<void>>();
+        std::future<void> fut = done->get_future();
+        enqueue(prio, job{ std::move(step), std::move(done), false });
+        return fut;
+    }
+
+    /** Executor: one-shot tasks at interactive priority. */
+    void execute(std::function<void()> task) { post(priority::interactive, std::move(task)); }
+
+    /** Executor posting at @prio; valid while the pool lives. */
+    executor at(priority prio) noexcept { return executor(this, prio); }
+
+    std::size_t size() const noexcept { return workers_.size(); }
+
+    /** Steps run in class @prio (one-shot tasks count one each). */
+    std::uint64_t steps(priority prio) const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        return steps_[static_cast<unsigned>(prio)];
+    }
+
+    /** Tasks run while a step task of a lower class was under way. */
+    std::uint64_t preemptions() const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        return preemptions_;
+    }
+
+    /** One-shot tasks that threw. */
+    std::uint64_t failures() const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        return failures_;
+    }
+
+    /** The latest exception a one-shot task threw, or null. */
+    std::exception_ptr last_error() const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        return last_error_;
+    }
+
+private:
+    struct job {
+        std::function<bool()>               step;
+        std::shared_ptr<std::promise<void>> done;   /* null for one-shot tasks */
+        bool                                started = false;
+    };
+
+    void enqueue(priority prio, job j)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            queues_[static_cast<unsigned>(prio)].push_back(std::move(j));
+        }
+        cv_.notify_one();
+    }
+
+    /* Highest non-empty class, or priority_classes */
+    unsigned pick() const
+    {
+        unsigned c = 0;
+        while (c < priority_classes && queues_[c].empty()) {
+            c++;
+        }
+        return c;
+    }
+
+    void run()
+    {
+        for (;;) {
+            job      j;
+            unsigned c;
+            bool     more = false;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                cv_.wait(lock, [this] { return stopping_ || pick() < priority_classes; });
+                c = pick();
+                if (c == priority_classes) {
+                    return;
+                }
+                j = std::move(queues_[c].front());
+                queues_[c].pop_front();
+                steps_[c]++;
+                for (unsigned k = c + 1; k < priority_classes; k++) {
+                    if (!queues_[k].empty() && queues_[k].front().started) {
+                        preemptions_++;
+                        break;
+                    }
+                }
+            }
+            /* Never rethrow on a worker: that would std::terminate() */
+            try {
+                more = j.step();
+            } catch (...) {
+                if (j.done) {
+                    j.done->set_exception(std::current_exception());
+                } else {
+                    std::lock_guard<std::mutex> lock(mu_);
+                    failures_++;
+                    last_error_ = std::current_exception();
+                }
+                continue;
+            }
+            if (!more) {
+                if (j.done) {
+                    j.done->set_value();
+                }
+                continue;
+            }
+            j.started = true;
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                queues_[c].push_front(std::move(j));
+            }
+            cv_.notify_one();
+        }
+    }
+
+    mutable std::mutex       mu_;
+    std::condition_variable  cv_;
+    std::deque<job>          queues_[priority_classes];
+    std::uint64_t            steps_[priority_classes] = {};
+    std::uint64_t            preemptions_ = 0;
+    std::uint64_t            failures_ = 0;
+    std::exception_ptr       last_error_;
+    std::vector<std::thread> workers_;
+    bool                     stopping_ = false;
+};
+
+/**
+ * generate_async() - basic_private_key<Traits>::generate() as a step task.
+ *
+ * Entropy is drawn and the seeds placed on the calling thread
+ * (xmss_keygen_begin()); the trees are then built leaf_batch leaves per
+ * step at @prio.  The key pair equals generate()'s for the same entropy.
+ * Throws xmss::error at once for bad parameters or failed entropy.
+ */
+template <class Traits>
+std::future<basic_keypair<Traits>>
+generate_async(priority_pool &pool, const params &p, std::uint32_t bds_k,
+               xmss_randombytes_fn randombytes, priority prio = priority::bulk)
+{
+    using state_type = typename Traits::state_type;
+
+    struct run {
+        params                                                                 p;
+        std::uint32_t                                                          bds_k;
+        xmss_keygen_ctx                                                        kc;
+        std::vector<std::uint8_t>                                              pk;
+        std::unique_ptr<std::uint8_t[], detail::wiping_delete<std::uint8_t[]>> sk;
+        std::unique_ptr<state_type, detail::wiping_delete<state_type>>         state;
+        std::promise<basic_keypair<Traits>>                                    done;
+
+        run(const params &pp, std::uint32_t k)
+            : p(pp), bds_k(k), kc(), pk(pp.pk_bytes()),
+              sk(new std::uint8_t[pp.sk_bytes()],
+                 detail::wiping_delete<std::uint8_t[]>{ pp.sk_bytes() }),
+              state(new state_type)
+        {
+        }
+    };
+
+    auto r = std::make_shared<run>(p, bds_k);
+    std::future<basic_keypair<Traits>> fut = r->done.get_future();
+
+    detail::check(Traits::keygen_begin(p.c_ptr(), &r->kc, r->sk.get(), r->state.get(),
+                                       bds_k, randombytes),
+                  "key generation failed");
+    pool.post_steps(prio, [r] {
+        try {
+            if (Traits::keygen_step(r->p.c_ptr(), &r->kc, r->pk.data(), r->sk.get(),
+                                    r->state.get(), r->bds_k, leaf_batch) > 0) {
+                return true;
+            }
+            r->done.set_value(basic_keypair<Traits>{
+                public_key(r->p, bytes_view(r->pk.data(), r->pk.size())),
+                basic_private_key<Traits>::restore(
+                    r->p, r->bds_k, bytes_view(r->sk.get(), r->p.sk_bytes()), *r->state) });
+        } catch (...) {
+            r->done.set_exception(std::current_exception());
+        }
+        return false;
+    });
+    return fut;
+}
+
+} // namespace xmss
+
+#endif /* XMSS_POOL_HPP */
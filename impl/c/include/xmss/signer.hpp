@@ -0,0 +1,406 @@
+/**
+ * signer.hpp - Single-writer signing runtime for one XMSS / XMSS-MT key
+ *
+ * A key's SK index and BDS state admit exactly one writer.  Instead of
+ * wrapping xmss_sign() in a mutex (and convoying every caller behind it),
+ * basic_signer_service owns the key on a dedicated thread and accepts
+ * requests from any number of producers through a bounded lock-free
+ * ring (mpsc_ring):
+ *
+ *   producers --try_push--> [ mpsc_ring ] --try_pop--> signer thread
+ *                                                      |  sign (+ BDS advance)
+ *                                                      |  ... up to max_batch
+ *                                                      |  commit(key)  (persist)
+ *                                                      v  complete futures / callbacks
+ *
+ * Requests are drained in batches of up to max_batch.  The optional
+ * commit hook runs once per batch, after the batch's signatures are made
+ * and before any of them is released, so one durable write of sk/state
+ * covers the whole batch.
+ *
+ * BDS advancement stays inside each xmss_sign() call: the treehash
+ * schedule must complete before the next leaf's auth path is formed, so
+ * it cannot be deferred across signatures.
+ */
+#ifndef XMSS_SIGNER_HPP
+#define XMSS_SIGNER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "xmss.hpp"
+
+namespace xmss {
+
+/* ====================================================================
+ * mpsc_ring - bounded lock-free multi-producer / single-consumer queue
+ *
+ * Sequence-numbered cells (Vyukov): a producer claims a slot with one
+ * CAS on the enqueue position and publishes it by bumping the cell's
+ * sequence; the single consumer never contends with anyone.
+ * ==================================================================== */
+
+template <class T>
+class mpsc_ring {
+public:
+    /** capacity is rounded up to a power of two (minimum 2). */
+    explicit mpsc_ring(std::size_t capacity)
+    {
+        std::size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        mask_  = cap - 1;
+        cells_ = std::unique_ptr<cell[]>(new cell[cap]);
+        for (std::size_t i = 0; i < cap; i++) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_ring(const mpsc_ring &) = delete;
+    mpsc_ring &operator=(const mpsc_ring &) = delete;
+
+    /** Returns false (and leaves v untouched) if the ring is full. */
+    bool try_push(T &v)
+    {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell &c = cells_[pos & mask_];
+            std::size_t seq = c.seq.load(std::memory_order_acquire);
+            std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq) -
+                                 static_cast<std::ptrdiff_t>(pos);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    c.value = std::move(v);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Consumer side only.  Returns false if the ring is empty. */
+    bool try_pop(T &out)
+    {
+        cell &c = cells_[tail_ & mask_];
+        std::size_t seq = c.seq.load(std::memory_order_acquire);
+        if (seq != tail_ + 1) {
+            return false;
+        }
+        out = std::move(c.value);
+        c.seq.store(tail_ + mask_ + 1, std::memory_order_release);
+        tail_++;
+        return true;
+    }
+
+    /** Consumer side only: true if a pop would currently succeed. */
+    bool ready() const
+    {
+        return cells_[tail_ & mask_].seq.load(std::memory_order_acquire) == tail_ + 1;
+    }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+private:
+    struct cell {
+        std::atomic<std::size_t> seq{ 0 };
+        T                        value{};
+    };
+
+    std::unique_ptr<cell[]>  cells_;
+    std::size_t              mask_ = 0;
+    alignas(64) std::atomic<std::size_t> head_{ 0 };
+    alignas(64) std::size_t  tail_ = 0;
+};
+
+/* ====================================================================
+ * basic_signer_service
+ * ==================================================================== */
+
+template <class Traits>
+class basic_signer_service {
+public:
+    using key_type = basic_private_key<Traits>;
+
+    /** Persist hook: called once per batch before its signatures are released. */
+    using commit_fn = std::function<void(const key_type &)>;
+
+    /** Completion callback: rc is XMSS_OK or an XMSS_ERR_* code (XMSS_ERR_IO
+     *  when the commit hook failed, XMSS_ERR_PARAMS for a non-xmss exception
+     *  such as std::bad_alloc); sig is only valid for the duration of the
+     *  call. */
+    using callback_fn = std::function<void(int rc, bytes_view sig)>;
+
+    struct options {
+        std::size_t queue_capacity = 1024;
+        std::size_t max_batch      = 64;
+        commit_fn   commit;
+    };
+
+    explicit basic_signer_service(key_type key) : basic_signer_service(std::move(key), options()) {}
+
+    basic_signer_service(key_type key, options opt)
+        : key_(std::move(key)), opt_(std::move(opt)),
+          ring_(opt_.queue_capacity),
+          sig_buf_(key_.parameters().sig_bytes())
+    {
+        if (opt_.max_batch == 0) {
+            opt_.max_batch = 1;
+        }
+        worker_ = std::thread([this] { run(); });
+    }
+
+    basic_signer_service(const basic_signer_service &) = delete;
+    basic_signer_service &operator=(const basic_signer_service &) = delete;
+
+    ~basic_signer_service() { shutdown(); }
+
+    /**
+     * submit() - queue msg for signing; the future yields the signature.
+     *
+     * Zero-copy: msg must stay valid until the future is ready.  Blocks
+     * (yielding) while the ring is full.  Throws std::logic_error after
+     * shutdown().
+     */
+    std::future<std::vector<std::uint8_t>> submit(bytes_view msg)
+    {
+        request r;
+        r.msg     = msg;
+        r.promise = std::make_shared<std::promise<std::vector<std::uint8_t>>>();
+        std::future<std::vector<std::uint8_t>> fut = r.promise->get_future();
+        enqueue(r);
+        return fut;
+    }
+
+    /** Callback flavour of submit(); cb runs on the signer thread. */
+    void submit(bytes_view msg, callback_fn cb)
+    {
+        request r;
+        r.msg = msg;
+        r.cb  = std::move(cb);
+        enqueue(r);
+    }
+
+    /** Non-blocking submit: returns false if the ring is full. */
+    bool try_submit(bytes_view msg, std::future<std::vector<std::uint8_t>> &out)
+    {
+        request r;
+        r.msg     = msg;
+        r.promise = std::make_shared<std::promise<std::vector<std::uint8_t>>>();
+        std::future<std::vector<std::uint8_t>> fut = r.promise->get_future();
+        if (!push(r)) {
+            return false;
+        }
+        out = std::move(fut);
+        return true;
+    }
+
+    /**
+     * shutdown() - stop accepting work, sign everything already queued,
+     * join the signer thread.  Idempotent.
+     */
+    void shutdown()
+    {
+        if (!worker_.joinable()) {
+            return;
+        }
+        stopping_.store(true, std::memory_order_seq_cst);
+        wake();
+        worker_.join();
+    }
+
+    /** Take the key back (e.g. to persist it); shuts the service down first. */
+    key_type release()
+    {
+        shutdown();
+        return std::move(key_);
+    }
+
+    std::uint64_t signatures() const noexcept { return n_sigs_.load(std::memory_order_relaxed); }
+    std::uint64_t batches() const noexcept { return n_batches_.load(std::memory_order_relaxed); }
+
+private:
+    struct request {
+        bytes_view                                               msg;
+        std::shared_ptr<std::promise<std::vector<std::uint8_t>>> promise;
+        callback_fn                                              cb;
+    };
+
+    /* Outcome of one request within a batch, released after commit. */
+    struct done {
+        request                   req;
+        std::vector<std::uint8_t> sig;
+        int                       rc = XMSS_OK;
+        std::exception_ptr        err;
+    };
+
+    /*
+     * A producer is counted in pushing_ from before its stopping_ check
+     * until its push is visible, and the signer thread only exits once
+     * stopping_ is set and pushing_ is zero with the ring empty.  Both
+     * sides are seq_cst, so either the producer sees stopping_ and throws
+     * or the signer sees it in flight and drains its request.
+     */
+    bool push(request &r)
+    {
+        pushing_.fetch_add(1, std::memory_order_seq_cst);
+        if (stopping_.load(std::memory_order_seq_cst)) {
+            pushing_.fetch_sub(1, std::memory_order_release);
+            throw std::logic_error("xmss::signer_service: submit after shutdown");
+        }
+        bool ok = ring_.try_push(r);
+        pushing_.fetch_sub(1, std::memory_order_release);
+        if (ok) {
+            wake_if_sleeping();
+        }
+        return ok;
+    }
+
+    void enqueue(request &r)
+    {
+        while (!push(r)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void wake_if_sleeping()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            wake();
+        }
+    }
+
+    void wake()
+    {
+        { std::lock_guard<std::mutex> lock(mu_); }
+        cv_.notify_one();
+    }
+
+    /* Park the signer thread until work arrives or shutdown is requested. */
+    void wait_for_work()
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cv_.wait(lock, [this] {
+            return ring_.ready() || stopping_.load(std::memory_order_acquire);
+        });
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    void run()
+    {
+        std::vector<done> batch;
+        batch.reserve(opt_.max_batch);
+
+        for (;;) {
+            request r;
+            while (batch.size() < opt_.max_batch && ring_.try_pop(r)) {
+                batch.push_back(sign_one(std::move(r)));
+                r = request();
+            }
+            if (!batch.empty()) {
+                release_batch(batch);
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire)) {
+                /* Producers past their stopping_ check may still publish. */
+                if (pushing_.load(std::memory_order_seq_cst) == 0 && !ring_.ready()) {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            wait_for_work();
+        }
+    }
+
+    done sign_one(request r)
+    {
+        done d;
+        d.req = std::move(r);
+        try {
+            key_.sign(d.req.msg, mutable_bytes(sig_buf_.data(), sig_buf_.size()));
+            d.sig.assign(sig_buf_.begin(), sig_buf_.end());
+            n_sigs_.fetch_add(1, std::memory_order_relaxed);
+        } catch (const error &e) {
+            d.rc  = e.code();
+            d.err = std::current_exception();
+        } catch (...) {
+            /* e.g. std::bad_alloc from the copy: fail this request only */
+            d.rc  = XMSS_ERR_PARAMS;
+            d.err = std::current_exception();
+        }
+        return d;
+    }
+
+    void release_batch(std::vector<done> &batch)
+    {
+        std::exception_ptr commit_err;
+        if (opt_.commit) {
+            try {
+                opt_.commit(key_);
+            } catch (...) {
+                commit_err = std::current_exception();
+            }
+        }
+        n_batches_.fetch_add(1, std::memory_order_relaxed);
+
+        for (done &d : batch) {
+            /* A failed commit withholds every signature in the batch. */
+            std::exception_ptr err = commit_err ? commit_err : d.err;
+            if (d.req.promise) {
+                if (err) {
+                    d.req.promise->set_exception(err);
+                } else {
+                    d.req.promise->set_value(std::move(d.sig));
+                }
+            } else if (d.req.cb) {
+                if (err) {
+                    d.req.cb(commit_err ? XMSS_ERR_IO : d.rc, bytes_view());
+                } else {
+                    d.req.cb(XMSS_OK, bytes_view(d.sig.data(), d.sig.size()));
+                }
+            }
+        }
+        batch.clear();
+    }
+
+    key_type                   key_;
+    options                    opt_;
+    mpsc_ring<request>         ring_;
+    std::vector<std::uint8_t>  sig_buf_;
+
+    std::mutex                 mu_;
+    std::condition_variable    cv_;
+    std::atomic<bool>          sleeping_{ false };
+    std::atomic<bool>          stopping_{ false };
+    std::atomic<std::size_t>   pushing_{ 0 };
+    std::atomic<std::uint64_t> n_sigs_{ 0 };
+    std::atomic<std::uint64_t> n_batches_{ 0 };
+    std::thread                worker_;
+};
+
+using signer_service    = basic_signer_service<single_tree>;
+using mt_signer_service = basic_signer_service<multi_tree>;
+
+} // namespace xmss
+
+#endif /* XMSS_SIGNER_HPP */
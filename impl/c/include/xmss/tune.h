@@ -0,0 +1,90 @@
+/**
+ * tune.h - Hash backend selection and startup autotuner
+ *
+ * Two choices are made at run time:
+ *   - leaf pipeline width: 1 (each leaf through the scalar F/H, which is
+ *     libcrypto's single-stream SHA-NI / ARMv8 SHA with XMSS_USE_OPENSSL)
+ *     or XMSS_HASH_LANES (the word-interleaved multi-lane kernels);
+ *   - Keccak-f[1600]: portable, or the ARMv8.2 SHA3 kernel when built in
+ *     and the CPU has it.
+ * Which one wins depends on the host (SHA extensions, vector width, SMT
+ * siblings sharing the vector unit) and the parameter set.
+ *
+ * xmss_backend_get() / xmss_backend_set() are part of libxmss and are
+ * always available; the selection is process-wide, so set it before
+ * signing threads start (it is held in atomics, so a late change is
+ * not a data race, and running threads pick it up at their next leaf
+ * with identical output).  xmss_autotune() lives in the optional
+ * xmss_tune library (CMake option XMSS_BUILD_TUNE; needs a hosted
+ * clock_gettime and stdio): it times each candidate on the active
+ * parameter set for a few milliseconds, pins the fastest, and can cache
+ * the decision in a small text file keyed by OID and host fingerprint.
+ */
+#ifndef XMSS_TUNE_H
+#define XMSS_TUNE_H
+
+#include <stdint.h>
+
+#include "xmss.h"
+
+/* Keccak-f[1600] implementations */
+#define XMSS_KECCAK_GENERIC     0U
+#define XMSS_KECCAK_ARM64_SHA3  1U
+
+/* SHA-2 block function (fixed at build time) */
+#define XMSS_SHA2_PORTABLE      0U
+#define XMSS_SHA2_LIBCRYPTO     1U
+
+/* Where the current selection came from */
+#define XMSS_TUNE_DEFAULT       0U   /* build defaults, nothing chosen yet */
+#define XMSS_TUNE_PINNED        1U   /* xmss_backend_set() */
+#define XMSS_TUNE_MEASURED      2U   /* xmss_autotune() benchmark */
+#define XMSS_TUNE_CACHED        3U   /* xmss_autotune() cache hit */
+
+/* Candidates: index = (leaf_lanes > 1) * 2 + keccak */
+#define XMSS_TUNE_CANDIDATES    4U
+
+/** Current backend selection (see xmss_backend_get()). */
+typedef struct {
+    uint32_t leaf_lanes;   /* 1 or XMSS_HASH_LANES */
+    uint32_t keccak;       /* XMSS_KECCAK_* */
+    uint32_t sha2;         /* XMSS_SHA2_* (informational) */
+    uint32_t source;       /* XMSS_TUNE_* */
+    uint32_t oid;          /* parameter set it was tuned for; 0 if not tuned */
+    uint32_t max_lanes;    /* XMSS_HASH_LANES of this build */
+    uint32_t keccak_avail; /* bit k set if XMSS_KECCAK_k can be selected */
+    uint64_t ns_per_leaf[XMSS_TUNE_CANDIDATES]; /* measured cost; 0 = not run */
+} xmss_backend_info;
+
+/** xmss_backend_get() - Copy the current selection and availability. */
+void xmss_backend_get(xmss_backend_info *out);
+
+/**
+ * xmss_backend_set() - Select leaf_lanes and keccak from *in.  Every
+ * setting produces identical outputs; only speed differs.
+ *
+ * The selection is recorded as XMSS_TUNE_PINNED, unless in->source is
+ * XMSS_TUNE_MEASURED or XMSS_TUNE_CACHED, in which case source, oid and
+ * ns_per_leaf are kept as given (this is how xmss_autotune() records).
+ *
+ * Returns XMSS_OK, or XMSS_ERR_PARAMS if leaf_lanes is neither 1 nor
+ * XMSS_HASH_LANES or the Keccak implementation is unavailable here.
+ */
+int xmss_backend_set(const xmss_backend_info *in);
+
+/**
+ * xmss_autotune() - Benchmark the candidates for p and pin the fastest.
+ *
+ * @p:          Parameter set the signer will use.
+ * @cache_path: Optional file.  A valid entry for p->oid and this host is
+ *              applied without measuring (source XMSS_TUNE_CACHED);
+ *              otherwise the result is measured and written back.
+ * @out:        Optional; receives the resulting selection.
+ *
+ * Returns XMSS_OK (cache write failures are not errors), or
+ * XMSS_ERR_PARAMS if p is NULL.
+ */
+int xmss_autotune(const xmss_params *p, const char *cache_path,
+                  xmss_backend_info *out);
+
+#endif /* XMSS_TUNE_H */
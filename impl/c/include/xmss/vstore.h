@@ -0,0 +1,159 @@
+/**
+ * vstore.h - Memory-mapped store of verify contexts, keyed by public key
+ *
+ * Optional companion to the core library (CMake option XMSS_BUILD_VSTORE,
+ * library xmss_vstore; POSIX mmap).  A verifier that trusts many public
+ * keys otherwise rebuilds its key table on every start: resolve each OID
+ * to an xmss_params (or re-run xmss_params_custom() for private sets),
+ * copy the key and insert it into a lookup structure.  The store keeps
+ * that table on disk in its final form, so opening it is one mmap and a
+ * 64-byte header check whatever the key count, and pages fault in as
+ * lookups touch them.
+ *
+ * Each record is an xmss_vctx: the resolved parameter set and the public
+ * key, laid out exactly as xmss_verify() / xmss_mt_verify() take them.
+ * Records are found through an open-addressing table (linear probing,
+ * load factor at most 1/2) hashed on the key's root:
+ *
+ *   header(64: "XMSSVCX1" | byte order | record size | slots | count)
+ *   slots    u32[slots], record index + 1, 0 = empty
+ *   records  xmss_vctx[slots / 2]
+ *
+ * The file is in host byte order and xmss_vctx layout; a store written by
+ * a build with a different layout is refused at open, not converted.
+ *
+ * One writer at a time (an exclusive flock on the file), any number of
+ * readers in any process.  xmss_vstore_add() appends in place, record
+ * first and slot last, so readers mapping the file see the key at once.
+ * A full table is rebuilt at twice the size into a new file that is
+ * renamed over the old one: readers keep the old mapping until
+ * xmss_vstore_refresh().  Appends are durable after xmss_vstore_sync() or
+ * xmss_vstore_close(); the store is a cache of the trusted key list, and
+ * anything lost to a crash before that is added again from the list.
+ *
+ * The records are trusted like the key list they come from; lookups still
+ * range-check a record's parameters (a few compares) before handing it
+ * to the verifier, so a damaged file cannot make it overrun its buffers.
+ */
+#ifndef XMSS_VSTORE_H
+#define XMSS_VSTORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xmss.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest public key a record holds: OID || root || SEED at n = 64. */
+#define XMSS_VSTORE_PK_MAX   (4U + 2U * XMSS_MAX_N)
+
+/** Longest store path, terminator included. */
+#define XMSS_VSTORE_PATH_MAX 4096U
+
+/** Flag for xmss_vstore_open(): open for appending, create if missing. */
+#define XMSS_VSTORE_WRITE 1
+
+/**
+ * xmss_vctx - One verify context, as mapped from the store.
+ *
+ * params and pk go straight to the verifier:
+ *   xmss_verify(&c->params, msg, len, sig, c->pk)      (params.d == 1)
+ *   xmss_mt_verify(&c->params, msg, len, sig, c->pk)   (params.d > 1)
+ */
+typedef struct {
+    xmss_params params;
+    uint8_t     pk[XMSS_VSTORE_PK_MAX];   /* params.pk_bytes used, rest zero */
+} xmss_vctx;
+
+/** Store handle.  Treat fields as private. */
+typedef struct {
+    uint8_t *base;       /* mapping, NULL when closed */
+    size_t   size;
+    int      fd;
+    int      writable;
+    uint64_t dev, ino;   /* identity of the mapped file (refresh) */
+    char     path[XMSS_VSTORE_PATH_MAX];
+} xmss_vstore;
+
+/**
+ * xmss_vstore_open() - Map a store.
+ *
+ * @vs:    Handle to initialise.
+ * @path:  Store file.  With XMSS_VSTORE_WRITE a missing file is created
+ *         empty, and @path + ".tmp" is used while the table grows.
+ * @flags: 0 (read-only) or XMSS_VSTORE_WRITE.
+ *
+ * Reads the header only.  Returns XMSS_OK, XMSS_ERR_PARAMS if @path is
+ * too long, or XMSS_ERR_IO if the file cannot be opened or mapped, is not
+ * a store of this layout, or another writer holds it.
+ */
+int xmss_vstore_open(xmss_vstore *vs, const char *path, int flags);
+
+/**
+ * xmss_vstore_add() - Append a public key.
+ *
+ * @p:  Parameter set of the key, XMSS or XMSS-MT (from the OID table or
+ *      xmss_params_custom()); stored as is.
+ * @pk: Public key, p->pk_bytes bytes, OID matching p->oid.
+ *
+ * Adding a key that is already present with the same parameter set does
+ * nothing.  Returns XMSS_OK; XMSS_ERR_PARAMS for a read-only handle, an
+ * LMS set, a key whose OID does not match, or a key already present with
+ * a different set; XMSS_ERR_IO if the table could not be grown.
+ */
+int xmss_vstore_add(xmss_vstore *vs, const xmss_params *p, const uint8_t *pk);
+
+/**
+ * xmss_vstore_find() - Verify context of a public key.
+ *
+ * @pk:    Public key bytes as carried by the caller.
+ * @pklen: Their length.
+ *
+ * Expected O(1): hashes the root and probes the slots.  The result points
+ * into the mapping and stays valid until the handle is refreshed or
+ * closed.  Returns NULL if the key is not in the store.
+ */
+const xmss_vctx *xmss_vstore_find(const xmss_vstore *vs,
+                                  const uint8_t *pk, size_t pklen);
+
+/**
+ * xmss_vstore_verify() - xmss_verify() or xmss_mt_verify() under the
+ * stored context of @pk.
+ *
+ * @sig: Signature, params.sig_bytes bytes of the stored set.
+ *
+ * Returns the verifier's result, or XMSS_ERR_VERIFY if @pk is not in the
+ * store (an unknown key is not trusted).
+ */
+int xmss_vstore_verify(const xmss_vstore *vs,
+                       const uint8_t *msg, size_t msglen,
+                       const uint8_t *sig,
+                       const uint8_t *pk, size_t pklen);
+
+/** xmss_vstore_count() - Keys in the store. */
+uint32_t xmss_vstore_count(const xmss_vstore *vs);
+
+/**
+ * xmss_vstore_refresh() - Remap if the file at the path was replaced
+ * (the writer grew the table); a no-op otherwise.  Pointers from
+ * xmss_vstore_find() are invalidated when it remaps.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_IO if the new file cannot be mapped (the
+ * handle keeps the old mapping).
+ */
+int xmss_vstore_refresh(xmss_vstore *vs);
+
+/** xmss_vstore_sync() - Write appended records back to disk (XMSS_ERR_IO on failure). */
+int xmss_vstore_sync(xmss_vstore *vs);
+
+/** xmss_vstore_close() - Sync (writers), unmap and close.  Safe on a closed handle. */
+void xmss_vstore_close(xmss_vstore *vs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XMSS_VSTORE_H */
@@ -25,12 +25,18 @@
 
 #include "params.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /** Error codes */
 #define XMSS_OK            0
 #define XMSS_ERR_PARAMS   (-1)
 #define XMSS_ERR_ENTROPY  (-2)
 #define XMSS_ERR_VERIFY   (-3)
 #define XMSS_ERR_EXHAUSTED (-4)  /* key index exhausted */
+#define XMSS_ERR_IO       (-5)  /* state write failed (persist.h) */
+#define XMSS_ERR_FAULT    (-6)  /* *_sign_checked(): signature failed its self-check */
 
 /**
  * Entropy callback type.
@@ -57,6 +63,28 @@ int xmss_verify(const xmss_params *p,
                 const uint8_t *msg, size_t msglen,
                 const uint8_t *sig, const uint8_t *pk);
 
+/**
+ * xmss_verify_batch() - Verify count independent XMSS signatures.
+ *
+ * Same result as xmss_verify() on each (msgs[i], sigs[i], pks[i]); the
+ * message hashes of up to 16 items at a time are computed together by a
+ * multi-buffer hash engine, which dominates verification of long messages.
+ *
+ * @p:       Parameter set (shared by all items).
+ * @count:   Number of items.
+ * @msgs:    count message pointers.
+ * @msglens: count message lengths.
+ * @sigs:    count signatures (p->sig_bytes bytes each).
+ * @pks:     count public keys (p->pk_bytes bytes each).
+ * @results: Optional; if non-NULL receives XMSS_OK or XMSS_ERR_VERIFY per item.
+ *
+ * Returns XMSS_OK if every signature is valid, XMSS_ERR_VERIFY otherwise.
+ */
+int xmss_verify_batch(const xmss_params *p, size_t count,
+                      const uint8_t *const *msgs, const size_t *msglens,
+                      const uint8_t *const *sigs, const uint8_t *const *pks,
+                      int *results);
+
 /* ====================================================================
  * BDS state types
  *
@@ -129,6 +157,44 @@ int xmss_keygen(const xmss_params *p, uint8_t *pk, uint8_t *sk,
                 xmss_bds_state *state, uint32_t bds_k,
                 xmss_randombytes_fn randombytes);
 
+/**
+ * xmss_keygen_ctx - Progress of a key generation run in steps.
+ *
+ * xmss_keygen() builds the whole tree in one call, as begin plus a
+ * single step over every leaf.  Smaller steps split it at leaf
+ * boundaries so a scheduler can run other work in between (see
+ * xmss/pool.hpp); the result is byte-identical.
+ */
+typedef struct {
+    uint32_t trees;         /* trees finished; 1 (XMSS) or d (XMSS-MT) = done */
+} xmss_keygen_ctx;
+
+/**
+ * xmss_keygen_begin() - Start a stepped xmss_keygen().
+ *
+ * Samples the seeds and writes @sk (root still zero); no hashing.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS if bds_k is invalid, or
+ * XMSS_ERR_ENTROPY.
+ */
+int xmss_keygen_begin(const xmss_params *p, xmss_keygen_ctx *kc,
+                      uint8_t *sk, xmss_bds_state *state, uint32_t bds_k,
+                      xmss_randombytes_fn randombytes);
+
+/**
+ * xmss_keygen_step() - Compute up to @leaves more leaves of the tree.
+ *
+ * The step that computes the last leaf also writes the root to @sk and
+ * @pk; until then @pk is untouched and the key must not be used.  @sk,
+ * @state and @bds_k are those given to xmss_keygen_begin().
+ *
+ * Returns the number of leaves still to compute (0 = key ready), or
+ * XMSS_ERR_PARAMS for @leaves = 0.
+ */
+int xmss_keygen_step(const xmss_params *p, xmss_keygen_ctx *kc,
+                     uint8_t *pk, uint8_t *sk, xmss_bds_state *state,
+                     uint32_t bds_k, uint32_t leaves);
+
 /**
  * xmss_sign() - Sign a message using BDS-accelerated auth path.
  *
@@ -155,6 +221,62 @@ int xmss_sign(const xmss_params *p, uint8_t *sig,
               const uint8_t *msg, size_t msglen,
               uint8_t *sk, xmss_bds_state *state, uint32_t bds_k);
 
+/**
+ * xmss_sign_checked() - xmss_sign() with a verify-after-sign fault check.
+ *
+ * Before returning, completes the WOTS+ chains from the produced
+ * signature, runs the L-tree and walks the auth path up to the root in
+ * @sk, as xmss_verify() would, but reuses the signing message digest
+ * instead of hashing @msg again.  A mismatch means a fault during signing.
+ *
+ * Returns as xmss_sign(), plus XMSS_ERR_FAULT: @sig is zeroed and must not
+ * be released.  The index and @state still advance, so the next call
+ * signs with a fresh leaf.
+ */
+int xmss_sign_checked(const xmss_params *p, uint8_t *sig,
+                      const uint8_t *msg, size_t msglen,
+                      uint8_t *sk, xmss_bds_state *state, uint32_t bds_k);
+
+/**
+ * xmss_skip() - Consume the current index without signing.
+ *
+ * Increments the index in @sk and advances @state exactly as xmss_sign()
+ * would, so the key then signs as if a signature had been made.  Used to
+ * give up indices that may have been used, e.g. when replaying a saved
+ * state up to a recorded reservation.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_EXHAUSTED if the key is exhausted.
+ */
+int xmss_skip(const xmss_params *p, uint8_t *sk, xmss_bds_state *state,
+              uint32_t bds_k);
+
+/**
+ * xmss_retune() - Switch a key's BDS state to another bds_k.
+ *
+ * Rebuilds the treehash instances and retain nodes of @state for @new_k
+ * at the key's current index; auth and keep nodes do not depend on bds_k
+ * and are kept.  The key then signs exactly as one generated with @new_k,
+ * so the memory/latency trade-off of a deployed key can change without
+ * a new key.  Costs under 2^(th - new_k) leaves for the instances plus
+ * about 2^th - idx for the retained levels, all as lane-batched subtrees;
+ * at most one keygen.
+ *
+ * @p:     Parameter set.
+ * @sk:    Secret key (p->sk_bytes bytes); read-only.
+ * @state: BDS state for @bds_k, converted in place.
+ * @bds_k: Retain parameter @state was built with.
+ * @new_k: Retain parameter to switch to (even, <= min(th, XMSS_MAX_BDS_K)).
+ *
+ * Pass @new_k to every later call on the key, and serialize the state
+ * with xmss_bds_serialized_size(p, new_k) bytes.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS for an invalid @bds_k or @new_k or a
+ * corrupt @state (treehash stack usage past the shared stack; @state is
+ * left as it was), or XMSS_ERR_EXHAUSTED if the key is exhausted.
+ */
+int xmss_retune(const xmss_params *p, const uint8_t *sk, xmss_bds_state *state,
+                uint32_t bds_k, uint32_t new_k);
+
 /**
  * xmss_remaining_sigs() - Query how many signatures remain in an XMSS key.
  *
@@ -234,6 +356,10 @@ typedef struct xmss_mt_state {
      * wots_sigs[i] = signature of layer i's root by layer i+1.
      * d-1 cached signatures. */
     uint8_t wots_sigs[XMSS_MAX_D - 1][XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+
+    /* roots[i] = root of layer i's current tree, the message signed by
+     * wots_sigs[i] (xmss_mt_sign_checked() compares against it). */
+    uint8_t roots[XMSS_MAX_D - 1][XMSS_MAX_N];
 } xmss_mt_state;
 
 /**
@@ -252,6 +378,21 @@ int xmss_mt_keygen(const xmss_params *p, uint8_t *pk, uint8_t *sk,
                   xmss_mt_state *state, uint32_t bds_k,
                   xmss_randombytes_fn randombytes);
 
+/**
+ * xmss_mt_keygen_begin() / xmss_mt_keygen_step() - Stepped
+ * xmss_mt_keygen(), as xmss_keygen_begin() / xmss_keygen_step().
+ *
+ * Layers are built bottom-up; a step that finishes a layer's tree below
+ * the top also WOTS+-signs its root.  The count returned covers every
+ * layer still to build.
+ */
+int xmss_mt_keygen_begin(const xmss_params *p, xmss_keygen_ctx *kc,
+                         uint8_t *sk, xmss_mt_state *state, uint32_t bds_k,
+                         xmss_randombytes_fn randombytes);
+int xmss_mt_keygen_step(const xmss_params *p, xmss_keygen_ctx *kc,
+                        uint8_t *pk, uint8_t *sk, xmss_mt_state *state,
+                        uint32_t bds_k, uint32_t leaves);
+
 /**
  * xmss_mt_sign() - Sign a message using XMSS-MT hypertree.
  *
@@ -269,6 +410,158 @@ int xmss_mt_sign(const xmss_params *p, uint8_t *sig,
                 const uint8_t *msg, size_t msglen,
                 uint8_t *sk, xmss_mt_state *state, uint32_t bds_k);
 
+/**
+ * xmss_mt_sign_checked() - xmss_mt_sign() with a verify-after-sign fault
+ * check; see xmss_sign_checked().
+ *
+ * The bottom layer is checked on every call against the cached root of
+ * its tree, so the cost is one layer of xmss_mt_verify() rather than d.
+ * Layer i > 0 is checked, up to the next cached root, on the calls where
+ * its part of the signature changes (idx a multiple of 2^(i*h/d)), which
+ * covers each cached WOTS+ signature before it is first released.
+ */
+int xmss_mt_sign_checked(const xmss_params *p, uint8_t *sig,
+                         const uint8_t *msg, size_t msglen,
+                         uint8_t *sk, xmss_mt_state *state, uint32_t bds_k);
+
+/**
+ * xmss_mt_next_tree - A layer's next tree, built outside xmss_mt_sign().
+ *
+ * xmss_mt_sign() grows the next tree of every layer below the top a leaf
+ * at a time and, when a layer's current tree is used up, swaps it in and
+ * WOTS+-signs its root at the layer above.  xmss_mt_next_build() does
+ * both in one call, on any thread, so a helper can take that work off
+ * the signing path (see xmss/mt_builder.hpp).
+ */
+typedef struct {
+    xmss_bds_state bds;     /* complete, as after 2^(h/d) incremental updates */
+    uint8_t  wots_sig[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];  /* root signed by layer+1 */
+    uint64_t tree;          /* tree index within the layer */
+    uint32_t layer;
+} xmss_mt_next_tree;
+
+/**
+ * xmss_mt_next_build() - Build tree @tree of @layer and sign its root.
+ *
+ * Reads only SK_SEED and SEED from @sk, so it may run concurrently with
+ * xmss_mt_sign() on the same key (which writes only the index bytes).
+ *
+ * @p:     Parameter set (d > 1).
+ * @sk:    Secret key.
+ * @layer: Layer, 0 <= layer < d-1 (the top layer has no next tree).
+ * @tree:  Tree index, < 2^(h - (layer+1)*h/d).
+ * @bds_k: BDS retain parameter of the key.
+ * @out:   Output.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_PARAMS for an out-of-range argument.
+ */
+int xmss_mt_next_build(const xmss_params *p, const uint8_t *sk,
+                       uint32_t layer, uint64_t tree, uint32_t bds_k,
+                       xmss_mt_next_tree *out);
+
+/**
+ * xmss_mt_next_begin() / xmss_mt_next_step() - xmss_mt_next_build() in
+ * steps of at most @leaves leaves.
+ *
+ * begin validates as xmss_mt_next_build() and does no hashing; the step
+ * that computes the last leaf signs the root.  The finished @out is
+ * byte-identical to xmss_mt_next_build()'s.
+ *
+ * xmss_mt_next_step() returns the number of leaves still to compute
+ * (0 = @out complete), or XMSS_ERR_PARAMS for @leaves = 0.
+ */
+int xmss_mt_next_begin(const xmss_params *p, uint32_t layer, uint64_t tree,
+                       uint32_t bds_k, xmss_mt_next_tree *out);
+int xmss_mt_next_step(const xmss_params *p, const uint8_t *sk,
+                      uint32_t bds_k, xmss_mt_next_tree *out, uint32_t leaves);
+
+/**
+ * xmss_mt_sign_ext() - xmss_mt_sign() with next trees built elsewhere.
+ *
+ * Layers whose bit is set in @ext_layers get no incremental next-tree
+ * work.  When such a layer crosses a tree boundary, @next[layer] must hold
+ * the tree that follows (xmss_mt_next_build()); it is copied in, together
+ * with its precomputed WOTS+ signature.  Signatures are byte-identical to
+ * xmss_mt_sign()'s.  xmss_mt_sign() is xmss_mt_sign_ext() with
+ * @ext_layers = 0.
+ *
+ * A layer leaves the external mode mid-tree through xmss_mt_next_install()
+ * with the tree that follows its current one.
+ *
+ * @ext_layers: Bit i set: layer i (< d-1) is built externally.
+ * @next:       d-1 entries, read only at those layers' boundaries; may be
+ *              NULL when @ext_layers is 0.
+ *
+ * Returns as xmss_mt_sign(), plus XMSS_ERR_PARAMS, with @sk unchanged, if
+ * a boundary needs a next tree that @next does not hold complete.
+ */
+int xmss_mt_sign_ext(const xmss_params *p, uint8_t *sig,
+                     const uint8_t *msg, size_t msglen,
+                     uint8_t *sk, xmss_mt_state *state, uint32_t bds_k,
+                     uint32_t ext_layers,
+                     const xmss_mt_next_tree *const *next);
+
+/**
+ * xmss_mt_next_install() - Hand a layer back to xmss_mt_sign().
+ *
+ * Stores @nt as the next tree of its layer, complete, so incremental
+ * updates stop and the boundary swap picks it up.  @nt must be the tree
+ * that follows the layer's current tree.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_PARAMS for a layer >= d-1.
+ */
+int xmss_mt_next_install(const xmss_params *p, xmss_mt_state *state,
+                         const xmss_mt_next_tree *nt);
+
+/**
+ * xmss_mt_skip() - Consume the current index without signing.
+ *
+ * XMSS-MT counterpart of xmss_skip(): the state advances as in
+ * xmss_mt_sign(), tree boundaries included.
+ *
+ * Returns XMSS_OK, or XMSS_ERR_EXHAUSTED if the key is exhausted.
+ */
+int xmss_mt_skip(const xmss_params *p, uint8_t *sk, xmss_mt_state *state,
+                 uint32_t bds_k);
+
+/**
+ * xmss_mt_retune() - Switch every layer's BDS state to another bds_k.
+ *
+ * XMSS-MT counterpart of xmss_retune(): each layer's current tree is
+ * converted at its leaf, and each partly built next tree is rebuilt to
+ * the same progress, which costs up to one more tree per layer.  Pass
+ * @new_k to every later call; the state serialises in
+ * xmss_mt_state_bytes(p, new_k) bytes.  Next trees installed with
+ * xmss_mt_next_install() are rebuilt too; an mt_builder
+ * (xmss/mt_builder.hpp) running for the key must be restarted.
+ *
+ * Returns as xmss_retune(), except that on a corrupt @state the layers
+ * below the corrupt one are already converted.
+ */
+int xmss_mt_retune(const xmss_params *p, const uint8_t *sk,
+                   xmss_mt_state *state, uint32_t bds_k, uint32_t new_k);
+
+/**
+ * xmss_mt_state_bytes() - Size of a serialised xmss_mt_state.
+ *
+ * Returns the number of bytes xmss_mt_state_serialize() writes for the
+ * given parameter set and bds_k value.
+ */
+uint32_t xmss_mt_state_bytes(const xmss_params *p, uint32_t bds_k);
+
+/**
+ * xmss_mt_state_serialize() / xmss_mt_state_deserialize() - Flat,
+ * big-endian form: the 2d-1 BDS states as xmss_bds_serialize(), then the
+ * cached WOTS signatures and roots of layers 0..d-2.
+ *
+ * Returns XMSS_OK, XMSS_ERR_PARAMS for d < 2 or an invalid bds_k, or
+ * the first error from xmss_bds_serialize() / xmss_bds_deserialize().
+ */
+int xmss_mt_state_serialize(const xmss_params *p, uint8_t *buf,
+                            const xmss_mt_state *state, uint32_t bds_k);
+int xmss_mt_state_deserialize(const xmss_params *p, xmss_mt_state *state,
+                              const uint8_t *buf, uint32_t bds_k);
+
 /**
  * xmss_mt_remaining_sigs() - Query how many signatures remain in an XMSS-MT key.
  *
@@ -298,6 +591,17 @@ int xmss_mt_verify(const xmss_params *p,
                   const uint8_t *msg, size_t msglen,
                   const uint8_t *sig, const uint8_t *pk);
 
+/**
+ * xmss_mt_verify_batch() - XMSS-MT counterpart of xmss_verify_batch().
+ *
+ * Returns XMSS_OK if every signature is valid, XMSS_ERR_VERIFY otherwise;
+ * per-item results as for xmss_verify_batch().
+ */
+int xmss_mt_verify_batch(const xmss_params *p, size_t count,
+                         const uint8_t *const *msgs, const size_t *msglens,
+                         const uint8_t *const *sigs, const uint8_t *const *pks,
+                         int *results);
+
 /* ====================================================================
  * Naive API (gated behind XMSS_NAIVE_AUTH_PATH)
  *
@@ -321,4 +625,8 @@ int xmss_sign_naive(const xmss_params *p, uint8_t *sig,
 
 #endif /* XMSS_NAIVE_AUTH_PATH */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* XMSS_H */
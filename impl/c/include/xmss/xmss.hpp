@@ -0,0 +1,709 @@
+/**
+ * xmss.hpp - Header-only C++17 wrapper for the XMSS / XMSS-MT C API
+ *
+ * Thin RAII layer over xmss.h for C++ consumers:
+ *   - xmss::params              value wrapper around xmss_params
+ *   - xmss::private_key,        move-only owners of SK bytes + BDS state
+ *     xmss::mt_private_key      (~5 KB / ~220 KB; never copied implicitly)
+ *   - xmss::span                zero-copy byte views (std::span under C++20)
+ *   - xmss::verify_batch,       std::future-returning batch operations on a
+ *     xmss::sign_batch          caller-supplied executor
+ *
+ * The C library stays C99 and malloc-free; every heap allocation made on
+ * behalf of the caller lives in this header.  Errors from keygen/sign are
+ * reported as xmss::error exceptions carrying the XMSS_ERR_* code; verify
+ * returns bool.
+ *
+ * Executors are duck-typed: any object with a member
+ *   void execute(std::function<void()> task)
+ * can be passed where a template parameter is named Executor.
+ * xmss::inline_executor and xmss::thread_pool are provided, and
+ * xmss::priority_pool (xmss/pool.hpp) when signing has to share cores
+ * with background work.
+ */
+#ifndef XMSS_HPP
+#define XMSS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define XMSS_HPP_STD_SPAN 1
+#endif
+#endif
+
+#include "xmss.h"
+
+namespace xmss {
+
+/* ====================================================================
+ * Byte views
+ * ==================================================================== */
+
+#ifdef XMSS_HPP_STD_SPAN
+template <class T>
+using span = std::span<T>;
+#else
+/** Minimal stand-in for std::span<T> (dynamic extent only) for C++17. */
+template <class T>
+class span {
+public:
+    using element_type = T;
+    using value_type   = std::remove_cv_t<T>;
+    using size_type    = std::size_t;
+    using pointer      = T *;
+    using reference    = T &;
+    using iterator     = T *;
+
+    constexpr span() noexcept : data_(nullptr), size_(0) {}
+    constexpr span(T *data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+    template <std::size_t N>
+    constexpr span(T (&arr)[N]) noexcept : data_(arr), size_(N) {}
+
+    /* Any contiguous container exposing data()/size() (vector, array, ...) */
+    template <class C,
+              class = std::enable_if_t<
+                  !std::is_array_v<std::remove_reference_t<C>> &&
+                  std::is_convertible_v<
+                      std::remove_pointer_t<decltype(std::declval<C &>().data())> (*)[],
+                      T (*)[]>>>
+    constexpr span(C &c) noexcept : data_(c.data()), size_(c.size()) {}
+
+    /* span<U> -> span<const U> */
+    template <class U,
+              class = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    constexpr span(const span<U> &o) noexcept : data_(o.data()), size_(o.size()) {}
+
+    constexpr T *data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr std::size_t size_bytes() const noexcept { return size_ * sizeof(T); }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T *begin() const noexcept { return data_; }
+    constexpr T *end() const noexcept { return data_ + size_; }
+    constexpr T &operator[](std::size_t i) const noexcept { return data_[i]; }
+
+    constexpr span subspan(std::size_t off, std::size_t count) const noexcept
+    {
+        return span(data_ + off, count);
+    }
+    constexpr span first(std::size_t count) const noexcept
+    {
+        return span(data_, count);
+    }
+
+private:
+    T          *data_;
+    std::size_t size_;
+};
+#endif /* XMSS_HPP_STD_SPAN */
+
+using bytes_view    = span<const std::uint8_t>;
+using mutable_bytes = span<std::uint8_t>;
+
+/** View the bytes of a string (e.g. a message) without copying. */
+inline bytes_view as_bytes(std::string_view s) noexcept
+{
+    return bytes_view(reinterpret_cast<const std::uint8_t *>(s.data()), s.size());
+}
+
+/* ====================================================================
+ * Errors
+ * ==================================================================== */
+
+/** Thrown when a C API call fails; code() is the XMSS_ERR_* value. */
+class error : public std::runtime_error {
+public:
+    error(int code, const char *what) : std::runtime_error(what), code_(code) {}
+    int code() const noexcept { return code_; }
+
+private:
+    int code_;
+};
+
+namespace detail {
+
+inline void check(int rc, const char *what)
+{
+    if (rc != XMSS_OK) {
+        throw error(rc, what);
+    }
+}
+
+/* Zero a buffer in a way the optimiser may not elide (mirrors xmss_memzero). */
+inline void wipe(void *ptr, std::size_t len) noexcept
+{
+    volatile std::uint8_t *p = static_cast<volatile std::uint8_t *>(ptr);
+    for (std::size_t i = 0; i < len; i++) {
+        p[i] = 0;
+    }
+}
+
+/* Deleter that wipes secret material before releasing it. */
+template <class T>
+struct wiping_delete {
+    std::size_t len = sizeof(T);
+    void operator()(T *ptr) const noexcept
+    {
+        if (ptr != nullptr) {
+            wipe(ptr, len);
+            delete ptr;
+        }
+    }
+};
+
+template <>
+struct wiping_delete<std::uint8_t[]> {
+    std::size_t len = 0;
+    void operator()(std::uint8_t *ptr) const noexcept
+    {
+        if (ptr != nullptr) {
+            wipe(ptr, len);
+            delete[] ptr;
+        }
+    }
+};
+
+} // namespace detail
+
+/* ====================================================================
+ * Parameters
+ * ==================================================================== */
+
+/** Immutable, copyable wrapper around a derived xmss_params. */
+class params {
+public:
+    /** XMSS (single-tree) parameter set from an RFC 8391 OID. */
+    static params from_oid(std::uint32_t oid)
+    {
+        xmss_params p;
+        detail::check(xmss_params_from_oid(&p, oid), "unknown XMSS OID");
+        return params(p);
+    }
+
+    /** XMSS-MT parameter set from an RFC 8391 (or prefixed internal) OID. */
+    static params mt_from_oid(std::uint32_t oid)
+    {
+        xmss_params p;
+        detail::check(xmss_mt_params_from_oid(&p, oid), "unknown XMSS-MT OID");
+        return params(p);
+    }
+
+    /** Parameter set from its RFC name ("XMSS-..." or "XMSSMT-..."). */
+    static params from_name(const std::string &name)
+    {
+        xmss_params p;
+        if (xmss_params_from_name(&p, name.c_str()) == XMSS_OK ||
+            xmss_mt_params_from_name(&p, name.c_str()) == XMSS_OK) {
+            return params(p);
+        }
+        throw error(XMSS_ERR_PARAMS, "unknown parameter set name");
+    }
+
+    explicit params(const xmss_params &p) noexcept : p_(p) {}
+
+    const xmss_params &c() const noexcept { return p_; }
+    const xmss_params *c_ptr() const noexcept { return &p_; }
+
+    std::uint32_t oid() const noexcept { return p_.oid; }
+    std::size_t sig_bytes() const noexcept { return p_.sig_bytes; }
+    std::size_t pk_bytes() const noexcept { return p_.pk_bytes; }
+    std::size_t sk_bytes() const noexcept { return p_.sk_bytes; }
+    bool is_mt() const noexcept { return p_.d > 1; }
+
+private:
+    xmss_params p_;
+};
+
+/* ====================================================================
+ * Scheme traits: bind the C entry points for XMSS vs XMSS-MT
+ * ==================================================================== */
+
+struct single_tree {
+    using state_type = xmss_bds_state;
+
+    static int keygen(const xmss_params *p, std::uint8_t *pk, std::uint8_t *sk,
+                      state_type *st, std::uint32_t bds_k, xmss_randombytes_fn rb)
+    {
+        return xmss_keygen(p, pk, sk, st, bds_k, rb);
+    }
+    static int keygen_begin(const xmss_params *p, xmss_keygen_ctx *kc, std::uint8_t *sk,
+                            state_type *st, std::uint32_t bds_k, xmss_randombytes_fn rb)
+    {
+        return xmss_keygen_begin(p, kc, sk, st, bds_k, rb);
+    }
+    static int keygen_step(const xmss_params *p, xmss_keygen_ctx *kc, std::uint8_t *pk,
+                           std::uint8_t *sk, state_type *st, std::uint32_t bds_k,
+                           std::uint32_t leaves)
+    {
+        return xmss_keygen_step(p, kc, pk, sk, st, bds_k, leaves);
+    }
+    static int sign(const xmss_params *p, std::uint8_t *sig,
+                    const std::uint8_t *msg, std::size_t msglen,
+                    std::uint8_t *sk, state_type *st, std::uint32_t bds_k)
+    {
+        return xmss_sign(p, sig, msg, msglen, sk, st, bds_k);
+    }
+    static std::uint64_t remaining(const xmss_params *p, const std::uint8_t *sk)
+    {
+        return xmss_remaining_sigs(p, sk);
+    }
+    static int retune(const xmss_params *p, const std::uint8_t *sk, state_type *st,
+                      std::uint32_t bds_k, std::uint32_t new_k)
+    {
+        return xmss_retune(p, sk, st, bds_k, new_k);
+    }
+};
+
+struct multi_tree {
+    using state_type = xmss_mt_state;
+
+    static int keygen(const xmss_params *p, std::uint8_t *pk, std::uint8_t *sk,
+                      state_type *st, std::uint32_t bds_k, xmss_randombytes_fn rb)
+    {
+        return xmss_mt_keygen(p, pk, sk, st, bds_k, rb);
+    }
+    static int keygen_begin(const xmss_params *p, xmss_keygen_ctx *kc, std::uint8_t *sk,
+                            state_type *st, std::uint32_t bds_k, xmss_randombytes_fn rb)
+    {
+        return xmss_mt_keygen_begin(p, kc, sk, st, bds_k, rb);
+    }
+    static int keygen_step(const xmss_params *p, xmss_keygen_ctx *kc, std::uint8_t *pk,
+                           std::uint8_t *sk, state_type *st, std::uint32_t bds_k,
+                           std::uint32_t leaves)
+    {
+        return xmss_mt_keygen_step(p, kc, pk, sk, st, bds_k, leaves);
+    }
+    static int sign(const xmss_params *p, std::uint8_t *sig,
+                    const std::uint8_t *msg, std::size_t msglen,
+                    std::uint8_t *sk, state_type *st, std::uint32_t bds_k)
+    {
+        return xmss_mt_sign(p, sig, msg, msglen, sk, st, bds_k);
+    }
+    static std::uint64_t remaining(const xmss_params *p, const std::uint8_t *sk)
+    {
+        return xmss_mt_remaining_sigs(p, sk);
+    }
+    static int retune(const xmss_params *p, const std::uint8_t *sk, state_type *st,
+                      std::uint32_t bds_k, std::uint32_t new_k)
+    {
+        return xmss_mt_retune(p, sk, st, bds_k, new_k);
+    }
+};
+
+/* ====================================================================
+ * Verification (stateless)
+ * ==================================================================== */
+
+/** Verify sig over msg under pk.  Undersized buffers verify as false. */
+inline bool verify(const params &p, bytes_view msg, bytes_view sig, bytes_view pk)
+{
+    int rc;
+    if (sig.size() < p.sig_bytes() || pk.size() < p.pk_bytes()) {
+        return false;
+    }
+    if (p.is_mt()) {
+        rc = xmss_mt_verify(p.c_ptr(), msg.data(), msg.size(), sig.data(), pk.data());
+    } else {
+        rc = xmss_verify(p.c_ptr(), msg.data(), msg.size(), sig.data(), pk.data());
+    }
+    return rc == XMSS_OK;
+}
+
+/** Public key: small and immutable, so freely copyable. */
+class public_key {
+public:
+    public_key(const params &p, bytes_view bytes)
+        : p_(p), bytes_(bytes.begin(), bytes.end())
+    {
+        if (bytes_.size() != p_.pk_bytes()) {
+            throw error(XMSS_ERR_PARAMS, "public key has wrong length");
+        }
+    }
+
+    const params &parameters() const noexcept { return p_; }
+    bytes_view bytes() const noexcept { return bytes_view(bytes_.data(), bytes_.size()); }
+
+    bool verify(bytes_view msg, bytes_view sig) const
+    {
+        return xmss::verify(p_, msg, sig, bytes());
+    }
+
+private:
+    params                    p_;
+    std::vector<std::uint8_t> bytes_;
+};
+
+/* ====================================================================
+ * Private keys (move-only)
+ * ==================================================================== */
+
+template <class Traits>
+class basic_private_key;
+
+template <class Traits>
+struct basic_keypair {
+    public_key                pub;
+    basic_private_key<Traits> priv;
+};
+
+/**
+ * basic_private_key - owns the SK bytes and the traversal state.
+ *
+ * Move-only: the state is heap-allocated once and only its pointer moves,
+ * so deep copies of the BDS / hypertree state cannot happen by accident.
+ * Secret material is wiped on destruction.  A key is not thread-safe;
+ * callers serialise access (see sign_batch()).
+ */
+template <class Traits>
+class basic_private_key {
+public:
+    using state_type = typename Traits::state_type;
+
+    /** Generate a fresh key pair. */
+    static basic_keypair<Traits> generate(const params &p, std::uint32_t bds_k,
+                                          xmss_randombytes_fn randombytes)
+    {
+        basic_private_key key(p, bds_k);
+        std::vector<std::uint8_t> pk(p.pk_bytes());
+        detail::check(Traits::keygen(p.c_ptr(), pk.data(), key.sk_.get(),
+                                     key.state_.get(), bds_k, randombytes),
+                      "key generation failed");
+        return basic_keypair<Traits>{ public_key(p, bytes_view(pk.data(), pk.size())),
+                                      std::move(key) };
+    }
+
+    /**
+     * Restore a key from persisted SK bytes and traversal state.
+     * The state is copied once into owned storage.
+     */
+    static basic_private_key restore(const params &p, std::uint32_t bds_k,
+                                     bytes_view sk, const state_type &state)
+    {
+        basic_private_key key(p, bds_k);
+        if (sk.size() != p.sk_bytes()) {
+            throw error(XMSS_ERR_PARAMS, "secret key has wrong length");
+        }
+        std::copy(sk.begin(), sk.end(), key.sk_.get());
+        *key.state_ = state;
+        return key;
+    }
+
+    basic_private_key(const basic_private_key &) = delete;
+    basic_private_key &operator=(const basic_private_key &) = delete;
+    basic_private_key(basic_private_key &&) noexcept = default;
+    basic_private_key &operator=(basic_private_key &&) noexcept = default;
+    ~basic_private_key() = default;
+
+    /**
+     * Sign msg into a caller-provided buffer (at least sig_bytes()).
+     * Returns the number of bytes written.  The SK index advances before
+     * return; persist sk_bytes() and state() before releasing the signature.
+     * Throws std::logic_error on a moved-from key.
+     */
+    std::size_t sign(bytes_view msg, mutable_bytes sig)
+    {
+        require_key("sign");
+        if (sig.size() < p_.sig_bytes()) {
+            throw error(XMSS_ERR_PARAMS, "signature buffer too small");
+        }
+        detail::check(Traits::sign(p_.c_ptr(), sig.data(), msg.data(), msg.size(),
+                                   sk_.get(), state_.get(), bds_k_),
+                      "signing failed");
+        return p_.sig_bytes();
+    }
+
+    /** Sign msg into a freshly allocated buffer. */
+    std::vector<std::uint8_t> sign(bytes_view msg)
+    {
+        std::vector<std::uint8_t> sig(p_.sig_bytes());
+        sign(msg, mutable_bytes(sig.data(), sig.size()));
+        return sig;
+    }
+
+    std::uint64_t remaining() const
+    {
+        require_key("remaining");
+        return Traits::remaining(p_.c_ptr(), sk_.get());
+    }
+
+    /**
+     * Switch the traversal state to new_k at the current index (see
+     * xmss_retune()).  bds_k() reports new_k afterwards; persist state()
+     * with it.
+     */
+    void retune(std::uint32_t new_k)
+    {
+        require_key("retune");
+        detail::check(Traits::retune(p_.c_ptr(), sk_.get(), state_.get(), bds_k_, new_k),
+                      "retune failed");
+        bds_k_ = new_k;
+    }
+
+    const params &parameters() const noexcept { return p_; }
+    std::uint32_t bds_k() const noexcept { return bds_k_; }
+
+    /** SK bytes for persistence (view into owned storage). */
+    bytes_view sk_bytes() const noexcept { return bytes_view(sk_.get(), p_.sk_bytes()); }
+
+    /** Traversal state for persistence (e.g. xmss_bds_serialize()). */
+    const state_type &state() const noexcept { return *state_; }
+
+    /** Raw access for callers that drive the C API directly. */
+    std::uint8_t *sk_data() noexcept { return sk_.get(); }
+    state_type *state_data() noexcept { return state_.get(); }
+
+private:
+    /* A moved-from key has no sk or state left to act on */
+    void require_key(const char *op) const
+    {
+        if (!sk_ || !state_) {
+            throw std::logic_error(std::string("xmss::private_key: ") + op +
+                                   " on a moved-from key");
+        }
+    }
+
+    basic_private_key(const params &p, std::uint32_t bds_k)
+        : p_(p), bds_k_(bds_k),
+          sk_(new std::uint8_t[p.sk_bytes()],
+              detail::wiping_delete<std::uint8_t[]>{ p.sk_bytes() }),
+          state_(new state_type)
+    {
+    }
+
+    params                                                               p_;
+    std::uint32_t                                                        bds_k_;
+    std::unique_ptr<std::uint8_t[], detail::wiping_delete<std::uint8_t[]>> sk_;
+    std::unique_ptr<state_type, detail::wiping_delete<state_type>>       state_;
+};
+
+using private_key    = basic_private_key<single_tree>;
+using mt_private_key = basic_private_key<multi_tree>;
+using keypair        = basic_keypair<single_tree>;
+using mt_keypair     = basic_keypair<multi_tree>;
+
+/* ====================================================================
+ * Executors
+ * ==================================================================== */
+
+/** Runs each task immediately on the submitting thread. */
+struct inline_executor {
+    void execute(std::function<void()> task) const { task(); }
+};
+
+/**
+ * thread_pool - fixed-size FIFO worker pool.
+ *
+ * The destructor drains queued tasks before joining the workers.
+ */
+class thread_pool {
+public:
+    explicit thread_pool(unsigned nthreads = std::thread::hardware_concurrency())
+    {
+        if (nthreads == 0) {
+            nthreads = 1;
+        }
+        workers_.reserve(nthreads);
+        for (unsigned i = 0; i < nthreads; i++) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread &t : workers_) {
+            t.join();
+        }
+    }
+
+    void execute(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    std::size_t size() const noexcept { return workers_.size(); }
+
+private:
+    void run()
+    {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex                        mu_;
+    std::condition_variable           cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread>          workers_;
+    bool                              stopping_ = false;
+};
+
+/* ====================================================================
+ * Batch operations
+ * ==================================================================== */
+
+/** One verification job.  Views must stay valid until the future is ready. */
+struct verify_item {
+    bytes_view msg;
+    bytes_view sig;
+    bytes_view pk;
+};
+
+/** Items per verify_batch() task; matches the C batch chunk size. */
+constexpr std::size_t verify_chunk = 16;
+
+namespace detail {
+
+/* Verify items[first, last) with one C batch call.  Undersized buffers
+ * verify as false without reaching the C layer. */
+inline void verify_range(const params &p, const std::vector<verify_item> &items,
+                         std::size_t first, std::size_t last, unsigned char *ok)
+{
+    const std::uint8_t *msgs[verify_chunk], *sigs[verify_chunk], *pks[verify_chunk];
+    std::size_t         lens[verify_chunk], slot[verify_chunk];
+    int                 rc[verify_chunk];
+    std::size_t         k = 0;
+
+    for (std::size_t i = first; i < last; i++) {
+        const verify_item &it = items[i];
+        ok[i] = 0;
+        if (it.sig.size() < p.sig_bytes() || it.pk.size() < p.pk_bytes()) {
+            continue;
+        }
+        msgs[k] = it.msg.data();
+        lens[k] = it.msg.size();
+        sigs[k] = it.sig.data();
+        pks[k]  = it.pk.data();
+        slot[k] = i;
+        k++;
+    }
+    if (p.is_mt()) {
+        (void)xmss_mt_verify_batch(p.c_ptr(), k, msgs, lens, sigs, pks, rc);
+    } else {
+        (void)xmss_verify_batch(p.c_ptr(), k, msgs, lens, sigs, pks, rc);
+    }
+    for (std::size_t j = 0; j < k; j++) {
+        ok[slot[j]] = rc[j] == XMSS_OK ? 1 : 0;
+    }
+}
+
+} // namespace detail
+
+/**
+ * verify_batch() - Verify items in parallel on ex.
+ *
+ * One task per verify_chunk items, each handing its chunk to
+ * xmss_verify_batch() / xmss_mt_verify_batch() so the message hashes run
+ * through the multi-buffer engine; result[i] is true iff items[i] verifies.
+ */
+template <class Executor>
+std::future<std::vector<bool>> verify_batch(Executor &ex, const params &p,
+                                            std::vector<verify_item> items)
+{
+    struct batch {
+        params                          p;
+        std::vector<verify_item>        items;
+        std::vector<unsigned char>      ok;
+        std::atomic<std::size_t>        pending;
+        std::promise<std::vector<bool>> done;
+
+        batch(const params &pp, std::vector<verify_item> it, std::size_t tasks)
+            : p(pp), items(std::move(it)), ok(items.size(), 0), pending(tasks)
+        {
+        }
+        void finish()
+        {
+            done.set_value(std::vector<bool>(ok.begin(), ok.end()));
+        }
+    };
+
+    const std::size_t n      = items.size();
+    const std::size_t chunks = (n + verify_chunk - 1) / verify_chunk;
+
+    auto b = std::make_shared<batch>(p, std::move(items), chunks);
+    std::future<std::vector<bool>> fut = b->done.get_future();
+
+    if (chunks == 0) {
+        b->finish();
+        return fut;
+    }
+    for (std::size_t first = 0; first < n; first += verify_chunk) {
+        std::size_t last = n - first < verify_chunk ? n : first + verify_chunk;
+        ex.execute([b, first, last] {
+            detail::verify_range(b->p, b->items, first, last, b->ok.data());
+            if (b->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                b->finish();
+            }
+        });
+    }
+    return fut;
+}
+
+/**
+ * sign_batch() - Sign msgs in order as a single task on ex.
+ *
+ * Signing mutates the key, so the batch runs sequentially; the key must
+ * outlive the future and must not be used by anyone else until it is ready.
+ * A signing error is delivered through the future.
+ */
+template <class Executor, class Traits>
+std::future<std::vector<std::vector<std::uint8_t>>>
+sign_batch(Executor &ex, basic_private_key<Traits> &key, std::vector<bytes_view> msgs)
+{
+    using result_t = std::vector<std::vector<std::uint8_t>>;
+    auto task = std::make_shared<std::packaged_task<result_t()>>(
+        [&key, msgs = std::move(msgs)] {
+            result_t sigs;
+            sigs.reserve(msgs.size());
+            for (const bytes_view &m : msgs) {
+                sigs.push_back(key.sign(m));
+            }
+            return sigs;
+        });
+    std::future<result_t> fut = task->get_future();
+    ex.execute([task] { (*task)(); });
+    return fut;
+}
+
+} // namespace xmss
+
+#endif /* XMSS_HPP */
@@ -0,0 +1,775 @@
+/**
+ * xmssmodule.c - CPython extension for the XMSS / XMSS-MT C API
+ *
+ * Module `xmss` (CMake option XMSS_BUILD_PYTHON):
+ *   - xmss.generate(name, bds_k=0, seed=None) -> xmss.Key
+ *   - xmss.restore(name, secret_key, state, bds_k=0) -> xmss.Key
+ *   - xmss.verify(name, message, signature, public_key) -> bool
+ *   - xmss.verify_batch(name, messages, signatures, public_keys,
+ *                       threads=0) -> list of bool
+ *   - xmss.params(name) -> dict of sizes
+ *
+ * Messages, signatures and public keys are taken through the buffer
+ * protocol (bytes, bytearray, memoryview, numpy arrays, mmap ...) and are
+ * never copied; signatures are written straight into the returned bytes.
+ * The GIL is released around every keygen, sign and verify, and
+ * verify_batch() spreads its items over native threads, so one process
+ * can keep every core busy.
+ *
+ * A Key owns its SK bytes and BDS / hypertree state in native memory
+ * (wiped on release) and is opaque to Python: only the public key, the
+ * SK bytes needed to persist the index, and the serialized BDS state
+ * (xmss_bds_serialize(), or xmss_mt_state_serialize() for XMSS-MT) are
+ * readable.  Signing on one Key is serialised by a
+ * per-key lock; different keys sign in parallel.
+ *
+ * Not part of the Jasmin-portable core: this is the one translation unit
+ * that allocates and creates threads on behalf of Python callers.
+ */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/random.h>
+#include <unistd.h>
+
+#include "xmss/xmss.h"
+#include "xmss/params.h"
+#include "utils.h"
+
+/* Items per native verify call; matches the multi-buffer engine's chunk */
+#define PY_VERIFY_CHUNK   16U
+/* Upper bound on verify_batch worker threads */
+#define PY_MAX_THREADS    256U
+
+static PyObject *XmssError;
+
+/* ====================================================================
+ * Helpers
+ * ==================================================================== */
+
+static int resolve_params(const char *name, xmss_params *p)
+{
+    if (xmss_params_from_name(p, name) == XMSS_OK ||
+        xmss_mt_params_from_name(p, name) == XMSS_OK) {
+        return 0;
+    }
+    PyErr_Format(PyExc_ValueError, "unknown XMSS / XMSS-MT parameter set '%s'", name);
+    return -1;
+}
+
+static PyObject *raise_code(int code, const char *what)
+{
+    PyObject *args = Py_BuildValue("(is)", code, what);
+    if (args != NULL) {
+        PyErr_SetObject(XmssError, args);
+        Py_DECREF(args);
+    }
+    return NULL;
+}
+
+/* getrandom(2), retried on short reads and EINTR */
+static int os_randombytes(uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t got = getrandom(buf, len, 0);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buf += got;
+        len -= (size_t)got;
+    }
+    return 0;
+}
+
+/*
+ * Caller-supplied keygen seed (KATs, tests).  The entropy callback has no
+ * context argument, so seeded keygen keeps the GIL, which guards these.
+ */
+static const uint8_t *seed_buf;
+static size_t         seed_left;
+
+static int seed_randombytes(uint8_t *buf, size_t len)
+{
+    if (seed_buf == NULL || len > seed_left) {
+        return -1;
+    }
+    memcpy(buf, seed_buf, len);
+    seed_buf  += len;
+    seed_left -= len;
+    return 0;
+}
+
+/* ====================================================================
+ * xmss.Key
+ * ==================================================================== */
+
+typedef struct {
+    PyObject_HEAD
+    xmss_params         p;
+    uint32_t            bds_k;
+    uint8_t            *pk;
+    uint8_t            *sk;
+    void               *state;   /* xmss_bds_state (d = 1) or xmss_mt_state */
+    size_t              state_size;
+    PyThread_type_lock  lock;    /* serialises sign on this key */
+} KeyObject;
+
+static PyTypeObject KeyType;
+
+static KeyObject *key_alloc(const xmss_params *p, uint32_t bds_k)
+{
+    KeyObject *k = PyObject_New(KeyObject, &KeyType);
+
+    if (k == NULL) {
+        return NULL;
+    }
+    k->p          = *p;
+    k->bds_k      = bds_k;
+    k->state_size = p->d == 1 ? sizeof(xmss_bds_state) : sizeof(xmss_mt_state);
+    k->pk         = (uint8_t *)PyMem_RawCalloc(1, p->pk_bytes);
+    k->sk         = (uint8_t *)PyMem_RawCalloc(1, p->sk_bytes);
+    k->state      = PyMem_RawCalloc(1, k->state_size);
+    k->lock       = PyThread_allocate_lock();
+    if (k->pk == NULL || k->sk == NULL || k->state == NULL || k->lock == NULL) {
+        Py_DECREF(k);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    return k;
+}
+
+static void key_dealloc(KeyObject *k)
+{
+    if (k->sk != NULL) {
+        xmss_memzero(k->sk, k->p.sk_bytes);
+    }
+    if (k->state != NULL) {
+        xmss_memzero(k->state, k->state_size);
+    }
+    PyMem_RawFree(k->pk);
+    PyMem_RawFree(k->sk);
+    PyMem_RawFree(k->state);
+    if (k->lock != NULL) {
+        PyThread_free_lock(k->lock);
+    }
+    PyObject_Free(k);
+}
+
+PyDoc_STRVAR(key_sign_doc,
+"sign(message) -> bytes\n\n"
+"Sign message (any bytes-like object) and advance the key's index.\n"
+"Persist export() before releasing the signature.  Raises xmss.Error\n"
+"when the key is exhausted.");
+
+static PyObject *key_sign(KeyObject *k, PyObject *args)
+{
+    Py_buffer msg;
+    PyObject *sig;
+    uint8_t  *out;
+    int       ret;
+
+    if (!PyArg_ParseTuple(args, "y*:sign", &msg)) {
+        return NULL;
+    }
+    sig = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)k->p.sig_bytes);
+    if (sig == NULL) {
+        PyBuffer_Release(&msg);
+        return NULL;
+    }
+    out = (uint8_t *)PyBytes_AS_STRING(sig);
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(k->lock, WAIT_LOCK);
+    if (k->p.d == 1) {
+        ret = xmss_sign(&k->p, out, (const uint8_t *)msg.buf, (size_t)msg.len,
+                        k->sk, (xmss_bds_state *)k->state, k->bds_k);
+    } else {
+        ret = xmss_mt_sign(&k->p, out, (const uint8_t *)msg.buf, (size_t)msg.len,
+                           k->sk, (xmss_mt_state *)k->state, k->bds_k);
+    }
+    PyThread_release_lock(k->lock);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&msg);
+    if (ret != XMSS_OK) {
+        Py_DECREF(sig);
+        return raise_code(ret, ret == XMSS_ERR_EXHAUSTED ? "key exhausted" : "sign failed");
+    }
+    return sig;
+}
+
+PyDoc_STRVAR(key_export_state_doc,
+"export_state() -> bytes\n\n"
+"Serialized BDS state (the whole hypertree's for XMSS-MT), for\n"
+"xmss.restore().  Read with secret_key from another thread, the two may\n"
+"straddle a sign(); use export() for a consistent pair.");
+
+/* Serialized state length for bds_k; bds_k must already be valid */
+static uint32_t state_bytes(const xmss_params *p, uint32_t bds_k)
+{
+    return p->d == 1 ? xmss_bds_serialized_size(p, bds_k) : xmss_mt_state_bytes(p, bds_k);
+}
+
+/* Serialize the state into @out; caller holds k->lock */
+static void export_state_locked(KeyObject *k, PyObject *out)
+{
+    if (k->p.d == 1) {
+        xmss_bds_serialize(&k->p, (uint8_t *)PyBytes_AS_STRING(out),
+                           (const xmss_bds_state *)k->state, k->bds_k);
+    } else {
+        xmss_mt_state_serialize(&k->p, (uint8_t *)PyBytes_AS_STRING(out),
+                                (const xmss_mt_state *)k->state, k->bds_k);
+    }
+}
+
+static PyObject *key_export_state(KeyObject *k, PyObject *noargs)
+{
+    PyObject *out;
+    uint32_t  len;
+
+    (void)noargs;
+    len = state_bytes(&k->p, k->bds_k);
+    out = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)len);
+    if (out == NULL) {
+        return NULL;
+    }
+    /* Sign holds the lock without the GIL; don't read a half-updated state */
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(k->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    export_state_locked(k, out);
+    PyThread_release_lock(k->lock);
+    return out;
+}
+
+PyDoc_STRVAR(key_export_doc,
+"export() -> (secret_key, state)\n\n"
+"The SK bytes and export_state(), read under one lock so no sign()\n"
+"from another thread falls between them.  Persist this pair and pass\n"
+"it to xmss.restore().");
+
+static PyObject *key_export(KeyObject *k, PyObject *noargs)
+{
+    PyObject *sk, *state;
+
+    (void)noargs;
+    sk = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)k->p.sk_bytes);
+    if (sk == NULL) {
+        return NULL;
+    }
+    state = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)state_bytes(&k->p, k->bds_k));
+    if (state == NULL) {
+        Py_DECREF(sk);
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(k->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    memcpy(PyBytes_AS_STRING(sk), k->sk, k->p.sk_bytes);
+    export_state_locked(k, state);
+    PyThread_release_lock(k->lock);
+    return Py_BuildValue("(NN)", sk, state);
+}
+
+static PyObject *key_get_public_key(KeyObject *k, void *closure)
+{
+    (void)closure;
+    return PyBytes_FromStringAndSize((const char *)k->pk, (Py_ssize_t)k->p.pk_bytes);
+}
+
+static PyObject *key_get_secret_key(KeyObject *k, void *closure)
+{
+    PyObject *out;
+
+    (void)closure;
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(k->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    out = PyBytes_FromStringAndSize((const char *)k->sk, (Py_ssize_t)k->p.sk_bytes);
+    PyThread_release_lock(k->lock);
+    return out;
+}
+
+static PyObject *key_get_remaining(KeyObject *k, void *closure)
+{
+    uint64_t left;
+
+    (void)closure;
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(k->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    left = k->p.d == 1 ? xmss_remaining_sigs(&k->p, k->sk)
+                       : xmss_mt_remaining_sigs(&k->p, k->sk);
+    PyThread_release_lock(k->lock);
+    return PyLong_FromUnsignedLongLong((unsigned long long)left);
+}
+
+static PyObject *key_get_oid(KeyObject *k, void *closure)
+{
+    (void)closure;
+    return PyLong_FromUnsignedLong((unsigned long)k->p.oid);
+}
+
+static PyObject *key_get_bds_k(KeyObject *k, void *closure)
+{
+    (void)closure;
+    return PyLong_FromUnsignedLong((unsigned long)k->bds_k);
+}
+
+static PyMethodDef key_methods[] = {
+    { "sign",         (PyCFunction)key_sign,         METH_VARARGS, key_sign_doc },
+    { "export_state", (PyCFunction)key_export_state, METH_NOARGS,  key_export_state_doc },
+    { "export",       (PyCFunction)key_export,       METH_NOARGS,  key_export_doc },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef key_getset[] = {
+    { "public_key", (getter)key_get_public_key, NULL, "Public key bytes", NULL },
+    { "secret_key", (getter)key_get_secret_key, NULL,
+      "Copy of the SK bytes (includes the next index); use export() to\n"
+      "persist it with a matching state", NULL },
+    { "remaining",  (getter)key_get_remaining,  NULL, "Signatures left", NULL },
+    { "oid",        (getter)key_get_oid,        NULL, "Parameter set OID", NULL },
+    { "bds_k",      (getter)key_get_bds_k,      NULL, "BDS retain parameter", NULL },
+    { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject KeyType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "xmss.Key",
+    .tp_basicsize = sizeof(KeyObject),
+    .tp_dealloc   = (destructor)key_dealloc,
+    .tp_flags     = Py_TPFLAGS_DEFAULT,
+    .tp_doc       = "Private key handle: SK bytes and traversal state in native memory.\n"
+                    "Create with xmss.generate() or xmss.restore().",
+    .tp_methods   = key_methods,
+    .tp_getset    = key_getset,
+};
+
+/* ====================================================================
+ * Module functions
+ * ==================================================================== */
+
+PyDoc_STRVAR(generate_doc,
+"generate(name, bds_k=0, seed=None) -> Key\n\n"
+"Generate a key for the named parameter set, e.g. 'XMSS-SHA2_10_256' or\n"
+"'XMSSMT-SHA2_20/2_256'.  seed, if given, supplies the 3*n key bytes\n"
+"(SK_SEED || SK_PRF || SEED) instead of getrandom(); seeded generation\n"
+"keeps the GIL.");
+
+static PyObject *py_generate(PyObject *self, PyObject *args, PyObject *kw)
+{
+    static char *kwlist[] = { "name", "bds_k", "seed", NULL };
+    const char  *name;
+    unsigned int bds_k = 0;
+    Py_buffer    seed  = { 0 };
+    xmss_params  p;
+    KeyObject   *k;
+    int          ret;
+
+    (void)self;
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "s|Iz*:generate", kwlist,
+                                     &name, &bds_k, &seed)) {
+        return NULL;
+    }
+    if (resolve_params(name, &p) != 0) {
+        PyBuffer_Release(&seed);
+        return NULL;
+    }
+    if ((bds_k & 1U) || bds_k > p.tree_height) {
+        PyBuffer_Release(&seed);
+        PyErr_SetString(PyExc_ValueError, "invalid bds_k");
+        return NULL;
+    }
+    if (seed.buf != NULL && (size_t)seed.len != 3U * p.n) {
+        PyBuffer_Release(&seed);
+        return PyErr_Format(PyExc_ValueError, "seed must be %u bytes", 3U * p.n);
+    }
+    k = key_alloc(&p, bds_k);
+    if (k == NULL) {
+        PyBuffer_Release(&seed);
+        return NULL;
+    }
+
+    if (seed.buf != NULL) {
+        seed_buf  = (const uint8_t *)seed.buf;
+        seed_left = (size_t)seed.len;
+        ret = p.d == 1
+            ? xmss_keygen(&p, k->pk, k->sk, (xmss_bds_state *)k->state, bds_k,
+                          seed_randombytes)
+            : xmss_mt_keygen(&p, k->pk, k->sk, (xmss_mt_state *)k->state, bds_k,
+                             seed_randombytes);
+        seed_buf  = NULL;
+        seed_left = 0;
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        ret = p.d == 1
+            ? xmss_keygen(&p, k->pk, k->sk, (xmss_bds_state *)k->state, bds_k,
+                          os_randombytes)
+            : xmss_mt_keygen(&p, k->pk, k->sk, (xmss_mt_state *)k->state, bds_k,
+                             os_randombytes);
+        Py_END_ALLOW_THREADS
+    }
+    PyBuffer_Release(&seed);
+
+    if (ret != XMSS_OK) {
+        Py_DECREF(k);
+        return raise_code(ret, "keygen failed");
+    }
+    return (PyObject *)k;
+}
+
+PyDoc_STRVAR(restore_doc,
+"restore(name, secret_key, state, bds_k=0) -> Key\n\n"
+"Rebuild an XMSS or XMSS-MT key from a persisted Key.export() pair.");
+
+static PyObject *py_restore(PyObject *self, PyObject *args, PyObject *kw)
+{
+    static char *kwlist[] = { "name", "secret_key", "state", "bds_k", NULL };
+    const char  *name;
+    Py_buffer    sk, st;
+    unsigned int bds_k = 0;
+    xmss_params  p;
+    KeyObject   *k = NULL;
+    int          ret;
+
+    (void)self;
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "sy*y*|I:restore", kwlist,
+                                     &name, &sk, &st, &bds_k)) {
+        return NULL;
+    }
+    if (resolve_params(name, &p) != 0) {
+        goto out;
+    }
+    if ((bds_k & 1U) || bds_k > p.tree_height) {
+        PyErr_SetString(PyExc_ValueError, "invalid bds_k");
+        goto out;
+    }
+    if ((size_t)sk.len != p.sk_bytes ||
+        (size_t)st.len != state_bytes(&p, bds_k)) {
+        PyErr_SetString(PyExc_ValueError, "secret_key or state has the wrong length");
+        goto out;
+    }
+    k = key_alloc(&p, bds_k);
+    if (k == NULL) {
+        goto out;
+    }
+    memcpy(k->sk, sk.buf, p.sk_bytes);
+    /* PK = OID || root || SEED, all held in the SK (RFC 8391 §4.1.3) */
+    memcpy(k->pk, k->sk, 4);
+    memcpy(k->pk + 4, k->sk + 4 + p.idx_bytes + 2 * p.n, 2 * p.n);
+    ret = p.d == 1
+        ? xmss_bds_deserialize(&p, (xmss_bds_state *)k->state,
+                               (const uint8_t *)st.buf, bds_k)
+        : xmss_mt_state_deserialize(&p, (xmss_mt_state *)k->state,
+                                    (const uint8_t *)st.buf, bds_k);
+    if (ret != XMSS_OK) {
+        Py_CLEAR(k);
+        raise_code(XMSS_ERR_PARAMS, "bad state");
+    }
+out:
+    PyBuffer_Release(&sk);
+    PyBuffer_Release(&st);
+    return (PyObject *)k;
+}
+
+PyDoc_STRVAR(verify_doc,
+"verify(name, message, signature, public_key) -> bool\n\n"
+"Arguments are bytes-like; nothing is copied and the GIL is released.\n"
+"A signature or public key of the wrong length does not verify.");
+
+static PyObject *py_verify(PyObject *self, PyObject *args)
+{
+    const char *name;
+    Py_buffer   msg, sig, pk;
+    xmss_params p;
+    int         ret = XMSS_ERR_VERIFY;
+
+    (void)self;
+    if (!PyArg_ParseTuple(args, "sy*y*y*:verify", &name, &msg, &sig, &pk)) {
+        return NULL;
+    }
+    if (resolve_params(name, &p) != 0) {
+        PyBuffer_Release(&msg); PyBuffer_Release(&sig); PyBuffer_Release(&pk);
+        return NULL;
+    }
+    if ((size_t)sig.len == p.sig_bytes && (size_t)pk.len == p.pk_bytes) {
+        Py_BEGIN_ALLOW_THREADS
+        ret = p.d == 1
+            ? xmss_verify(&p, (const uint8_t *)msg.buf, (size_t)msg.len,
+                          (const uint8_t *)sig.buf, (const uint8_t *)pk.buf)
+            : xmss_mt_verify(&p, (const uint8_t *)msg.buf, (size_t)msg.len,
+                             (const uint8_t *)sig.buf, (const uint8_t *)pk.buf);
+        Py_END_ALLOW_THREADS
+    }
+    PyBuffer_Release(&msg); PyBuffer_Release(&sig); PyBuffer_Release(&pk);
+    return PyBool_FromLong(ret == XMSS_OK);
+}
+
+/* ---- verify_batch: native worker threads over PY_VERIFY_CHUNK chunks ---- */
+
+typedef struct {
+    const xmss_params    *p;
+    size_t                count;
+    const uint8_t *const *msgs;
+    const size_t         *lens;
+    const uint8_t *const *sigs;
+    const uint8_t *const *pks;
+    unsigned char        *ok;      /* 1 = verified; pre-cleared for bad sizes */
+    size_t                stride;  /* number of workers */
+} batch_job;
+
+typedef struct {
+    const batch_job *job;
+    size_t           first_chunk;
+} batch_worker;
+
+/* Chunks first_chunk, first_chunk + stride, ... through the C batch API */
+static void *batch_run(void *arg)
+{
+    const batch_worker *w = (const batch_worker *)arg;
+    const batch_job    *j = w->job;
+    const uint8_t      *msgs[PY_VERIFY_CHUNK], *sigs[PY_VERIFY_CHUNK], *pks[PY_VERIFY_CHUNK];
+    size_t              lens[PY_VERIFY_CHUNK], slot[PY_VERIFY_CHUNK];
+    int                 rc[PY_VERIFY_CHUNK];
+    size_t              c, i, k, first, last;
+
+    for (c = w->first_chunk; c * PY_VERIFY_CHUNK < j->count; c += j->stride) {
+        first = c * PY_VERIFY_CHUNK;
+        last  = first + PY_VERIFY_CHUNK < j->count ? first + PY_VERIFY_CHUNK : j->count;
+        k = 0;
+        for (i = first; i < last; i++) {
+            if (j->sigs[i] == NULL) {
+                continue;
+            }
+            msgs[k] = j->msgs[i];
+            lens[k] = j->lens[i];
+            sigs[k] = j->sigs[i];
+            pks[k]  = j->pks[i];
+            slot[k] = i;
+            k++;
+        }
+        if (j->p->d == 1) {
+            (void)xmss_verify_batch(j->p, k, msgs, lens, sigs, pks, rc);
+        } else {
+            (void)xmss_mt_verify_batch(j->p, k, msgs, lens, sigs, pks, rc);
+        }
+        for (i = 0; i < k; i++) {
+            j->ok[slot[i]] = rc[i] == XMSS_OK ? 1U : 0U;
+        }
+    }
+    return NULL;
+}
+
+static size_t default_threads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1U;
+}
+
+PyDoc_STRVAR(verify_batch_doc,
+"verify_batch(name, messages, signatures, public_keys, threads=0) -> list\n\n"
+"Verify parallel sequences of bytes-like objects under one parameter set;\n"
+"result[i] is True iff item i verifies.  Items are handed to the native\n"
+"batch verifier 16 at a time on up to `threads` native threads (0: one\n"
+"per online CPU) with the GIL released.");
+
+static PyObject *py_verify_batch(PyObject *self, PyObject *args, PyObject *kw)
+{
+    static char *kwlist[] = { "name", "messages", "signatures", "public_keys",
+                              "threads", NULL };
+    const char     *name;
+    PyObject       *om, *os, *op, *fm = NULL, *fs = NULL, *fp = NULL, *res = NULL;
+    unsigned int    threads = 0;
+    xmss_params     p;
+    Py_ssize_t      n = 0, got = 0, i;
+    Py_buffer      *bufs = NULL;
+    const uint8_t **ptrs = NULL;
+    size_t         *lens = NULL;
+    unsigned char  *ok = NULL;
+    batch_job       job;
+    batch_worker    w[PY_MAX_THREADS];
+    pthread_t       tid[PY_MAX_THREADS];
+    int             spawned[PY_MAX_THREADS];
+    size_t          nthreads, chunks, t;
+
+    (void)self;
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "sOOO|I:verify_batch", kwlist,
+                                     &name, &om, &os, &op, &threads)) {
+        return NULL;
+    }
+    if (resolve_params(name, &p) != 0) {
+        return NULL;
+    }
+    fm = PySequence_Fast(om, "messages must be a sequence");
+    fs = PySequence_Fast(os, "signatures must be a sequence");
+    fp = PySequence_Fast(op, "public_keys must be a sequence");
+    if (fm == NULL || fs == NULL || fp == NULL) {
+        goto out;
+    }
+    n = PySequence_Fast_GET_SIZE(fm);
+    if (PySequence_Fast_GET_SIZE(fs) != n || PySequence_Fast_GET_SIZE(fp) != n) {
+        PyErr_SetString(PyExc_ValueError, "sequences must have the same length");
+        goto out;
+    }
+    res = PyList_New(n);
+    if (res == NULL || n == 0) {
+        goto out;
+    }
+
+    /* One allocation per array; buffers are held until the workers join */
+    bufs = PyMem_New(Py_buffer, (size_t)n * 3U);
+    ptrs = PyMem_New(const uint8_t *, (size_t)n * 3U);
+    lens = PyMem_New(size_t, (size_t)n);
+    ok   = PyMem_New(unsigned char, (size_t)n);
+    if (bufs == NULL || ptrs == NULL || lens == NULL || ok == NULL) {
+        PyErr_NoMemory();
+        Py_CLEAR(res);
+        goto out;
+    }
+    for (got = 0; got < n * 3; got++) {
+        PyObject *src = got < n ? PySequence_Fast_GET_ITEM(fm, got)
+                      : got < 2 * n ? PySequence_Fast_GET_ITEM(fs, got - n)
+                      : PySequence_Fast_GET_ITEM(fp, got - 2 * n);
+        if (PyObject_GetBuffer(src, &bufs[got], PyBUF_SIMPLE) != 0) {
+            Py_CLEAR(res);
+            goto out;
+        }
+        ptrs[got] = (const uint8_t *)bufs[got].buf;
+    }
+    for (i = 0; i < n; i++) {
+        lens[i] = (size_t)bufs[i].len;
+        ok[i]   = 0;
+        /* Wrong-length items fail without reaching the verifier */
+        if ((size_t)bufs[n + i].len != p.sig_bytes ||
+            (size_t)bufs[2 * n + i].len != p.pk_bytes) {
+            ptrs[n + i] = NULL;
+        }
+    }
+
+    job.p = &p; job.count = (size_t)n; job.msgs = ptrs; job.lens = lens;
+    job.sigs = ptrs + n; job.pks = ptrs + 2 * n; job.ok = ok;
+    chunks   = ((size_t)n + PY_VERIFY_CHUNK - 1) / PY_VERIFY_CHUNK;
+    nthreads = threads ? threads : default_threads();
+    if (nthreads > chunks)         { nthreads = chunks; }
+    if (nthreads > PY_MAX_THREADS) { nthreads = PY_MAX_THREADS; }
+    job.stride = nthreads;
+
+    Py_BEGIN_ALLOW_THREADS
+    /* Worker 0, and any worker whose thread could not be created, runs here */
+    for (t = 0; t < nthreads; t++) {
+        w[t].job         = &job;
+        w[t].first_chunk = t;
+        spawned[t] = t > 0 && pthread_create(&tid[t], NULL, batch_run, &w[t]) == 0;
+    }
+    for (t = 0; t < nthreads; t++) {
+        if (!spawned[t]) {
+            batch_run(&w[t]);
+        }
+    }
+    for (t = 1; t < nthreads; t++) {
+        if (spawned[t]) {
+            pthread_join(tid[t], NULL);
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    for (i = 0; i < n; i++) {
+        PyObject *b = ok[i] ? Py_True : Py_False;
+        Py_INCREF(b);
+        PyList_SET_ITEM(res, i, b);
+    }
+
+out:
+    for (i = 0; i < got; i++) {
+        PyBuffer_Release(&bufs[i]);
+    }
+    PyMem_Free(bufs);
+    PyMem_Free(ptrs);
+    PyMem_Free(lens);
+    PyMem_Free(ok);
+    Py_XDECREF(fm);
+    Py_XDECREF(fs);
+    Py_XDECREF(fp);
+    return res;
+}
+
+PyDoc_STRVAR(params_doc,
+"params(name) -> dict\n\n"
+"oid, n, w, h, d, tree_height, sig_bytes, pk_bytes, sk_bytes.");
+
+static PyObject *py_params(PyObject *self, PyObject *args)
+{
+    const char *name;
+    xmss_params p;
+
+    (void)self;
+    if (!PyArg_ParseTuple(args, "s:params", &name) || resolve_params(name, &p) != 0) {
+        return NULL;
+    }
+    return Py_BuildValue("{s:k,s:I,s:I,s:I,s:I,s:I,s:I,s:I,s:I}",
+                         "oid", (unsigned long)p.oid, "n", p.n, "w", p.w, "h", p.h,
+                         "d", p.d, "tree_height", p.tree_height,
+                         "sig_bytes", p.sig_bytes, "pk_bytes", p.pk_bytes,
+                         "sk_bytes", p.sk_bytes);
+}
+
+static PyMethodDef module_methods[] = {
+    { "generate",     (PyCFunction)(void (*)(void))py_generate,
+      METH_VARARGS | METH_KEYWORDS, generate_doc },
+    { "restore",      (PyCFunction)(void (*)(void))py_restore,
+      METH_VARARGS | METH_KEYWORDS, restore_doc },
+    { "verify",       (PyCFunction)py_verify, METH_VARARGS, verify_doc },
+    { "verify_batch", (PyCFunction)(void (*)(void))py_verify_batch,
+      METH_VARARGS | METH_KEYWORDS, verify_batch_doc },
+    { "params",       (PyCFunction)py_params, METH_VARARGS, params_doc },
+    { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef xmss_module = {
+    PyModuleDef_HEAD_INIT,
+    "xmss",
+    "XMSS / XMSS-MT (RFC 8391) signatures: zero-copy buffers, GIL released\n"
+    "around keygen/sign/verify, native-threaded batch verification.",
+    -1,
+    module_methods,
+    NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit_xmss(void);
+
+PyMODINIT_FUNC PyInit_xmss(void)
+{
+    PyObject *m;
+
+    if (PyType_Ready(&KeyType) < 0) {
+        return NULL;
+    }
+    m = PyModule_Create(&xmss_module);
+    if (m == NULL) {
+        return NULL;
+    }
+    XmssError = PyErr_NewExceptionWithDoc("xmss.Error",
+        "Library error; args are (code, message) with code an XMSS_ERR_* value.",
+        NULL, NULL);
+    Py_INCREF(&KeyType);
+    if (XmssError == NULL ||
+        PyModule_AddObject(m, "Key", (PyObject *)&KeyType) < 0 ||
+        PyModule_AddObject(m, "Error", XmssError) < 0 ||
+        PyModule_AddIntConstant(m, "ERR_PARAMS", XMSS_ERR_PARAMS) < 0 ||
+        PyModule_AddIntConstant(m, "ERR_ENTROPY", XMSS_ERR_ENTROPY) < 0 ||
+        PyModule_AddIntConstant(m, "ERR_VERIFY", XMSS_ERR_VERIFY) < 0 ||
+        PyModule_AddIntConstant(m, "ERR_EXHAUSTED", XMSS_ERR_EXHAUSTED) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    Py_INCREF(XmssError);
+    return m;
+}
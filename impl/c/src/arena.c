@@ -0,0 +1,190 @@
+/**
+ * arena.c - Hugepage-backed, NUMA-placed arena for key states (Linux)
+ *
+ * Not part of the Jasmin-portable core: this is the one translation unit
+ * that talks to the OS (mmap, madvise and the raw mbind/getcpu system
+ * calls).  Built only with -DXMSS_BUILD_ARENA=ON on Linux.
+ */
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../include/xmss/arena.h"
+#include "utils.h"
+
+/* <linux/mempolicy.h>, spelled out to avoid depending on kernel headers */
+#define ARENA_MPOL_PREFERRED 1
+
+/* mbind() node mask: enough bits for any shipping NUMA topology */
+#define ARENA_MAX_NODES 1024U
+#define ARENA_MASK_BITS (8U * sizeof(unsigned long))
+
+#define ARENA_PAGE      4096U
+#define ARENA_DEF_ALIGN 64U
+
+static size_t round_up(size_t x, size_t to)
+{
+    return (x + to - 1) & ~(to - 1);
+}
+
+int xmss_arena_current_node(void)
+{
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+        return -1;
+    }
+    return (int)node;
+}
+
+/* Explicit hugepages: only succeeds if the admin reserved enough of them. */
+static uint8_t *map_hugetlb(size_t len)
+{
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return p == MAP_FAILED ? NULL : (uint8_t *)p;
+}
+
+/* Fallback: over-map, trim to a 2 MB-aligned window, advise THP. */
+static uint8_t *map_thp(size_t len)
+{
+    size_t   slack = XMSS_ARENA_HUGEPAGE;
+    uint8_t *raw, *base;
+    size_t   head, tail;
+    void    *p;
+
+    p = mmap(NULL, len + slack, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    raw  = (uint8_t *)p;
+    base = (uint8_t *)round_up((size_t)(uintptr_t)raw, XMSS_ARENA_HUGEPAGE);
+    head = (size_t)(base - raw);
+    tail = slack - head;
+    if (head) { munmap(raw, head); }
+    if (tail) { munmap(base + len, tail); }
+
+    /* Best effort: THP may be disabled system-wide */
+    (void)madvise(base, len, MADV_HUGEPAGE);
+    return base;
+}
+
+/* Preferred (not strict) policy: fall back to other nodes rather than OOM. */
+static int bind_node(uint8_t *base, size_t len, int node)
+{
+    unsigned long mask[ARENA_MAX_NODES / ARENA_MASK_BITS];
+    unsigned      n = (unsigned)node;
+
+    if (node < 0 || n >= ARENA_MAX_NODES) {
+        return -1;
+    }
+    memset(mask, 0, sizeof(mask));
+    mask[n / ARENA_MASK_BITS] = 1UL << (n % ARENA_MASK_BITS);
+    /* maxnode counts one past the last bit the kernel should read */
+    if (syscall(SYS_mbind, base, len, ARENA_MPOL_PREFERRED, mask,
+                (unsigned long)ARENA_MAX_NODES + 1, 0U) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int xmss_arena_init(xmss_arena *a, size_t size, int node)
+{
+    volatile uint8_t *v;
+    size_t            len, off;
+
+    memset(a, 0, sizeof(*a));
+    if (size == 0) {
+        return XMSS_ERR_PARAMS;
+    }
+    len = round_up(size, XMSS_ARENA_HUGEPAGE);
+
+    a->base       = map_hugetlb(len);
+    a->st.backing = XMSS_ARENA_BACKING_HUGETLB;
+    if (a->base == NULL) {
+        a->base       = map_thp(len);
+        a->st.backing = XMSS_ARENA_BACKING_THP;
+    }
+    if (a->base == NULL) {
+        memset(a, 0, sizeof(*a));
+        return XMSS_ERR_PARAMS;
+    }
+    a->st.mapped = len;
+
+    if (node == XMSS_ARENA_NODE_LOCAL) {
+        node = xmss_arena_current_node();
+    }
+    a->st.node = -1;
+    if (node != XMSS_ARENA_NODE_ANY && bind_node(a->base, len, node) == 0) {
+        a->st.node = node;
+    }
+
+    /* Prefault now, from this thread, so placement is decided here */
+    v = a->base;
+    for (off = 0; off < len; off += ARENA_PAGE) {
+        v[off] = 0;
+    }
+    return XMSS_OK;
+}
+
+void *xmss_arena_alloc(xmss_arena *a, size_t size, size_t align)
+{
+    size_t off;
+
+    if (align == 0) {
+        align = ARENA_DEF_ALIGN;
+    }
+    if ((align & (align - 1)) != 0 || align > XMSS_ARENA_HUGEPAGE) {
+        a->st.failed++;
+        return NULL;
+    }
+    off = round_up(a->st.used, align);
+    if (a->base == NULL || off > a->st.mapped || size > a->st.mapped - off) {
+        a->st.failed++;
+        return NULL;
+    }
+    /* Fresh mappings are zero and reset() wipes, so no memset here */
+    a->st.used = off + size;
+    if (a->st.used > a->st.peak) {
+        a->st.peak = a->st.used;
+    }
+    a->st.allocs++;
+    return a->base + off;
+}
+
+xmss_bds_state *xmss_arena_bds_state(xmss_arena *a)
+{
+    return (xmss_bds_state *)xmss_arena_alloc(a, sizeof(xmss_bds_state), 0);
+}
+
+xmss_mt_state *xmss_arena_mt_state(xmss_arena *a)
+{
+    /* Page-aligned so a state never shares its first page with a neighbour */
+    return (xmss_mt_state *)xmss_arena_alloc(a, sizeof(xmss_mt_state), ARENA_PAGE);
+}
+
+void xmss_arena_reset(xmss_arena *a)
+{
+    if (a->base != NULL) {
+        xmss_memzero(a->base, a->st.used);
+    }
+    a->st.used = 0;
+}
+
+void xmss_arena_destroy(xmss_arena *a)
+{
+    if (a->base != NULL) {
+        xmss_memzero(a->base, a->st.used);
+        munmap(a->base, a->st.mapped);
+    }
+    memset(a, 0, sizeof(*a));
+}
+
+void xmss_arena_stats(const xmss_arena *a, xmss_arena_stats_t *out)
+{
+    *out = a->st;
+}
@@ -13,6 +13,8 @@
 #include "bds.h"
 #include "wots.h"
 #include "ltree.h"
+#include "lmots.h"
+#include "treehash.h"
 #include "hash/hash_iface.h"
 #include "address.h"
 #include "utils.h"
@@ -22,6 +24,9 @@
 
 /* ====================================================================
  * gen_leaf() - Compute a single leaf: l_tree(WOTS_genPK(...))
+ *
+ * LMS sets (hss.c) pass the tree's SEED and I here and get the LM-OTS
+ * leaf; everything else in this file is shared.
  * ==================================================================== */
 static void gen_leaf(const xmss_params *p, uint8_t *leaf,
                      const uint8_t *sk_seed, const uint8_t *seed,
@@ -30,6 +35,11 @@ static void gen_leaf(const xmss_params *p, uint8_t *leaf,
     uint8_t wots_pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
     xmss_adrs_t a;
 
+    if (p->func == XMSS_FUNC_LMS_SHA256) {
+        lms_gen_leaf(p, leaf, sk_seed, seed, leaf_idx);
+        return;
+    }
+
     a = *adrs;
     xmss_adrs_set_type(&a, XMSS_ADRS_TYPE_OTS);
     xmss_adrs_set_ots(&a, leaf_idx);
@@ -122,6 +132,7 @@ void bds_treehash_init(const xmss_params *p, uint8_t *root,
 {
     /* Local stack for the full tree build (not the BDS shared stack) */
     uint8_t  stack[(XMSS_MAX_H + 1)][XMSS_MAX_N];
+    uint8_t  leaves[XMSS_HASH_LANES][XMSS_MAX_N];
     uint32_t stack_levels[XMSS_MAX_H + 1];
     uint32_t stack_offset = 0;
 
@@ -143,8 +154,13 @@ void bds_treehash_init(const xmss_params *p, uint8_t *root,
 
     i = 0;
     for (idx = 0; idx < lastnode; idx++) {
-        /* Generate leaf */
-        gen_leaf(p, stack[stack_offset], sk_seed, seed, idx, adrs);
+        /* Generate leaves XMSS_HASH_LANES at a time */
+        if (idx % XMSS_HASH_LANES == 0) {
+            treehash_gen_leaves(p, leaves, sk_seed, seed, idx,
+                                lastnode - idx < XMSS_HASH_LANES ? lastnode - idx
+                                                                 : XMSS_HASH_LANES, adrs);
+        }
+        memcpy(stack[stack_offset], leaves[idx % XMSS_HASH_LANES], p->n);
         stack_levels[stack_offset] = 0;
         stack_offset++;
 
@@ -296,31 +312,20 @@ void bds_treehash_update(const xmss_params *p, xmss_bds_state *state,
 }
 
 /* ====================================================================
- * bds_state_update() - Process one leaf for incremental tree building
+ * state_push_leaf() - Merge leaf next_leaf onto the BDS state's stack
  *
- * Used by XMSS-MT to incrementally build "next" trees during signing.
- * Each call generates one leaf (at index state->next_leaf) and merges
- * it onto the BDS state's own stack, capturing auth/treehash/retain
- * nodes along the way.  After 2^tree_height calls, the tree is fully
- * built and the root sits in state->stack[0].
- *
- * Returns 0 on success, -1 if the tree is already complete.
+ * The leaf has been written to state->stack[state->stack_offset].
+ * Captures auth/treehash/retain nodes on the way up, as
+ * bds_treehash_init() does.
  * ==================================================================== */
-int bds_state_update(const xmss_params *p, xmss_bds_state *state,
-                     uint32_t bds_k,
-                     const uint8_t *sk_seed, const uint8_t *seed,
-                     xmss_adrs_t *adrs)
+static void state_push_leaf(const xmss_params *p, xmss_bds_state *state,
+                            uint32_t bds_k, const uint8_t *seed,
+                            xmss_adrs_t *adrs)
 {
     uint32_t idx = state->next_leaf;
     uint32_t nodeh;
     xmss_adrs_t a;
 
-    if (idx >= (uint32_t)1 << p->tree_height) {
-        return -1;
-    }
-
-    /* Generate leaf onto stack top */
-    gen_leaf(p, state->stack[state->stack_offset], sk_seed, seed, idx, adrs);
     state->stack_levels[state->stack_offset] = 0;
     state->stack_offset++;
 
@@ -368,5 +373,262 @@ int bds_state_update(const xmss_params *p, xmss_bds_state *state,
     }
 
     state->next_leaf++;
+}
+
+/* ====================================================================
+ * bds_state_update() - Process one leaf for incremental tree building
+ *
+ * Used by XMSS-MT to incrementally build "next" trees during signing.
+ * Each call generates one leaf (at index state->next_leaf) and merges
+ * it onto the BDS state's own stack, capturing auth/treehash/retain
+ * nodes along the way.  After 2^tree_height calls, the tree is fully
+ * built and the root sits in state->stack[0].
+ *
+ * Returns 0 on success, -1 if the tree is already complete.
+ * ==================================================================== */
+int bds_state_update(const xmss_params *p, xmss_bds_state *state,
+                     uint32_t bds_k,
+                     const uint8_t *sk_seed, const uint8_t *seed,
+                     xmss_adrs_t *adrs)
+{
+    if (state->next_leaf >= (uint32_t)1 << p->tree_height) {
+        return -1;
+    }
+
+    /* Generate leaf onto stack top */
+    gen_leaf(p, state->stack[state->stack_offset], sk_seed, seed,
+             state->next_leaf, adrs);
+    state_push_leaf(p, state, bds_k, seed, adrs);
     return 0;
 }
+
+/* ====================================================================
+ * bds_state_build() - Process up to @leaves leaves in one call
+ *
+ * Whole lane groups go through treehash_gen_leaves(), so a tree built
+ * in steps costs what bds_treehash_init() costs; a group that would
+ * overrun @leaves or the tree is done a leaf at a time.
+ * ==================================================================== */
+uint32_t bds_state_build(const xmss_params *p, xmss_bds_state *state,
+                         uint32_t bds_k, uint32_t leaves,
+                         const uint8_t *sk_seed, const uint8_t *seed,
+                         xmss_adrs_t *adrs)
+{
+    uint8_t  group[XMSS_HASH_LANES][XMSS_MAX_N];
+    uint32_t total = (uint32_t)1 << p->tree_height;
+    uint32_t l;
+
+    while (leaves > 0 && state->next_leaf < total) {
+        if (state->next_leaf % XMSS_HASH_LANES == 0 && leaves >= XMSS_HASH_LANES &&
+            total - state->next_leaf >= XMSS_HASH_LANES) {
+            treehash_gen_leaves(p, group, sk_seed, seed, state->next_leaf,
+                                XMSS_HASH_LANES, adrs);
+            for (l = 0; l < XMSS_HASH_LANES; l++) {
+                memcpy(state->stack[state->stack_offset], group[l], p->n);
+                state_push_leaf(p, state, bds_k, seed, adrs);
+            }
+            leaves -= XMSS_HASH_LANES;
+        } else {
+            (void)bds_state_update(p, state, bds_k, sk_seed, seed, adrs);
+            leaves--;
+        }
+    }
+    return total - state->next_leaf;
+}
+
+/* ====================================================================
+ * bds_state_seal() - Finish a state built by bds_state_build()
+ * ==================================================================== */
+void bds_state_seal(const xmss_params *p, xmss_bds_state *state,
+                    uint32_t bds_k)
+{
+    uint32_t i;
+
+    for (i = 0; i < p->tree_height - bds_k; i++) {
+        state->treehash[i].h = i;
+        state->treehash[i].completed = 1;
+        state->treehash[i].stack_usage = 0;
+    }
+    memset(state->stack[1], 0, sizeof(state->stack) - sizeof(state->stack[0]));
+    memset(state->stack_levels + 1, 0, sizeof(state->stack_levels) - 1);
+}
+
+/* ====================================================================
+ * bds_retune() - Rebuild the bds_k-dependent part of a state at a leaf
+ *
+ * auth and keep hold the same nodes for every bds_k and are kept.  Each
+ * treehash instance below th - new_k is set completed on the right node
+ * its level moves to next, as bds_round() would find it; the retain
+ * stack is refilled from the height-(th - new_k) nodes after the current
+ * leaf, hashed up in place.  Every node is a whole subtree computed by
+ * treehash(), lane-batched.
+ * ==================================================================== */
+int bds_retune(const xmss_params *p, xmss_bds_state *state,
+               uint32_t bds_k, uint32_t new_k, uint32_t leaf,
+               const uint8_t *sk_seed, const uint8_t *seed,
+               xmss_adrs_t *adrs)
+{
+    uint8_t  row[(uint32_t)1 << XMSS_MAX_BDS_K][XMSS_MAX_N];
+    uint32_t th   = p->tree_height;
+    uint32_t b    = th - new_k;
+    uint32_t base = state->stack_offset;
+    uint32_t used = 0;
+    uint32_t j, x, r, lo, hi;
+    xmss_adrs_t a;
+
+    /* Stack entries under the instances' (a finished tree's root) stay;
+     * a corrupt state must not wrap base and clear past the stack */
+    for (j = 0; j < th - bds_k; j++) {
+        used += state->treehash[j].stack_usage;
+    }
+    if (base > XMSS_MAX_H + 1 || used > base) {
+        return XMSS_ERR_PARAMS;
+    }
+    base -= used;
+    memset(state->stack[base], 0, (XMSS_MAX_H + 1 - base) * sizeof(state->stack[0]));
+    memset(state->stack_levels + base, 0, XMSS_MAX_H + 1 - base);
+    state->stack_offset = base;
+
+    memset(state->treehash, 0, sizeof(state->treehash));
+    for (j = 0; j < b; j++) {
+        /* Right node at height j taken over by the next round with tau > j */
+        uint32_t t = ((leaf >> (j + 1)) << 1) + 3;
+
+        state->treehash[j].h = j;
+        state->treehash[j].completed = 1;
+        if (t < (uint32_t)1 << (th - j)) {
+            treehash(p, state->treehash[j].node, sk_seed, seed,
+                     t << j, (uint32_t)1 << j, adrs);
+        }
+    }
+
+    memset(state->retain, 0, sizeof(state->retain));
+    if (new_k == 0) {
+        return XMSS_OK;
+    }
+
+    /* Nodes of height b wholly after the leaf: every retained node still
+     * to be used lies above them */
+    lo = (leaf >> b) + 1;
+    hi = (uint32_t)1 << new_k;
+    for (x = lo; x < hi; x++) {
+        treehash(p, row[x], sk_seed, seed, x << b, (uint32_t)1 << b, adrs);
+    }
+
+    /* J5: new_k - 1 levels of at most 2^new_k nodes */
+    for (j = b; j + 1 < th; j++) {
+        uint32_t off = ((uint32_t)1 << (th - 1 - j)) + j - th;
+
+        /* Right nodes the rounds from leaf on read: (r - 1) << j > leaf */
+        for (r = lo | 1; r < hi; r += 2) {
+            if (r >= 3 && ((r - 1) << j) > leaf) {
+                memcpy(state->retain[off + ((r - 3) >> 1)], row[r], p->n);
+            }
+        }
+
+        /* Parents of the complete pairs, in place (row[x] from row[2x], row[2x + 1]) */
+        lo = (lo + 1) >> 1;
+        hi >>= 1;
+        for (x = lo; x < hi; x++) {
+            a = *adrs;
+            xmss_adrs_set_type(&a, XMSS_ADRS_TYPE_HASH);
+            xmss_adrs_set_tree_height(&a, j);
+            xmss_adrs_set_tree_index(&a, x);
+            xmss_H(p, row[x], seed, &a, row[2 * x], row[2 * x + 1]);
+        }
+    }
+    return XMSS_OK;
+}
+
+/* ====================================================================
+ * bds_walk_begin() / bds_layer_advance() - One layer of a hypertree
+ * advance (XMSS-MT and HSS signing)
+ * ==================================================================== */
+
+static void deep_state_swap(xmss_bds_state *a, xmss_bds_state *b)
+{
+    xmss_bds_state tmp;
+    memcpy(&tmp, a, sizeof(xmss_bds_state));
+    memcpy(a, b, sizeof(xmss_bds_state));
+    memcpy(b, &tmp, sizeof(xmss_bds_state));
+}
+
+void bds_walk_begin(const xmss_params *p, bds_walk *w, uint32_t bds_k)
+{
+    /* ceil((th - bds_k) / 2): BDS assumes th - bds_k even, which odd custom
+     * heights are not.  At least one, or the upper layers' next trees are
+     * never built when bds_k == th. */
+    w->updates = (p->tree_height - bds_k + 1) >> 1;
+    if (w->updates == 0) { w->updates = 1; }
+    w->swapped_upto = -1;
+}
+
+int bds_layer_advance(const xmss_params *p, bds_walk *w,
+                      xmss_bds_state *cur, xmss_bds_state *next,
+                      uint32_t external, const xmss_bds_state *ext_tree,
+                      uint32_t bds_k, uint64_t idx, uint32_t layer,
+                      const uint8_t *sk_seed, const uint8_t *seed,
+                      const uint8_t *next_sk_seed, const uint8_t *next_seed)
+{
+    uint32_t th       = p->tree_height;
+    uint64_t idx_tree = idx >> (th * (layer + 1));
+    uint32_t idx_leaf = (uint32_t)((idx >> (th * layer)) & (((uint64_t)1 << th) - 1));
+    /* The next tree exists: it lies inside this layer */
+    int      has_next = next != NULL &&
+                        (1 + idx_tree) * ((uint64_t)1 << th) + idx_leaf <
+                        ((uint64_t)1 << (p->h - th * layer));
+    uint32_t j;
+    xmss_adrs_t adrs;
+
+    /* Mandatory update for layer 0's next tree */
+    if (layer == 0 && !external && has_next) {
+        memset(&adrs, 0, sizeof(adrs));
+        xmss_adrs_set_layer(&adrs, 0);
+        xmss_adrs_set_tree(&adrs, idx_tree + 1);
+        bds_state_update(p, next, bds_k, next_sk_seed, next_seed, &adrs);
+    }
+
+    if (((idx + 1) & (((uint64_t)1 << ((layer + 1) * th)) - 1)) != 0) {
+        /* Not at a boundary: advance the current tree */
+        memset(&adrs, 0, sizeof(adrs));
+        xmss_adrs_set_layer(&adrs, layer);
+        xmss_adrs_set_tree(&adrs, idx_tree);
+        if ((int)layer == w->swapped_upto + 1) {
+            bds_round(p, cur, bds_k, idx_leaf, sk_seed, seed, &adrs);
+        }
+        bds_treehash_update(p, cur, bds_k, w->updates, sk_seed, seed, &adrs);
+
+        /* Next tree from the budget; external layers cost nothing here,
+         * their share stays with the layers above */
+        if (layer > 0 && has_next && w->updates > 0 && !external &&
+            next->next_leaf < ((uint32_t)1 << th)) {
+            memset(&adrs, 0, sizeof(adrs));
+            xmss_adrs_set_layer(&adrs, layer);
+            xmss_adrs_set_tree(&adrs, idx_tree + 1);
+            bds_state_update(p, next, bds_k, next_sk_seed, next_seed, &adrs);
+            w->updates--;
+        }
+        return 0;
+    }
+    if (idx >= ((uint64_t)1 << p->h) - 1 || next == NULL) {
+        return 0;
+    }
+
+    /* At a boundary: the next tree becomes current */
+    if (external) {
+        memcpy(cur, ext_tree, sizeof(xmss_bds_state));
+    } else {
+        deep_state_swap(next, cur);
+    }
+    next->stack_offset = 0;
+    next->next_leaf    = 0;
+
+    if (w->updates > 0) { w->updates--; }
+    w->swapped_upto = (int)layer;
+
+    /* Mark all treehash instances as completed for swapped state */
+    for (j = 0; j < th - bds_k; j++) {
+        cur->treehash[j].completed = 1;
+    }
+    return 1;
+}
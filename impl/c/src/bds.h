@@ -88,4 +88,104 @@ int bds_state_update(const xmss_params *p, struct xmss_bds_state *state,
                      const uint8_t *sk_seed, const uint8_t *seed,
                      xmss_adrs_t *adrs);
 
+/**
+ * bds_state_build() - Process up to @leaves leaves of an incremental build.
+ *
+ * bds_state_update() for a batch of leaves, generated XMSS_HASH_LANES at
+ * a time where whole lane groups fit.  Lets a tree be built in bounded
+ * steps (xmss_mt_next_step(), the stepped keygens) at the cost of
+ * bds_treehash_init().
+ *
+ * Returns the number of leaves the tree still lacks (0 = complete).
+ */
+uint32_t bds_state_build(const xmss_params *p, struct xmss_bds_state *state,
+                         uint32_t bds_k, uint32_t leaves,
+                         const uint8_t *sk_seed, const uint8_t *seed,
+                         xmss_adrs_t *adrs);
+
+/**
+ * bds_state_seal() - Finish a tree completed by bds_state_build().
+ *
+ * Leaves the state exactly as bds_treehash_init() would, with the root
+ * as the only stack entry: treehash instances marked complete and the
+ * rest of the shared stack cleared.
+ */
+void bds_state_seal(const xmss_params *p, struct xmss_bds_state *state,
+                    uint32_t bds_k);
+
+/**
+ * bds_retune() - Convert a state from @bds_k to @new_k at @leaf.
+ *
+ * @state must be ready to sign @leaf with @bds_k; afterwards it signs
+ * @leaf and every later leaf of its tree with @new_k.  Costs under
+ * 2^(th - new_k) leaves for the instances plus about 2^th - leaf for
+ * the retained levels.
+ *
+ * @p:       Parameter set.
+ * @state:   BDS state, converted in place.
+ * @bds_k:   Retain parameter the state was built with.
+ * @new_k:   Retain parameter to switch to (even, <= min(th, XMSS_MAX_BDS_K)).
+ * @leaf:    Next leaf the state signs.
+ * @sk_seed: n-byte secret seed.
+ * @seed:    n-byte public seed.
+ * @adrs:    Hash tree address (layer/tree set by caller).
+ *
+ * Return: XMSS_OK, or XMSS_ERR_PARAMS (state untouched) if the
+ * instances claim more shared-stack entries than the stack holds.
+ */
+int bds_retune(const xmss_params *p, struct xmss_bds_state *state,
+               uint32_t bds_k, uint32_t new_k, uint32_t leaf,
+               const uint8_t *sk_seed, const uint8_t *seed,
+               xmss_adrs_t *adrs);
+
+/**
+ * bds_walk - Budget carried across the layers of one hypertree advance.
+ *
+ * @updates:      Treehash / next-tree leaf budget left for the layers above.
+ * @swapped_upto: Highest layer that swapped in its next tree, or -1.
+ */
+typedef struct {
+    uint32_t updates;
+    int      swapped_upto;
+} bds_walk;
+
+/**
+ * bds_walk_begin() - Start moving a hypertree on by one index.
+ */
+void bds_walk_begin(const xmss_params *p, bds_walk *w, uint32_t bds_k);
+
+/**
+ * bds_layer_advance() - Move one layer of a hypertree from @idx to @idx + 1.
+ *
+ * The layer-update step shared by XMSS-MT and HSS signing; call it for
+ * layers 0..d-1 in order with one @w.  Off a tree boundary the current
+ * tree's auth path and treehash instances move on and the next tree
+ * gets a leaf from the budget (layer 0 always gets one).  At a boundary
+ * the next tree, or @ext_tree for an @external layer, becomes current
+ * and @next is reset for the tree after it.
+ *
+ * @p:        Parameter set.
+ * @w:        Walk state from bds_walk_begin().
+ * @cur:      The layer's current tree.
+ * @next:     Its next tree; NULL for the top layer.
+ * @external: Next trees are built elsewhere: @next is not grown here.
+ * @ext_tree: Complete next tree, read only at an @external boundary.
+ * @bds_k:    Retain parameter.
+ * @idx:      Index just signed.
+ * @layer:    Layer of @cur.
+ * @sk_seed:  n-byte secret seed of the current tree.
+ * @seed:     n-byte public seed of the current tree.
+ * @next_sk_seed: n-byte secret seed of the next tree.
+ * @next_seed:    n-byte public seed of the next tree.
+ *
+ * Return: 1 if @cur is a newly swapped-in tree whose root (@cur->stack[0])
+ * the caller must sign at the layer above, else 0.
+ */
+int bds_layer_advance(const xmss_params *p, bds_walk *w,
+                      struct xmss_bds_state *cur, struct xmss_bds_state *next,
+                      uint32_t external, const struct xmss_bds_state *ext_tree,
+                      uint32_t bds_k, uint64_t idx, uint32_t layer,
+                      const uint8_t *sk_seed, const uint8_t *seed,
+                      const uint8_t *next_sk_seed, const uint8_t *next_seed);
+
 #endif /* XMSS_BDS_H */
@@ -170,3 +170,66 @@ int xmss_bds_deserialize(const xmss_params *p, xmss_bds_state *state,
 
     return XMSS_OK;
 }
+
+/* ====================================================================
+ * XMSS-MT state: 2d-1 BDS states, then (WOTS sig | root) per lower layer
+ * ==================================================================== */
+
+uint32_t xmss_mt_state_bytes(const xmss_params *p, uint32_t bds_k)
+{
+    return (2 * p->d - 1) * xmss_bds_serialized_size(p, bds_k) +
+           (p->d - 1) * (p->len * p->n + p->n);
+}
+
+int xmss_mt_state_serialize(const xmss_params *p, uint8_t *buf,
+                            const xmss_mt_state *state, uint32_t bds_k)
+{
+    uint32_t bds_bytes = xmss_bds_serialized_size(p, bds_k);
+    uint32_t ots_bytes = p->len * p->n;
+    uint32_t i;
+    int      ret;
+
+    if (p->d < 2 || p->d > XMSS_MAX_D || (bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+    for (i = 0; i < 2 * p->d - 1; i++) {
+        ret = xmss_bds_serialize(p, buf, &state->bds[i], bds_k);
+        if (ret != XMSS_OK) {
+            return ret;
+        }
+        buf += bds_bytes;
+    }
+    for (i = 0; i + 1 < p->d; i++) {
+        memcpy(buf, state->wots_sigs[i], ots_bytes);
+        memcpy(buf + ots_bytes, state->roots[i], p->n);
+        buf += ots_bytes + p->n;
+    }
+    return XMSS_OK;
+}
+
+int xmss_mt_state_deserialize(const xmss_params *p, xmss_mt_state *state,
+                              const uint8_t *buf, uint32_t bds_k)
+{
+    uint32_t bds_bytes = xmss_bds_serialized_size(p, bds_k);
+    uint32_t ots_bytes = p->len * p->n;
+    uint32_t i;
+    int      ret;
+
+    if (p->d < 2 || p->d > XMSS_MAX_D || (bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+    memset(state, 0, sizeof(*state));
+    for (i = 0; i < 2 * p->d - 1; i++) {
+        ret = xmss_bds_deserialize(p, &state->bds[i], buf, bds_k);
+        if (ret != XMSS_OK) {
+            return ret;
+        }
+        buf += bds_bytes;
+    }
+    for (i = 0; i + 1 < p->d; i++) {
+        memcpy(state->wots_sigs[i], buf, ots_bytes);
+        memcpy(state->roots[i], buf + ots_bytes, p->n);
+        buf += ots_bytes + p->n;
+    }
+    return XMSS_OK;
+}
@@ -0,0 +1,494 @@
+/**
+ * flashlog.c - Append-only key-state log for NOR flash
+ *
+ * Not part of the Jasmin-portable core (callbacks into the storage
+ * driver), but like it: C99, no malloc, no recursion, no OS calls.  The
+ * caller's work buffer holds the one large record, a snapshot; index
+ * records and headers live on the stack.
+ *
+ * Invariant behind recovery: the current sector starts with a snapshot
+ * carrying the reservation V at the time, and every later reservation is
+ * an index record in the same sector.  Moving on erases a different
+ * sector (the oldest) or, if the current one never got its snapshot, the
+ * current one again; either way the newest valid snapshot and the
+ * highest V survive every step.
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/xmss/flashlog.h"
+#include "sk_offsets.h"
+#include "state_record.h"
+#include "utils.h"
+
+#define FL_SECTOR_HDR 16U   /* "XFL1" | seq | OID | CRC-32 */
+#define FL_IDX_REC    8U    /* 'I' | delta | CRC-24 */
+#define FL_SNAP_HDR   24U   /* 'S' | 0(3) | len | V | payload CRC | header CRC */
+#define FL_TAG_IDX    0x49U
+#define FL_TAG_SNAP   0x53U
+
+static const uint8_t fl_magic[4] = { 'X', 'F', 'L', '1' };
+
+static int all_erased(const uint8_t *b, uint32_t len)
+{
+    uint8_t acc = 0xFF;
+    while (len--) { acc &= *b++; }
+    return acc == 0xFF;
+}
+
+/* Newer of two sector sequence numbers, wrap-safe */
+static int seq_after(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+/* ====================================================================
+ * Device access
+ * ==================================================================== */
+
+static int dev_prog(xmss_flashlog *fl, uint32_t addr, const uint8_t *buf, uint32_t len)
+{
+    if (fl->dev->prog(fl->dev->ctx, addr, buf, len) != 0) {
+        fl->error  = XMSS_ERR_IO;
+        fl->cursor = fl->dev->sector_bytes;     /* never append after a torn write */
+        return XMSS_ERR_IO;
+    }
+    fl->st.prog_bytes += len;
+    return XMSS_OK;
+}
+
+/* Program one record at the cursor; padding stays erased (0xFF) */
+static int put_record(xmss_flashlog *fl, const uint8_t *rec, uint32_t area)
+{
+    int rc = dev_prog(fl, fl->sector * fl->dev->sector_bytes + fl->cursor, rec, area);
+    if (rc == XMSS_OK) {
+        fl->cursor += area;
+    }
+    return rc;
+}
+
+/* Snapshot record of sk / state into the work buffer */
+static void build_snapshot(xmss_flashlog *fl, const uint8_t *sk, const void *state)
+{
+    const xmss_params *p   = &fl->p;
+    uint8_t           *rec = fl->work;
+    uint32_t           len = p->sk_bytes + fl->state_bytes;
+
+    memset(rec, 0xFF, fl->snap_area);
+    memset(rec, 0, 4);
+    rec[0] = FL_TAG_SNAP;
+    ull_to_bytes(rec + 4, 4, len);
+    ull_to_bytes(rec + 8, 8, fl->reserved);
+    memcpy(rec + FL_SNAP_HDR, sk, p->sk_bytes);
+    if (p->d > 1) {
+        xmss_mt_state_serialize(p, rec + FL_SNAP_HDR + p->sk_bytes,
+                                (const xmss_mt_state *)state, fl->bds_k);
+    } else {
+        xmss_bds_serialize(p, rec + FL_SNAP_HDR + p->sk_bytes,
+                           (const xmss_bds_state *)state, fl->bds_k);
+    }
+    ull_to_bytes(rec + 16, 4, crc32_update(0, rec + FL_SNAP_HDR, len));
+    ull_to_bytes(rec + 20, 4, crc32_update(0, rec, 20));
+}
+
+/* Snapshot in the work buffer goes to the cursor; it becomes the base of
+ * a sector that has none yet */
+static int put_snapshot(xmss_flashlog *fl, const uint8_t *sk)
+{
+    int rc = put_record(fl, fl->work, fl->snap_area);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    if (!fl->has_base) {
+        fl->base     = bytes_to_ull(sk + sk_off_idx(&fl->p), fl->p.idx_bytes);
+        fl->has_base = 1;
+    }
+    fl->since_snap = 0;
+    fl->st.snapshots++;
+    return XMSS_OK;
+}
+
+/* Move to the next sector: erase it, header, snapshot of sk / state.  If
+ * the current sector never got its snapshot it is reused instead, so the
+ * previous sector, which holds the newest snapshot, is not touched. */
+static int new_sector(xmss_flashlog *fl, const uint8_t *sk, const void *state)
+{
+    const xmss_flash_dev *dev = fl->dev;
+    uint8_t  hdr[XMSS_FLASH_MAX_PROG > FL_SECTOR_HDR ? XMSS_FLASH_MAX_PROG : FL_SECTOR_HDR];
+    uint32_t target = fl->has_base ? (fl->sector + 1) % dev->sectors : fl->sector;
+    int      rc;
+
+    if (dev->erase(dev->ctx, target) != 0) {
+        fl->error  = XMSS_ERR_IO;
+        fl->cursor = dev->sector_bytes;
+        return XMSS_ERR_IO;
+    }
+    fl->st.erases++;
+    fl->sector   = target;
+    fl->seq     += 1;
+    fl->cursor   = 0;
+    fl->has_base = 0;
+
+    memset(hdr, 0xFF, sizeof(hdr));
+    memcpy(hdr, fl_magic, 4);
+    ull_to_bytes(hdr + 4, 4, fl->seq);
+    ull_to_bytes(hdr + 8, 4, fl->p.oid);
+    ull_to_bytes(hdr + 12, 4, crc32_update(0, hdr, 12));
+    rc = put_record(fl, hdr, fl->hdr_area);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    build_snapshot(fl, sk, state);
+    return put_snapshot(fl, sk);
+}
+
+static int log_snapshot(xmss_flashlog *fl, const uint8_t *sk, const void *state)
+{
+    if (fl->cursor + fl->snap_area > fl->dev->sector_bytes) {
+        return new_sector(fl, sk, state);
+    }
+    build_snapshot(fl, sk, state);
+    return put_snapshot(fl, sk);
+}
+
+/* Record V; a full sector or a delta past 32 bits starts a new one first */
+static int log_index(xmss_flashlog *fl, uint64_t v, const uint8_t *sk, const void *state)
+{
+    uint8_t rec[XMSS_FLASH_MAX_PROG > FL_IDX_REC ? XMSS_FLASH_MAX_PROG : FL_IDX_REC];
+    int     rc;
+
+    if (fl->cursor + fl->idx_area > fl->dev->sector_bytes ||
+        !fl->has_base || v - fl->base > 0xFFFFFFFFULL) {
+        rc = new_sector(fl, sk, state);
+        if (rc != XMSS_OK) {
+            return rc;
+        }
+    }
+    memset(rec, 0xFF, sizeof(rec));
+    rec[0] = FL_TAG_IDX;
+    ull_to_bytes(rec + 1, 4, v - fl->base);
+    ull_to_bytes(rec + 5, 3, crc32_update(0, rec, 5) & 0xFFFFFFU);
+    rc = put_record(fl, rec, fl->idx_area);
+    if (rc == XMSS_OK) {
+        fl->st.index_records++;
+    }
+    return rc;
+}
+
+/* ====================================================================
+ * Recovery scan
+ * ==================================================================== */
+
+typedef struct {
+    uint64_t v;              /* highest V seen */
+    int      found;          /* a valid snapshot exists */
+    uint32_t snap_sector;    /* newest valid snapshot */
+    uint32_t snap_off;
+    uint32_t snap_seq;
+    int      have_newest;    /* newest valid sector header */
+    uint32_t newest, newest_seq, newest_end;
+    int      newest_base, newest_clean;
+    uint64_t newest_base_idx;
+} fl_scan;
+
+/* Parse one sector's records; returns XMSS_ERR_IO on a read failure */
+static int scan_sector(xmss_flashlog *fl, uint32_t s, uint32_t seq, fl_scan *sc)
+{
+    const xmss_flash_dev *dev  = fl->dev;
+    const xmss_params    *p    = &fl->p;
+    uint32_t              at   = s * dev->sector_bytes;
+    uint32_t              off  = fl->hdr_area;
+    uint32_t              len  = p->sk_bytes + fl->state_bytes;
+    uint8_t               rec[FL_SNAP_HDR];
+    uint64_t              base = 0, v;
+    int                   has_base = 0, clean = 0;
+    uint32_t              chunk;
+
+    while (off + FL_IDX_REC <= dev->sector_bytes) {
+        if (dev->read(dev->ctx, at + off, rec, FL_IDX_REC) != 0) { return XMSS_ERR_IO; }
+
+        if (all_erased(rec, FL_IDX_REC)) {
+            /* End of the log in this sector if the rest is erased too */
+            uint32_t o = off;
+            clean = 1;
+            while (clean && o < dev->sector_bytes) {
+                chunk = dev->sector_bytes - o < fl->snap_area ? dev->sector_bytes - o
+                                                               : fl->snap_area;
+                if (dev->read(dev->ctx, at + o, fl->work, chunk) != 0) { return XMSS_ERR_IO; }
+                clean = all_erased(fl->work, chunk);
+                o += chunk;
+            }
+            break;
+        }
+        if (rec[0] == FL_TAG_IDX) {
+            if (!has_base ||
+                bytes_to_ull(rec + 5, 3) != (crc32_update(0, rec, 5) & 0xFFFFFFU)) {
+                break;
+            }
+            v = base + bytes_to_ull(rec + 1, 4);
+            if (v > sc->v) { sc->v = v; }
+            off += fl->idx_area;
+            continue;
+        }
+        if (rec[0] != FL_TAG_SNAP || off + fl->snap_area > dev->sector_bytes) {
+            break;
+        }
+        if (dev->read(dev->ctx, at + off, fl->work, fl->snap_area) != 0) { return XMSS_ERR_IO; }
+        if (bytes_to_ull(fl->work + 20, 4) != crc32_update(0, fl->work, 20) ||
+            bytes_to_ull(fl->work + 4, 4) != len ||
+            bytes_to_ull(fl->work + 16, 4) != crc32_update(0, fl->work + FL_SNAP_HDR, len) ||
+            (uint32_t)bytes_to_ull(fl->work + FL_SNAP_HDR, 4) != p->oid) {
+            break;
+        }
+        v = bytes_to_ull(fl->work + FL_SNAP_HDR + sk_off_idx(p), p->idx_bytes);
+        if (!has_base) {
+            base     = v;
+            has_base = 1;
+        }
+        if (v > sc->v) { sc->v = v; }
+        if (bytes_to_ull(fl->work + 8, 8) > sc->v) { sc->v = bytes_to_ull(fl->work + 8, 8); }
+        if (!sc->found || seq_after(seq, sc->snap_seq) ||
+            (seq == sc->snap_seq && off > sc->snap_off)) {
+            sc->found       = 1;
+            sc->snap_sector = s;
+            sc->snap_off    = off;
+            sc->snap_seq    = seq;
+        }
+        off += fl->snap_area;
+    }
+
+    if (!sc->have_newest || seq_after(seq, sc->newest_seq)) {
+        sc->have_newest     = 1;
+        sc->newest          = s;
+        sc->newest_seq      = seq;
+        sc->newest_end      = off;
+        sc->newest_base     = has_base;
+        sc->newest_base_idx = base;
+        sc->newest_clean    = clean;
+    }
+    return XMSS_OK;
+}
+
+static int fl_load(xmss_flashlog *fl, uint8_t *sk, void *state)
+{
+    const xmss_flash_dev *dev = fl->dev;
+    const xmss_params    *p   = &fl->p;
+    fl_scan  sc;
+    uint8_t  hdr[FL_SECTOR_HDR];
+    uint64_t idx;
+    uint32_t s;
+    int      rc;
+
+    memset(&sc, 0, sizeof(sc));
+    for (s = 0; s < dev->sectors; s++) {
+        if (dev->read(dev->ctx, s * dev->sector_bytes, hdr, FL_SECTOR_HDR) != 0) {
+            return XMSS_ERR_IO;
+        }
+        if (memcmp(hdr, fl_magic, 4) != 0 ||
+            bytes_to_ull(hdr + 12, 4) != crc32_update(0, hdr, 12) ||
+            (uint32_t)bytes_to_ull(hdr + 8, 4) != p->oid) {
+            continue;
+        }
+        rc = scan_sector(fl, s, (uint32_t)bytes_to_ull(hdr + 4, 4), &sc);
+        if (rc != XMSS_OK) {
+            return rc;
+        }
+    }
+    if (!sc.found) {
+        return XMSS_ERR_PARAMS;
+    }
+
+    /* Newest snapshot into sk / state */
+    if (dev->read(dev->ctx, sc.snap_sector * dev->sector_bytes + sc.snap_off,
+                  fl->work, fl->snap_area) != 0) {
+        return XMSS_ERR_IO;
+    }
+    memcpy(sk, fl->work + FL_SNAP_HDR, p->sk_bytes);
+    if (p->d > 1) {
+        rc = xmss_mt_state_deserialize(p, (xmss_mt_state *)state,
+                                       fl->work + FL_SNAP_HDR + p->sk_bytes, fl->bds_k);
+    } else {
+        rc = xmss_bds_deserialize(p, (xmss_bds_state *)state,
+                                  fl->work + FL_SNAP_HDR + p->sk_bytes, fl->bds_k);
+    }
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+
+    /* Replay up to V: indices below it may have signed something */
+    if (sc.v > p->idx_max + 1) {
+        sc.v = p->idx_max + 1;
+    }
+    fl->st.replayed = 0;
+    idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
+    while (idx < sc.v) {
+        rc = p->d > 1 ? xmss_mt_skip(p, sk, (xmss_mt_state *)state, fl->bds_k)
+                      : xmss_skip(p, sk, (xmss_bds_state *)state, fl->bds_k);
+        if (rc != XMSS_OK) {
+            return rc;
+        }
+        idx++;
+        fl->st.replayed++;
+    }
+
+    /* Append after the newest sector's records, or move on if it is torn */
+    fl->sector     = sc.newest;
+    fl->seq        = sc.newest_seq;
+    fl->has_base   = sc.newest_base;
+    fl->base       = sc.newest_base_idx;
+    fl->cursor     = sc.newest_clean && sc.newest_base ? sc.newest_end : dev->sector_bytes;
+    fl->reserved   = sc.v > idx ? sc.v : idx;
+    fl->since_snap = (uint32_t)fl->st.replayed;
+    fl->error      = XMSS_OK;
+    return XMSS_OK;
+}
+
+static int fl_format(xmss_flashlog *fl, const uint8_t *sk, const void *state)
+{
+    const xmss_flash_dev *dev = fl->dev;
+    uint32_t s;
+
+    for (s = 1; s < dev->sectors; s++) {
+        if (dev->erase(dev->ctx, s) != 0) {
+            return XMSS_ERR_IO;
+        }
+        fl->st.erases++;
+    }
+    /* new_sector() erases sector 0 and reuses it: no base yet */
+    fl->sector   = 0;
+    fl->seq      = 0;
+    fl->has_base = 0;
+    fl->error    = XMSS_OK;
+    fl->reserved = bytes_to_ull(sk + sk_off_idx(&fl->p), fl->p.idx_bytes);
+    return new_sector(fl, sk, state);
+}
+
+static int fl_sign(xmss_flashlog *fl, uint8_t *sig, const uint8_t *msg, size_t msglen,
+                   uint8_t *sk, void *state)
+{
+    const xmss_params *p = &fl->p;
+    uint64_t idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
+    uint64_t v;
+    int      rc;
+
+    if (fl->error != XMSS_OK) {
+        return fl->error;
+    }
+    if (idx > p->idx_max) {
+        return XMSS_ERR_EXHAUSTED;
+    }
+
+    /* Index durable before the signature exists */
+    if (idx + 1 > fl->reserved) {
+        v = idx + fl->reserve;
+        if (v > p->idx_max + 1) { v = p->idx_max + 1; }
+        rc = log_index(fl, v, sk, state);
+        if (rc != XMSS_OK) {
+            return rc;
+        }
+        fl->reserved = v;
+    }
+
+    rc = p->d > 1 ? xmss_mt_sign(p, sig, msg, msglen, sk, (xmss_mt_state *)state, fl->bds_k)
+                  : xmss_sign(p, sig, msg, msglen, sk, (xmss_bds_state *)state, fl->bds_k);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    fl->st.signatures++;
+    fl->since_snap++;
+
+    if (fl->snap_interval != 0 && fl->since_snap >= fl->snap_interval) {
+        rc = log_snapshot(fl, sk, state);
+        if (rc != XMSS_OK) {
+            xmss_memzero(sig, p->sig_bytes);
+            return rc;
+        }
+    }
+    return XMSS_OK;
+}
+
+/* ====================================================================
+ * Public API
+ * ==================================================================== */
+
+uint32_t xmss_flashlog_work_bytes(const xmss_params *p, uint32_t bds_k)
+{
+    return round_up32(FL_SNAP_HDR + p->sk_bytes + state_bytes_for(p, bds_k), XMSS_FLASH_MAX_PROG);
+}
+
+int xmss_flashlog_init(xmss_flashlog *fl, const xmss_flash_dev *dev,
+                       const xmss_params *p, uint32_t bds_k,
+                       uint32_t reserve, uint32_t snap_interval, uint8_t *work)
+{
+    uint32_t prog = dev->prog_bytes;
+
+    memset(fl, 0, sizeof(*fl));
+    if (prog == 0 || prog > XMSS_FLASH_MAX_PROG || (prog & (prog - 1)) != 0 ||
+        dev->sectors < 2 || dev->sector_bytes % prog != 0 || reserve == 0 ||
+        (bds_k & 1) || bds_k > p->tree_height || p->func > XMSS_FUNC_SHAKE256) {
+        return XMSS_ERR_PARAMS;
+    }
+    fl->p             = *p;
+    fl->dev           = dev;
+    fl->work          = work;
+    fl->bds_k         = bds_k;
+    fl->reserve       = reserve;
+    fl->snap_interval = snap_interval;
+    fl->state_bytes   = state_bytes_for(p, bds_k);
+    fl->hdr_area      = round_up32(FL_SECTOR_HDR, prog);
+    fl->idx_area      = round_up32(FL_IDX_REC, prog);
+    fl->snap_area     = round_up32(FL_SNAP_HDR + p->sk_bytes + fl->state_bytes, prog);
+    fl->cursor        = dev->sector_bytes;
+
+    if ((uint64_t)fl->hdr_area + fl->snap_area + fl->idx_area > dev->sector_bytes) {
+        return XMSS_ERR_PARAMS;
+    }
+    return XMSS_OK;
+}
+
+int xmss_flashlog_format(xmss_flashlog *fl, const uint8_t *sk,
+                         const xmss_bds_state *state)
+{
+    if (fl->p.d != 1) { return XMSS_ERR_PARAMS; }
+    return fl_format(fl, sk, state);
+}
+
+int xmss_mt_flashlog_format(xmss_flashlog *fl, const uint8_t *sk,
+                            const xmss_mt_state *state)
+{
+    if (fl->p.d < 2) { return XMSS_ERR_PARAMS; }
+    return fl_format(fl, sk, state);
+}
+
+int xmss_flashlog_load(xmss_flashlog *fl, uint8_t *sk, xmss_bds_state *state)
+{
+    if (fl->p.d != 1) { return XMSS_ERR_PARAMS; }
+    return fl_load(fl, sk, state);
+}
+
+int xmss_mt_flashlog_load(xmss_flashlog *fl, uint8_t *sk, xmss_mt_state *state)
+{
+    if (fl->p.d < 2) { return XMSS_ERR_PARAMS; }
+    return fl_load(fl, sk, state);
+}
+
+int xmss_flashlog_sign(xmss_flashlog *fl, uint8_t *sig,
+                       const uint8_t *msg, size_t msglen,
+                       uint8_t *sk, xmss_bds_state *state)
+{
+    if (fl->p.d != 1) { return XMSS_ERR_PARAMS; }
+    return fl_sign(fl, sig, msg, msglen, sk, state);
+}
+
+int xmss_mt_flashlog_sign(xmss_flashlog *fl, uint8_t *sig,
+                          const uint8_t *msg, size_t msglen,
+                          uint8_t *sk, xmss_mt_state *state)
+{
+    if (fl->p.d < 2) { return XMSS_ERR_PARAMS; }
+    return fl_sign(fl, sig, msg, msglen, sk, state);
+}
+
+void xmss_flashlog_stats(const xmss_flashlog *fl, xmss_flashlog_stats_t *out)
+{
+    *out = fl->st;
+}
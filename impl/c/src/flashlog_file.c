@@ -0,0 +1,146 @@
+/**
+ * flashlog_file.c - NOR flash emulated in a file (flashlog.h)
+ *
+ * Stand-in device for hosted builds and tests: stdio only.  Enforces what
+ * real NOR would punish silently (programming a range that is not erased
+ * or not aligned) and can simulate a power cut part way through a write.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/xmss/flashlog.h"
+
+#define FF_CHUNK 256U
+
+static int ff_read(void *ctx, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+    xmss_flash_file *f = (xmss_flash_file *)ctx;
+
+    if ((uint64_t)addr + len > (uint64_t)f->dev.sector_bytes * f->dev.sectors ||
+        fseek((FILE *)f->fp, (long)addr, SEEK_SET) != 0 ||
+        fread(buf, 1, len, (FILE *)f->fp) != len) {
+        return -1;
+    }
+    return 0;
+}
+
+static int ff_prog(void *ctx, uint32_t addr, const uint8_t *buf, uint32_t len)
+{
+    xmss_flash_file *f = (xmss_flash_file *)ctx;
+    FILE    *fp = (FILE *)f->fp;
+    uint8_t  old[FF_CHUNK];
+    uint32_t done, n, i;
+    int      cut = 0;
+
+    if (addr % f->dev.prog_bytes != 0 || len % f->dev.prog_bytes != 0 ||
+        (uint64_t)addr + len > (uint64_t)f->dev.sector_bytes * f->dev.sectors) {
+        return -1;
+    }
+    if (f->cut_after < len) {               /* power fails part way through */
+        len = (uint32_t)f->cut_after;
+        cut = 1;
+    }
+    for (done = 0; done < len; done += n) {
+        n = len - done < FF_CHUNK ? len - done : FF_CHUNK;
+        if (ff_read(ctx, addr + done, old, n) != 0) {
+            return -1;
+        }
+        for (i = 0; i < n; i++) {
+            if (old[i] != 0xFF) {
+                return -1;                  /* not erased */
+            }
+            old[i] = buf[done + i];
+        }
+        if (fseek(fp, (long)(addr + done), SEEK_SET) != 0 ||
+            fwrite(old, 1, n, fp) != n) {
+            return -1;
+        }
+    }
+    if (fflush(fp) != 0) {
+        return -1;
+    }
+    if (f->cut_after != UINT64_MAX) {
+        f->cut_after -= len;
+    }
+    return cut ? -1 : 0;
+}
+
+static int ff_erase(void *ctx, uint32_t sector)
+{
+    xmss_flash_file *f = (xmss_flash_file *)ctx;
+    FILE    *fp = (FILE *)f->fp;
+    uint8_t  ones[FF_CHUNK];
+    uint32_t done, n;
+
+    if (sector >= f->dev.sectors || f->cut_after == 0 ||
+        fseek(fp, (long)sector * (long)f->dev.sector_bytes, SEEK_SET) != 0) {
+        return -1;
+    }
+    memset(ones, 0xFF, sizeof(ones));
+    for (done = 0; done < f->dev.sector_bytes; done += n) {
+        n = f->dev.sector_bytes - done < FF_CHUNK ? f->dev.sector_bytes - done : FF_CHUNK;
+        if (fwrite(ones, 1, n, fp) != n) {
+            return -1;
+        }
+    }
+    f->erase_count[sector]++;
+    return fflush(fp) == 0 ? 0 : -1;
+}
+
+int xmss_flash_file_open(xmss_flash_file *f, const char *path,
+                         uint32_t sector_bytes, uint32_t sectors,
+                         uint32_t prog_bytes)
+{
+    FILE    *fp;
+    uint8_t  ones[FF_CHUNK];
+    long     size, total;
+
+    memset(f, 0, sizeof(*f));
+    if (sectors < 2 || sectors > XMSS_FLASH_FILE_MAX_SECTORS || prog_bytes == 0 ||
+        prog_bytes > XMSS_FLASH_MAX_PROG || (prog_bytes & (prog_bytes - 1)) != 0 ||
+        sector_bytes == 0 || sector_bytes % prog_bytes != 0 ||
+        (uint64_t)sector_bytes * sectors > 0x7FFFFFFFULL) {
+        return XMSS_ERR_PARAMS;
+    }
+    fp = fopen(path, "r+b");
+    if (fp == NULL) {
+        fp = fopen(path, "w+b");
+    }
+    if (fp == NULL || fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0) {
+        if (fp != NULL) { fclose(fp); }
+        return XMSS_ERR_IO;
+    }
+
+    /* Extend with erased bytes */
+    total = (long)sector_bytes * (long)sectors;
+    memset(ones, 0xFF, sizeof(ones));
+    while (size < total) {
+        size_t n = (size_t)(total - size < (long)FF_CHUNK ? total - size : (long)FF_CHUNK);
+        if (fwrite(ones, 1, n, fp) != n) {
+            fclose(fp);
+            return XMSS_ERR_IO;
+        }
+        size += (long)n;
+    }
+    fflush(fp);
+
+    f->fp               = fp;
+    f->cut_after        = UINT64_MAX;
+    f->dev.ctx          = f;
+    f->dev.sector_bytes = sector_bytes;
+    f->dev.sectors      = sectors;
+    f->dev.prog_bytes   = prog_bytes;
+    f->dev.read         = ff_read;
+    f->dev.prog         = ff_prog;
+    f->dev.erase        = ff_erase;
+    return XMSS_OK;
+}
+
+void xmss_flash_file_close(xmss_flash_file *f)
+{
+    if (f->fp != NULL) {
+        fclose((FILE *)f->fp);
+        f->fp = NULL;
+    }
+}
@@ -2,7 +2,7 @@
  * hash_iface.h - XMSS hash function interface (internal)
  *
  * This is the SOLE location of hash backend dispatch.
- * All algorithm code calls only the five functions declared here.
+ * All algorithm code calls only the functions declared here.
  * No algorithm file includes sha2_local.h or shake_local.h directly.
  *
  * JASMIN: when porting, replace xmss_hash.c with a parameter-set-specific
@@ -33,6 +33,25 @@ int xmss_F(const xmss_params *p, uint8_t *out,
            const uint8_t *key, const xmss_adrs_t *adrs,
            const uint8_t *in);
 
+/**
+ * xmss_F_chain() - WOTS+ chaining function over several steps (Alg 2)
+ *
+ * out = F applied steps times to in, with hash address start, start+1,
+ * ... (stopping at w-1) and key_and_mask 0.  adrs is left at the last
+ * hash address used.  out may equal in.
+ *
+ * @p:     Parameter set.
+ * @out:   Output n-byte chain element.
+ * @in:    Input n-byte chain element.
+ * @start: Starting hash address.
+ * @steps: Number of F applications.
+ * @seed:  n-byte SEED.
+ * @adrs:  Address (type=OTS, chain set by the caller).
+ */
+int xmss_F_chain(const xmss_params *p, uint8_t *out, const uint8_t *in,
+                 uint32_t start, uint32_t steps,
+                 const uint8_t *seed, xmss_adrs_t *adrs);
+
 /**
  * xmss_H() - Tree hash function (RFC 8391 §4.1.2)
  *
@@ -67,6 +86,33 @@ int xmss_H_msg(const xmss_params *p, uint8_t *out,
                const uint8_t *r, const uint8_t *root, uint64_t idx,
                const uint8_t *msg, size_t msglen);
 
+/**
+ * xmss_hmsg_input - One H_msg evaluation for xmss_H_msg_multi().
+ */
+typedef struct {
+    const uint8_t *r;       /* n-byte randomiser from the signature */
+    const uint8_t *root;    /* n-byte tree root from the public key */
+    uint64_t       idx;     /* signature index */
+    const uint8_t *msg;
+    size_t         msglen;
+} xmss_hmsg_input;
+
+/**
+ * xmss_H_msg_multi() - xmss_H_msg() for count independent messages.
+ *
+ * Multi-buffer engine: each of XMSS_HASH_LANES lanes streams one message
+ * block by block through a lane-parallel compression function, and a
+ * lane whose message has finished is refilled with the next pending one,
+ * so messages of different lengths keep every lane busy.
+ *
+ * @p:     Parameter set.
+ * @out:   Output: count * n bytes; H_msg of in[i] at out + i*n.
+ * @in:    count inputs.
+ * @count: Number of inputs.
+ */
+int xmss_H_msg_multi(const xmss_params *p, uint8_t *out,
+                     const xmss_hmsg_input *in, uint32_t count);
+
 /**
  * xmss_PRF() - Pseudorandom function (RFC 8391 §4.1.2)
  *
@@ -112,4 +158,169 @@ int xmss_PRF_keygen(const xmss_params *p, uint8_t *out,
 int xmss_PRF_idx(const xmss_params *p, uint8_t *out,
                  const uint8_t *sk_prf, uint64_t idx);
 
+/* ====================================================================
+ * Multi-lane interface
+ *
+ * The leaf pipeline computes XMSS_HASH_LANES leaves in lockstep.  Nodes
+ * stay in a word-interleaved (structure-of-arrays) layout from WOTS+
+ * key expansion through chaining and the L-tree, and are converted to
+ * byte strings only at the leaf boundary (xmss_lanes_store()).
+ *
+ * Lane l of every call uses its own address adrs[l]; key and seed
+ * arguments are shared by all lanes.  out may alias any input.
+ * ==================================================================== */
+
+/**
+ * xmss_lanes_t - XMSS_HASH_LANES n-byte nodes, word-interleaved.
+ *
+ * Big-endian 32-bit word j (bytes 4j..4j+3) of lane l is w[j][l].
+ * Only the first n/4 rows are meaningful.
+ */
+typedef struct {
+    uint32_t w[XMSS_MAX_N / 4][XMSS_HASH_LANES];
+} xmss_lanes_t;
+
+/**
+ * xmss_lanes_load() - Copy an n-byte node into one lane.
+ * xmss_lanes_store() - Copy one lane out as an n-byte node.
+ */
+void xmss_lanes_load(const xmss_params *p, xmss_lanes_t *dst,
+                     uint32_t lane, const uint8_t *in);
+void xmss_lanes_store(const xmss_params *p, uint8_t *out,
+                      const xmss_lanes_t *src, uint32_t lane);
+
+/**
+ * xmss_F_lanes() - xmss_F() on every lane.
+ *
+ * @p:    Parameter set.
+ * @out:  Output lanes.
+ * @key:  n-byte key (SEED), shared.
+ * @adrs: XMSS_HASH_LANES addresses, one per lane.
+ * @in:   Input lanes.
+ */
+int xmss_F_lanes(const xmss_params *p, xmss_lanes_t *out,
+                 const uint8_t *key, const xmss_adrs_t *adrs,
+                 const xmss_lanes_t *in);
+
+/**
+ * xmss_H_lanes() - xmss_H() on every lane.
+ *
+ * @p:     Parameter set.
+ * @out:   Output lanes.
+ * @key:   n-byte key (SEED), shared.
+ * @adrs:  XMSS_HASH_LANES addresses, one per lane.
+ * @in_l:  Left input lanes.
+ * @in_r:  Right input lanes.
+ */
+int xmss_H_lanes(const xmss_params *p, xmss_lanes_t *out,
+                 const uint8_t *key, const xmss_adrs_t *adrs,
+                 const xmss_lanes_t *in_l, const xmss_lanes_t *in_r);
+
+/**
+ * xmss_PRF_keygen_lanes() - xmss_PRF_keygen() on every lane.
+ *
+ * @p:        Parameter set.
+ * @out:      Output lanes.
+ * @sk_seed:  n-byte secret seed, shared.
+ * @pub_seed: n-byte public seed, shared.
+ * @adrs:     XMSS_HASH_LANES addresses, one per lane.
+ */
+int xmss_PRF_keygen_lanes(const xmss_params *p, xmss_lanes_t *out,
+                          const uint8_t *sk_seed, const uint8_t *pub_seed,
+                          const xmss_adrs_t *adrs);
+
+/**
+ * xmss_hash_leaf_lanes() - Leaf pipeline width selected by
+ * xmss_backend_set(): 1 or XMSS_HASH_LANES (the default).
+ */
+uint32_t xmss_hash_leaf_lanes(void);
+
+/**
+ * xmss_hash_lanes_native() - 1 if the *_lanes() kernels are real lane
+ * code for p (SHA2, n = 32); otherwise they loop over the scalar hash
+ * per lane and callers are better off on their scalar path.
+ */
+int xmss_hash_lanes_native(const xmss_params *p);
+
+/* ====================================================================
+ * LMS / LM-OTS hashing (RFC 8554), func == XMSS_FUNC_LMS_SHA256
+ *
+ * Every hash is SHA-256 of a prefix I || u32str(q) || ... where I is the
+ * tree's 16-byte identifier; there are no bitmasks.  I is passed as an
+ * n-byte buffer whose first 16 bytes are the identifier, so it can stand
+ * in for SEED wherever XMSS code passes one through.
+ *
+ * xmss_H() on such a set is the interior node hash
+ *   T[r] = H(I || u32str(r) || u16str(D_INTR) || M_l || M_r)
+ * with r = 2^(tree_height - height - 1) + tree_index taken from the
+ * address, so treehash, BDS and compute_root() run unchanged.
+ * ==================================================================== */
+
+/**
+ * xmss_lmots_prf() - LM-OTS private element (RFC 8554 Appendix A)
+ *
+ * out = H(I || u32str(q) || u16str(i) || u8str(0xff) || SEED)
+ */
+int xmss_lmots_prf(const xmss_params *p, uint8_t *out,
+                   const uint8_t *I, uint32_t q, uint32_t i,
+                   const uint8_t *seed);
+
+/**
+ * xmss_lmots_chain() - steps iterations of the LM-OTS chain function
+ *
+ * tmp = H(I || u32str(q) || u16str(i) || u8str(j) || tmp) for
+ * j = start, ..., start + steps - 1.  out may equal in.
+ */
+int xmss_lmots_chain(const xmss_params *p, uint8_t *out, const uint8_t *in,
+                     const uint8_t *I, uint32_t q, uint32_t i,
+                     uint32_t start, uint32_t steps);
+
+/**
+ * xmss_lmots_prf_lanes() / xmss_lmots_chain_lanes() - The same on every
+ * lane, lane l using leaf q[l]; I, i and the chain range are shared.
+ * Each hash is a single SHA-256 block, run XMSS_HASH_LANES wide.
+ */
+int xmss_lmots_prf_lanes(const xmss_params *p, xmss_lanes_t *out,
+                         const uint8_t *I, const uint32_t *q, uint32_t i,
+                         const uint8_t *seed);
+int xmss_lmots_chain_lanes(const xmss_params *p, xmss_lanes_t *out,
+                           const xmss_lanes_t *in, const uint8_t *I,
+                           const uint32_t *q, uint32_t i,
+                           uint32_t start, uint32_t steps);
+
+/**
+ * xmss_lmots_pk() - LM-OTS public key from the chain ends
+ *
+ * out = H(I || u32str(q) || u16str(D_PBLC) || y[0] || ... || y[len-1])
+ */
+int xmss_lmots_pk(const xmss_params *p, uint8_t *out,
+                  const uint8_t *I, uint32_t q, const uint8_t *y);
+
+/**
+ * xmss_lmots_msg() - LM-OTS message digest
+ *
+ * out = H(I || u32str(q) || u16str(D_MESG) || C || msg)
+ */
+int xmss_lmots_msg(const xmss_params *p, uint8_t *out,
+                   const uint8_t *I, uint32_t q, const uint8_t *C,
+                   const uint8_t *msg, size_t msglen);
+
+/**
+ * xmss_lms_leaf() - LMS leaf node
+ *
+ * out = H(I || u32str(r) || u16str(D_LEAF) || K), r = 2^tree_height + q.
+ */
+int xmss_lms_leaf(const xmss_params *p, uint8_t *out,
+                  const uint8_t *I, uint32_t r, const uint8_t *K);
+
+/**
+ * xmss_hss_derive() - Per-tree secrets and randomisers for HSS
+ *
+ * out = H(I || u32str(level) || u64str(tree) || u8str(tag) || key)
+ * with I the top tree's identifier and key an n-byte master secret.
+ */
+int xmss_hss_derive(const xmss_params *p, uint8_t *out,
+                    const uint8_t *key, const uint8_t *I,
+                    uint32_t level, uint64_t tree, uint32_t tag);
+
 #endif /* XMSS_HASH_IFACE_H */
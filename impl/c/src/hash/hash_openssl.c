@@ -0,0 +1,104 @@
+/**
+ * hash_openssl.c - System libcrypto hash provider (XMSS_USE_OPENSSL)
+ *
+ * SHA-256 / SHA-512 use the low-level SHA{256,512}_Transform block
+ * functions, which libcrypto backs with its assembly (SHA-NI, ARMv8 SHA,
+ * AVX2) kernels.  libcrypto exposes no raw Keccak-f[1600], so SHAKE goes
+ * through EVP one-shot; the incremental SHAKE contexts keep the portable
+ * permutation.
+ *
+ * The SHAKE EVP_MDs are fetched once per process and each thread keeps
+ * one EVP_MD_CTX (freed at thread exit), so a call is DigestInit /
+ * Update / FinalXOF with no allocation and no implicit fetch.
+ *
+ * Not part of the Jasmin port: this file calls into an external library
+ * and EVP allocates internally.
+ */
+/* SHA*_Transform are deprecated in OpenSSL 3 but remain the only
+ * midstate-level entry points; BoringSSL keeps them undeprecated. */
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
+#include <openssl/sha.h>
+
+#include "hash_openssl.h"
+
+void xmss_ossl_sha256_block(uint32_t state[8], const uint8_t block[64])
+{
+    SHA256_CTX c;
+    uint32_t   i;
+
+    for (i = 0; i < 8; i++) { c.h[i] = state[i]; }
+    SHA256_Transform(&c, block);
+    for (i = 0; i < 8; i++) { state[i] = (uint32_t)c.h[i]; }
+}
+
+void xmss_ossl_sha512_block(uint64_t state[8], const uint8_t block[128])
+{
+    SHA512_CTX c;
+    uint32_t   i;
+
+    for (i = 0; i < 8; i++) { c.h[i] = state[i]; }
+    SHA512_Transform(&c, block);
+    for (i = 0; i < 8; i++) { state[i] = (uint64_t)c.h[i]; }
+}
+
+#ifndef OPENSSL_IS_BORINGSSL
+
+static pthread_once_t g_shake_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  g_shake_key;
+static int            g_shake_ok;
+static const EVP_MD  *g_shake128;
+static const EVP_MD  *g_shake256;
+
+static void shake_ctx_free(void *ctx)
+{
+    EVP_MD_CTX_free((EVP_MD_CTX *)ctx);
+}
+
+/* OpenSSL 3 resolves EVP_shake*() by an implicit fetch on every init */
+static void shake_init_once(void)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    g_shake128 = EVP_MD_fetch(NULL, "SHAKE128", NULL);
+    g_shake256 = EVP_MD_fetch(NULL, "SHAKE256", NULL);
+#else
+    g_shake128 = EVP_shake128();
+    g_shake256 = EVP_shake256();
+#endif
+    g_shake_ok = g_shake128 != NULL && g_shake256 != NULL &&
+                 pthread_key_create(&g_shake_key, shake_ctx_free) == 0;
+}
+
+#endif /* OPENSSL_IS_BORINGSSL */
+
+int xmss_ossl_shake(uint8_t *out, size_t outlen,
+                    const uint8_t *in, size_t inlen, uint32_t rate)
+{
+#ifdef OPENSSL_IS_BORINGSSL
+    (void)out; (void)outlen; (void)in; (void)inlen; (void)rate;
+    return -1;
+#else
+    EVP_MD_CTX *ctx;
+
+    if (pthread_once(&g_shake_once, shake_init_once) != 0 || !g_shake_ok) {
+        return -1;
+    }
+    ctx = (EVP_MD_CTX *)pthread_getspecific(g_shake_key);
+    if (ctx == NULL) {
+        ctx = EVP_MD_CTX_new();
+        if (ctx == NULL || pthread_setspecific(g_shake_key, ctx) != 0) {
+            EVP_MD_CTX_free(ctx);
+            return -1;
+        }
+    }
+    return EVP_DigestInit_ex(ctx, rate == 168U ? g_shake128 : g_shake256, NULL) == 1 &&
+           EVP_DigestUpdate(ctx, in, inlen) == 1 &&
+           EVP_DigestFinalXOF(ctx, out, outlen) == 1 ? 0 : -1;
+#endif
+}
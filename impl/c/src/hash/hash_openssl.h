@@ -0,0 +1,33 @@
+/**
+ * hash_openssl.h - System libcrypto (OpenSSL / BoringSSL) hash provider
+ *
+ * Built only with -DXMSS_USE_OPENSSL=ON.  sha2_local.c and shake_local.c
+ * route their block function and one-shot SHAKE through these entry
+ * points, so everything above them (hash_iface.h, midstates, the
+ * incremental H_msg contexts) is unchanged.
+ *
+ * The SHA-2 functions are midstate-friendly: they compress exactly one
+ * block into a caller-held state, with no length accounting or padding.
+ */
+#ifndef XMSS_HASH_OPENSSL_H
+#define XMSS_HASH_OPENSSL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* state = compress(state, block) with libcrypto's SHA-256 block function. */
+void xmss_ossl_sha256_block(uint32_t state[8], const uint8_t block[64]);
+
+/* state = compress(state, block) with libcrypto's SHA-512 block function. */
+void xmss_ossl_sha512_block(uint64_t state[8], const uint8_t block[128]);
+
+/*
+ * One-shot SHAKE-128 (rate 168) or SHAKE-256 (rate 136) through EVP.
+ * Returns 0 on success, -1 if libcrypto cannot provide it (allocation
+ * failure, or a libcrypto without SHAKE); the caller then falls back to
+ * the portable Keccak.
+ */
+int xmss_ossl_shake(uint8_t *out, size_t outlen,
+                    const uint8_t *in, size_t inlen, uint32_t rate);
+
+#endif /* XMSS_HASH_OPENSSL_H */
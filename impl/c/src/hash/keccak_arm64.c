@@ -0,0 +1,155 @@
+/**
+ * keccak_arm64.c - Keccak-f[1600] on the ARMv8.2 SHA3 extension (aarch64)
+ *
+ * Compiled with -march=armv8.2-a+sha3 (this file only) and used only
+ * after keccak_arm64_sha3() has seen HWCAP_SHA3.  Each round is
+ *
+ *   theta:   C[x]  = EOR3(EOR3(A[x], A[x+5], A[x+10]), A[x+15], A[x+20])
+ *            D[x]  = RAX1(C[x-1], C[x+1])              C[x-1] ^ rol(C[x+1], 1)
+ *   rho, pi: B[pi] = XAR(A[x+5y], D[x], 64 - r[x][y])   ror(A ^ D, 64 - r)
+ *   chi:     A[i]  = BCAX(B[i], B[i+2], B[i+1])         B ^ (B[+2] & ~B[+1])
+ *   iota:    A[0] ^= RC[round]
+ *
+ * so theta's column mix is folded into rho.  Vectors are 2 x 64-bit: the
+ * x2 entry point keeps two states side by side, the single-state entry
+ * point uses the low half only.
+ *
+ * Not part of the Jasmin port (the portable keccak_f1600 is).
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include <arm_neon.h>
+#include <sys/auxv.h>
+
+#include "keccak_arm64.h"
+
+#ifndef HWCAP_SHA3
+#define HWCAP_SHA3 (1UL << 17)
+#endif
+
+typedef uint64x2_t kv;
+
+#define EOR3(a, b, c) veor3q_u64((a), (b), (c))
+#define RAX1(a, b)    vrax1q_u64((a), (b))
+#define XAR(a, b, n)  vxarq_u64((a), (b), (n))
+#define BCAX(a, b, c) vbcaxq_u64((a), (b), (c))
+
+static const uint64_t RC[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL,
+    0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL,
+    0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL,
+    0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL,
+    0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+/* Cleared by keccak_arm64_enable(0) to force the portable permutation */
+static int enabled = 1;
+
+int keccak_arm64_available(void)
+{
+    /* Racing first callers all store the same value */
+    static int have = -1;
+    int h = __atomic_load_n(&have, __ATOMIC_RELAXED);
+    if (h < 0) {
+        h = (getauxval(AT_HWCAP) & HWCAP_SHA3) != 0;
+        __atomic_store_n(&have, h, __ATOMIC_RELAXED);
+    }
+    return h;
+}
+
+int keccak_arm64_sha3(void)
+{
+    return __atomic_load_n(&enabled, __ATOMIC_RELAXED) && keccak_arm64_available();
+}
+
+void keccak_arm64_enable(int on)
+{
+    __atomic_store_n(&enabled, on != 0, __ATOMIC_RELAXED);
+}
+
+static void keccak_rounds(kv A[25])
+{
+    kv       B[25], C[5], D[5];
+    uint32_t round, y;
+
+    for (round = 0; round < 24; round++) {
+        /* Theta */
+        C[0] = EOR3(EOR3(A[0], A[5], A[10]), A[15], A[20]);
+        C[1] = EOR3(EOR3(A[1], A[6], A[11]), A[16], A[21]);
+        C[2] = EOR3(EOR3(A[2], A[7], A[12]), A[17], A[22]);
+        C[3] = EOR3(EOR3(A[3], A[8], A[13]), A[18], A[23]);
+        C[4] = EOR3(EOR3(A[4], A[9], A[14]), A[19], A[24]);
+        D[0] = RAX1(C[4], C[1]);
+        D[1] = RAX1(C[0], C[2]);
+        D[2] = RAX1(C[1], C[3]);
+        D[3] = RAX1(C[2], C[4]);
+        D[4] = RAX1(C[3], C[0]);
+
+        /* Theta application, Rho and Pi: B[y + 5((2x + 3y) % 5)] */
+        B[ 0] = XAR(A[ 0], D[0],  0);
+        B[10] = XAR(A[ 1], D[1], 63);
+        B[20] = XAR(A[ 2], D[2],  2);
+        B[ 5] = XAR(A[ 3], D[3], 36);
+        B[15] = XAR(A[ 4], D[4], 37);
+        B[16] = XAR(A[ 5], D[0], 28);
+        B[ 1] = XAR(A[ 6], D[1], 20);
+        B[11] = XAR(A[ 7], D[2], 58);
+        B[21] = XAR(A[ 8], D[3],  9);
+        B[ 6] = XAR(A[ 9], D[4], 44);
+        B[ 7] = XAR(A[10], D[0], 61);
+        B[17] = XAR(A[11], D[1], 54);
+        B[ 2] = XAR(A[12], D[2], 21);
+        B[12] = XAR(A[13], D[3], 39);
+        B[22] = XAR(A[14], D[4], 25);
+        B[23] = XAR(A[15], D[0], 23);
+        B[ 8] = XAR(A[16], D[1], 19);
+        B[18] = XAR(A[17], D[2], 49);
+        B[ 3] = XAR(A[18], D[3], 43);
+        B[13] = XAR(A[19], D[4], 56);
+        B[14] = XAR(A[20], D[0], 46);
+        B[24] = XAR(A[21], D[1], 62);
+        B[ 9] = XAR(A[22], D[2],  3);
+        B[19] = XAR(A[23], D[3],  8);
+        B[ 4] = XAR(A[24], D[4], 50);
+
+        /* Chi */
+        for (y = 0; y < 25; y += 5) {
+            A[y + 0] = BCAX(B[y + 0], B[y + 2], B[y + 1]);
+            A[y + 1] = BCAX(B[y + 1], B[y + 3], B[y + 2]);
+            A[y + 2] = BCAX(B[y + 2], B[y + 4], B[y + 3]);
+            A[y + 3] = BCAX(B[y + 3], B[y + 0], B[y + 4]);
+            A[y + 4] = BCAX(B[y + 4], B[y + 1], B[y + 0]);
+        }
+
+        /* Iota */
+        A[0] = veorq_u64(A[0], vdupq_n_u64(RC[round]));
+    }
+}
+
+void keccak_f1600_arm64(uint64_t st[25])
+{
+    kv       A[25];
+    uint32_t i;
+
+    for (i = 0; i < 25; i++) { A[i] = vdupq_n_u64(st[i]); }
+    keccak_rounds(A);
+    for (i = 0; i < 25; i++) { st[i] = vgetq_lane_u64(A[i], 0); }
+}
+
+void keccak_f1600_arm64_x2(uint64_t *st, size_t stride)
+{
+    kv       A[25];
+    uint32_t i;
+
+    for (i = 0; i < 25; i++) { A[i] = vld1q_u64(st + i * stride); }
+    keccak_rounds(A);
+    for (i = 0; i < 25; i++) { vst1q_u64(st + i * stride, A[i]); }
+}
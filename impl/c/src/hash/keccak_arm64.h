@@ -0,0 +1,32 @@
+/**
+ * keccak_arm64.h - Keccak-f[1600] on the ARMv8.2 SHA3 extension (aarch64)
+ *
+ * Built only for aarch64 with XMSS_KECCAK_ARM64 (CMake option
+ * XMSS_ARM64_SHA3).  shake_local.c checks keccak_arm64_sha3() at each
+ * permutation and otherwise runs the portable code, so one binary serves
+ * hosts with and without the extension.
+ */
+#ifndef XMSS_KECCAK_ARM64_H
+#define XMSS_KECCAK_ARM64_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 1 if the CPU has EOR3/RAX1/XAR/BCAX (HWCAP_SHA3), else 0.  Cached. */
+int keccak_arm64_available(void);
+
+/* 1 if the kernels are available and enabled: the dispatch test. */
+int keccak_arm64_sha3(void);
+
+/* Enable (default) or disable the kernels; see xmss_backend_set(). */
+void keccak_arm64_enable(int on);
+
+/* One state, held in the low half of each vector register. */
+void keccak_f1600_arm64(uint64_t st[25]);
+
+/* Two states at once, one per vector half: word i of state k (k = 0, 1)
+ * is st[i * stride + k], the layout of two adjacent keccak_f1600_lanes()
+ * lanes. */
+void keccak_f1600_arm64_x2(uint64_t *st, size_t stride);
+
+#endif /* XMSS_KECCAK_ARM64_H */
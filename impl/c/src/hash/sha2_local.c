@@ -11,6 +11,9 @@
 #include <string.h>
 #include <stdint.h>
 #include "sha2_local.h"
+#ifdef XMSS_USE_OPENSSL
+#include "hash_openssl.h"
+#endif
 
 /* ====================================================================
  * Common helpers
@@ -19,11 +22,13 @@
 #define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
 #define ROR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
 
+#ifndef XMSS_USE_OPENSSL
 static uint32_t be32(const uint8_t *p)
 {
     return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
          | ((uint32_t)p[2] << 8)  |  (uint32_t)p[3];
 }
+#endif
 
 static void store_be32(uint8_t *p, uint32_t x)
 {
@@ -31,6 +36,7 @@ static void store_be32(uint8_t *p, uint32_t x)
     p[2] = (uint8_t)(x >>  8); p[3] = (uint8_t)(x      );
 }
 
+#ifndef XMSS_USE_OPENSSL
 static uint64_t be64(const uint8_t *p)
 {
     return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48)
@@ -38,6 +44,7 @@ static uint64_t be64(const uint8_t *p)
          | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16)
          | ((uint64_t)p[6] <<  8) |  (uint64_t)p[7];
 }
+#endif
 
 static void store_be64(uint8_t *p, uint64_t x)
 {
@@ -75,6 +82,13 @@ static const uint32_t SHA256_IV[8] = {
     0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u
 };
 
+#ifdef XMSS_USE_OPENSSL
+/* libcrypto's block function (assembly / SHA-NI where available) */
+static void sha256_transform(uint32_t state[8], const uint8_t block[64])
+{
+    xmss_ossl_sha256_block(state, block);
+}
+#else
 static void sha256_transform(uint32_t state[8], const uint8_t block[64])
 {
     uint32_t W[64];
@@ -108,6 +122,7 @@ static void sha256_transform(uint32_t state[8], const uint8_t block[64])
     state[0] += a; state[1] += b; state[2] += c; state[3] += d;
     state[4] += e; state[5] += f; state[6] += g; state[7] += h;
 }
+#endif
 
 void sha256_ctx_init(sha256_ctx_t *ctx)
 {
@@ -123,6 +138,9 @@ void sha256_ctx_update(sha256_ctx_t *ctx, const uint8_t *in, size_t inlen)
 {
     size_t rem;
 
+    /* An empty message may arrive as in == NULL; never hand it to memcpy */
+    if (inlen == 0) { return; }
+
     ctx->count += (uint64_t)inlen * 8;
 
     if (ctx->buflen > 0) {
@@ -191,6 +209,69 @@ void sha256_local(uint8_t out[32], const uint8_t *in, size_t inlen)
     sha256_ctx_final(&ctx, out);
 }
 
+void sha256_midstate(uint32_t state[8], const uint8_t block[64])
+{
+    memcpy(state, SHA256_IV, sizeof(SHA256_IV));
+    sha256_transform(state, block);
+}
+
+void sha256_init_lanes(uint32_t state[8][XMSS_HASH_LANES])
+{
+    uint32_t j, l;
+    for (j = 0; j < 8; j++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            state[j][l] = SHA256_IV[j];
+        }
+    }
+}
+
+/* ====================================================================
+ * sha256_transform_lanes() - XMSS_HASH_LANES compressions in lockstep
+ *
+ * Same round structure as sha256_transform(), with every scalar
+ * replaced by a row of XMSS_HASH_LANES words.
+ * ==================================================================== */
+void sha256_transform_lanes(uint32_t state[8][XMSS_HASH_LANES],
+                            const uint32_t block[16][XMSS_HASH_LANES])
+{
+    uint32_t W[64][XMSS_HASH_LANES];
+    uint32_t v[8][XMSS_HASH_LANES];
+    uint32_t i, j, l;
+
+    memcpy(W, block, 16 * sizeof(W[0]));
+    for (i = 16; i < 64; i++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            uint32_t w15 = W[i-15][l], w2 = W[i-2][l];
+            uint32_t s0 = ROR32(w15, 7) ^ ROR32(w15, 18) ^ (w15 >> 3);
+            uint32_t s1 = ROR32(w2, 17) ^ ROR32(w2, 19)  ^ (w2  >> 10);
+            W[i][l] = W[i-16][l] + s0 + W[i-7][l] + s1;
+        }
+    }
+
+    memcpy(v, state, sizeof(v));
+
+    for (i = 0; i < 64; i++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            uint32_t a = v[0][l], b = v[1][l], c = v[2][l], d = v[3][l];
+            uint32_t e = v[4][l], f = v[5][l], g = v[6][l], h = v[7][l];
+            uint32_t S1  = ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25);
+            uint32_t ch  = (e & f) ^ (~e & g);
+            uint32_t T1  = h + S1 + ch + K256[i] + W[i][l];
+            uint32_t S0  = ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+
+            v[7][l] = g; v[6][l] = f; v[5][l] = e; v[4][l] = d + T1;
+            v[3][l] = c; v[2][l] = b; v[1][l] = a; v[0][l] = T1 + S0 + maj;
+        }
+    }
+
+    for (j = 0; j < 8; j++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            state[j][l] += v[j][l];
+        }
+    }
+}
+
 /* ====================================================================
  * SHA-512
  * ==================================================================== */
@@ -245,6 +326,12 @@ static const uint64_t SHA512_IV[8] = {
     0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
 };
 
+#ifdef XMSS_USE_OPENSSL
+static void sha512_transform(uint64_t state[8], const uint8_t block[128])
+{
+    xmss_ossl_sha512_block(state, block);
+}
+#else
 static void sha512_transform(uint64_t state[8], const uint8_t block[128])
 {
     uint64_t W[80];
@@ -278,6 +365,59 @@ static void sha512_transform(uint64_t state[8], const uint8_t block[128])
     state[0] += a; state[1] += b; state[2] += c; state[3] += d;
     state[4] += e; state[5] += f; state[6] += g; state[7] += h;
 }
+#endif
+
+void sha512_init_lanes(uint64_t state[8][XMSS_HASH_LANES])
+{
+    uint32_t j, l;
+    for (j = 0; j < 8; j++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            state[j][l] = SHA512_IV[j];
+        }
+    }
+}
+
+/* sha512_transform() on XMSS_HASH_LANES word-interleaved states */
+void sha512_transform_lanes(uint64_t state[8][XMSS_HASH_LANES],
+                            const uint64_t block[16][XMSS_HASH_LANES])
+{
+    uint64_t W[80][XMSS_HASH_LANES];
+    uint64_t v[8][XMSS_HASH_LANES];
+    uint32_t i, j, l;
+
+    memcpy(W, block, 16 * sizeof(W[0]));
+    for (i = 16; i < 80; i++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            uint64_t w15 = W[i-15][l], w2 = W[i-2][l];
+            uint64_t s0 = ROR64(w15, 1) ^ ROR64(w15, 8) ^ (w15 >> 7);
+            uint64_t s1 = ROR64(w2, 19) ^ ROR64(w2, 61) ^ (w2  >> 6);
+            W[i][l] = W[i-16][l] + s0 + W[i-7][l] + s1;
+        }
+    }
+
+    memcpy(v, state, sizeof(v));
+
+    for (i = 0; i < 80; i++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            uint64_t a = v[0][l], b = v[1][l], c = v[2][l], d = v[3][l];
+            uint64_t e = v[4][l], f = v[5][l], g = v[6][l], h = v[7][l];
+            uint64_t S1  = ROR64(e, 14) ^ ROR64(e, 18) ^ ROR64(e, 41);
+            uint64_t ch  = (e & f) ^ (~e & g);
+            uint64_t T1  = h + S1 + ch + K512[i] + W[i][l];
+            uint64_t S0  = ROR64(a, 28) ^ ROR64(a, 34) ^ ROR64(a, 39);
+            uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+
+            v[7][l] = g; v[6][l] = f; v[5][l] = e; v[4][l] = d + T1;
+            v[3][l] = c; v[2][l] = b; v[1][l] = a; v[0][l] = T1 + S0 + maj;
+        }
+    }
+
+    for (j = 0; j < 8; j++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            state[j][l] += v[j][l];
+        }
+    }
+}
 
 void sha512_ctx_init(sha512_ctx_t *ctx)
 {
@@ -294,6 +434,9 @@ void sha512_ctx_update(sha512_ctx_t *ctx, const uint8_t *in, size_t inlen)
     size_t rem;
     uint64_t bit_add = (uint64_t)inlen * 8;
 
+    /* An empty message may arrive as in == NULL; never hand it to memcpy */
+    if (inlen == 0) { return; }
+
     /* 128-bit addition for bit count */
     ctx->count[1] += bit_add;
     if (ctx->count[1] < bit_add) { ctx->count[0]++; }
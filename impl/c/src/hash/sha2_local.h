@@ -12,6 +12,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "../../include/xmss/params.h"
 
 /* One-shot SHA-256: produces 32 bytes */
 void sha256_local(uint8_t out[32], const uint8_t *in, size_t inlen);
@@ -19,6 +20,26 @@ void sha256_local(uint8_t out[32], const uint8_t *in, size_t inlen);
 /* One-shot SHA-512: produces 64 bytes */
 void sha512_local(uint8_t out[64], const uint8_t *in, size_t inlen);
 
+/*
+ * Fixed-shape SHA-256 building blocks for the multi-lane F/H/PRF path.
+ *
+ * sha256_midstate():        state = compress(IV, block) for one 64-byte block.
+ * sha256_init_lanes():      IV broadcast to every lane.
+ * sha256_transform_lanes(): XMSS_HASH_LANES independent compressions with
+ *   word-interleaved state and message: word j of lane l is at [j][l].
+ *   The per-lane inner loops have no cross-lane dependencies and are
+ *   written to be auto-vectorised.
+ */
+void sha256_midstate(uint32_t state[8], const uint8_t block[64]);
+void sha256_init_lanes(uint32_t state[8][XMSS_HASH_LANES]);
+void sha256_transform_lanes(uint32_t state[8][XMSS_HASH_LANES],
+                            const uint32_t block[16][XMSS_HASH_LANES]);
+
+/* SHA-512 counterparts (64-bit words), used by the multi-buffer H_msg. */
+void sha512_init_lanes(uint64_t state[8][XMSS_HASH_LANES]);
+void sha512_transform_lanes(uint64_t state[8][XMSS_HASH_LANES],
+                            const uint64_t block[16][XMSS_HASH_LANES]);
+
 /*
  * Incremental SHA-256 for H_msg (arbitrary-length messages).
  * State is entirely on the stack; no malloc.
@@ -13,6 +13,12 @@
 #include <string.h>
 #include <stdint.h>
 #include "shake_local.h"
+#ifdef XMSS_USE_OPENSSL
+#include "hash_openssl.h"
+#endif
+#ifdef XMSS_KECCAK_ARM64
+#include "keccak_arm64.h"
+#endif
 
 /* ====================================================================
  * Keccak-f[1600] permutation
@@ -45,7 +51,7 @@ static const uint32_t KECCAK_PI[24] = {
     15, 23, 19, 13, 12,  2, 20, 14, 22,  9,  6,  1
 };
 
-static void keccak_f1600(uint64_t st[25])
+static void keccak_f1600_generic(uint64_t st[25])
 {
     int round;
     uint64_t tmp, C[5], D[5];
@@ -89,6 +95,93 @@ static void keccak_f1600(uint64_t st[25])
     }
 }
 
+static void keccak_f1600(uint64_t st[25])
+{
+#ifdef XMSS_KECCAK_ARM64
+    /* JASMIN: replace dispatch with direct call */
+    if (keccak_arm64_sha3()) {
+        keccak_f1600_arm64(st);
+        return;
+    }
+#endif
+    keccak_f1600_generic(st);
+}
+
+/* keccak_f1600() with every state word widened to a row of lanes */
+void keccak_f1600_lanes(uint64_t st[25][XMSS_HASH_LANES])
+{
+    int round;
+    uint64_t C[5][XMSS_HASH_LANES], D[5][XMSS_HASH_LANES];
+    uint64_t cur[XMSS_HASH_LANES], tmp[XMSS_HASH_LANES];
+    uint64_t t[5][XMSS_HASH_LANES];
+    uint32_t x, y, l;
+
+#ifdef XMSS_KECCAK_ARM64
+    /* Lanes two at a time, one per NEON vector half; an odd last lane
+     * goes through the single-state kernel. */
+    if (keccak_arm64_sha3()) {
+        for (l = 0; l + 1 < XMSS_HASH_LANES; l += 2) {
+            keccak_f1600_arm64_x2(&st[0][l], XMSS_HASH_LANES);
+        }
+        if (l < XMSS_HASH_LANES) {
+            uint64_t one[25];
+            for (x = 0; x < 25; x++) { one[x] = st[x][l]; }
+            keccak_f1600_arm64(one);
+            for (x = 0; x < 25; x++) { st[x][l] = one[x]; }
+        }
+        return;
+    }
+#endif
+
+    for (round = 0; round < 24; round++) {
+        /* Theta */
+        for (x = 0; x < 5; x++) {
+            for (l = 0; l < XMSS_HASH_LANES; l++) {
+                C[x][l] = st[x][l] ^ st[x+5][l] ^ st[x+10][l] ^
+                          st[x+15][l] ^ st[x+20][l];
+            }
+        }
+        for (x = 0; x < 5; x++) {
+            for (l = 0; l < XMSS_HASH_LANES; l++) {
+                D[x][l] = C[(x+4)%5][l] ^ ROL64(C[(x+1)%5][l], 1);
+            }
+        }
+        for (y = 0; y < 5; y++) {
+            for (x = 0; x < 5; x++) {
+                for (l = 0; l < XMSS_HASH_LANES; l++) {
+                    st[y*5+x][l] ^= D[x][l];
+                }
+            }
+        }
+
+        /* Rho and Pi */
+        memcpy(cur, st[1], sizeof(cur));
+        for (x = 0; x < 24; x++) {
+            uint32_t j = KECCAK_PI[x];
+            memcpy(tmp, st[j], sizeof(tmp));
+            for (l = 0; l < XMSS_HASH_LANES; l++) {
+                st[j][l] = ROL64(cur[l], KECCAK_RHO[x]);
+            }
+            memcpy(cur, tmp, sizeof(cur));
+        }
+
+        /* Chi */
+        for (y = 0; y < 5; y++) {
+            memcpy(t, st[y*5], sizeof(t));
+            for (x = 0; x < 5; x++) {
+                for (l = 0; l < XMSS_HASH_LANES; l++) {
+                    st[y*5+x][l] = t[x][l] ^ (~t[(x+1)%5][l] & t[(x+2)%5][l]);
+                }
+            }
+        }
+
+        /* Iota */
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            st[0][l] ^= KECCAK_RC[round];
+        }
+    }
+}
+
 /* XOR rate bytes of input into state (little-endian 64-bit lanes) */
 static void keccak_absorb_block(uint64_t st[25], const uint8_t *block, uint32_t rate)
 {
@@ -125,6 +218,9 @@ static void shake_absorb(uint64_t st[25], uint8_t *buf, uint32_t *buflen,
 {
     size_t rem;
 
+    /* An empty message may arrive as in == NULL; never hand it to memcpy */
+    if (inlen == 0) { return; }
+
     if (*buflen > 0) {
         rem = rate - *buflen;
         if (inlen < rem) {
@@ -174,6 +270,11 @@ static void shake_oneshot(uint8_t *out, size_t outlen,
     uint32_t buflen = 0;
     uint8_t  out_buf[168];
 
+#ifdef XMSS_USE_OPENSSL
+    /* libcrypto first; the portable sponge below is the fallback */
+    if (xmss_ossl_shake(out, outlen, in, inlen, rate) == 0) { return; }
+#endif
+
     memset(st, 0, sizeof(st));
     memset(buf, 0, sizeof(buf));
     memset(out_buf, 0, sizeof(out_buf));
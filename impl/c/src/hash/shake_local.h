@@ -14,6 +14,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "../../include/xmss/params.h"
 
 /* One-shot SHAKE-128: output outlen bytes */
 void shake128_local(uint8_t *out, size_t outlen, const uint8_t *in, size_t inlen);
@@ -56,4 +57,10 @@ void shake256_ctx_absorb (shake256_ctx_t *ctx, const uint8_t *in, size_t inlen);
 void shake256_ctx_finalize(shake256_ctx_t *ctx);
 void shake256_ctx_squeeze(shake256_ctx_t *ctx, uint8_t *out, size_t outlen);
 
+/*
+ * Keccak-f[1600] on XMSS_HASH_LANES independent states, lane word i of
+ * lane l at st[i][l].  Used by the multi-buffer H_msg.
+ */
+void keccak_f1600_lanes(uint64_t st[25][XMSS_HASH_LANES]);
+
 #endif /* XMSS_SHAKE_LOCAL_H */
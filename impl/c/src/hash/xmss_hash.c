@@ -3,6 +3,7 @@
  *
  * This is the SOLE location of hash backend dispatch.
  * Implements F, H, H_msg, PRF, PRF_keygen for SHA-2 and SHAKE backends.
+ * Also the LMS / LM-OTS hashes (RFC 8554, SHA-256 only) used by hss.c.
  *
  * All backends (SHA-2 and SHAKE) use the same thash construction for F and H:
  *   key = PRF(PUB_SEED, ADRS[key_and_mask=0])
@@ -23,6 +24,10 @@
 #include "../address.h"
 #include "../../include/xmss/params.h"
 #include "../../include/xmss/types.h"
+#include "../../include/xmss/tune.h"
+#ifdef XMSS_KECCAK_ARM64
+#include "keccak_arm64.h"
+#endif
 
 /* Domain constants (RFC 8391 §5.1) */
 #define DOM_F         0x00U
@@ -31,6 +36,13 @@
 #define DOM_PRF       0x03U
 #define DOM_PRF_KEYGEN 0x04U
 
+/* RFC 8554 §4.3/§5.3 domain separators */
+#define LMS_D_PBLC    0x8080U
+#define LMS_D_MESG    0x8181U
+#define LMS_D_LEAF    0x8282U
+#define LMS_D_INTR    0x8383U
+#define LMS_I_BYTES   16U
+
 /* ====================================================================
  * core_hash_local() - Dispatch to SHA-256/SHA-512/SHAKE-128/SHAKE-256
  *
@@ -117,6 +129,58 @@ int xmss_F(const xmss_params *p, uint8_t *out,
     return 0;
 }
 
+/* ====================================================================
+ * F_chain - steps applications of F along one WOTS+ chain (Alg 2)
+ *
+ * Hash address start, start+1, ... capped at w-1; on return adrs holds
+ * the last hash address and key_and_mask 0, as after the step loop.
+ * The step loop lives here rather than in wots.c so a .jazz port can
+ * take whole chains; every build runs this C loop.
+ * ==================================================================== */
+
+int xmss_F_chain(const xmss_params *p, uint8_t *out, const uint8_t *in,
+                 uint32_t start, uint32_t steps,
+                 const uint8_t *seed, xmss_adrs_t *adrs)
+{
+    uint8_t  tmp[XMSS_MAX_N];
+    uint32_t end = start + steps;
+    uint32_t i;
+
+    /* J5: loop bound = steps <= w-1 <= 255 */
+    if (end > p->w) { end = p->w; }
+
+    memcpy(tmp, in, p->n);
+    for (i = start; i < end; i++) {
+        xmss_adrs_set_hash(adrs, i);
+        xmss_adrs_set_key_and_mask(adrs, 0);
+        xmss_F(p, tmp, seed, adrs, tmp);
+    }
+    memcpy(out, tmp, p->n);
+    return 0;
+}
+
+/* ====================================================================
+ * lms_intr() - LMS interior node, xmss_H() for XMSS_FUNC_LMS_SHA256
+ *
+ * The address carries the children's height and the parent's index in
+ * that row, as for XMSS; RFC 8554 numbers the parent r = 2^(H-height-1)
+ * + index (root = 1).
+ * ==================================================================== */
+static void lms_intr(const xmss_params *p, uint8_t *out, const uint8_t *I,
+                     const xmss_adrs_t *adrs,
+                     const uint8_t *in_l, const uint8_t *in_r)
+{
+    uint8_t  buf[LMS_I_BYTES + 4 + 2 + 2 * 32];
+    uint32_t r = ((uint32_t)1 << (p->tree_height - adrs->w[5] - 1)) + adrs->w[6];
+
+    memcpy(buf, I, LMS_I_BYTES);
+    ull_to_bytes(buf + 16, 4, r);
+    ull_to_bytes(buf + 20, 2, LMS_D_INTR);
+    memcpy(buf + 22, in_l, 32);
+    memcpy(buf + 54, in_r, 32);
+    sha256_local(out, buf, sizeof(buf));
+}
+
 /* ====================================================================
  * H - Tree hash function
  *
@@ -137,6 +201,11 @@ int xmss_H(const xmss_params *p, uint8_t *out,
     uint32_t i;
     xmss_adrs_t a;
 
+    if (p->func == XMSS_FUNC_LMS_SHA256) {
+        lms_intr(p, out, key, adrs, in_l, in_r);
+        return 0;
+    }
+
     /* Generate key: PRF(PUB_SEED, ADRS[key_and_mask=0]) */
     a = *adrs;
     xmss_adrs_set_key_and_mask(&a, 0);
@@ -304,3 +373,808 @@ int xmss_PRF_idx(const xmss_params *p, uint8_t *out,
     core_hash_local(p, out, buf, off);
     return 0;
 }
+
+/* ====================================================================
+ * Multi-lane F / H / PRF_keygen
+ *
+ * SHA-256 with n=32 runs natively on the interleaved layout: every
+ * message block is built from lane words and fed to
+ * sha256_transform_lanes(); the hash state rows are the output node
+ * words, so no byte conversion happens between calls.  The blocks
+ * toByte(3, n) || SEED (PRF) and toByte(4, n) || SK_SEED (PRF_keygen)
+ * are identical for every lane and are compressed once per call.
+ *
+ * Every other parameter set falls back to the scalar functions lane by
+ * lane; the layout (and the callers) stay the same.
+ * ==================================================================== */
+
+#define L XMSS_HASH_LANES
+
+static uint32_t load_be32(const uint8_t *b)
+{
+    return (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 |
+           (uint32_t)b[2] << 8  | (uint32_t)b[3];
+}
+
+void xmss_lanes_load(const xmss_params *p, xmss_lanes_t *dst,
+                     uint32_t lane, const uint8_t *in)
+{
+    uint32_t j;
+    for (j = 0; j < p->n / 4; j++) {
+        dst->w[j][lane] = load_be32(in + 4 * j);
+    }
+}
+
+void xmss_lanes_store(const xmss_params *p, uint8_t *out,
+                      const xmss_lanes_t *src, uint32_t lane)
+{
+    uint32_t j;
+    for (j = 0; j < p->n / 4; j++) {
+        uint32_t x = src->w[j][lane];
+        out[4 * j + 0] = (uint8_t)(x >> 24);
+        out[4 * j + 1] = (uint8_t)(x >> 16);
+        out[4 * j + 2] = (uint8_t)(x >>  8);
+        out[4 * j + 3] = (uint8_t)(x      );
+    }
+}
+
+/* state = mid on every lane */
+static void broadcast8(uint32_t state[8][L], const uint32_t mid[8])
+{
+    uint32_t j, l;
+    for (j = 0; j < 8; j++) {
+        for (l = 0; l < L; l++) {
+            state[j][l] = mid[j];
+        }
+    }
+}
+
+/* Words 8..15 of the final block of a message ending 32 bytes into it */
+static void pad_tail(uint32_t blk[16][L], uint32_t bitlen)
+{
+    uint32_t j, l;
+    for (l = 0; l < L; l++) {
+        blk[8][l] = 0x80000000u;
+        for (j = 9; j < 15; j++) {
+            blk[j][l] = 0;
+        }
+        blk[15][l] = bitlen;
+    }
+}
+
+/* Padding-only block for a message of bitlen bits ending on a boundary */
+static void pad_block(uint32_t blk[16][L], uint32_t bitlen)
+{
+    uint32_t j, l;
+    for (l = 0; l < L; l++) {
+        blk[0][l] = 0x80000000u;
+        for (j = 1; j < 15; j++) {
+            blk[j][l] = 0;
+        }
+        blk[15][l] = bitlen;
+    }
+}
+
+/* Rows 0..7 of blk = ADRS of each lane with key_and_mask = km */
+static void adrs_rows(uint32_t rows[8][L], const xmss_adrs_t *adrs, uint32_t km)
+{
+    uint32_t j, l;
+    xmss_adrs_t a;
+    for (l = 0; l < L; l++) {
+        a = adrs[l];
+        xmss_adrs_set_key_and_mask(&a, km);
+        for (j = 0; j < 8; j++) {
+            rows[j][l] = a.w[j];
+        }
+    }
+}
+
+/* midstate of toByte(dom, 32) || key */
+static void sha256_domain_midstate(uint32_t mid[8], uint32_t dom, const uint8_t *key)
+{
+    uint8_t blk[64];
+    memset(blk, 0, 31);
+    blk[31] = (uint8_t)dom;
+    memcpy(blk + 32, key, 32);
+    sha256_midstate(mid, blk);
+}
+
+/* PRF(SEED, ADRS[key_and_mask=km]) per lane, from the shared midstate */
+static void sha256_prf_lanes(uint32_t out[8][L], const uint32_t mid[8],
+                             const xmss_adrs_t *adrs, uint32_t km)
+{
+    uint32_t blk[16][L];
+
+    adrs_rows(blk, adrs, km);
+    pad_tail(blk, 8 * (32 + 32 + 32));
+    broadcast8(out, mid);
+    sha256_transform_lanes(out, (const uint32_t (*)[L])blk);
+}
+
+/* First block toByte(dom, 32) || key[lane] for the outer F/H hash */
+static void sha256_outer_first(uint32_t state[8][L], uint32_t dom,
+                               const uint32_t key[8][L])
+{
+    uint32_t blk[16][L];
+    uint32_t j, l;
+
+    for (l = 0; l < L; l++) {
+        for (j = 0; j < 7; j++) {
+            blk[j][l] = 0;
+        }
+        blk[7][l] = dom;
+        for (j = 0; j < 8; j++) {
+            blk[8 + j][l] = key[j][l];
+        }
+    }
+    sha256_init_lanes(state);
+    sha256_transform_lanes(state, (const uint32_t (*)[L])blk);
+}
+
+static void sha256_F_lanes(xmss_lanes_t *out, const uint8_t *key,
+                           const xmss_adrs_t *adrs, const xmss_lanes_t *in)
+{
+    uint32_t mid[8];
+    uint32_t k[8][L], bm[8][L], st[8][L];
+    uint32_t blk[16][L];
+    uint32_t j, l;
+
+    sha256_domain_midstate(mid, DOM_PRF, key);
+    sha256_prf_lanes(k, mid, adrs, 0);
+    sha256_prf_lanes(bm, mid, adrs, 1);
+
+    sha256_outer_first(st, DOM_F, (const uint32_t (*)[L])k);
+    for (j = 0; j < 8; j++) {
+        for (l = 0; l < L; l++) {
+            blk[j][l] = in->w[j][l] ^ bm[j][l];
+        }
+    }
+    pad_tail(blk, 8 * (32 + 32 + 32));
+    sha256_transform_lanes(st, (const uint32_t (*)[L])blk);
+
+    memcpy(out->w, st, sizeof(st));
+}
+
+static void sha256_H_lanes(xmss_lanes_t *out, const uint8_t *key,
+                           const xmss_adrs_t *adrs,
+                           const xmss_lanes_t *in_l, const xmss_lanes_t *in_r)
+{
+    uint32_t mid[8];
+    uint32_t k[8][L], bm_l[8][L], bm_r[8][L], st[8][L];
+    uint32_t blk[16][L];
+    uint32_t j, l;
+
+    sha256_domain_midstate(mid, DOM_PRF, key);
+    sha256_prf_lanes(k, mid, adrs, 0);
+    sha256_prf_lanes(bm_l, mid, adrs, 1);
+    sha256_prf_lanes(bm_r, mid, adrs, 2);
+
+    sha256_outer_first(st, DOM_H, (const uint32_t (*)[L])k);
+    for (j = 0; j < 8; j++) {
+        for (l = 0; l < L; l++) {
+            blk[j][l]     = in_l->w[j][l] ^ bm_l[j][l];
+            blk[8 + j][l] = in_r->w[j][l] ^ bm_r[j][l];
+        }
+    }
+    sha256_transform_lanes(st, (const uint32_t (*)[L])blk);
+
+    pad_block(blk, 8 * (32 + 32 + 64));
+    sha256_transform_lanes(st, (const uint32_t (*)[L])blk);
+
+    memcpy(out->w, st, sizeof(st));
+}
+
+static void sha256_PRF_keygen_lanes(xmss_lanes_t *out,
+                                    const uint8_t *sk_seed,
+                                    const uint8_t *pub_seed,
+                                    const xmss_adrs_t *adrs)
+{
+    uint32_t mid[8], st[8][L];
+    uint32_t blk[16][L];
+    uint32_t j, l;
+
+    sha256_domain_midstate(mid, DOM_PRF_KEYGEN, sk_seed);
+    broadcast8(st, mid);
+
+    for (j = 0; j < 8; j++) {
+        uint32_t s = load_be32(pub_seed + 4 * j);
+        for (l = 0; l < L; l++) {
+            blk[j][l] = s;
+        }
+    }
+    for (l = 0; l < L; l++) {
+        for (j = 0; j < 8; j++) {
+            blk[8 + j][l] = adrs[l].w[j];
+        }
+    }
+    sha256_transform_lanes(st, (const uint32_t (*)[L])blk);
+
+    pad_block(blk, 8 * (32 + 32 + 32 + 32));
+    sha256_transform_lanes(st, (const uint32_t (*)[L])blk);
+
+    memcpy(out->w, st, sizeof(st));
+    xmss_memzero(mid, sizeof(mid));
+    xmss_memzero(st, sizeof(st));
+}
+
+static int lanes_native(const xmss_params *p)
+{
+    return p->func == XMSS_FUNC_SHA2 && p->n == 32;
+}
+
+int xmss_F_lanes(const xmss_params *p, xmss_lanes_t *out,
+                 const uint8_t *key, const xmss_adrs_t *adrs,
+                 const xmss_lanes_t *in)
+{
+    uint8_t  buf[XMSS_MAX_N];
+    uint32_t l;
+
+    /* JASMIN: replace dispatch with direct call */
+    if (lanes_native(p)) {
+        sha256_F_lanes(out, key, adrs, in);
+        return 0;
+    }
+    for (l = 0; l < L; l++) {
+        xmss_lanes_store(p, buf, in, l);
+        xmss_F(p, buf, key, &adrs[l], buf);
+        xmss_lanes_load(p, out, l, buf);
+    }
+    return 0;
+}
+
+int xmss_H_lanes(const xmss_params *p, xmss_lanes_t *out,
+                 const uint8_t *key, const xmss_adrs_t *adrs,
+                 const xmss_lanes_t *in_l, const xmss_lanes_t *in_r)
+{
+    uint8_t  bl[XMSS_MAX_N], br[XMSS_MAX_N];
+    uint32_t l;
+
+    /* JASMIN: replace dispatch with direct call */
+    if (lanes_native(p)) {
+        sha256_H_lanes(out, key, adrs, in_l, in_r);
+        return 0;
+    }
+    for (l = 0; l < L; l++) {
+        xmss_lanes_store(p, bl, in_l, l);
+        xmss_lanes_store(p, br, in_r, l);
+        xmss_H(p, bl, key, &adrs[l], bl, br);
+        xmss_lanes_load(p, out, l, bl);
+    }
+    return 0;
+}
+
+int xmss_PRF_keygen_lanes(const xmss_params *p, xmss_lanes_t *out,
+                          const uint8_t *sk_seed, const uint8_t *pub_seed,
+                          const xmss_adrs_t *adrs)
+{
+    uint8_t  buf[XMSS_MAX_N];
+    uint32_t l;
+
+    /* JASMIN: replace dispatch with direct call */
+    if (lanes_native(p)) {
+        sha256_PRF_keygen_lanes(out, sk_seed, pub_seed, adrs);
+        return 0;
+    }
+    for (l = 0; l < L; l++) {
+        xmss_PRF_keygen(p, buf, sk_seed, pub_seed, &adrs[l]);
+        xmss_lanes_load(p, out, l, buf);
+    }
+    xmss_memzero(buf, sizeof(buf));
+    return 0;
+}
+
+#undef L
+
+/* ====================================================================
+ * LMS / LM-OTS (RFC 8554)
+ *
+ * The PRF and chain hashes are both I || u32str(q) || u16str(i) ||
+ * u8str(j) || 32 bytes = 55 bytes, i.e. exactly one SHA-256 block.  In
+ * the lane kernel the 32-byte value starts three bytes into word 5, so
+ * its interleaved words are shifted into place rather than copied.
+ * ==================================================================== */
+
+#define L XMSS_HASH_LANES
+
+/* One-block prefix hash: I || u32str(q) || u16str(i) || u8str(j) || v */
+static void lmots_block(uint8_t *out, const uint8_t *I, uint32_t q,
+                        uint32_t i, uint32_t j, const uint8_t *v)
+{
+    uint8_t buf[LMS_I_BYTES + 4 + 2 + 1 + 32];
+
+    memcpy(buf, I, LMS_I_BYTES);
+    ull_to_bytes(buf + 16, 4, q);
+    ull_to_bytes(buf + 20, 2, i);
+    buf[22] = (uint8_t)j;
+    memcpy(buf + 23, v, 32);
+    sha256_local(out, buf, sizeof(buf));
+}
+
+int xmss_lmots_prf(const xmss_params *p, uint8_t *out,
+                   const uint8_t *I, uint32_t q, uint32_t i,
+                   const uint8_t *seed)
+{
+    (void)p;
+    lmots_block(out, I, q, i, 0xff, seed);
+    return 0;
+}
+
+int xmss_lmots_chain(const xmss_params *p, uint8_t *out, const uint8_t *in,
+                     const uint8_t *I, uint32_t q, uint32_t i,
+                     uint32_t start, uint32_t steps)
+{
+    uint32_t j;
+
+    (void)p;
+    if (out != in) {
+        memcpy(out, in, 32);
+    }
+    for (j = start; j < start + steps; j++) {
+        lmots_block(out, I, q, i, j, out);
+    }
+    return 0;
+}
+
+/* Lane l: one block I || q[l] || i || j || v[l], v word-interleaved */
+static void lmots_block_lanes(uint32_t st[8][L], const uint32_t Iw[4],
+                              const uint32_t *q, uint32_t i, uint32_t j,
+                              const uint32_t v[8][L])
+{
+    uint32_t blk[16][L];
+    uint32_t m, l;
+
+    for (l = 0; l < L; l++) {
+        for (m = 0; m < 4; m++) {
+            blk[m][l] = Iw[m];
+        }
+        blk[4][l] = q[l];
+        blk[5][l] = i << 16 | j << 8 | v[0][l] >> 24;
+        for (m = 0; m < 7; m++) {
+            blk[6 + m][l] = v[m][l] << 8 | v[m + 1][l] >> 24;
+        }
+        blk[13][l] = v[7][l] << 8 | 0x80u;
+        blk[14][l] = 0;
+        blk[15][l] = 8 * 55;
+    }
+    sha256_init_lanes(st);
+    sha256_transform_lanes(st, (const uint32_t (*)[L])blk);
+}
+
+int xmss_lmots_prf_lanes(const xmss_params *p, xmss_lanes_t *out,
+                         const uint8_t *I, const uint32_t *q, uint32_t i,
+                         const uint8_t *seed)
+{
+    uint32_t Iw[4], v[8][L], st[8][L];
+    uint32_t m;
+
+    (void)p;
+    for (m = 0; m < 4; m++) {
+        Iw[m] = load_be32(I + 4 * m);
+    }
+    for (m = 0; m < 8; m++) {
+        uint32_t s = load_be32(seed + 4 * m);
+        uint32_t l;
+        for (l = 0; l < L; l++) {
+            v[m][l] = s;
+        }
+    }
+    lmots_block_lanes(st, Iw, q, i, 0xff, (const uint32_t (*)[L])v);
+    memcpy(out->w, st, sizeof(st));
+    xmss_memzero(v, sizeof(v));
+    xmss_memzero(st, sizeof(st));
+    return 0;
+}
+
+int xmss_lmots_chain_lanes(const xmss_params *p, xmss_lanes_t *out,
+                           const xmss_lanes_t *in, const uint8_t *I,
+                           const uint32_t *q, uint32_t i,
+                           uint32_t start, uint32_t steps)
+{
+    uint32_t Iw[4], st[8][L];
+    uint32_t j, m;
+
+    (void)p;
+    for (m = 0; m < 4; m++) {
+        Iw[m] = load_be32(I + 4 * m);
+    }
+    memcpy(st, in->w, sizeof(st));
+    for (j = start; j < start + steps; j++) {
+        lmots_block_lanes(st, Iw, q, i, j, (const uint32_t (*)[L])st);
+    }
+    memcpy(out->w, st, sizeof(st));
+    return 0;
+}
+
+int xmss_lmots_pk(const xmss_params *p, uint8_t *out,
+                  const uint8_t *I, uint32_t q, const uint8_t *y)
+{
+    sha256_ctx_t ctx;
+    uint8_t      pre[LMS_I_BYTES + 4 + 2];
+
+    memcpy(pre, I, LMS_I_BYTES);
+    ull_to_bytes(pre + 16, 4, q);
+    ull_to_bytes(pre + 20, 2, LMS_D_PBLC);
+    sha256_ctx_init(&ctx);
+    sha256_ctx_update(&ctx, pre, sizeof(pre));
+    sha256_ctx_update(&ctx, y, (size_t)p->len * 32);
+    sha256_ctx_final(&ctx, out);
+    return 0;
+}
+
+int xmss_lmots_msg(const xmss_params *p, uint8_t *out,
+                   const uint8_t *I, uint32_t q, const uint8_t *C,
+                   const uint8_t *msg, size_t msglen)
+{
+    sha256_ctx_t ctx;
+    uint8_t      pre[LMS_I_BYTES + 4 + 2];
+
+    (void)p;
+    memcpy(pre, I, LMS_I_BYTES);
+    ull_to_bytes(pre + 16, 4, q);
+    ull_to_bytes(pre + 20, 2, LMS_D_MESG);
+    sha256_ctx_init(&ctx);
+    sha256_ctx_update(&ctx, pre, sizeof(pre));
+    sha256_ctx_update(&ctx, C, 32);
+    sha256_ctx_update(&ctx, msg, msglen);
+    sha256_ctx_final(&ctx, out);
+    return 0;
+}
+
+int xmss_lms_leaf(const xmss_params *p, uint8_t *out,
+                  const uint8_t *I, uint32_t r, const uint8_t *K)
+{
+    uint8_t buf[LMS_I_BYTES + 4 + 2 + 32];
+
+    (void)p;
+    memcpy(buf, I, LMS_I_BYTES);
+    ull_to_bytes(buf + 16, 4, r);
+    ull_to_bytes(buf + 20, 2, LMS_D_LEAF);
+    memcpy(buf + 22, K, 32);
+    sha256_local(out, buf, sizeof(buf));
+    return 0;
+}
+
+int xmss_hss_derive(const xmss_params *p, uint8_t *out,
+                    const uint8_t *key, const uint8_t *I,
+                    uint32_t level, uint64_t tree, uint32_t tag)
+{
+    uint8_t buf[LMS_I_BYTES + 4 + 8 + 1 + 32];
+
+    (void)p;
+    memcpy(buf, I, LMS_I_BYTES);
+    ull_to_bytes(buf + 16, 4, level);
+    ull_to_bytes(buf + 20, 8, tree);
+    buf[28] = (uint8_t)tag;
+    memcpy(buf + 29, key, 32);
+    sha256_local(out, buf, sizeof(buf));
+    xmss_memzero(buf, sizeof(buf));
+    return 0;
+}
+
+#undef L
+
+/* ====================================================================
+ * xmss_H_msg_multi() - multi-buffer H_msg with lane refill
+ *
+ * Every lane streams toByte(2, n) || r || root || toByte(idx, n) || M
+ * followed by the hash's own padding, one rate-sized block per round.
+ * All lanes are compressed together (idle lanes hash a zero block);
+ * when a lane emits its final block its digest is written out and the
+ * lane restarts from the IV on the next pending message.
+ * ==================================================================== */
+
+#define L XMSS_HASH_LANES
+
+#define HMSG_SHA256   0U
+#define HMSG_SHA512   1U
+#define HMSG_SHAKE    2U
+#define HMSG_MAX_RATE 168U            /* SHAKE-128 rate; >= SHA-512 block */
+#define HMSG_IDLE     0xFFFFFFFFu
+
+typedef struct {
+    uint8_t        pre[4 * XMSS_MAX_N];
+    uint32_t       prelen;
+    const uint8_t *msg;
+    uint64_t       total;             /* prelen + msglen */
+    uint64_t       pos;               /* bytes of pre || msg emitted */
+    int            padded;            /* SHA-2 0x80 byte emitted */
+} hmsg_stream;
+
+typedef struct {
+    uint32_t kind;
+    uint32_t rate;                    /* block size in bytes */
+    uint32_t lenbytes;                /* SHA-2 length field; 0 for SHAKE */
+    uint32_t s256[8][L];
+    uint64_t s512[8][L];
+    uint64_t keccak[25][L];
+    uint32_t iv256[8][L];
+    uint64_t iv512[8][L];
+} hmsg_engine;
+
+static void hmsg_stream_init(const xmss_params *p, hmsg_stream *s,
+                             const xmss_hmsg_input *in)
+{
+    uint32_t n = p->n;
+
+    memset(s->pre, 0, n - 1);
+    s->pre[n - 1] = DOM_H_MSG;
+    memcpy(s->pre + n, in->r, n);
+    memcpy(s->pre + 2 * n, in->root, n);
+    ull_to_bytes(s->pre + 3 * n, n, in->idx);
+    s->prelen = 4 * n;
+    s->msg    = in->msg;
+    s->total  = (uint64_t)s->prelen + in->msglen;
+    s->pos    = 0;
+    s->padded = 0;
+}
+
+/* Emit the next block of the stream; returns 1 if it is the final one */
+static int hmsg_next_block(const hmsg_engine *e, hmsg_stream *s, uint8_t *blk)
+{
+    uint32_t rate = e->rate;
+    uint32_t k = 0;
+    uint32_t c;
+    uint64_t bits;
+
+    if (s->pos < s->prelen) {
+        c = s->prelen - (uint32_t)s->pos;
+        if (c > rate) { c = rate; }
+        memcpy(blk, s->pre + s->pos, c);
+        k = c;
+        s->pos += c;
+    }
+    if (k < rate && s->pos < s->total) {
+        c = rate - k;
+        if (s->total - s->pos < c) { c = (uint32_t)(s->total - s->pos); }
+        memcpy(blk + k, s->msg + (s->pos - s->prelen), c);
+        k += c;
+        s->pos += c;
+    }
+    if (k == rate) {
+        return 0;
+    }
+
+    memset(blk + k, 0, rate - k);
+    if (e->kind == HMSG_SHAKE) {
+        /* pad10*1 with the SHAKE domain bits */
+        blk[k] ^= 0x1F;
+        blk[rate - 1] |= 0x80;
+        return 1;
+    }
+    if (!s->padded) {
+        blk[k++] = 0x80;
+        s->padded = 1;
+    }
+    if (rate - k < e->lenbytes) {
+        return 0;
+    }
+    /* Big-endian bit length in the low 8 bytes of the length field */
+    bits = s->total * 8;
+    ull_to_bytes(blk + rate - 8, 8, bits);
+    return 1;
+}
+
+static void hmsg_reset_lane(hmsg_engine *e, uint32_t l)
+{
+    uint32_t j;
+
+    if (e->kind == HMSG_SHA256) {
+        for (j = 0; j < 8; j++) { e->s256[j][l] = e->iv256[j][l]; }
+    } else if (e->kind == HMSG_SHA512) {
+        for (j = 0; j < 8; j++) { e->s512[j][l] = e->iv512[j][l]; }
+    } else {
+        for (j = 0; j < 25; j++) { e->keccak[j][l] = 0; }
+    }
+}
+
+/* Interleave one block per lane and run one lane-parallel compression */
+static void hmsg_compress(hmsg_engine *e, uint8_t blk[L][HMSG_MAX_RATE])
+{
+    uint32_t j, l, b;
+
+    /* JASMIN: replace dispatch with direct call */
+    if (e->kind == HMSG_SHA256) {
+        uint32_t w[16][L];
+        for (j = 0; j < 16; j++) {
+            for (l = 0; l < L; l++) { w[j][l] = load_be32(blk[l] + 4 * j); }
+        }
+        sha256_transform_lanes(e->s256, (const uint32_t (*)[L])w);
+    } else if (e->kind == HMSG_SHA512) {
+        uint64_t w[16][L];
+        for (j = 0; j < 16; j++) {
+            for (l = 0; l < L; l++) { w[j][l] = bytes_to_ull(blk[l] + 8 * j, 8); }
+        }
+        sha512_transform_lanes(e->s512, (const uint64_t (*)[L])w);
+    } else {
+        for (j = 0; j < e->rate / 8; j++) {
+            for (l = 0; l < L; l++) {
+                uint64_t x = 0;
+                for (b = 0; b < 8; b++) {
+                    x |= (uint64_t)blk[l][8 * j + b] << (8 * b);
+                }
+                e->keccak[j][l] ^= x;
+            }
+        }
+        keccak_f1600_lanes(e->keccak);
+    }
+}
+
+static void hmsg_extract(const hmsg_engine *e, uint32_t l, uint8_t *out, uint32_t n)
+{
+    uint8_t  buf[64];
+    uint32_t j, b;
+
+    if (e->kind == HMSG_SHA256) {
+        for (j = 0; j < 8; j++) {
+            ull_to_bytes(buf + 4 * j, 4, e->s256[j][l]);
+        }
+    } else if (e->kind == HMSG_SHA512) {
+        for (j = 0; j < 8; j++) {
+            ull_to_bytes(buf + 8 * j, 8, e->s512[j][l]);
+        }
+    } else {
+        for (j = 0; j < 8; j++) {
+            for (b = 0; b < 8; b++) {
+                buf[8 * j + b] = (uint8_t)(e->keccak[j][l] >> (8 * b));
+            }
+        }
+    }
+    memcpy(out, buf, n);
+}
+
+int xmss_H_msg_multi(const xmss_params *p, uint8_t *out,
+                     const xmss_hmsg_input *in, uint32_t count)
+{
+    hmsg_engine e;
+    hmsg_stream s[L];
+    uint8_t     blk[L][HMSG_MAX_RATE];
+    uint32_t    item[L];
+    int         last[L];
+    uint32_t    next = 0, active = 0;
+    uint32_t    l;
+
+    if (p->func == XMSS_FUNC_SHA2 && p->n == 32) {
+        e.kind = HMSG_SHA256; e.rate = 64;  e.lenbytes = 8;
+        sha256_init_lanes(e.iv256);
+    } else if (p->func == XMSS_FUNC_SHA2) {
+        e.kind = HMSG_SHA512; e.rate = 128; e.lenbytes = 16;
+        sha512_init_lanes(e.iv512);
+    } else {
+        e.kind = HMSG_SHAKE;
+        e.rate = (p->func == XMSS_FUNC_SHAKE128) ? 168U : 136U;
+        e.lenbytes = 0;
+    }
+
+    for (l = 0; l < L; l++) {
+        item[l] = HMSG_IDLE;
+        last[l] = 0;
+        if (next < count) {
+            hmsg_stream_init(p, &s[l], &in[next]);
+            hmsg_reset_lane(&e, l);
+            item[l] = next++;
+            active++;
+        }
+    }
+
+    /* J5: one round per block of the longest lane schedule */
+    while (active > 0) {
+        for (l = 0; l < L; l++) {
+            if (item[l] != HMSG_IDLE) {
+                last[l] = hmsg_next_block(&e, &s[l], blk[l]);
+            } else {
+                memset(blk[l], 0, e.rate);
+            }
+        }
+        hmsg_compress(&e, blk);
+
+        for (l = 0; l < L; l++) {
+            if (item[l] == HMSG_IDLE || !last[l]) {
+                continue;
+            }
+            hmsg_extract(&e, l, out + (size_t)item[l] * p->n, p->n);
+            if (next < count) {
+                hmsg_stream_init(p, &s[l], &in[next]);
+                hmsg_reset_lane(&e, l);
+                item[l] = next++;
+            } else {
+                item[l] = HMSG_IDLE;
+                active--;
+            }
+        }
+    }
+    return 0;
+}
+
+#undef L
+
+/* ====================================================================
+ * Backend selection (tune.h)
+ *
+ * Process-wide and meant to be set before signing starts, but signer and
+ * pool threads read g_leaf_lanes on every leaf, so every access is an
+ * __atomic builtin: relaxed for the lane width (any value is valid), and
+ * the tuning record (oid, ns) is published by a release store of
+ * g_source.  The Keccak choice lives in keccak_arm64.c, whose dispatch
+ * test already sits on the permutation path.
+ * ==================================================================== */
+
+static uint32_t g_leaf_lanes = XMSS_HASH_LANES;
+static uint32_t g_source     = XMSS_TUNE_DEFAULT;
+static uint32_t g_oid        = 0;
+static uint64_t g_ns[XMSS_TUNE_CANDIDATES];
+
+uint32_t xmss_hash_leaf_lanes(void)
+{
+    return __atomic_load_n(&g_leaf_lanes, __ATOMIC_RELAXED);
+}
+
+int xmss_hash_lanes_native(const xmss_params *p)
+{
+    return lanes_native(p);
+}
+
+static uint32_t keccak_avail(void)
+{
+    uint32_t m = 1U << XMSS_KECCAK_GENERIC;
+#ifdef XMSS_KECCAK_ARM64
+    if (keccak_arm64_available()) {
+        m |= 1U << XMSS_KECCAK_ARM64_SHA3;
+    }
+#endif
+    return m;
+}
+
+void xmss_backend_get(xmss_backend_info *out)
+{
+    uint32_t i;
+
+    memset(out, 0, sizeof(*out));
+    out->leaf_lanes   = __atomic_load_n(&g_leaf_lanes, __ATOMIC_RELAXED);
+    out->keccak       = XMSS_KECCAK_GENERIC;
+#ifdef XMSS_KECCAK_ARM64
+    if (keccak_arm64_sha3()) {
+        out->keccak = XMSS_KECCAK_ARM64_SHA3;
+    }
+#endif
+#ifdef XMSS_USE_OPENSSL
+    out->sha2         = XMSS_SHA2_LIBCRYPTO;
+#else
+    out->sha2         = XMSS_SHA2_PORTABLE;
+#endif
+    out->source       = __atomic_load_n(&g_source, __ATOMIC_ACQUIRE);
+    out->oid          = __atomic_load_n(&g_oid, __ATOMIC_RELAXED);
+    out->max_lanes    = XMSS_HASH_LANES;
+    out->keccak_avail = keccak_avail();
+    for (i = 0; i < XMSS_TUNE_CANDIDATES; i++) {
+        out->ns_per_leaf[i] = __atomic_load_n(&g_ns[i], __ATOMIC_RELAXED);
+    }
+}
+
+int xmss_backend_set(const xmss_backend_info *in)
+{
+    uint32_t source = XMSS_TUNE_PINNED;
+    uint32_t i;
+
+    if (in->leaf_lanes != 1 && in->leaf_lanes != XMSS_HASH_LANES) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (in->keccak >= 32 || ((keccak_avail() >> in->keccak) & 1U) == 0) {
+        return XMSS_ERR_PARAMS;
+    }
+    __atomic_store_n(&g_leaf_lanes, in->leaf_lanes, __ATOMIC_RELAXED);
+#ifdef XMSS_KECCAK_ARM64
+    keccak_arm64_enable(in->keccak == XMSS_KECCAK_ARM64_SHA3);
+#endif
+    if (in->source == XMSS_TUNE_MEASURED || in->source == XMSS_TUNE_CACHED) {
+        source = in->source;
+    }
+    __atomic_store_n(&g_oid, source == XMSS_TUNE_PINNED ? 0U : in->oid,
+                     __ATOMIC_RELAXED);
+    for (i = 0; i < XMSS_TUNE_CANDIDATES; i++) {
+        __atomic_store_n(&g_ns[i],
+                         source == XMSS_TUNE_PINNED ? 0U : in->ns_per_leaf[i],
+                         __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&g_source, source, __ATOMIC_RELEASE);
+    return XMSS_OK;
+}
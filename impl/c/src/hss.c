@@ -0,0 +1,429 @@
+/**
+ * hss.c - LMS / HSS key generation, signing, verification
+ *
+ * RFC 8554 §5 (LMS) and §6 (HSS).  The hypertree is driven exactly like
+ * XMSS-MT (xmss_mt.c): level 0 signs messages, each level above signs the
+ * public key of the current tree below, and every level's next tree is
+ * grown by bds_state_update() while its current one is used up.  Leaves
+ * and interior nodes are the LMS ones (lmots.c, xmss_H() for
+ * XMSS_FUNC_LMS_SHA256), so treehash, BDS and compute_root() are shared.
+ *
+ * Trees other than the top one take SEED and I from xmss_hss_derive()
+ * over (level, tree index); see hss.h.
+ *
+ * No malloc (J3), no recursion (J4), no VLAs (J1), no function pointers (J2).
+ * All loops bounded by params fields or XMSS_MAX_* constants (J5).
+ */
+#include <string.h>
+#include <stdint.h>
+
+#include "../include/xmss/hss.h"
+#include "../include/xmss/params.h"
+#include "../include/xmss/types.h"
+#include "utils.h"
+#include "address.h"
+#include "hash/hash_iface.h"
+#include "lmots.h"
+#include "treehash.h"
+#include "bds.h"
+#include "sk_offsets.h"
+
+/* xmss_hss_derive() tags */
+#define TAG_SEED    0U   /* tree SEED */
+#define TAG_I       1U   /* tree identifier I */
+#define TAG_C_MSG   2U   /* LM-OTS randomiser of message idx */
+#define TAG_C_PUB   3U   /* LM-OTS randomiser of a child public key */
+
+#define LMS_I_BYTES 16U
+
+static int hss_params_ok(const xmss_params *p)
+{
+    return p->func == XMSS_FUNC_LMS_SHA256 && (p->oid >> 24) == 0x4CU &&
+           p->d >= 1 && p->d <= XMSS_HSS_MAX_LEVELS;
+}
+
+static uint32_t lms_type(const xmss_params *p) { return (p->oid >> 8) & 0xFFU; }
+static uint32_t ots_type(const xmss_params *p) { return p->oid & 0xFFU; }
+
+/* u32str(q) || u32str(otstype) || C || y[p] || u32str(type) || path[h] */
+static uint32_t lms_sig_bytes(const xmss_params *p)
+{
+    return 4 + (4 + p->n + p->len * p->n) + 4 + p->tree_height * p->n;
+}
+
+/* ====================================================================
+ * tree_keys() - SEED and I (first 16 bytes of an n-byte buffer, rest
+ * zero) of tree `tree` at `level`
+ * ==================================================================== */
+static void tree_keys(const xmss_params *p, const uint8_t *sk,
+                      uint32_t level, uint64_t tree, uint8_t *seed, uint8_t *I)
+{
+    const uint8_t *master = sk + sk_off_seed(p);
+    const uint8_t *top_I  = sk + sk_off_pub_seed(p);
+    uint8_t        buf[32];
+
+    memset(I, 0, p->n);
+    if (level + 1 == p->d) {
+        memcpy(seed, master, p->n);
+        memcpy(I, top_I, LMS_I_BYTES);
+        return;
+    }
+    xmss_hss_derive(p, seed, master, top_I, level, tree, TAG_SEED);
+    xmss_hss_derive(p, buf, master, top_I, level, tree, TAG_I);
+    memcpy(I, buf, LMS_I_BYTES);
+}
+
+/* LMS public key: u32str(type) || u32str(otstype) || I || root */
+static void lms_pub(const xmss_params *p, uint8_t *out,
+                    const uint8_t *I, const uint8_t *root)
+{
+    ull_to_bytes(out, 4, lms_type(p));
+    ull_to_bytes(out + 4, 4, ots_type(p));
+    memcpy(out + 8, I, LMS_I_BYTES);
+    memcpy(out + 8 + LMS_I_BYTES, root, p->n);
+}
+
+/* ====================================================================
+ * sign_child() - C || y: LM-OTS signature by level+1 of the public key
+ * of tree `tree` at `level` (leaf tree mod 2^th of parent tree >> th)
+ * ==================================================================== */
+static void sign_child(const xmss_params *p, const uint8_t *sk, uint8_t *out,
+                       uint32_t level, uint64_t tree,
+                       const uint8_t *I, const uint8_t *root)
+{
+    uint8_t  pub[XMSS_HSS_LMS_PUB_BYTES];
+    uint8_t  seed[XMSS_MAX_N], parent_I[XMSS_MAX_N];
+    uint32_t th = p->tree_height;
+
+    lms_pub(p, pub, I, root);
+    tree_keys(p, sk, level + 1, tree >> th, seed, parent_I);
+    xmss_hss_derive(p, out, sk + sk_off_prf(p), sk + sk_off_pub_seed(p),
+                    level, tree, TAG_C_PUB);
+    lmots_sign(p, out + p->n, out, pub, sizeof(pub), seed, parent_I,
+               (uint32_t)(tree & (((uint64_t)1 << th) - 1)));
+    xmss_memzero(seed, sizeof(seed));
+}
+
+/* ====================================================================
+ * xmss_hss_keygen() - RFC 8554 §6.1, with BDS state for every level
+ * ==================================================================== */
+
+int xmss_hss_keygen(const xmss_params *p, uint8_t *pk, uint8_t *sk,
+                    xmss_hss_state *state, uint32_t bds_k,
+                    xmss_randombytes_fn randombytes)
+{
+    uint8_t  root[XMSS_MAX_N];
+    uint8_t  seed[XMSS_MAX_N], I[XMSS_MAX_N];
+    uint8_t  rnd[2 * 32 + LMS_I_BYTES];
+    xmss_adrs_t adrs;
+    uint32_t i;
+
+    if (!hss_params_ok(p)) {
+        return XMSS_ERR_PARAMS;
+    }
+    if ((bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+
+    /* SEED, SK_PRF, I */
+    if (randombytes(rnd, sizeof(rnd)) != 0) {
+        return XMSS_ERR_ENTROPY;
+    }
+
+    /* SK: OID(4) | idx(8) | SEED(n) | SK_PRF(n) | root(n) | I(16) || 0(16).
+     * Written first: tree_keys() reads SEED and I from it. */
+    memset(sk, 0, p->sk_bytes);
+    ull_to_bytes(sk, 4, p->oid);
+    memcpy(sk + sk_off_seed(p), rnd, p->n);
+    memcpy(sk + sk_off_prf(p), rnd + p->n, p->n);
+    memcpy(sk + sk_off_pub_seed(p), rnd + 2 * p->n, LMS_I_BYTES);
+    xmss_memzero(rnd, sizeof(rnd));
+
+    memset(state, 0, sizeof(*state));
+
+    /* Tree 0 of every level, bottom up; each public key below the top is
+     * signed by leaf 0 of the level above.  The next trees start empty
+     * (next_leaf = 0) and are built during signing. */
+    for (i = 0; i < p->d; i++) {
+        memset(&adrs, 0, sizeof(adrs));
+        xmss_adrs_set_layer(&adrs, i);
+        xmss_adrs_set_tree(&adrs, 0);
+
+        tree_keys(p, sk, i, 0, seed, I);
+        bds_treehash_init(p, root, &state->bds[i], bds_k, seed, I, &adrs);
+        if (i + 1 < p->d) {
+            memcpy(state->roots[i], root, p->n);
+            sign_child(p, sk, state->ots_sigs[i], i, 0, I, root);
+        }
+    }
+    xmss_memzero(seed, sizeof(seed));
+
+    memcpy(sk + sk_off_root(p), root, p->n);
+
+    /* PK: u32str(L) || LMS public key of the top tree */
+    ull_to_bytes(pk, 4, p->d);
+    lms_pub(p, pk + 4, I, root);
+    return XMSS_OK;
+}
+
+/* ====================================================================
+ * xmss_hss_sign() - RFC 8554 §6.2; state upkeep as xmss_mt_sign()
+ * ==================================================================== */
+
+int xmss_hss_sign(const xmss_params *p, uint8_t *sig,
+                  const uint8_t *msg, size_t msglen,
+                  uint8_t *sk, xmss_hss_state *state, uint32_t bds_k)
+{
+    uint64_t idx, idx_tree;
+    uint32_t idx_leaf;
+    uint8_t  seed[XMSS_MAX_N], I[XMSS_MAX_N];
+    uint8_t  next_seed[XMSS_MAX_N], next_I[XMSS_MAX_N];
+    uint8_t *out = sig;
+    bds_walk w;
+    uint32_t i, j, lev;
+    uint32_t th = p->tree_height;
+    uint64_t mask = ((uint64_t)1 << th) - 1;
+    uint32_t ots_bytes = p->n + p->len * p->n;
+
+    if (!hss_params_ok(p) || (bds_k & 1) || bds_k > th) {
+        return XMSS_ERR_PARAMS;
+    }
+
+    idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
+    if (idx > p->idx_max) {
+        return XMSS_ERR_EXHAUSTED;
+    }
+
+    /* Increment index in SK before anything is released */
+    ull_to_bytes(sk + sk_off_idx(p), p->idx_bytes, idx + 1);
+
+    /* ---- Build signature, top level first ---- */
+    ull_to_bytes(out, 4, p->d - 1);
+    out += 4;
+
+    for (lev = p->d - 1; lev >= 1; lev--) {
+        /* Cached signature of the current tree below */
+        ull_to_bytes(out, 4, (idx >> (lev * th)) & mask);
+        ull_to_bytes(out + 4, 4, ots_type(p));
+        memcpy(out + 8, state->ots_sigs[lev - 1], ots_bytes);
+        out += 8 + ots_bytes;
+        ull_to_bytes(out, 4, lms_type(p));
+        out += 4;
+        for (j = 0; j < th; j++) {
+            memcpy(out + j * p->n, state->bds[lev].auth[j], p->n);
+        }
+        out += th * p->n;
+
+        /* ... and that tree's public key */
+        tree_keys(p, sk, lev - 1, idx >> (lev * th), seed, I);
+        lms_pub(p, out, I, state->roots[lev - 1]);
+        out += XMSS_HSS_LMS_PUB_BYTES;
+    }
+
+    /* Level 0: the message */
+    idx_leaf = (uint32_t)(idx & mask);
+    tree_keys(p, sk, 0, idx >> th, seed, I);
+    ull_to_bytes(out, 4, idx_leaf);
+    ull_to_bytes(out + 4, 4, ots_type(p));
+    xmss_hss_derive(p, out + 8, sk + sk_off_prf(p), sk + sk_off_pub_seed(p),
+                    0, idx, TAG_C_MSG);
+    lmots_sign(p, out + 8 + p->n, out + 8, msg, msglen, seed, I, idx_leaf);
+    out += 8 + ots_bytes;
+    ull_to_bytes(out, 4, lms_type(p));
+    out += 4;
+    for (j = 0; j < th; j++) {
+        memcpy(out + j * p->n, state->bds[0].auth[j], p->n);
+    }
+
+    /* ---- Update BDS states (as xmss_mt_sign()) ---- */
+    bds_walk_begin(p, &w, bds_k);
+    for (i = 0; i < p->d; i++) {
+        idx_tree = idx >> (th * (i + 1));
+        tree_keys(p, sk, i, idx_tree, seed, I);
+        tree_keys(p, sk, i, idx_tree + 1, next_seed, next_I);
+        if (bds_layer_advance(p, &w, &state->bds[i],
+                              i + 1 < p->d ? &state->bds[p->d + i] : NULL, 0, NULL,
+                              bds_k, idx, i, seed, I, next_seed, next_I)) {
+            /* Swapped in the next tree: sign its public key */
+            memcpy(state->roots[i], state->bds[i].stack[0], p->n);
+            sign_child(p, sk, state->ots_sigs[i], i, idx_tree + 1, next_I,
+                       state->roots[i]);
+        }
+    }
+
+    xmss_memzero(next_seed, sizeof(next_seed));
+    xmss_memzero(seed, sizeof(seed));
+    return XMSS_OK;
+}
+
+uint64_t xmss_hss_remaining_sigs(const xmss_params *p, const uint8_t *sk)
+{
+    uint64_t idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
+    if (idx > p->idx_max) {
+        return 0;
+    }
+    return p->idx_max - idx + 1;
+}
+
+/* ====================================================================
+ * lms_verify() - RFC 8554 Algorithm 6a on one level; 1 if valid
+ *
+ * @p is the single-level set of this level's types; the public key and
+ * the signature must both carry them.
+ * ==================================================================== */
+static int lms_verify(const xmss_params *p, const uint8_t *pub,
+                      const uint8_t *msg, size_t msglen, const uint8_t *s)
+{
+    uint8_t  I[XMSS_MAX_N], K[XMSS_MAX_N], node[XMSS_MAX_N], root[XMSS_MAX_N];
+    const uint8_t *t = s + 8 + p->n + p->len * p->n;
+    uint64_t q = bytes_to_ull(s, 4);
+    xmss_adrs_t adrs;
+
+    if (bytes_to_ull(pub, 4) != lms_type(p) || bytes_to_ull(pub + 4, 4) != ots_type(p) ||
+        bytes_to_ull(s + 4, 4) != ots_type(p) || bytes_to_ull(t, 4) != lms_type(p) ||
+        q >> p->tree_height != 0) {
+        return 0;
+    }
+    memset(I, 0, sizeof(I));
+    memcpy(I, pub + 8, LMS_I_BYTES);
+
+    lmots_pk_from_sig(p, K, s + 8, s + 8 + p->n, msg, msglen, I, (uint32_t)q);
+    xmss_lms_leaf(p, node, I, ((uint32_t)1 << p->tree_height) + (uint32_t)q, K);
+
+    memset(&adrs, 0, sizeof(adrs));
+    compute_root(p, root, node, (uint32_t)q, t + 4, I, &adrs);
+    return ct_memcmp(root, pub + 8 + LMS_I_BYTES, p->n) == 0;
+}
+
+/* ====================================================================
+ * hss_verify() - RFC 8554 Algorithm 6b over siglen bytes; 1 if valid
+ *
+ * Each level's LMS and LM-OTS types come from its public key (the top
+ * one from pk, the others from the signature) and are dispatched on per
+ * level.  With @want set, every level must use its type pair as well.
+ * ==================================================================== */
+static int hss_verify(const xmss_params *want,
+                      const uint8_t *msg, size_t msglen,
+                      const uint8_t *sig, size_t siglen,
+                      const uint8_t *pk, size_t pklen)
+{
+    xmss_params lp;
+    const uint8_t *pub = pk + 4;
+    size_t   left, lsig;
+    uint32_t levels, i;
+
+    if (pklen != 4 + XMSS_HSS_LMS_PUB_BYTES || siglen < 4) {
+        return 0;
+    }
+    levels = (uint32_t)bytes_to_ull(pk, 4);
+    if (levels < 1 || levels > XMSS_HSS_MAX_LEVELS ||
+        bytes_to_ull(sig, 4) != levels - 1) {
+        return 0;
+    }
+    sig  += 4;
+    left  = siglen - 4;
+
+    /* J5: loop bound = levels <= XMSS_HSS_MAX_LEVELS */
+    for (i = 0; i < levels; i++) {
+        if (xmss_hss_params(&lp, 1, (uint32_t)bytes_to_ull(pub, 4),
+                            (uint32_t)bytes_to_ull(pub + 4, 4)) != XMSS_OK) {
+            return 0;
+        }
+        if (want != NULL && (lms_type(&lp) != lms_type(want) ||
+                             ots_type(&lp) != ots_type(want))) {
+            return 0;
+        }
+        lsig = lms_sig_bytes(&lp);
+        if (i + 1 < levels) {
+            /* LMS signature, then the child public key it signs */
+            if (left < lsig + XMSS_HSS_LMS_PUB_BYTES ||
+                !lms_verify(&lp, pub, sig + lsig, XMSS_HSS_LMS_PUB_BYTES, sig)) {
+                return 0;
+            }
+            pub   = sig + lsig;
+            sig  += lsig + XMSS_HSS_LMS_PUB_BYTES;
+            left -= lsig + XMSS_HSS_LMS_PUB_BYTES;
+        } else if (left != lsig || !lms_verify(&lp, pub, msg, msglen, sig)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* ====================================================================
+ * xmss_hss_verify() / xmss_hss_verify_any() - RFC 8554 §6.3
+ * ==================================================================== */
+
+int xmss_hss_verify(const xmss_params *p,
+                    const uint8_t *msg, size_t msglen,
+                    const uint8_t *sig, const uint8_t *pk)
+{
+    if (!hss_params_ok(p) || bytes_to_ull(pk, 4) != p->d) {
+        return XMSS_ERR_VERIFY;
+    }
+    return hss_verify(p, msg, msglen, sig, p->sig_bytes, pk, p->pk_bytes)
+           ? XMSS_OK : XMSS_ERR_VERIFY;
+}
+
+int xmss_hss_verify_any(const uint8_t *msg, size_t msglen,
+                        const uint8_t *sig, size_t siglen,
+                        const uint8_t *pk, size_t pklen)
+{
+    return hss_verify(NULL, msg, msglen, sig, siglen, pk, pklen)
+           ? XMSS_OK : XMSS_ERR_VERIFY;
+}
+
+/* ====================================================================
+ * State serialisation: 2L-1 BDS states, then L-1 (C || y, root) pairs
+ * ==================================================================== */
+
+uint32_t xmss_hss_state_bytes(const xmss_params *p, uint32_t bds_k)
+{
+    return (2 * p->d - 1) * xmss_bds_serialized_size(p, bds_k) +
+           (p->d - 1) * (p->n + p->len * p->n + p->n);
+}
+
+int xmss_hss_state_serialize(const xmss_params *p, uint8_t *buf,
+                             const xmss_hss_state *state, uint32_t bds_k)
+{
+    uint32_t bds_bytes = xmss_bds_serialized_size(p, bds_k);
+    uint32_t ots_bytes = p->n + p->len * p->n;
+    uint32_t i;
+
+    if (!hss_params_ok(p) || (bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+    for (i = 0; i < 2 * p->d - 1; i++) {
+        xmss_bds_serialize(p, buf, &state->bds[i], bds_k);
+        buf += bds_bytes;
+    }
+    for (i = 0; i + 1 < p->d; i++) {
+        memcpy(buf, state->ots_sigs[i], ots_bytes);
+        memcpy(buf + ots_bytes, state->roots[i], p->n);
+        buf += ots_bytes + p->n;
+    }
+    return XMSS_OK;
+}
+
+int xmss_hss_state_deserialize(const xmss_params *p, xmss_hss_state *state,
+                               const uint8_t *buf, uint32_t bds_k)
+{
+    uint32_t bds_bytes = xmss_bds_serialized_size(p, bds_k);
+    uint32_t ots_bytes = p->n + p->len * p->n;
+    uint32_t i;
+
+    if (!hss_params_ok(p) || (bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+    memset(state, 0, sizeof(*state));
+    for (i = 0; i < 2 * p->d - 1; i++) {
+        xmss_bds_deserialize(p, &state->bds[i], buf, bds_k);
+        buf += bds_bytes;
+    }
+    for (i = 0; i + 1 < p->d; i++) {
+        memcpy(state->ots_sigs[i], buf, ots_bytes);
+        memcpy(state->roots[i], buf + ots_bytes, p->n);
+        buf += ots_bytes + p->n;
+    }
+    return XMSS_OK;
+}
@@ -0,0 +1,157 @@
+/**
+ * lmots.c - LM-OTS one-time signatures and LMS leaves
+ *
+ * RFC 8554 §4 (Algorithms 1, 3, 4b) and the leaf hash of §5.3.
+ *
+ * J4: No recursion.
+ * J3: No malloc; all buffers on stack or caller-provided.
+ * J6: Key expansion runs exactly len chains of w-1 steps; signing and
+ *     verification chain lengths come from the public message digest.
+ */
+#include <string.h>
+#include <stdint.h>
+
+#include "lmots.h"
+#include "hash/hash_iface.h"
+#include "utils.h"
+#include "../include/xmss/params.h"
+
+/* ====================================================================
+ * lmots_coefs() - Digits of Q || Cksm(Q) (RFC 8554 §4.4, Algorithm 2)
+ *
+ * coef(S, i, w) reads w-bit digits most significant first, which is
+ * base_w() of the 34-byte string.  The checksum sums (2^w - 1 - digit)
+ * over the len1 digits of Q and is shifted left by ls = 16 - len2 * w,
+ * so its len2 digits are the top of the 16-bit field.
+ * ==================================================================== */
+static void lmots_coefs(const xmss_params *p, uint32_t *a, const uint8_t *Q)
+{
+    uint8_t  s[32 + 2];
+    uint32_t mask = p->w - 1;
+    uint32_t sum  = 0;
+    uint32_t i, bit;
+
+    memcpy(s, Q, 32);
+    for (i = 0; i < p->len1; i++) {
+        bit = i * p->log2_w;
+        sum += mask - (((uint32_t)s[bit / 8] >> (8 - bit % 8 - p->log2_w)) & mask);
+    }
+    ull_to_bytes(s + 32, 2, (uint64_t)sum << (16 - p->len2 * p->log2_w));
+
+    for (i = 0; i < p->len; i++) {
+        bit = i * p->log2_w;
+        a[i] = ((uint32_t)s[bit / 8] >> (8 - bit % 8 - p->log2_w)) & mask;
+    }
+}
+
+/* ====================================================================
+ * lmots_sign() - Algorithm 3: y[i] = chain a[i] steps from x[i]
+ * ==================================================================== */
+void lmots_sign(const xmss_params *p, uint8_t *y, const uint8_t *C,
+                const uint8_t *msg, size_t msglen,
+                const uint8_t *seed, const uint8_t *I, uint32_t q)
+{
+    uint8_t  Q[32];
+    uint32_t a[XMSS_MAX_WOTS_LEN];
+    uint32_t i;
+
+    xmss_lmots_msg(p, Q, I, q, C, msg, msglen);
+    lmots_coefs(p, a, Q);
+
+    /* J5: len bounded by XMSS_MAX_WOTS_LEN */
+    for (i = 0; i < p->len; i++) {
+        xmss_lmots_prf(p, y + i * p->n, I, q, i, seed);
+        xmss_lmots_chain(p, y + i * p->n, y + i * p->n, I, q, i, 0, a[i]);
+    }
+}
+
+/* ====================================================================
+ * lmots_pk_from_sig() - Algorithm 4b: finish every chain, hash the ends
+ * ==================================================================== */
+void lmots_pk_from_sig(const xmss_params *p, uint8_t *K,
+                       const uint8_t *C, const uint8_t *y,
+                       const uint8_t *msg, size_t msglen,
+                       const uint8_t *I, uint32_t q)
+{
+    uint8_t  z[XMSS_MAX_WOTS_LEN * 32];
+    uint8_t  Q[32];
+    uint32_t a[XMSS_MAX_WOTS_LEN];
+    uint32_t i;
+
+    xmss_lmots_msg(p, Q, I, q, C, msg, msglen);
+    lmots_coefs(p, a, Q);
+
+    for (i = 0; i < p->len; i++) {
+        xmss_lmots_chain(p, z + i * p->n, y + i * p->n, I, q, i,
+                         a[i], p->w - 1 - a[i]);
+    }
+    xmss_lmots_pk(p, K, I, q, z);
+}
+
+/* ====================================================================
+ * lms_gen_leaf() - Algorithm 1 public key K, then the leaf hash
+ * ==================================================================== */
+void lms_gen_leaf(const xmss_params *p, uint8_t *leaf,
+                  const uint8_t *seed, const uint8_t *I, uint32_t q)
+{
+    uint8_t  y[XMSS_MAX_WOTS_LEN * 32];
+    uint8_t  K[32];
+    uint32_t i;
+
+    /* J6: exactly len chains of w-1 steps */
+    for (i = 0; i < p->len; i++) {
+        xmss_lmots_prf(p, y + i * p->n, I, q, i, seed);
+        xmss_lmots_chain(p, y + i * p->n, y + i * p->n, I, q, i, 0, p->w - 1);
+    }
+    xmss_lmots_pk(p, K, I, q, y);
+    xmss_lms_leaf(p, leaf, I, ((uint32_t)1 << p->tree_height) + q, K);
+}
+
+/* ====================================================================
+ * gen_leaves_lanes() - XMSS_HASH_LANES leaves, chains run lane-parallel
+ *
+ * Chain ends are stored as bytes per lane as each chain finishes; K is
+ * a multi-block hash per lane, a few percent of the chain work.
+ * ==================================================================== */
+static void gen_leaves_lanes(const xmss_params *p,
+                             uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N],
+                             const uint8_t *seed, const uint8_t *I, uint32_t first)
+{
+    uint8_t      y[XMSS_HASH_LANES][XMSS_MAX_WOTS_LEN * 32];
+    uint8_t      K[32];
+    uint32_t     q[XMSS_HASH_LANES];
+    xmss_lanes_t c;
+    uint32_t     i, l;
+
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        q[l] = first + l;
+    }
+    for (i = 0; i < p->len; i++) {
+        xmss_lmots_prf_lanes(p, &c, I, q, i, seed);
+        xmss_lmots_chain_lanes(p, &c, &c, I, q, i, 0, p->w - 1);
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            xmss_lanes_store(p, y[l] + i * p->n, &c, l);
+        }
+    }
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        xmss_lmots_pk(p, K, I, q[l], y[l]);
+        xmss_lms_leaf(p, leaves[l], I, ((uint32_t)1 << p->tree_height) + q[l], K);
+    }
+}
+
+/* Separate frames, as in treehash_gen_leaves() */
+void lms_gen_leaves(const xmss_params *p,
+                    uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N],
+                    const uint8_t *seed, const uint8_t *I, uint32_t first,
+                    uint32_t count)
+{
+    uint32_t l;
+
+    if (xmss_hash_leaf_lanes() == 1 || count < XMSS_HASH_LANES) {
+        for (l = 0; l < count; l++) {
+            lms_gen_leaf(p, leaves[l], seed, I, first + l);
+        }
+    } else {
+        gen_leaves_lanes(p, leaves, seed, I, first);
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * lmots.h - LM-OTS and LMS leaves internal API
+ *
+ * RFC 8554 §4 (LM-OTS) and the leaf hash of §5.3, for hss.c and the
+ * func == XMSS_FUNC_LMS_SHA256 branches of bds.c and treehash.c.  Key
+ * material per tree: SEED (n bytes) and I (16 bytes at the start of an
+ * n-byte buffer).  p->len is the LM-OTS p, p->w = 2^w.
+ */
+#ifndef XMSS_LMOTS_H
+#define XMSS_LMOTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/xmss/params.h"
+
+/**
+ * lmots_sign() - LM-OTS signature body y[0..p-1] (RFC 8554 Alg 3).
+ *
+ * @p:      Parameter set.
+ * @y:      Output: len*n bytes.
+ * @C:      n-byte randomiser (written before y in the signature).
+ * @msg:    Message (arbitrary length).
+ * @msglen: Message length.
+ * @seed:   n-byte tree SEED.
+ * @I:      Tree identifier.
+ * @q:      Leaf index.
+ */
+void lmots_sign(const xmss_params *p, uint8_t *y, const uint8_t *C,
+                const uint8_t *msg, size_t msglen,
+                const uint8_t *seed, const uint8_t *I, uint32_t q);
+
+/**
+ * lmots_pk_from_sig() - Candidate public key Kc (RFC 8554 Alg 4b).
+ *
+ * @p:      Parameter set.
+ * @K:      Output n-byte Kc.
+ * @C:      n-byte randomiser from the signature.
+ * @y:      len*n bytes from the signature.
+ * @msg:    Message.
+ * @msglen: Message length.
+ * @I:      Tree identifier.
+ * @q:      Leaf index.
+ */
+void lmots_pk_from_sig(const xmss_params *p, uint8_t *K,
+                       const uint8_t *C, const uint8_t *y,
+                       const uint8_t *msg, size_t msglen,
+                       const uint8_t *I, uint32_t q);
+
+/**
+ * lms_gen_leaf() - Leaf q of an LMS tree: H(I || r || D_LEAF || K_q).
+ */
+void lms_gen_leaf(const xmss_params *p, uint8_t *leaf,
+                  const uint8_t *seed, const uint8_t *I, uint32_t q);
+
+/**
+ * lms_gen_leaves() - Leaves first .. first + count - 1 (count <= XMSS_HASH_LANES).
+ *
+ * LM-OTS key expansion and chains run on the lane kernels; with
+ * leaf_lanes = 1 selected (tune.h), or a short batch, the leaves are
+ * computed one at a time.  Output is identical either way.
+ */
+void lms_gen_leaves(const xmss_params *p,
+                    uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N],
+                    const uint8_t *seed, const uint8_t *I, uint32_t first,
+                    uint32_t count);
+
+#endif /* XMSS_LMOTS_H */
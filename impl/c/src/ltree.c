@@ -62,3 +62,41 @@ void l_tree(const xmss_params *p, uint8_t *root, uint8_t *pk,
 
     memcpy(root, pk, p->n);
 }
+
+/* Same reduction as l_tree(), one lane block per node position. */
+void l_tree_lanes(const xmss_params *p, xmss_lanes_t *root, xmss_lanes_t *pk,
+                  const uint8_t *seed, const xmss_adrs_t *adrs)
+{
+    uint32_t    len    = p->len;
+    uint32_t    height = 0;
+    uint32_t    i, l;
+    xmss_adrs_t a[XMSS_HASH_LANES];
+
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        a[l] = adrs[l];
+    }
+
+    while (len > 1) {
+        uint32_t half = len / 2;
+
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            xmss_adrs_set_tree_height(&a[l], height);
+        }
+        for (i = 0; i < half; i++) {
+            for (l = 0; l < XMSS_HASH_LANES; l++) {
+                xmss_adrs_set_tree_index(&a[l], i);
+            }
+            xmss_H_lanes(p, &pk[i], seed, a, &pk[2*i], &pk[2*i + 1]);
+        }
+
+        /* If len is odd, copy the last element up */
+        if (len & 1) {
+            pk[half] = pk[len - 1];
+        }
+
+        len = (len + 1) / 2;
+        height++;
+    }
+
+    *root = pk[0];
+}
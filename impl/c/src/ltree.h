@@ -7,6 +7,7 @@
 #include <stdint.h>
 #include "../include/xmss/params.h"
 #include "../include/xmss/types.h"
+#include "hash/hash_iface.h"
 
 /**
  * l_tree() - Algorithm 7: Compute an L-tree root from a WOTS+ public key.
@@ -23,4 +24,16 @@
 void l_tree(const xmss_params *p, uint8_t *root, uint8_t *pk,
             const uint8_t *seed, xmss_adrs_t *adrs);
 
+/**
+ * l_tree_lanes() - l_tree() on XMSS_HASH_LANES WOTS+ public keys at once.
+ *
+ * @p:    Parameter set.
+ * @root: Output lane block (one L-tree root per lane).
+ * @pk:   len lane blocks from wots_gen_pk_lanes(); modified in place.
+ * @seed: n-byte public seed.
+ * @adrs: XMSS_HASH_LANES L-tree addresses (L-tree index set per lane).
+ */
+void l_tree_lanes(const xmss_params *p, xmss_lanes_t *root, xmss_lanes_t *pk,
+                  const uint8_t *seed, const xmss_adrs_t *adrs);
+
 #endif /* XMSS_LTREE_H */
@@ -3,12 +3,17 @@
  *
  * RFC 8391 §5.3: all 12 XMSS parameter sets.
  * Formulae from RFC 8391 §3.1 and §5.3.
+ * xmss_params_custom(): validated private-use sets built by the same
+ * derivation (w = 256 is not an RFC value but the formulae hold).
+ * xmss_hss_params(): RFC 8554 LMS/HSS sets; the WOTS+ len1/len2 formulae
+ * give LM-OTS u/v for n = 32, so derive_params() serves there too.
  */
 #include <string.h>
 #include <stddef.h>
 
 #include "../include/xmss/params.h"
 #include "../include/xmss/xmss.h"
+#include "../include/xmss/hss.h"
 
 /* ceil(a/b) for positive integers */
 static uint32_t ceil_div(uint32_t a, uint32_t b)
@@ -34,6 +39,7 @@ static int derive_params(xmss_params *p)
     /* log2(w) */
     if (p->w == 4)        { p->log2_w = 2; }
     else if (p->w == 16)  { p->log2_w = 4; }
+    else if (p->w == 256) { p->log2_w = 8; }
     else { return -1; }
 
     /* RFC 8391 §3.1.1 */
@@ -218,3 +224,80 @@ int xmss_mt_params_from_name(xmss_params *p, const char *name)
     }
     return XMSS_ERR_PARAMS;
 }
+
+int xmss_params_custom(xmss_params *p, uint32_t oid, uint8_t func,
+                       uint32_t n, uint32_t w, uint32_t h, uint32_t d)
+{
+    xmss_params c;
+
+    if (p == NULL || oid < OID_XMSS_PRIVATE_MIN) { return XMSS_ERR_PARAMS; }
+
+    /* Hash/n pairings of the RFC sets; the backends key on both */
+    if (!((func == XMSS_FUNC_SHA2     && (n == 32 || n == 64)) ||
+          (func == XMSS_FUNC_SHAKE128 && n == 32) ||
+          (func == XMSS_FUNC_SHAKE256 && n == 64))) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (d == 0 || d > XMSS_MAX_D || h == 0 || h > XMSS_MAX_FULL_H || h % d != 0) {
+        return XMSS_ERR_PARAMS;
+    }
+    /* BDS arrays are sized by XMSS_MAX_H */
+    if (h / d > XMSS_MAX_H) { return XMSS_ERR_PARAMS; }
+    /* XMSS-MT: idx is ceil(h/8) bytes, so for h a multiple of 8 the
+     * exhausted value 2^h would wrap to 0; and one-leaf trees starve the
+     * upper layers' next-tree builds in xmss_mt_sign() */
+    if (d > 1 && (h % 8 == 0 || h / d < 2)) { return XMSS_ERR_PARAMS; }
+
+    memset(&c, 0, sizeof(c));
+    c.oid  = oid;
+    c.func = func;
+    c.n    = n;
+    c.w    = w;
+    c.h    = h;
+    c.d    = d;
+    /* Rejects other w and WOTS+ lengths over XMSS_MAX_WOTS_LEN (w = 4, n = 64) */
+    if (derive_params(&c) != 0) { return XMSS_ERR_PARAMS; }
+
+    *p = c;
+    return XMSS_OK;
+}
+
+int xmss_hss_params(xmss_params *p, uint32_t levels,
+                    uint32_t lms_type, uint32_t ots_type)
+{
+    xmss_params c;
+    uint32_t    lms_sig;
+
+    if (p == NULL || levels == 0 || levels > XMSS_HSS_MAX_LEVELS) {
+        return XMSS_ERR_PARAMS;
+    }
+    /* H5..H20; H25 is over XMSS_MAX_H */
+    if (lms_type < LMS_SHA256_M32_H5 || lms_type > LMS_SHA256_M32_H20) {
+        return XMSS_ERR_PARAMS;
+    }
+    /* W2..W8; W1 (p = 265) is over XMSS_MAX_WOTS_LEN */
+    if (ots_type < LMOTS_SHA256_N32_W2 || ots_type > LMOTS_SHA256_N32_W8) {
+        return XMSS_ERR_PARAMS;
+    }
+
+    memset(&c, 0, sizeof(c));
+    c.oid  = XMSS_HSS_OID(levels, lms_type, ots_type);
+    c.func = XMSS_FUNC_LMS_SHA256;
+    c.n    = 32;
+    c.w    = (uint32_t)1 << ((uint32_t)1 << (ots_type - 1));   /* 2^(1, 2, 4, 8) */
+    c.d    = levels;
+    c.h    = levels * 5 * (lms_type - LMS_SHA256_M32_H5 + 1);
+    if (c.h > XMSS_MAX_FULL_H || derive_params(&c) != 0) {
+        return XMSS_ERR_PARAMS;
+    }
+
+    /* RFC 8554 encodings: u32 q everywhere, so the SK index is 8 bytes */
+    c.idx_bytes = 8;
+    lms_sig     = 4 + (4 + c.n + c.len * c.n) + 4 + c.tree_height * c.n;
+    c.sig_bytes = 4 + (levels - 1) * (lms_sig + XMSS_HSS_LMS_PUB_BYTES) + lms_sig;
+    c.pk_bytes  = 4 + XMSS_HSS_LMS_PUB_BYTES;
+    c.sk_bytes  = 4 + c.idx_bytes + 4 * c.n;
+
+    *p = c;
+    return XMSS_OK;
+}
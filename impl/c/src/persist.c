@@ -0,0 +1,647 @@
+/**
+ * persist.c - Pipelined sign-and-persist of key state (Linux)
+ *
+ * Not part of the Jasmin-portable core: talks to the OS (pwrite,
+ * fdatasync, mmap and the raw io_uring system calls; no liburing).  Built
+ * only with -DXMSS_BUILD_PERSIST=ON on Linux.  Without <linux/io_uring.h>
+ * at build time (XMSS_PERSIST_NO_URING) only the sync backend exists.
+ *
+ * Each record takes two SQEs, a write linked to a datasync.  The slot is
+ * freed, and the record counted durable, when the datasync completes; a
+ * failed write cancels its datasync, so both arrive either way.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef XMSS_PERSIST_NO_URING
+#include <linux/io_uring.h>
+#endif
+
+#include "../include/xmss/persist.h"
+#include "sk_offsets.h"
+#include "state_record.h"
+#include "utils.h"
+
+#define PERSIST_PAGE 4096U
+#define PERSIST_HDR  32U    /* magic(8) | idx(8) | len(4) | crc(4) | zero(8) */
+
+static const uint8_t persist_magic[8] = { 'X', 'M', 'S', 'S', 'P', 'S', 'T', '1' };
+
+/* Ring offsets kept in xmss_persist.sq_off / cq_off */
+enum { SQ_HEAD, SQ_TAIL, SQ_MASK, SQ_ARRAY };
+enum { CQ_HEAD, CQ_TAIL, CQ_MASK, CQ_CQES };
+
+static uint32_t record_crc(const uint8_t *rec, uint32_t payload)
+{
+    uint32_t crc = crc32_update(0, rec + 8, 12);             /* idx | len */
+    return crc32_update(crc, rec + PERSIST_HDR, payload);
+}
+
+static uint8_t *slot_buf(const xmss_persist *ps, uint32_t slot)
+{
+    return ps->buf + (size_t)slot * ps->slot_bytes;
+}
+
+/* A record just completed its datasync (res < 0: it or its write failed) */
+static void record_done(xmss_persist *ps, uint32_t slot, int res)
+{
+    if (res < 0) {
+        ps->error = XMSS_ERR_IO;
+    } else {
+        ps->st.durable++;
+        if (ps->slot_idx[slot] > ps->durable_idx) {
+            ps->durable_idx  = ps->slot_idx[slot];
+            ps->durable_slot = slot;
+        }
+    }
+    ps->slot_busy[slot] = 0;
+    ps->st.in_flight--;
+}
+
+/* ====================================================================
+ * Sync backend
+ * ==================================================================== */
+
+static int write_full(int fd, const uint8_t *buf, size_t len, off_t off)
+{
+    ssize_t w;
+
+    while (len > 0) {
+        w = pwrite(fd, buf, len, off);
+        if (w < 0 && errno == EINTR) {
+            continue;
+        }
+        if (w <= 0) {
+            return -1;
+        }
+        buf += w;
+        len -= (size_t)w;
+        off += w;
+    }
+    return 0;
+}
+
+static void sync_submit(xmss_persist *ps, uint32_t slot)
+{
+    int ok = write_full(ps->fd, slot_buf(ps, slot), ps->slot_bytes,
+                        (off_t)slot * ps->slot_bytes) == 0 &&
+             fdatasync(ps->fd) == 0;
+
+    record_done(ps, slot, ok ? 0 : -1);
+}
+
+/* ====================================================================
+ * io_uring backend
+ * ==================================================================== */
+
+#ifndef XMSS_PERSIST_NO_URING
+
+static uint32_t *sq_field(const xmss_persist *ps, int f)
+{
+    return (uint32_t *)((uint8_t *)ps->sq_ring + ps->sq_off[f]);
+}
+
+static uint32_t *cq_field(const xmss_persist *ps, int f)
+{
+    return (uint32_t *)((uint8_t *)ps->cq_ring + ps->cq_off[f]);
+}
+
+static void uring_teardown(xmss_persist *ps)
+{
+    if (ps->sqes != NULL) {
+        munmap(ps->sqes, ps->sqes_len);
+    }
+    if (ps->cq_ring != NULL && ps->cq_ring != ps->sq_ring) {
+        munmap(ps->cq_ring, ps->cq_ring_len);
+    }
+    if (ps->sq_ring != NULL) {
+        munmap(ps->sq_ring, ps->sq_ring_len);
+    }
+    if (ps->ring_fd >= 0) {
+        close(ps->ring_fd);
+    }
+    ps->sq_ring = ps->cq_ring = ps->sqes = NULL;
+    ps->ring_fd = -1;
+}
+
+/* The kernel must know WRITE and FSYNC; the probe itself needs 5.6+ */
+static int uring_probe(int ring_fd)
+{
+    uint64_t                storage[(sizeof(struct io_uring_probe) +
+                                     256 * sizeof(struct io_uring_probe_op)) / 8 + 1];
+    struct io_uring_probe  *pr = (struct io_uring_probe *)storage;
+
+    memset(storage, 0, sizeof(storage));
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, pr, 256) < 0 ||
+        pr->last_op < IORING_OP_WRITE ||
+        !(pr->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) ||
+        !(pr->ops[IORING_OP_FSYNC].flags & IO_URING_OP_SUPPORTED)) {
+        return -1;
+    }
+    return 0;
+}
+
+static void *map_ring(int ring_fd, size_t len, uint64_t off)
+{
+    void *m = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd, (off_t)off);
+    return m == MAP_FAILED ? NULL : m;
+}
+
+static int uring_setup(xmss_persist *ps)
+{
+    struct io_uring_params prm;
+    long                   fd;
+
+    memset(&prm, 0, sizeof(prm));
+    fd = syscall(__NR_io_uring_setup, 2 * ps->nslots, &prm);
+    if (fd < 0) {
+        return -1;
+    }
+    ps->ring_fd = (int)fd;
+    if (uring_probe(ps->ring_fd) != 0) {
+        uring_teardown(ps);
+        return -1;
+    }
+
+    ps->sq_ring_len = prm.sq_off.array + prm.sq_entries * sizeof(uint32_t);
+    ps->cq_ring_len = prm.cq_off.cqes + prm.cq_entries * sizeof(struct io_uring_cqe);
+    if (prm.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ps->cq_ring_len > ps->sq_ring_len) {
+            ps->sq_ring_len = ps->cq_ring_len;
+        }
+        ps->sq_ring = map_ring(ps->ring_fd, ps->sq_ring_len, IORING_OFF_SQ_RING);
+        ps->cq_ring = ps->sq_ring;
+    } else {
+        ps->sq_ring = map_ring(ps->ring_fd, ps->sq_ring_len, IORING_OFF_SQ_RING);
+        ps->cq_ring = map_ring(ps->ring_fd, ps->cq_ring_len, IORING_OFF_CQ_RING);
+    }
+    ps->sqes_len = prm.sq_entries * sizeof(struct io_uring_sqe);
+    ps->sqes     = map_ring(ps->ring_fd, ps->sqes_len, IORING_OFF_SQES);
+    if (ps->sq_ring == NULL || ps->cq_ring == NULL || ps->sqes == NULL) {
+        uring_teardown(ps);
+        return -1;
+    }
+
+    ps->sq_off[SQ_HEAD]  = prm.sq_off.head;
+    ps->sq_off[SQ_TAIL]  = prm.sq_off.tail;
+    ps->sq_off[SQ_MASK]  = prm.sq_off.ring_mask;
+    ps->sq_off[SQ_ARRAY] = prm.sq_off.array;
+    ps->cq_off[CQ_HEAD]  = prm.cq_off.head;
+    ps->cq_off[CQ_TAIL]  = prm.cq_off.tail;
+    ps->cq_off[CQ_MASK]  = prm.cq_off.ring_mask;
+    ps->cq_off[CQ_CQES]  = prm.cq_off.cqes;
+    return 0;
+}
+
+static long uring_enter(const xmss_persist *ps, uint32_t submit, uint32_t wait)
+{
+    long r;
+
+    do {
+        r = syscall(__NR_io_uring_enter, ps->ring_fd, submit, wait,
+                    wait ? IORING_ENTER_GETEVENTS : 0U, NULL, 0);
+    } while (r < 0 && errno == EINTR);
+    return r;
+}
+
+/*
+ * Hand the last @want queued SQEs to the kernel.  It may take fewer
+ * (a short count, or EAGAIN / EBUSY while completions are backed up);
+ * the rest stay queued in the SQ ring, so reap a completion and ask
+ * again.  Waits only while a CQE is owed.  Returns the SQEs left over.
+ */
+static int uring_reap(xmss_persist *ps, int wait);
+
+static uint32_t uring_flush(xmss_persist *ps, uint32_t want)
+{
+    long r;
+
+    while (want > 0) {
+        r = uring_enter(ps, want, 0);
+        if (r > 0) {
+            want         -= (uint32_t)r;
+            ps->sqes_out += (uint32_t)r;
+            continue;
+        }
+        if ((r == 0 || errno == EAGAIN || errno == EBUSY) && ps->sqes_out > 0 &&
+            uring_reap(ps, 1) == 0) {
+            continue;
+        }
+        break;
+    }
+    return want;
+}
+
+/* user_data: slot << 1 | is_datasync */
+static void uring_submit(xmss_persist *ps, uint32_t slot)
+{
+    struct io_uring_sqe *sqe   = (struct io_uring_sqe *)ps->sqes;
+    uint32_t            *array = sq_field(ps, SQ_ARRAY);
+    uint32_t             mask  = *sq_field(ps, SQ_MASK);
+    uint32_t             tail  = *sq_field(ps, SQ_TAIL);   /* only we write it */
+    uint32_t             w = tail & mask, s = (tail + 1) & mask;
+
+    memset(&sqe[w], 0, sizeof(sqe[w]));
+    sqe[w].opcode    = IORING_OP_WRITE;
+    sqe[w].flags     = IOSQE_IO_LINK;
+    sqe[w].fd        = ps->fd;
+    sqe[w].addr      = (uint64_t)(uintptr_t)slot_buf(ps, slot);
+    sqe[w].len       = ps->slot_bytes;
+    sqe[w].off       = (uint64_t)slot * ps->slot_bytes;
+    sqe[w].user_data = (uint64_t)slot << 1;
+    array[w]         = w;
+
+    memset(&sqe[s], 0, sizeof(sqe[s]));
+    sqe[s].opcode      = IORING_OP_FSYNC;
+    sqe[s].fd          = ps->fd;
+    sqe[s].fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe[s].user_data   = ((uint64_t)slot << 1) | 1U;
+    array[s]           = s;
+
+    __atomic_store_n(sq_field(ps, SQ_TAIL), tail + 2, __ATOMIC_RELEASE);
+    switch (uring_flush(ps, 2)) {
+    case 0:
+        break;
+    case 1:
+        /* The write went alone and the datasync never will: fail the record
+         * when the write's CQE is in (it may be already) */
+        ps->error = XMSS_ERR_IO;
+        if (ps->slot_busy[slot] == 3) {
+            record_done(ps, slot, -1);
+        } else {
+            ps->slot_busy[slot] = 2;
+        }
+        break;
+    default:
+        /* Not queued: no completions will come for this slot */
+        ps->error = XMSS_ERR_IO;
+        ps->slot_busy[slot] = 0;
+        ps->st.in_flight--;
+        break;
+    }
+}
+
+/*
+ * Returns -1 only if waiting failed or no CQE is owed, i.e. nothing more
+ * can be reaped.  slot_busy: 1 queued, 2 write submitted alone, 3 written.
+ */
+static int uring_reap(xmss_persist *ps, int wait)
+{
+    const struct io_uring_cqe *cqes;
+    uint32_t                   head, tail, mask, slot, got;
+    uint64_t                   ud;
+
+    cqes = (const struct io_uring_cqe *)((uint8_t *)ps->cq_ring + ps->cq_off[CQ_CQES]);
+    mask = *cq_field(ps, CQ_MASK);
+    for (;;) {
+        head = *cq_field(ps, CQ_HEAD);
+        tail = __atomic_load_n(cq_field(ps, CQ_TAIL), __ATOMIC_ACQUIRE);
+        for (got = 0; head != tail; head++, got++) {
+            ud   = cqes[head & mask].user_data;
+            slot = (uint32_t)(ud >> 1);
+            ps->sqes_out--;
+            if (ud & 1U) {
+                record_done(ps, slot, cqes[head & mask].res);
+            } else if (ps->slot_busy[slot] == 2) {
+                record_done(ps, slot, -1);      /* its datasync was never submitted */
+            } else {
+                ps->slot_busy[slot] = 3;        /* written, datasync to come */
+                if (cqes[head & mask].res != (int32_t)ps->slot_bytes) {
+                    ps->error = XMSS_ERR_IO;    /* short write: datasync cancelled */
+                }
+            }
+        }
+        __atomic_store_n(cq_field(ps, CQ_HEAD), head, __ATOMIC_RELEASE);
+        if (got > 0 || !wait || ps->st.in_flight == 0) {
+            return 0;
+        }
+        if (ps->sqes_out == 0 || uring_enter(ps, 0, 1) < 0) {
+            ps->error = XMSS_ERR_IO;
+            return -1;
+        }
+    }
+}
+
+#else /* XMSS_PERSIST_NO_URING */
+
+static int  uring_setup(xmss_persist *ps)    { (void)ps; return -1; }
+static void uring_teardown(xmss_persist *ps) { ps->ring_fd = -1; }
+static void uring_submit(xmss_persist *ps, uint32_t slot) { (void)ps; (void)slot; }
+static int  uring_reap(xmss_persist *ps, int wait) { (void)ps; (void)wait; return -1; }
+
+#endif /* XMSS_PERSIST_NO_URING */
+
+/* ====================================================================
+ * Pipeline
+ * ==================================================================== */
+
+int xmss_persist_open(xmss_persist *ps, int fd, const xmss_params *p,
+                      uint32_t bds_k, uint32_t depth, int flags)
+{
+    void  *m;
+    size_t len;
+
+    memset(ps, 0, sizeof(*ps));
+    ps->ring_fd = -1;
+    if (p == NULL || fd < 0 || depth == 0 || depth > XMSS_PERSIST_MAX_DEPTH ||
+        (bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+    ps->p           = *p;
+    ps->bds_k       = bds_k;
+    ps->fd          = fd;
+    ps->nslots      = depth + 1;
+    ps->state_bytes = state_bytes_for(p, bds_k);
+    ps->slot_bytes  = round_up32(PERSIST_HDR + p->sk_bytes + ps->state_bytes, PERSIST_PAGE);
+
+    len = (size_t)ps->nslots * ps->slot_bytes;
+    m   = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) {
+        memset(ps, 0, sizeof(*ps));
+        ps->ring_fd = -1;
+        return XMSS_ERR_PARAMS;
+    }
+    ps->buf = (uint8_t *)m;
+
+    ps->st.depth   = depth;
+    ps->st.backend = XMSS_PERSIST_BACKEND_SYNC;
+    if (!(flags & XMSS_PERSIST_SYNC) && uring_setup(ps) == 0) {
+        ps->st.backend = XMSS_PERSIST_BACKEND_URING;
+    }
+    return XMSS_OK;
+}
+
+/*
+ * A slot that is neither in flight nor holding the newest durable record.
+ * With depth + 1 slots one is free unless depth records are in flight.
+ */
+static int acquire_slot(xmss_persist *ps, uint32_t *slot)
+{
+    uint32_t k, s;
+    int      stalled = 0;
+
+    for (;;) {
+        if (ps->error != XMSS_OK) {
+            return ps->error;
+        }
+        for (k = 0; k < ps->nslots; k++) {
+            s = (ps->cursor + k) % ps->nslots;
+            if (!ps->slot_busy[s] && !(ps->durable_idx != 0 && s == ps->durable_slot)) {
+                ps->cursor = (s + 1) % ps->nslots;
+                *slot      = s;
+                return XMSS_OK;
+            }
+        }
+        if (!stalled) {
+            ps->st.stalls++;
+            stalled = 1;
+        }
+        if (uring_reap(ps, 1) < 0) {
+            return ps->error;
+        }
+    }
+}
+
+/* Header and SK; the state has already been written after the SK */
+static void submit_record(xmss_persist *ps, uint32_t slot, const uint8_t *sk)
+{
+    uint8_t *rec     = slot_buf(ps, slot);
+    uint32_t payload = ps->p.sk_bytes + ps->state_bytes;
+    uint64_t idx     = bytes_to_ull(sk + sk_off_idx(&ps->p), ps->p.idx_bytes);
+
+    memcpy(rec + PERSIST_HDR, sk, ps->p.sk_bytes);
+    memcpy(rec, persist_magic, sizeof(persist_magic));
+    ull_to_bytes(rec + 8, 8, idx);
+    ull_to_bytes(rec + 16, 4, payload);
+    ull_to_bytes(rec + 20, 4, record_crc(rec, payload));
+    memset(rec + 24, 0, PERSIST_HDR - 24);
+
+    ps->slot_idx[slot]  = idx;
+    ps->slot_busy[slot] = 1;
+    ps->st.records++;
+    ps->st.in_flight++;
+    if (ps->ring_fd >= 0) {
+        uring_submit(ps, slot);
+        (void)uring_reap(ps, 0);
+    } else {
+        sync_submit(ps, slot);
+    }
+}
+
+int xmss_persist_sign(xmss_persist *ps, uint8_t *sig,
+                      const uint8_t *msg, size_t msglen,
+                      uint8_t *sk, xmss_bds_state *state, uint64_t *idx)
+{
+    uint32_t slot = 0;
+    int      rc;
+
+    if (ps->p.d != 1) {
+        return XMSS_ERR_PARAMS;
+    }
+    rc = acquire_slot(ps, &slot);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    *idx = bytes_to_ull(sk + sk_off_idx(&ps->p), ps->p.idx_bytes);
+    rc   = xmss_sign(&ps->p, sig, msg, msglen, sk, state, ps->bds_k);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    xmss_bds_serialize(&ps->p, slot_buf(ps, slot) + PERSIST_HDR + ps->p.sk_bytes,
+                       state, ps->bds_k);
+    submit_record(ps, slot, sk);
+    return ps->error;
+}
+
+int xmss_mt_persist_sign(xmss_persist *ps, uint8_t *sig,
+                         const uint8_t *msg, size_t msglen,
+                         uint8_t *sk, xmss_mt_state *state, uint64_t *idx)
+{
+    uint32_t slot = 0;
+    int      rc;
+
+    if (ps->p.d < 2) {
+        return XMSS_ERR_PARAMS;
+    }
+    rc = acquire_slot(ps, &slot);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    *idx = bytes_to_ull(sk + sk_off_idx(&ps->p), ps->p.idx_bytes);
+    rc   = xmss_mt_sign(&ps->p, sig, msg, msglen, sk, state, ps->bds_k);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    xmss_mt_state_serialize(&ps->p, slot_buf(ps, slot) + PERSIST_HDR + ps->p.sk_bytes,
+                            state, ps->bds_k);
+    submit_record(ps, slot, sk);
+    return ps->error;
+}
+
+int xmss_persist_poll(xmss_persist *ps, int wait)
+{
+    if (ps->ring_fd >= 0) {
+        (void)uring_reap(ps, wait);
+    }
+    return ps->error;
+}
+
+uint64_t xmss_persist_durable(const xmss_persist *ps)
+{
+    return ps->durable_idx;
+}
+
+int xmss_persist_drain(xmss_persist *ps)
+{
+    while (ps->st.in_flight > 0 && ps->ring_fd >= 0) {
+        if (uring_reap(ps, 1) < 0) {
+            break;
+        }
+    }
+    return ps->error;
+}
+
+void xmss_persist_close(xmss_persist *ps)
+{
+    if (ps->buf != NULL) {
+        (void)xmss_persist_drain(ps);
+        uring_teardown(ps);
+        xmss_memzero(ps->buf, (size_t)ps->nslots * ps->slot_bytes);
+        munmap(ps->buf, (size_t)ps->nslots * ps->slot_bytes);
+    }
+    memset(ps, 0, sizeof(*ps));
+    ps->ring_fd = -1;
+}
+
+void xmss_persist_stats(const xmss_persist *ps, xmss_persist_stats_t *out)
+{
+    *out = ps->st;
+}
+
+/* ====================================================================
+ * Recovery
+ * ==================================================================== */
+
+static int read_full(int fd, uint8_t *buf, size_t len, off_t off)
+{
+    ssize_t r;
+
+    while (len > 0) {
+        r = pread(fd, buf, len, off);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            return -1;
+        }
+        buf += r;
+        len -= (size_t)r;
+        off += r;
+    }
+    return 0;
+}
+
+static int record_valid(const xmss_params *p, const uint8_t *rec, uint32_t payload)
+{
+    const uint8_t *sk = rec + PERSIST_HDR;
+
+    return memcmp(rec, persist_magic, sizeof(persist_magic)) == 0 &&
+           bytes_to_ull(rec + 16, 4) == payload &&
+           bytes_to_ull(rec + 20, 4) == record_crc(rec, payload) &&
+           bytes_to_ull(sk + sk_off_oid(p), 4) == p->oid &&
+           bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes) == bytes_to_ull(rec + 8, 8);
+}
+
+/*
+ * Scan every whole slot of the file and leave the newest valid record in
+ * *rec, inside a two-slot mapping the caller wipes and unmaps.
+ */
+static int load_newest(int fd, const xmss_params *p, uint32_t state_bytes,
+                       uint8_t **map, size_t *map_len, const uint8_t **rec)
+{
+    uint32_t    payload    = p->sk_bytes + state_bytes;
+    uint32_t    slot_bytes = round_up32(PERSIST_HDR + payload, PERSIST_PAGE);
+    uint64_t    best_idx   = 0, idx, k, nslots;
+    uint8_t    *cur, *best = NULL;
+    struct stat sb;
+    void       *m;
+
+    if (fstat(fd, &sb) != 0) {
+        return XMSS_ERR_IO;
+    }
+    nslots   = (uint64_t)sb.st_size / slot_bytes;
+    *map_len = 2 * (size_t)slot_bytes;
+    m = mmap(NULL, *map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) {
+        return XMSS_ERR_PARAMS;
+    }
+    *map = (uint8_t *)m;
+    cur  = *map;
+
+    for (k = 0; k < nslots; k++) {
+        if (read_full(fd, cur, slot_bytes, (off_t)(k * slot_bytes)) != 0) {
+            return XMSS_ERR_IO;
+        }
+        idx = bytes_to_ull(cur + 8, 8);
+        if (record_valid(p, cur, payload) && (best == NULL || idx > best_idx)) {
+            best_idx = idx;
+            best     = cur;
+            cur      = best == *map ? *map + slot_bytes : *map;
+        }
+    }
+    *rec = best;
+    return best == NULL ? XMSS_ERR_PARAMS : XMSS_OK;
+}
+
+int xmss_persist_load(int fd, const xmss_params *p, uint32_t bds_k,
+                      uint8_t *sk, xmss_bds_state *state)
+{
+    const uint8_t *rec = NULL;
+    uint8_t       *map = NULL;
+    size_t         map_len = 0;
+    int            rc;
+
+    if (p == NULL || p->d != 1) {
+        return XMSS_ERR_PARAMS;
+    }
+    rc = load_newest(fd, p, xmss_bds_serialized_size(p, bds_k), &map, &map_len, &rec);
+    if (rc == XMSS_OK) {
+        memcpy(sk, rec + PERSIST_HDR, p->sk_bytes);
+        rc = xmss_bds_deserialize(p, state, rec + PERSIST_HDR + p->sk_bytes, bds_k);
+    }
+    if (map != NULL) {
+        xmss_memzero(map, map_len);
+        munmap(map, map_len);
+    }
+    return rc;
+}
+
+int xmss_mt_persist_load(int fd, const xmss_params *p, uint32_t bds_k,
+                         uint8_t *sk, xmss_mt_state *state)
+{
+    const uint8_t *rec = NULL;
+    uint8_t       *map = NULL;
+    size_t         map_len = 0;
+    int            rc;
+
+    if (p == NULL || p->d < 2 || (bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+    rc = load_newest(fd, p, xmss_mt_state_bytes(p, bds_k), &map, &map_len, &rec);
+    if (rc == XMSS_OK) {
+        memcpy(sk, rec + PERSIST_HDR, p->sk_bytes);
+        rc = xmss_mt_state_deserialize(p, state, rec + PERSIST_HDR + p->sk_bytes, bds_k);
+    }
+    if (map != NULL) {
+        xmss_memzero(map, map_len);
+        munmap(map, map_len);
+    }
+    return rc;
+}
@@ -0,0 +1,48 @@
+/**
+ * state_record.h - Record helpers shared by the key-state stores (internal)
+ *
+ * persist.c and flashlog.c both frame an SK plus a serialised traversal
+ * state into fixed-size, CRC-checked records.  Not part of the core; the
+ * stores include it directly.
+ */
+#ifndef XMSS_STATE_RECORD_H
+#define XMSS_STATE_RECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/xmss/xmss.h"
+
+/* x rounded up to a multiple of to (a power of two) */
+static inline uint32_t round_up32(uint32_t x, uint32_t to)
+{
+    return (x + to - 1) & ~(to - 1);
+}
+
+/* Serialised state size: the whole hypertree's for XMSS-MT */
+static inline uint32_t state_bytes_for(const xmss_params *p, uint32_t bds_k)
+{
+    return p->d > 1 ? xmss_mt_state_bytes(p, bds_k)
+                    : xmss_bds_serialized_size(p, bds_k);
+}
+
+/* CRC-32 (IEEE, reflected), a nibble at a time from a constant table;
+ * torn-write detection, not integrity */
+static inline uint32_t crc32_update(uint32_t crc, const uint8_t *buf, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+        0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+        0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+        0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+    };
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        crc = (crc >> 4) ^ table[crc & 0xFU];
+        crc = (crc >> 4) ^ table[crc & 0xFU];
+    }
+    return ~crc;
+}
+
+#endif /* XMSS_STATE_RECORD_H */
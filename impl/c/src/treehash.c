@@ -13,6 +13,7 @@
 #include "treehash.h"
 #include "wots.h"
 #include "ltree.h"
+#include "lmots.h"
 #include "hash/hash_iface.h"
 #include "address.h"
 #include "utils.h"
@@ -46,12 +47,99 @@ static void stack_pop_two(treehash_stack_t *st, uint8_t *lo, uint8_t *hi,
     *lo_h = st->height[st->top];
 }
 
+/* ====================================================================
+ * gen_leaves_scalar() - count of the same leaves, one at a time through F/H
+ *
+ * Selected by xmss_backend_set() leaf_lanes = 1 (see tune.h), and for
+ * batches shorter than XMSS_HASH_LANES.
+ * ==================================================================== */
+static void gen_leaves_scalar(const xmss_params *p,
+                              uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N],
+                              const uint8_t *sk_seed, const uint8_t *seed,
+                              uint32_t first, uint32_t count,
+                              const xmss_adrs_t *adrs)
+{
+    uint8_t     wots_pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    xmss_adrs_t a;
+    uint32_t    l;
+
+    /* J5: count <= XMSS_HASH_LANES */
+    for (l = 0; l < count; l++) {
+        a = *adrs;
+        xmss_adrs_set_type(&a, XMSS_ADRS_TYPE_OTS);
+        xmss_adrs_set_ots(&a, first + l);
+        wots_gen_pk(p, wots_pk, sk_seed, seed, &a);
+
+        a = *adrs;
+        xmss_adrs_set_type(&a, XMSS_ADRS_TYPE_LTREE);
+        xmss_adrs_set_ltree(&a, first + l);
+        l_tree(p, leaves[l], wots_pk, seed, &a);
+    }
+}
+
+/* ====================================================================
+ * gen_leaves_lanes() - XMSS_HASH_LANES leaves through the lane pipeline
+ * ==================================================================== */
+static void gen_leaves_lanes(const xmss_params *p,
+                             uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N],
+                             const uint8_t *sk_seed, const uint8_t *seed,
+                             uint32_t first, const xmss_adrs_t *adrs)
+{
+    xmss_lanes_t wots_pk[XMSS_MAX_WOTS_LEN];
+    xmss_lanes_t root;
+    xmss_adrs_t  a[XMSS_HASH_LANES];
+    uint32_t     l;
+
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        a[l] = *adrs;
+        xmss_adrs_set_type(&a[l], XMSS_ADRS_TYPE_OTS);
+        xmss_adrs_set_ots(&a[l], first + l);
+    }
+    wots_gen_pk_lanes(p, wots_pk, sk_seed, seed, a);
+
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        a[l] = *adrs;
+        xmss_adrs_set_type(&a[l], XMSS_ADRS_TYPE_LTREE);
+        xmss_adrs_set_ltree(&a[l], first + l);
+    }
+    l_tree_lanes(p, &root, wots_pk, seed, a);
+
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        xmss_lanes_store(p, leaves[l], &root, l);
+    }
+}
+
+/* ====================================================================
+ * treehash_gen_leaves() - Up to XMSS_HASH_LANES leaves, lanes or one at
+ * a time
+ *
+ * The two paths are separate frames so the scalar one does not also
+ * reserve the lane buffers (see test_footprint).  A short batch (the
+ * 1- and 2-leaf subtrees bds_retune() rebuilds) takes the scalar path
+ * rather than filling every lane.  LMS sets (hss.c) take the LM-OTS
+ * leaves of lmots.c.
+ * ==================================================================== */
+void treehash_gen_leaves(const xmss_params *p,
+                         uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N],
+                         const uint8_t *sk_seed, const uint8_t *seed,
+                         uint32_t first, uint32_t count, const xmss_adrs_t *adrs)
+{
+    if (p->func == XMSS_FUNC_LMS_SHA256) {
+        lms_gen_leaves(p, leaves, sk_seed, seed, first, count);
+    } else if (xmss_hash_leaf_lanes() == 1 || count < XMSS_HASH_LANES) {
+        gen_leaves_scalar(p, leaves, sk_seed, seed, first, count, adrs);
+    } else {
+        gen_leaves_lanes(p, leaves, sk_seed, seed, first, adrs);
+    }
+}
+
 /* ====================================================================
  * treehash() - Algorithm 9: iterative treehash
  *
  * Iterates over all 2^t leaves from index s to s+2^t-1.
  * For each leaf:
- *   1. Compute leaf via WOTS+ keygen + l_tree.
+ *   1. Compute leaf via WOTS+ keygen + l_tree (batched, see
+ *      treehash_gen_leaves()).
  *   2. Push onto stack with height 0.
  *   3. While top two stack elements have equal height h:
  *      - Pop them, H-merge, push result with height h+1.
@@ -64,7 +152,7 @@ void treehash(const xmss_params *p, uint8_t *root,
               uint32_t s, uint32_t t, xmss_adrs_t *adrs)
 {
     treehash_stack_t stack;
-    uint8_t  wots_pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    uint8_t  leaves[XMSS_HASH_LANES][XMSS_MAX_N];
     uint8_t  leaf[XMSS_MAX_N];
     uint8_t  lo[XMSS_MAX_N], hi[XMSS_MAX_N];
     uint32_t lo_h, hi_h;
@@ -75,16 +163,14 @@ void treehash(const xmss_params *p, uint8_t *root,
 
     /* J5: loop over t leaves (t = 2^height, bounded by 2^XMSS_MAX_H) */
     for (idx = s; idx < s + t; idx++) {
-        /* Compute leaf = l_tree(WOTS_genPK(SK_SEED, SEED, OTS_ADRS)) */
-        a = *adrs;
-        xmss_adrs_set_type(&a, XMSS_ADRS_TYPE_OTS);
-        xmss_adrs_set_ots(&a, idx);
-        wots_gen_pk(p, wots_pk, sk_seed, seed, &a);
-
-        a = *adrs;
-        xmss_adrs_set_type(&a, XMSS_ADRS_TYPE_LTREE);
-        xmss_adrs_set_ltree(&a, idx);
-        l_tree(p, leaf, wots_pk, seed, &a);
+        /* Compute leaf = l_tree(WOTS_genPK(SK_SEED, SEED, OTS_ADRS)),
+         * XMSS_HASH_LANES leaves at a time */
+        if ((idx - s) % XMSS_HASH_LANES == 0) {
+            uint32_t left = s + t - idx;
+            treehash_gen_leaves(p, leaves, sk_seed, seed, idx,
+                                left < XMSS_HASH_LANES ? left : XMSS_HASH_LANES, adrs);
+        }
+        memcpy(leaf, leaves[(idx - s) % XMSS_HASH_LANES], p->n);
 
         /* Push leaf at height 0 */
         a = *adrs;
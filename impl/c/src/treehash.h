@@ -26,6 +26,30 @@ void treehash(const xmss_params *p, uint8_t *root,
               const uint8_t *sk_seed, const uint8_t *seed,
               uint32_t s, uint32_t t, xmss_adrs_t *adrs);
 
+/**
+ * treehash_gen_leaves() - Compute count consecutive leaves.
+ *
+ * leaves[l] = l_tree(WOTS_genPK(SK_SEED, SEED, OTS_ADRS[first + l])).
+ * A full batch runs WOTS+ keygen and the L-tree in the interleaved lane
+ * layout; this is the only point where their nodes are converted back
+ * to bytes.  With leaf_lanes = 1 selected (tune.h), or fewer than
+ * XMSS_HASH_LANES leaves asked for, the leaves are computed one at a
+ * time instead; the output is identical.
+ *
+ * @p:       Parameter set.
+ * @leaves:  Output: XMSS_HASH_LANES n-byte leaves.
+ * @sk_seed: n-byte secret seed.
+ * @seed:    n-byte public seed.
+ * @first:   Index of leaves[0].
+ * @count:   Leaves to compute, 1 .. XMSS_HASH_LANES; leaves[count..]
+ *           are left untouched.
+ * @adrs:    Tree address (layer and tree fields must be set by caller).
+ */
+void treehash_gen_leaves(const xmss_params *p,
+                         uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N],
+                         const uint8_t *sk_seed, const uint8_t *seed,
+                         uint32_t first, uint32_t count, const xmss_adrs_t *adrs);
+
 /**
  * compute_root() - Compute the tree root from a leaf and authentication path.
  *
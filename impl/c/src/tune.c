@@ -0,0 +1,221 @@
+/**
+ * tune.c - Startup backend autotuner (tune.h)
+ *
+ * Not part of the Jasmin-portable core: this translation unit reads a
+ * monotonic clock and a cache file.  Built only with -DXMSS_BUILD_TUNE=ON
+ * (library xmss_tune).
+ *
+ * Each candidate (leaf pipeline width x Keccak implementation) computes
+ * one warm-up batch of XMSS_HASH_LANES leaves with treehash_gen_leaves(),
+ * then TUNE_ROUNDS timed batches; the fastest batch is its score.  Leaf
+ * generation is where keygen, BDS updates and MT subtree rebuilds spend
+ * their time, and it exercises F, H and PRF_keygen in signing proportions.
+ *
+ * Cache file: one line per OID,
+ *     xmss-tune v1 oid=0x00000001 host=L4-k1-s0-c8 lanes=4 keccak=0
+ * where host fingerprints what the choice depends on (XMSS_HASH_LANES,
+ * available Keccak kernels, SHA-2 provider, online CPUs).  Lines for other
+ * OIDs are kept when an entry is rewritten; malformed lines are dropped.
+ */
+#define _POSIX_C_SOURCE 200112L
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/xmss/tune.h"
+#include "../include/xmss/params.h"
+#include "treehash.h"
+#include "address.h"
+
+#define TUNE_ROUNDS     3U
+#define TUNE_LINE       128U
+#define TUNE_MAX_LINES  64U
+#define TUNE_PATH       1024U
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void host_id(char *out, size_t len, const xmss_backend_info *b)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    snprintf(out, len, "L%u-k%u-s%u-c%ld",
+             (unsigned)b->max_lanes, (unsigned)b->keccak_avail,
+             (unsigned)b->sha2, cpus > 0 ? cpus : 0L);
+}
+
+/* Parse one cache line; returns 1 if well-formed. */
+static int parse_line(const char *line, uint32_t *oid, char host[64],
+                      uint32_t *lanes, uint32_t *keccak)
+{
+    unsigned o, l, k;
+    if (sscanf(line, "xmss-tune v1 oid=0x%8x host=%63s lanes=%u keccak=%u",
+               &o, host, &l, &k) != 4) {
+        return 0;
+    }
+    *oid = o; *lanes = l; *keccak = k;
+    return 1;
+}
+
+/* Look up p->oid for this host; on a usable hit fill *sel and return 1. */
+static int cache_lookup(const char *path, uint32_t oid, const char *host,
+                        xmss_backend_info *sel)
+{
+    char     line[TUNE_LINE], h[64];
+    uint32_t o, l, k;
+    FILE    *f = fopen(path, "r");
+    int      hit = 0;
+
+    if (f == NULL) {
+        return 0;
+    }
+    while (!hit && fgets(line, sizeof(line), f) != NULL) {
+        if (parse_line(line, &o, h, &l, &k) && o == oid && strcmp(h, host) == 0) {
+            sel->leaf_lanes = l;
+            sel->keccak     = k;
+            hit = 1;
+        }
+    }
+    fclose(f);
+    return hit;
+}
+
+/* Rewrite the cache with this OID's entry replaced; tmp file + rename. */
+static void cache_store(const char *path, uint32_t oid, const char *host,
+                        const xmss_backend_info *sel)
+{
+    char     keep[TUNE_MAX_LINES][TUNE_LINE];
+    char     line[TUNE_LINE], h[64], tmp[TUNE_PATH];
+    uint32_t o, l, k, n = 0, i;
+    FILE    *f;
+
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        return;
+    }
+    f = fopen(path, "r");
+    if (f != NULL) {
+        while (n < TUNE_MAX_LINES - 1 && fgets(line, sizeof(line), f) != NULL) {
+            if (parse_line(line, &o, h, &l, &k) && o != oid) {
+                memcpy(keep[n++], line, sizeof(line));
+            }
+        }
+        fclose(f);
+    }
+
+    f = fopen(tmp, "w");
+    if (f == NULL) {
+        return;
+    }
+    for (i = 0; i < n; i++) {
+        fputs(keep[i], f);
+    }
+    fprintf(f, "xmss-tune v1 oid=0x%08x host=%s lanes=%u keccak=%u\n",
+            (unsigned)oid, host, (unsigned)sel->leaf_lanes, (unsigned)sel->keccak);
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        remove(tmp);
+    }
+}
+
+/* Best batch time of the current selection, per leaf. */
+static uint64_t time_candidate(const xmss_params *p, const uint8_t *sk_seed,
+                               const uint8_t *seed)
+{
+    uint8_t     leaves[XMSS_HASH_LANES][XMSS_MAX_N];
+    xmss_adrs_t adrs;
+    uint64_t    best = UINT64_MAX, t;
+    uint32_t    r;
+
+    memset(&adrs, 0, sizeof(adrs));
+    treehash_gen_leaves(p, leaves, sk_seed, seed, 0, XMSS_HASH_LANES, &adrs);
+    for (r = 0; r < TUNE_ROUNDS; r++) {
+        t = now_ns();
+        treehash_gen_leaves(p, leaves, sk_seed, seed, (r + 1) * XMSS_HASH_LANES,
+                            XMSS_HASH_LANES, &adrs);
+        t = now_ns() - t;
+        if (t < best) {
+            best = t;
+        }
+    }
+    return best / XMSS_HASH_LANES + 1;
+}
+
+int xmss_autotune(const xmss_params *p, const char *cache_path,
+                  xmss_backend_info *out)
+{
+    xmss_backend_info b, c, best;
+    uint8_t           sk_seed[XMSS_MAX_N], seed[XMSS_MAX_N];
+    uint32_t          lanes[2], nl, i, k, cand, idx;
+    char              host[64];
+
+    if (p == NULL) {
+        return XMSS_ERR_PARAMS;
+    }
+    xmss_backend_get(&b);
+    host_id(host, sizeof(host), &b);
+
+    if (cache_path != NULL) {
+        c = b;
+        if (cache_lookup(cache_path, p->oid, host, &c)) {
+            c.source = XMSS_TUNE_CACHED;
+            c.oid    = p->oid;
+            memset(c.ns_per_leaf, 0, sizeof(c.ns_per_leaf));
+            if (xmss_backend_set(&c) == XMSS_OK) {
+                if (out != NULL) { xmss_backend_get(out); }
+                return XMSS_OK;
+            }
+        }
+    }
+
+    /* Timing inputs are public, fixed bytes: nothing secret is hashed */
+    memset(sk_seed, 0x5a, sizeof(sk_seed));
+    memset(seed, 0xa5, sizeof(seed));
+
+    lanes[0] = XMSS_HASH_LANES;
+    lanes[1] = 1;
+    nl = XMSS_HASH_LANES > 1 ? 2U : 1U;
+
+    best = b;
+    best.source = XMSS_TUNE_MEASURED;
+    best.oid    = p->oid;
+    memset(best.ns_per_leaf, 0, sizeof(best.ns_per_leaf));
+    idx = XMSS_TUNE_CANDIDATES;
+
+    for (i = 0; i < nl; i++) {
+        for (k = 0; k < 2; k++) {
+            /* Keccak only matters for SHAKE; SHA-2 keeps the build default */
+            if (((b.keccak_avail >> k) & 1U) == 0 ||
+                (p->func == XMSS_FUNC_SHA2 && k != b.keccak)) {
+                continue;
+            }
+            c = b;
+            c.leaf_lanes = lanes[i];
+            c.keccak     = k;
+            if (xmss_backend_set(&c) != XMSS_OK) {
+                continue;
+            }
+            c.ns_per_leaf[0] = time_candidate(p, sk_seed, seed);
+            cand = (lanes[i] > 1 ? 2U : 0U) + k;
+            best.ns_per_leaf[cand] = c.ns_per_leaf[0];
+            if (idx == XMSS_TUNE_CANDIDATES ||
+                c.ns_per_leaf[0] < best.ns_per_leaf[idx]) {
+                idx = cand;
+                best.leaf_lanes = lanes[i];
+                best.keccak     = k;
+            }
+        }
+    }
+
+    xmss_backend_set(&best);
+    if (cache_path != NULL) {
+        cache_store(cache_path, p->oid, host, &best);
+    }
+    if (out != NULL) {
+        xmss_backend_get(out);
+    }
+    return XMSS_OK;
+}
@@ -0,0 +1,77 @@
+/**
+ * verify_batch.c - Chunk preparation shared by the batch verifiers
+ *
+ * J3: No malloc; the chunk lives on the caller's stack.
+ * J5: Loops bounded by XMSS_VERIFY_CHUNK and WOTS_SCHED_JOBS.
+ */
+#include <string.h>
+#include <stdint.h>
+
+#include "verify_batch.h"
+#include "../include/xmss/xmss.h"
+#include "utils.h"
+#include "wots.h"
+#include "sk_offsets.h"
+
+int xmss_verify_decode(const xmss_params *p, const uint8_t *sig,
+                       const uint8_t *pk, uint64_t *idx)
+{
+    /* Validate PK OID matches params */
+    if ((uint32_t)bytes_to_ull(pk, 4) != p->oid) { return XMSS_ERR_VERIFY; }
+
+    /* Extract index */
+    *idx = bytes_to_ull(sig, p->idx_bytes);
+
+    /* Sanity check */
+    if (*idx > p->idx_max) { return XMSS_ERR_VERIFY; }
+    return XMSS_OK;
+}
+
+int xmss_verify_chunk_hash(const xmss_params *p, xmss_verify_chunk *c,
+                           size_t base, size_t end,
+                           const uint8_t *const *msgs, const size_t *msglens,
+                           const uint8_t *const *sigs, const uint8_t *const *pks,
+                           int *results)
+{
+    size_t   i;
+    uint32_t k = 0;
+    int      all = XMSS_OK;
+
+    /* J5: end - base <= XMSS_VERIFY_CHUNK */
+    for (i = base; i < end; i++) {
+        uint64_t idx;
+        if (xmss_verify_decode(p, sigs[i], pks[i], &idx) != XMSS_OK) {
+            if (results) { results[i] = XMSS_ERR_VERIFY; }
+            all = XMSS_ERR_VERIFY;
+            continue;
+        }
+        c->in[k].r      = sigs[i] + p->idx_bytes;
+        c->in[k].root   = pks[i] + pk_off_root(p);
+        c->in[k].idx    = idx;
+        c->in[k].msg    = msglens[i] > 0 ? msgs[i] : NULL;
+        c->in[k].msglen = msglens[i];
+        c->slot[k] = (uint32_t)(i - base);
+        k++;
+    }
+    c->count = k;
+
+    xmss_H_msg_multi(p, c->m_hash, c->in, k);
+    return all;
+}
+
+uint32_t xmss_verify_chunk_run(const xmss_params *p, const xmss_verify_chunk *c,
+                               uint32_t j, size_t base,
+                               const uint8_t *const *pks)
+{
+    const uint8_t *seed = pks[base + c->slot[j]] + pk_off_seed(p);
+    uint32_t       run  = 1;
+
+    if (xmss_hash_leaf_lanes() > 1 && xmss_hash_lanes_native(p)) {
+        /* J5: run < WOTS_SCHED_JOBS */
+        while (j + run < c->count && run < WOTS_SCHED_JOBS &&
+               memcmp(pks[base + c->slot[j + run]] + pk_off_seed(p), seed, p->n) == 0) {
+            run++;
+        }
+    }
+    return run;
+}
@@ -0,0 +1,70 @@
+/**
+ * verify_batch.h - Chunk preparation shared by the batch verifiers
+ *
+ * xmss_verify_batch() and xmss_mt_verify_batch() walk their items in
+ * chunks of XMSS_VERIFY_CHUNK: decode every item, run the chunk's
+ * message hashes through xmss_H_msg_multi(), then finish each run of
+ * items under one public key with their own tree walk.
+ */
+#ifndef XMSS_VERIFY_BATCH_H
+#define XMSS_VERIFY_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/xmss/params.h"
+#include "hash/hash_iface.h"
+
+#define XMSS_VERIFY_CHUNK 16U
+
+/**
+ * xmss_verify_chunk - One chunk's decoded items and message hashes.
+ *
+ * Entry k (k < count) is item base + slot[k]; its m_hash is at
+ * m_hash + k*n and its index at in[k].idx.  Items that failed to
+ * decode have no entry.
+ */
+typedef struct {
+    xmss_hmsg_input in[XMSS_VERIFY_CHUNK];
+    uint32_t        slot[XMSS_VERIFY_CHUNK];
+    uint8_t         m_hash[XMSS_VERIFY_CHUNK * XMSS_MAX_N];
+    uint32_t        count;
+} xmss_verify_chunk;
+
+/**
+ * xmss_verify_decode() - Check the PK OID and extract the signature index.
+ *
+ * The signature and public key layouts agree up to the auth paths, so
+ * one decode serves XMSS and XMSS-MT.
+ *
+ * Return: XMSS_OK, or XMSS_ERR_VERIFY on a wrong OID or out-of-range idx.
+ */
+int xmss_verify_decode(const xmss_params *p, const uint8_t *sig,
+                       const uint8_t *pk, uint64_t *idx);
+
+/**
+ * xmss_verify_chunk_hash() - Decode items [base, end) and hash their messages.
+ *
+ * Items that fail to decode get XMSS_ERR_VERIFY in results (if non-NULL).
+ * A zero-length message is never read, so its pointer may be NULL.
+ *
+ * @end: At most base + XMSS_VERIFY_CHUNK.
+ *
+ * Return: XMSS_OK if every item decoded, XMSS_ERR_VERIFY otherwise.
+ */
+int xmss_verify_chunk_hash(const xmss_params *p, xmss_verify_chunk *c,
+                           size_t base, size_t end,
+                           const uint8_t *const *msgs, const size_t *msglens,
+                           const uint8_t *const *sigs, const uint8_t *const *pks,
+                           int *results);
+
+/**
+ * xmss_verify_chunk_run() - Length of the run of entries from j under one SEED.
+ *
+ * At most WOTS_SCHED_JOBS; always 1 unless several leaf lanes are in
+ * use and the lane kernel is native (xmss_hash_lanes_native()).
+ */
+uint32_t xmss_verify_chunk_run(const xmss_params *p, const xmss_verify_chunk *c,
+                               uint32_t j, size_t base,
+                               const uint8_t *const *pks);
+
+#endif /* XMSS_VERIFY_BATCH_H */
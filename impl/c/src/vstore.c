@@ -0,0 +1,412 @@
+/**
+ * vstore.c - Memory-mapped store of verify contexts (vstore.h)
+ *
+ * Not part of the Jasmin-portable core: talks to the OS (open, flock,
+ * mmap, rename).  Built only with -DXMSS_BUILD_VSTORE=ON.
+ *
+ * Publication order for readers in other processes: a record is written,
+ * then the count (release), then its slot (release); a lookup loads the
+ * slot and the count with acquire and ignores an index not yet counted.
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/xmss/vstore.h"
+#include "utils.h"
+
+#define VS_HDR        64U
+#define VS_ENDIAN     0x01020304U
+#define VS_MIN_SLOTS  64U
+#define VS_MAX_SLOTS  ((uint32_t)1 << 26)
+
+static const uint8_t vs_magic[8] = { 'X', 'M', 'S', 'S', 'V', 'C', 'X', '1' };
+
+/* Header, host byte order */
+typedef struct {
+    uint8_t  magic[8];
+    uint32_t endian;
+    uint32_t rec_bytes;   /* sizeof(xmss_vctx) */
+    uint32_t slots;       /* power of two; records hold slots / 2 */
+    uint32_t count;
+    uint8_t  zero[VS_HDR - 24];
+} vs_header;
+
+static vs_header *vs_hdr(const xmss_vstore *vs)
+{
+    return (vs_header *)vs->base;
+}
+
+static uint32_t *vs_slots(const xmss_vstore *vs)
+{
+    return (uint32_t *)(vs->base + VS_HDR);
+}
+
+static xmss_vctx *vs_recs(const xmss_vstore *vs, uint32_t slots)
+{
+    return (xmss_vctx *)(vs->base + VS_HDR + (size_t)slots * 4U);
+}
+
+static size_t vs_file_size(uint32_t slots)
+{
+    return VS_HDR + (size_t)slots * 4U + (size_t)(slots / 2U) * sizeof(xmss_vctx);
+}
+
+/* Root bytes are hash output; fold in the OID so equal roots of different sets spread */
+static uint32_t vs_hash(const uint8_t *pk)
+{
+    uint64_t h = bytes_to_ull(pk + 4, 8) ^ (bytes_to_ull(pk, 4) * 0x9E3779B97F4A7C15ULL);
+
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+/* Range checks before a record reaches the verifier's fixed-size buffers */
+static int vctx_sane(const xmss_vctx *c)
+{
+    const xmss_params *p = &c->params;
+
+    return p->func <= XMSS_FUNC_SHAKE256 &&
+           p->n >= 16 && p->n <= XMSS_MAX_N &&
+           ((p->w == 4 && p->log2_w == 2) || (p->w == 16 && p->log2_w == 4) ||
+            (p->w == 256 && p->log2_w == 8)) &&
+           p->len == p->len1 + p->len2 && p->len <= XMSS_MAX_WOTS_LEN &&
+           p->d >= 1 && p->d <= XMSS_MAX_D &&
+           p->tree_height >= 1 && p->tree_height <= XMSS_MAX_H &&
+           p->h == p->tree_height * p->d &&
+           p->idx_bytes >= 1 && p->idx_bytes <= 8 &&
+           p->pk_bytes == 4 + 2 * p->n &&
+           (uint32_t)bytes_to_ull(c->pk, 4) == p->oid;
+}
+
+static int same_set(const xmss_params *a, const xmss_params *b)
+{
+    return a->oid == b->oid && a->func == b->func && a->n == b->n &&
+           a->w == b->w && a->h == b->h && a->d == b->d;
+}
+
+static void vs_unmap(xmss_vstore *vs)
+{
+    if (vs->base != NULL) {
+        munmap(vs->base, vs->size);
+    }
+    if (vs->fd >= 0) {
+        close(vs->fd);
+    }
+    vs->base = NULL;
+    vs->size = 0;
+    vs->fd   = -1;
+}
+
+/* Map an open store file and check its header */
+static int vs_map(xmss_vstore *vs, int fd, int writable)
+{
+    const vs_header *h;
+    struct stat      st;
+    void            *m;
+
+    vs->fd = fd;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < VS_HDR) {
+        return XMSS_ERR_IO;
+    }
+    m = mmap(NULL, (size_t)st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+             MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED) {
+        return XMSS_ERR_IO;
+    }
+    vs->base = (uint8_t *)m;
+    vs->size = (size_t)st.st_size;
+    vs->dev  = (uint64_t)st.st_dev;
+    vs->ino  = (uint64_t)st.st_ino;
+
+    h = vs_hdr(vs);
+    if (memcmp(h->magic, vs_magic, sizeof(vs_magic)) != 0 ||
+        h->endian != VS_ENDIAN || h->rec_bytes != (uint32_t)sizeof(xmss_vctx) ||
+        h->slots < VS_MIN_SLOTS || h->slots > VS_MAX_SLOTS ||
+        (h->slots & (h->slots - 1)) != 0 || h->count > h->slots / 2U ||
+        vs->size != vs_file_size(h->slots)) {
+        return XMSS_ERR_IO;
+    }
+    /* Lookups hash all over the table */
+    (void)madvise(vs->base, vs->size, MADV_RANDOM);
+    return XMSS_OK;
+}
+
+static int vs_open_file(xmss_vstore *vs, int writable)
+{
+    int fd = open(vs->path, writable ? O_RDWR : O_RDONLY);
+    int rc;
+
+    if (fd < 0) {
+        return XMSS_ERR_IO;
+    }
+    if (writable && flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return XMSS_ERR_IO;
+    }
+    rc = vs_map(vs, fd, writable);
+    if (rc != XMSS_OK) {
+        vs_unmap(vs);
+    }
+    return rc;
+}
+
+/* Link record idx into the table of @slots slots */
+static void vs_link(uint32_t *slot, uint32_t slots, const xmss_vctx *rec, uint32_t idx)
+{
+    uint32_t i = vs_hash(rec->pk) & (slots - 1);
+
+    while (slot[i] != 0) {
+        i = (i + 1) & (slots - 1);
+    }
+    __atomic_store_n(&slot[i], idx + 1, __ATOMIC_RELEASE);
+}
+
+/* Fill a fresh, locked file of @slots slots at nv->fd with vs's records */
+static int vs_fill(xmss_vstore *nv, const xmss_vstore *vs, uint32_t slots)
+{
+    size_t      size  = vs_file_size(slots);
+    uint32_t    count = vs->base != NULL ? vs_hdr(vs)->count : 0;
+    vs_header  *h;
+    struct stat st;
+    uint32_t    i;
+    void       *m;
+
+    if (flock(nv->fd, LOCK_EX | LOCK_NB) != 0 || ftruncate(nv->fd, (off_t)size) != 0) {
+        return XMSS_ERR_IO;
+    }
+    m = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, nv->fd, 0);
+    if (m == MAP_FAILED) {
+        return XMSS_ERR_IO;
+    }
+    nv->base = (uint8_t *)m;
+    nv->size = size;
+
+    /* ftruncate() zero-filled the slots and records */
+    h = vs_hdr(nv);
+    memcpy(h->magic, vs_magic, sizeof(vs_magic));
+    h->endian    = VS_ENDIAN;
+    h->rec_bytes = (uint32_t)sizeof(xmss_vctx);
+    h->slots     = slots;
+    h->count     = count;
+    if (count > 0) {
+        memcpy(vs_recs(nv, slots), vs_recs(vs, vs_hdr(vs)->slots),
+               (size_t)count * sizeof(xmss_vctx));
+    }
+    /* J5: count <= slots / 2 records */
+    for (i = 0; i < count; i++) {
+        vs_link(vs_slots(nv), slots, &vs_recs(nv, slots)[i], i);
+    }
+    if (msync(nv->base, size, MS_SYNC) != 0 || fsync(nv->fd) != 0 ||
+        fstat(nv->fd, &st) != 0) {
+        return XMSS_ERR_IO;
+    }
+    nv->dev = (uint64_t)st.st_dev;
+    nv->ino = (uint64_t)st.st_ino;
+    (void)madvise(nv->base, size, MADV_RANDOM);
+    return XMSS_OK;
+}
+
+/*
+ * Write a store of @slots slots holding the current records (none if
+ * vs is not mapped) to path.tmp, rename it over path and switch the
+ * handle to it.  The new file is locked before it becomes visible.
+ */
+static int vs_rebuild(xmss_vstore *vs, uint32_t slots)
+{
+    char        tmp[XMSS_VSTORE_PATH_MAX + 4];
+    size_t      len = strlen(vs->path);
+    xmss_vstore nv;
+    int         rc;
+
+    memcpy(tmp, vs->path, len);
+    memcpy(tmp + len, ".tmp", 5);
+
+    memset(&nv, 0, sizeof(nv));
+    memcpy(nv.path, vs->path, sizeof(nv.path));
+    nv.writable = 1;
+    nv.fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (nv.fd < 0) {
+        return XMSS_ERR_IO;
+    }
+    rc = vs_fill(&nv, vs, slots);
+    if (rc == XMSS_OK && rename(tmp, vs->path) != 0) {
+        rc = XMSS_ERR_IO;
+    }
+    if (rc != XMSS_OK) {
+        vs_unmap(&nv);
+        unlink(tmp);
+        return rc;
+    }
+    vs_unmap(vs);
+    *vs = nv;
+    return XMSS_OK;
+}
+
+int xmss_vstore_open(xmss_vstore *vs, const char *path, int flags)
+{
+    size_t len = strlen(path);
+    int    writable = (flags & XMSS_VSTORE_WRITE) != 0;
+
+    memset(vs, 0, sizeof(*vs));
+    vs->fd = -1;
+    if (len == 0 || len >= XMSS_VSTORE_PATH_MAX) {
+        return XMSS_ERR_PARAMS;
+    }
+    memcpy(vs->path, path, len + 1);
+    vs->writable = writable;
+
+    if (writable && access(path, F_OK) != 0) {
+        return vs_rebuild(vs, VS_MIN_SLOTS);
+    }
+    return vs_open_file(vs, writable);
+}
+
+const xmss_vctx *xmss_vstore_find(const xmss_vstore *vs,
+                                  const uint8_t *pk, size_t pklen)
+{
+    const uint32_t  *slot;
+    const xmss_vctx *recs, *c;
+    uint32_t         slots, i, probe, s;
+
+    if (vs->base == NULL || pklen < 12 || pklen > XMSS_VSTORE_PK_MAX) {
+        return NULL;
+    }
+    slots = vs_hdr(vs)->slots;
+    slot  = vs_slots(vs);
+    recs  = vs_recs(vs, slots);
+    i     = vs_hash(pk) & (slots - 1);
+
+    /* J5: at most slots probes; the table is never more than half full */
+    for (probe = 0; probe < slots; probe++) {
+        s = __atomic_load_n(&slot[i], __ATOMIC_ACQUIRE);
+        if (s == 0) {
+            return NULL;
+        }
+        if (s <= __atomic_load_n(&vs_hdr(vs)->count, __ATOMIC_ACQUIRE)) {
+            c = &recs[s - 1];
+            if (c->params.pk_bytes == pklen && memcmp(c->pk, pk, pklen) == 0) {
+                return vctx_sane(c) ? c : NULL;
+            }
+        }
+        i = (i + 1) & (slots - 1);
+    }
+    return NULL;
+}
+
+int xmss_vstore_add(xmss_vstore *vs, const xmss_params *p, const uint8_t *pk)
+{
+    const xmss_vctx *old;
+    xmss_vctx       *rec;
+    vs_header       *h;
+    uint32_t         idx;
+    int              rc;
+
+    if (vs->base == NULL || !vs->writable || p->func > XMSS_FUNC_SHAKE256 ||
+        p->pk_bytes != 4 + 2 * p->n || p->pk_bytes > XMSS_VSTORE_PK_MAX ||
+        (uint32_t)bytes_to_ull(pk, 4) != p->oid) {
+        return XMSS_ERR_PARAMS;
+    }
+    old = xmss_vstore_find(vs, pk, p->pk_bytes);
+    if (old != NULL) {
+        return same_set(&old->params, p) ? XMSS_OK : XMSS_ERR_PARAMS;
+    }
+
+    h = vs_hdr(vs);
+    if (h->count == h->slots / 2U) {
+        if (h->slots == VS_MAX_SLOTS) {
+            return XMSS_ERR_IO;
+        }
+        rc = vs_rebuild(vs, h->slots * 2U);
+        if (rc != XMSS_OK) {
+            return rc;
+        }
+        h = vs_hdr(vs);
+    }
+
+    idx = h->count;
+    rec = &vs_recs(vs, h->slots)[idx];
+    memset(rec, 0, sizeof(*rec));
+    rec->params = *p;
+    memcpy(rec->pk, pk, p->pk_bytes);
+    __atomic_store_n(&h->count, idx + 1, __ATOMIC_RELEASE);
+    vs_link(vs_slots(vs), h->slots, rec, idx);
+    return XMSS_OK;
+}
+
+int xmss_vstore_verify(const xmss_vstore *vs,
+                       const uint8_t *msg, size_t msglen,
+                       const uint8_t *sig,
+                       const uint8_t *pk, size_t pklen)
+{
+    const xmss_vctx *c = xmss_vstore_find(vs, pk, pklen);
+
+    if (c == NULL) {
+        return XMSS_ERR_VERIFY;
+    }
+    return c->params.d > 1 ? xmss_mt_verify(&c->params, msg, msglen, sig, c->pk)
+                           : xmss_verify(&c->params, msg, msglen, sig, c->pk);
+}
+
+uint32_t xmss_vstore_count(const xmss_vstore *vs)
+{
+    if (vs->base == NULL) {
+        return 0;
+    }
+    return __atomic_load_n(&vs_hdr(vs)->count, __ATOMIC_ACQUIRE);
+}
+
+int xmss_vstore_refresh(xmss_vstore *vs)
+{
+    xmss_vstore nv;
+    struct stat st;
+    int         rc;
+
+    /* The writer renamed the current file into place itself */
+    if (vs->writable) {
+        return XMSS_OK;
+    }
+    if (stat(vs->path, &st) != 0) {
+        return XMSS_ERR_IO;
+    }
+    if ((uint64_t)st.st_dev == vs->dev && (uint64_t)st.st_ino == vs->ino &&
+        vs->base != NULL) {
+        return XMSS_OK;
+    }
+    memset(&nv, 0, sizeof(nv));
+    nv.fd = -1;
+    memcpy(nv.path, vs->path, sizeof(nv.path));
+    rc = vs_open_file(&nv, 0);
+    if (rc != XMSS_OK) {
+        return rc;
+    }
+    vs_unmap(vs);
+    *vs = nv;
+    return XMSS_OK;
+}
+
+int xmss_vstore_sync(xmss_vstore *vs)
+{
+    if (vs->base == NULL || !vs->writable) {
+        return XMSS_OK;
+    }
+    return msync(vs->base, vs->size, MS_SYNC) == 0 && fsync(vs->fd) == 0
+           ? XMSS_OK : XMSS_ERR_IO;
+}
+
+void xmss_vstore_close(xmss_vstore *vs)
+{
+    if (vs->base == NULL) {
+        return;
+    }
+    (void)xmss_vstore_sync(vs);
+    vs_unmap(vs);
+}
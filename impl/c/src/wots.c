@@ -96,19 +96,8 @@ static void gen_chain(const xmss_params *p,
                       uint32_t start, uint32_t steps,
                       const uint8_t *seed, xmss_adrs_t *adrs)
 {
-    uint8_t  tmp[XMSS_MAX_N];
-    uint32_t i;
-
-    memcpy(tmp, in, p->n);
-
-    /* J5: loop bound = steps <= w-1 <= 15 */
-    for (i = start; i < (start + steps) && i < p->w; i++) {
-        xmss_adrs_set_hash(adrs, i);
-        xmss_adrs_set_key_and_mask(adrs, 0);
-        xmss_F(p, tmp, seed, adrs, tmp);
-    }
-
-    memcpy(out, tmp, p->n);
+    /* JASMIN: replace with direct call (one per chain) */
+    xmss_F_chain(p, out, in, start, steps, seed, adrs);
 }
 
 /* ====================================================================
@@ -168,6 +157,38 @@ void wots_gen_pk(const xmss_params *p, uint8_t *pk,
     xmss_memzero(sk, sizeof(sk));
 }
 
+/* ====================================================================
+ * wots_gen_pk_lanes() - Alg 4 on XMSS_HASH_LANES OTS addresses at once
+ *
+ * Each chain is seeded and run to w-1 in place; unlike wots_gen_pk()
+ * the secret elements are never materialised as a separate array.
+ * ==================================================================== */
+void wots_gen_pk_lanes(const xmss_params *p, xmss_lanes_t *pk,
+                       const uint8_t *sk_seed, const uint8_t *seed,
+                       const xmss_adrs_t *adrs)
+{
+    xmss_adrs_t a[XMSS_HASH_LANES];
+    uint32_t i, j, l;
+
+    /* J5: len bounded by XMSS_MAX_WOTS_LEN, steps by w-1 */
+    for (i = 0; i < p->len; i++) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            a[l] = adrs[l];
+            xmss_adrs_set_chain(&a[l], i);
+            xmss_adrs_set_hash(&a[l], 0);
+            xmss_adrs_set_key_and_mask(&a[l], 0);
+        }
+        xmss_PRF_keygen_lanes(p, &pk[i], sk_seed, seed, a);
+
+        for (j = 0; j < p->w - 1; j++) {
+            for (l = 0; l < XMSS_HASH_LANES; l++) {
+                xmss_adrs_set_hash(&a[l], j);
+            }
+            xmss_F_lanes(p, &pk[i], seed, a, &pk[i]);
+        }
+    }
+}
+
 /* ====================================================================
  * wots_sign() - Alg 5: Generate WOTS+ signature
  * ==================================================================== */
@@ -203,8 +224,115 @@ void wots_sign(const xmss_params *p, uint8_t *sig,
     xmss_memzero(sk, sizeof(sk));
 }
 
+/* ====================================================================
+ * wots_pk_from_sig_multi() - Alg 6 for several signatures on the lanes
+ *
+ * Items are (job, chain) pairs ordered by steps left, longest first,
+ * so the short chains fill the gaps at the end.  Verification only:
+ * every input is public.
+ * ==================================================================== */
+void wots_pk_from_sig_multi(const xmss_params *p, uint8_t *const *pk,
+                            const uint8_t *const *sig, const uint8_t *const *msg,
+                            const uint8_t *seed, const xmss_adrs_t *adrs,
+                            uint32_t count, wots_sched_stats *st)
+{
+    uint32_t     lengths[XMSS_MAX_WOTS_LEN];
+    uint8_t      start[WOTS_SCHED_JOBS][XMSS_MAX_WOTS_LEN];
+    uint16_t     order[WOTS_SCHED_JOBS * XMSS_MAX_WOTS_LEN];
+    uint16_t     item[XMSS_HASH_LANES];
+    uint32_t     pos[XMSS_HASH_LANES];
+    xmss_adrs_t  a[XMSS_HASH_LANES];
+    xmss_lanes_t v;
+    uint32_t     nitems = 0, next = 0, active = 0;
+    uint32_t     i, j, l, it;
+
+    /* Chain start points; chains already at w-1 are copied through */
+    for (j = 0; j < count; j++) {
+        base_w(p, lengths, p->len1, msg[j]);
+        wots_checksum(p, lengths);
+        for (i = 0; i < p->len; i++) {
+            start[j][i] = (uint8_t)lengths[i];
+            if (lengths[i] == p->w - 1) {
+                memcpy(pk[j] + i * p->n, sig[j] + i * p->n, p->n);
+            }
+        }
+    }
+
+    /* Longest first: one pass per start point (J5: w passes over at
+     * most WOTS_SCHED_JOBS * len items) */
+    for (it = 0; it + 1 < p->w; it++) {
+        for (j = 0; j < count; j++) {
+            for (i = 0; i < p->len; i++) {
+                if (start[j][i] == it) {
+                    order[nitems++] = (uint16_t)(j * p->len + i);
+                }
+            }
+        }
+    }
+
+    /* Lanes without work hash whatever they hold under lane 0's address */
+    memset(&v, 0, sizeof(v));
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        if (next < nitems) {
+            it      = order[next++];
+            j       = it / p->len;
+            i       = it % p->len;
+            item[l] = (uint16_t)it;
+            pos[l]  = start[j][i];
+            a[l]    = adrs[j];
+            xmss_adrs_set_chain(&a[l], i);
+            xmss_lanes_load(p, &v, l, sig[j] + i * p->n);
+            active++;
+        } else {
+            item[l] = UINT16_MAX;
+            a[l]    = adrs[0];
+        }
+    }
+
+    /* J5: at most ceil(count * len * (w-1) / lanes) + w rounds */
+    while (active > 0) {
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            if (item[l] != UINT16_MAX) {
+                xmss_adrs_set_hash(&a[l], pos[l]);
+                xmss_adrs_set_key_and_mask(&a[l], 0);
+            }
+        }
+        xmss_F_lanes(p, &v, seed, a, &v);
+        if (st != NULL) {
+            st->steps  += active;
+            st->rounds += 1;
+        }
+
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            if (item[l] == UINT16_MAX || ++pos[l] < p->w - 1) {
+                continue;
+            }
+            /* Chain done: store it and refill the lane */
+            j = item[l] / p->len;
+            i = item[l] % p->len;
+            xmss_lanes_store(p, pk[j] + i * p->n, &v, l);
+            if (next < nitems) {
+                it      = order[next++];
+                j       = it / p->len;
+                i       = it % p->len;
+                item[l] = (uint16_t)it;
+                pos[l]  = start[j][i];
+                a[l]    = adrs[j];
+                xmss_adrs_set_chain(&a[l], i);
+                xmss_lanes_load(p, &v, l, sig[j] + i * p->n);
+            } else {
+                item[l] = UINT16_MAX;
+                active--;
+            }
+        }
+    }
+}
+
 /* ====================================================================
  * wots_pk_from_sig() - Alg 6: Recover public key from signature
+ *
+ * On the lane scheduler when the lane pipeline is selected and has a
+ * native kernel for p, otherwise one chain at a time.
  * ==================================================================== */
 void wots_pk_from_sig(const xmss_params *p, uint8_t *pk,
                       const uint8_t *sig, const uint8_t *msg,
@@ -214,6 +342,11 @@ void wots_pk_from_sig(const xmss_params *p, uint8_t *pk,
     uint32_t i;
     xmss_adrs_t a;
 
+    if (xmss_hash_leaf_lanes() > 1 && xmss_hash_lanes_native(p)) {
+        wots_pk_from_sig_multi(p, &pk, &sig, &msg, seed, adrs, 1, NULL);
+        return;
+    }
+
     /* Recompute chain lengths */
     base_w(p, lengths, p->len1, msg);
     wots_checksum(p, lengths);
@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include "../include/xmss/params.h"
 #include "../include/xmss/types.h"
+#include "hash/hash_iface.h"
 
 /**
  * wots_gen_pk() - Generate a WOTS+ public key (RFC 8391 Alg 4).
@@ -23,6 +24,22 @@ void wots_gen_pk(const xmss_params *p, uint8_t *pk,
                  const uint8_t *sk_seed, const uint8_t *seed,
                  xmss_adrs_t *adrs);
 
+/**
+ * wots_gen_pk_lanes() - wots_gen_pk() for XMSS_HASH_LANES key pairs at once.
+ *
+ * Chain values stay word-interleaved throughout; pk[i] holds chain i of
+ * every lane.
+ *
+ * @p:       Parameter set.
+ * @pk:      Output: len lane blocks.
+ * @sk_seed: n-byte secret seed.
+ * @seed:    n-byte public seed (SEED).
+ * @adrs:    XMSS_HASH_LANES OTS addresses (OTS address set per lane).
+ */
+void wots_gen_pk_lanes(const xmss_params *p, xmss_lanes_t *pk,
+                       const uint8_t *sk_seed, const uint8_t *seed,
+                       const xmss_adrs_t *adrs);
+
 /**
  * wots_sign() - Generate a WOTS+ signature (RFC 8391 Alg 5).
  *
@@ -52,4 +69,41 @@ void wots_pk_from_sig(const xmss_params *p, uint8_t *pk,
                       const uint8_t *sig, const uint8_t *msg,
                       const uint8_t *seed, xmss_adrs_t *adrs);
 
+/* Signatures one wots_pk_from_sig_multi() call schedules together */
+#define WOTS_SCHED_JOBS 2U
+
+/**
+ * wots_sched_stats - Lane utilisation of the chain scheduler:
+ * steps / (rounds * XMSS_HASH_LANES).
+ */
+typedef struct {
+    uint64_t steps;    /* chain steps computed */
+    uint64_t rounds;   /* xmss_F_lanes() calls */
+} wots_sched_stats;
+
+/**
+ * wots_pk_from_sig_multi() - wots_pk_from_sig() for up to WOTS_SCHED_JOBS
+ * signatures under one SEED, on the lane kernel.
+ *
+ * Every chain of every signature is a work item (value, address, steps
+ * left); items go to the XMSS_HASH_LANES lanes longest first, and a lane
+ * whose chain is done is refilled at once, so lanes idle only while the
+ * last few chains finish.  wots_pk_from_sig() uses it with count 1 when
+ * the lane pipeline is selected (xmss_hash_leaf_lanes() > 1) and native
+ * for p (xmss_hash_lanes_native()).
+ *
+ * @p:     Parameter set.
+ * @pk:    count outputs, len*n bytes each.
+ * @sig:   count WOTS+ signatures, len*n bytes each.
+ * @msg:   count n-byte messages.
+ * @seed:  n-byte public seed, shared.
+ * @adrs:  count OTS addresses (OTS address set by caller).
+ * @count: 1..WOTS_SCHED_JOBS.
+ * @st:    Utilisation counters to add to, or NULL.
+ */
+void wots_pk_from_sig_multi(const xmss_params *p, uint8_t *const *pk,
+                            const uint8_t *const *sig, const uint8_t *const *msg,
+                            const uint8_t *seed, const xmss_adrs_t *adrs,
+                            uint32_t count, wots_sched_stats *st);
+
 #endif /* XMSS_WOTS_H */
@@ -24,6 +24,7 @@
 #include "treehash.h"
 #include "bds.h"
 #include "sk_offsets.h"
+#include "verify_batch.h"
 
 /* ====================================================================
  * Naive keygen/sign — gated behind XMSS_NAIVE_AUTH_PATH
@@ -147,49 +148,16 @@ uint64_t xmss_remaining_sigs(const xmss_params *p, const uint8_t *sk)
 }
 
 /* ====================================================================
- * xmss_verify() - Algorithm 14
+ * pk_root() - Root implied by a recovered WOTS+ public key (overwritten
+ * by the L-tree) and the auth path
  * ==================================================================== */
-
-int xmss_verify(const xmss_params *p,
-                const uint8_t *msg, size_t msglen,
-                const uint8_t *sig, const uint8_t *pk)
+static void pk_root(const xmss_params *p, uint8_t *root, uint8_t *wots_pk,
+                    uint64_t idx, const uint8_t *sig, const uint8_t *seed)
 {
-    uint64_t idx;
-    uint8_t  r[XMSS_MAX_N];
-    uint8_t  m_hash[XMSS_MAX_N];
-    uint8_t  wots_pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
     uint8_t  leaf[XMSS_MAX_N];
-    uint8_t  computed_root[XMSS_MAX_N];
     xmss_adrs_t adrs;
 
-    const uint8_t *pk_root = pk + pk_off_root(p);
-    const uint8_t *pk_seed = pk + pk_off_seed(p);
-    const uint8_t *sig_wots = sig + p->idx_bytes + p->n;
-    const uint8_t *auth     = sig + p->idx_bytes + p->n + p->len * p->n;
-
-    /* Validate PK OID matches params */
-    if ((uint32_t)bytes_to_ull(pk, 4) != p->oid) { return XMSS_ERR_VERIFY; }
-
-    /* Extract index */
-    idx = bytes_to_ull(sig, p->idx_bytes);
-
-    /* Sanity check */
-    if (idx > p->idx_max) { return XMSS_ERR_VERIFY; }
-
-    /* Extract r */
-    memcpy(r, sig + p->idx_bytes, p->n);
-
-    /* m_hash = H_msg(r, root, idx, msg) */
-    xmss_H_msg(p, m_hash, r, pk_root, idx, msg, msglen);
-
-    /* Recover WOTS+ public key from signature */
-    memset(&adrs, 0, sizeof(adrs));
-    xmss_adrs_set_layer(&adrs, 0);
-    xmss_adrs_set_tree(&adrs, 0);
-    xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_OTS);
-    xmss_adrs_set_ots(&adrs, (uint32_t)idx);
-
-    wots_pk_from_sig(p, wots_pk, sig_wots, m_hash, pk_seed, &adrs);
+    const uint8_t *auth = sig + p->idx_bytes + p->n + p->len * p->n;
 
     /* Compute leaf from WOTS+ pk via l_tree */
     memset(&adrs, 0, sizeof(adrs));
@@ -198,22 +166,175 @@ int xmss_verify(const xmss_params *p,
     xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_LTREE);
     xmss_adrs_set_ltree(&adrs, (uint32_t)idx);
 
-    l_tree(p, leaf, wots_pk, pk_seed, &adrs);
+    l_tree(p, leaf, wots_pk, seed, &adrs);
 
     /* Walk auth path to compute candidate root */
     memset(&adrs, 0, sizeof(adrs));
     xmss_adrs_set_layer(&adrs, 0);
     xmss_adrs_set_tree(&adrs, 0);
 
-    compute_root(p, computed_root, leaf, (uint32_t)idx, auth, pk_seed, &adrs);
+    compute_root(p, root, leaf, (uint32_t)idx, auth, seed, &adrs);
+}
+
+static void ots_adrs(xmss_adrs_t *adrs, uint64_t idx)
+{
+    memset(adrs, 0, sizeof(*adrs));
+    xmss_adrs_set_layer(adrs, 0);
+    xmss_adrs_set_tree(adrs, 0);
+    xmss_adrs_set_type(adrs, XMSS_ADRS_TYPE_OTS);
+    xmss_adrs_set_ots(adrs, (uint32_t)idx);
+}
+
+/* ====================================================================
+ * sig_root() - Root implied by a WOTS+ signature and auth path over m_hash
+ *
+ * Algorithm 14 after H_msg; shared by verification and the signer's
+ * fault check.
+ * ==================================================================== */
+static void sig_root(const xmss_params *p, uint8_t *root, const uint8_t *m_hash,
+                     uint64_t idx, const uint8_t *sig, const uint8_t *seed)
+{
+    uint8_t  wots_pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    xmss_adrs_t adrs;
+
+    /* Recover WOTS+ public key from signature */
+    ots_adrs(&adrs, idx);
+    wots_pk_from_sig(p, wots_pk, sig + p->idx_bytes + p->n, m_hash, seed, &adrs);
+
+    pk_root(p, root, wots_pk, idx, sig, seed);
+}
+
+/* ====================================================================
+ * sig_roots() - sig_root() for up to WOTS_SCHED_JOBS signatures under one
+ * SEED, their WOTS+ chains sharing the lane scheduler
+ * ==================================================================== */
+static void sig_roots(const xmss_params *p, uint8_t root[][XMSS_MAX_N],
+                      const uint8_t *const *m_hash, const uint64_t *idx,
+                      const uint8_t *const *sig, const uint8_t *seed,
+                      uint32_t count)
+{
+    uint8_t        wots_pk[WOTS_SCHED_JOBS][XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    uint8_t       *pks[WOTS_SCHED_JOBS];
+    const uint8_t *sigs_wots[WOTS_SCHED_JOBS];
+    xmss_adrs_t    adrs[WOTS_SCHED_JOBS];
+    uint32_t       j;
+
+    for (j = 0; j < count; j++) {
+        ots_adrs(&adrs[j], idx[j]);
+        pks[j]       = wots_pk[j];
+        sigs_wots[j] = sig[j] + p->idx_bytes + p->n;
+    }
+    wots_pk_from_sig_multi(p, pks, sigs_wots, m_hash, seed, adrs, count, NULL);
+
+    for (j = 0; j < count; j++) {
+        pk_root(p, root[j], wots_pk[j], idx[j], sig[j], seed);
+    }
+}
+
+/* ====================================================================
+ * verify_mhash() - Algorithm 14 once m_hash = H_msg(r, root, idx, M) is known
+ * ==================================================================== */
+static int verify_mhash(const xmss_params *p, const uint8_t *m_hash,
+                        uint64_t idx, const uint8_t *sig, const uint8_t *pk)
+{
+    uint8_t computed_root[XMSS_MAX_N];
+
+    sig_root(p, computed_root, m_hash, idx, sig, pk + pk_off_seed(p));
 
     /* Constant-time compare (J6) */
-    if (ct_memcmp(computed_root, pk_root, p->n) != 0) {
+    if (ct_memcmp(computed_root, pk + pk_off_root(p), p->n) != 0) {
         return XMSS_ERR_VERIFY;
     }
     return XMSS_OK;
 }
 
+/* ====================================================================
+ * xmss_verify() - Algorithm 14
+ * ==================================================================== */
+
+int xmss_verify(const xmss_params *p,
+                const uint8_t *msg, size_t msglen,
+                const uint8_t *sig, const uint8_t *pk)
+{
+    uint64_t idx;
+    uint8_t  m_hash[XMSS_MAX_N];
+
+    if (xmss_verify_decode(p, sig, pk, &idx) != XMSS_OK) {
+        return XMSS_ERR_VERIFY;
+    }
+
+    /* m_hash = H_msg(r, root, idx, msg) */
+    xmss_H_msg(p, m_hash, sig + p->idx_bytes, pk + pk_off_root(p), idx,
+               msg, msglen);
+
+    return verify_mhash(p, m_hash, idx, sig, pk);
+}
+
+/* ====================================================================
+ * xmss_verify_batch() - Algorithm 14 over many signatures
+ *
+ * Items are processed in chunks of XMSS_VERIFY_CHUNK: the chunk's
+ * message hashes go through the multi-buffer xmss_H_msg_multi() first
+ * (verify_batch.c), then each item finishes with the usual WOTS+ /
+ * L-tree / auth path walk.
+ * Consecutive items under one public key recover their WOTS+ keys in
+ * pairs on the chain scheduler, so no lane idles at a signature's tail.
+ * ==================================================================== */
+
+int xmss_verify_batch(const xmss_params *p, size_t count,
+                      const uint8_t *const *msgs, const size_t *msglens,
+                      const uint8_t *const *sigs, const uint8_t *const *pks,
+                      int *results)
+{
+    xmss_verify_chunk c;
+    uint8_t           roots[WOTS_SCHED_JOBS][XMSS_MAX_N];
+    size_t            base, i;
+    uint32_t          j, run;
+    int               all = XMSS_OK;
+    int               rc;
+
+    /* J5: count / XMSS_VERIFY_CHUNK chunks of at most XMSS_VERIFY_CHUNK items */
+    for (base = 0; base < count; base += XMSS_VERIFY_CHUNK) {
+        size_t end = (count - base < XMSS_VERIFY_CHUNK) ? count : base + XMSS_VERIFY_CHUNK;
+
+        if (xmss_verify_chunk_hash(p, &c, base, end, msgs, msglens,
+                                   sigs, pks, results) != XMSS_OK) {
+            all = XMSS_ERR_VERIFY;
+        }
+
+        /* Runs of items under the same public key share the chain lanes */
+        for (j = 0; j < c.count; j += run) {
+            const uint8_t *mh[WOTS_SCHED_JOBS];
+            const uint8_t *sg[WOTS_SCHED_JOBS];
+            uint64_t       ix[WOTS_SCHED_JOBS];
+            uint32_t       r;
+
+            run = xmss_verify_chunk_run(p, &c, j, base, pks);
+            if (run == 1) {
+                i  = base + c.slot[j];
+                rc = verify_mhash(p, c.m_hash + j * p->n, c.in[j].idx, sigs[i], pks[i]);
+                if (results) { results[i] = rc; }
+                if (rc != XMSS_OK) { all = XMSS_ERR_VERIFY; }
+                continue;
+            }
+            for (r = 0; r < run; r++) {
+                mh[r] = c.m_hash + (j + r) * p->n;
+                sg[r] = sigs[base + c.slot[j + r]];
+                ix[r] = c.in[j + r].idx;
+            }
+            sig_roots(p, roots, mh, ix, sg, pks[base + c.slot[j]] + pk_off_seed(p), run);
+            for (r = 0; r < run; r++) {
+                i  = base + c.slot[j + r];
+                rc = ct_memcmp(roots[r], pks[i] + pk_off_root(p), p->n) != 0
+                     ? XMSS_ERR_VERIFY : XMSS_OK;
+                if (results) { results[i] = rc; }
+                if (rc != XMSS_OK) { all = XMSS_ERR_VERIFY; }
+            }
+        }
+    }
+    return all;
+}
+
 /* ====================================================================
  * xmss_keygen() - BDS-accelerated key generation (Algorithm 10 + BDS)
  * ==================================================================== */
@@ -222,62 +343,131 @@ int xmss_keygen(const xmss_params *p, uint8_t *pk, uint8_t *sk,
                     xmss_bds_state *state, uint32_t bds_k,
                     xmss_randombytes_fn randombytes)
 {
-    uint8_t  root[XMSS_MAX_N];
-    uint8_t  seeds[3 * XMSS_MAX_N];
-    xmss_adrs_t adrs;
+    xmss_keygen_ctx kc;
     int ret;
 
-    /* Validate bds_k */
-    if ((bds_k & 1) || bds_k > p->tree_height) {
-        return XMSS_ERR_PARAMS;
+    /* Whole tree in one step: the stepped form with nothing between */
+    ret = xmss_keygen_begin(p, &kc, sk, state, bds_k, randombytes);
+    if (ret != XMSS_OK) {
+        return ret;
     }
+    xmss_keygen_step(p, &kc, pk, sk, state, bds_k, (uint32_t)1 << p->tree_height);
+    return XMSS_OK;
+}
 
-    /* Sample 3n random bytes: SK_SEED, SK_PRF, SEED */
-    ret = randombytes(seeds, 3 * p->n);
-    if (ret != 0) { return XMSS_ERR_ENTROPY; }
-
-    /* Zero the BDS state */
-    memset(state, 0, sizeof(*state));
+/* ====================================================================
+ * xmss_keygen_begin() / xmss_keygen_step() - xmss_keygen() in steps
+ *
+ * The tree is grown with bds_state_build() on the state's own stack and
+ * sealed into the form bds_treehash_init() leaves.
+ * ==================================================================== */
 
-    /* Compute tree root with BDS state capture */
-    memset(&adrs, 0, sizeof(adrs));
-    xmss_adrs_set_layer(&adrs, 0);
-    xmss_adrs_set_tree(&adrs, 0);
+int xmss_keygen_begin(const xmss_params *p, xmss_keygen_ctx *kc,
+                      uint8_t *sk, xmss_bds_state *state, uint32_t bds_k,
+                      xmss_randombytes_fn randombytes)
+{
+    uint8_t seeds[3 * XMSS_MAX_N];
 
-    bds_treehash_init(p, root, state, bds_k,
-                      seeds,           /* SK_SEED */
-                      seeds + 2*p->n,  /* SEED */
-                      &adrs);
+    if ((bds_k & 1) || bds_k > p->tree_height) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (randombytes(seeds, 3 * p->n) != 0) {
+        return XMSS_ERR_ENTROPY;
+    }
 
-    /* Serialise PK */
-    ull_to_bytes(pk, 4, p->oid);
-    memcpy(pk + pk_off_root(p), root, p->n);
-    memcpy(pk + pk_off_seed(p), seeds + 2*p->n, p->n);
+    memset(state, 0, sizeof(*state));
+    kc->trees = 0;
 
-    /* Serialise SK */
     ull_to_bytes(sk + sk_off_oid(p),  4,            p->oid);
     ull_to_bytes(sk + sk_off_idx(p),  p->idx_bytes, 0);
     memcpy(sk + sk_off_seed(p),     seeds,          p->n);
     memcpy(sk + sk_off_prf(p),      seeds + p->n,   p->n);
-    memcpy(sk + sk_off_root(p),     root,            p->n);
+    memset(sk + sk_off_root(p),     0,              p->n);
     memcpy(sk + sk_off_pub_seed(p), seeds + 2*p->n, p->n);
 
     xmss_memzero(seeds, sizeof(seeds));
     return XMSS_OK;
 }
 
+int xmss_keygen_step(const xmss_params *p, xmss_keygen_ctx *kc,
+                     uint8_t *pk, uint8_t *sk, xmss_bds_state *state,
+                     uint32_t bds_k, uint32_t leaves)
+{
+    xmss_adrs_t adrs;
+    uint32_t left;
+
+    if (leaves == 0) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (kc->trees == 1) {
+        return 0;
+    }
+
+    memset(&adrs, 0, sizeof(adrs));
+    left = bds_state_build(p, state, bds_k, leaves,
+                           sk + sk_off_seed(p), sk + sk_off_pub_seed(p), &adrs);
+    if (left > 0) {
+        return (int)left;
+    }
+
+    /* Root off the stack; the state is then as xmss_keygen() leaves it */
+    bds_state_seal(p, state, bds_k);
+    memcpy(sk + sk_off_root(p), state->stack[0], p->n);
+    memset(state->stack[0], 0, sizeof(state->stack[0]));
+    state->stack_levels[0] = 0;
+    state->stack_offset    = 0;
+    state->next_leaf       = 0;
+    kc->trees = 1;
+
+    ull_to_bytes(pk, 4, p->oid);
+    memcpy(pk + pk_off_root(p), sk + sk_off_root(p),     p->n);
+    memcpy(pk + pk_off_seed(p), sk + sk_off_pub_seed(p), p->n);
+    return 0;
+}
+
 /* ====================================================================
- * xmss_sign() - BDS-accelerated signing (Algorithm 11 + BDS)
+ * bds_advance() - Move the BDS state on from leaf idx to idx + 1
  * ==================================================================== */
 
-int xmss_sign(const xmss_params *p, uint8_t *sig,
-                  const uint8_t *msg, size_t msglen,
-                  uint8_t *sk, xmss_bds_state *state, uint32_t bds_k)
+static void bds_advance(const xmss_params *p, xmss_bds_state *state,
+                        uint32_t bds_k, uint64_t idx, const uint8_t *sk)
+{
+    xmss_adrs_t adrs;
+
+    const uint8_t *sk_seed  = sk + sk_off_seed(p);
+    const uint8_t *pub_seed = sk + sk_off_pub_seed(p);
+
+    memset(&adrs, 0, sizeof(adrs));
+    xmss_adrs_set_layer(&adrs, 0);
+    xmss_adrs_set_tree(&adrs, 0);
+
+    bds_round(p, state, bds_k, (uint32_t)idx, sk_seed, pub_seed, &adrs);
+
+    /* Run treehash updates: ceil((h - bds_k) / 2) per signature (BDS assumes
+     * h - bds_k even; rounding up keeps odd custom heights on schedule) */
+    if (p->tree_height > bds_k) {
+        bds_treehash_update(p, state, bds_k, (p->tree_height - bds_k + 1) / 2,
+                            sk_seed, pub_seed, &adrs);
+    }
+}
+
+/* ====================================================================
+ * sign_bds() - BDS-accelerated signing (Algorithm 11 + BDS)
+ *
+ * With check set, the finished signature is run back up to the root
+ * (sig_root() on the signing m_hash) before the BDS state advances.
+ * ==================================================================== */
+
+static int sign_bds(const xmss_params *p, uint8_t *sig,
+                    const uint8_t *msg, size_t msglen,
+                    uint8_t *sk, xmss_bds_state *state, uint32_t bds_k,
+                    int check)
 {
     uint64_t idx;
     uint8_t  r[XMSS_MAX_N];
     uint8_t  m_hash[XMSS_MAX_N];
     xmss_adrs_t adrs;
+    int ret = XMSS_OK;
 
     const uint8_t *sk_seed  = sk + sk_off_seed(p);
     const uint8_t *sk_prf   = sk + sk_off_prf(p);
@@ -325,18 +515,86 @@ int xmss_sign(const xmss_params *p, uint8_t *sig,
         }
     }
 
+    /* Fault check: the emitted idx, r, WOTS+ signature and auth path must
+     * lead back to the root.  The index has already moved on, so a faulty
+     * signature is withheld rather than retried at the same leaf. */
+    if (check) {
+        uint8_t computed_root[XMSS_MAX_N];
+
+        sig_root(p, computed_root, m_hash, idx, sig, pub_seed);
+        if (bytes_to_ull(sig, p->idx_bytes) != idx ||
+            ct_memcmp(sig + p->idx_bytes, r, p->n) != 0 ||
+            ct_memcmp(computed_root, root, p->n) != 0) {
+            xmss_memzero(sig, p->sig_bytes);
+            ret = XMSS_ERR_FAULT;
+        }
+    }
+
     /* Advance BDS state for next signature */
-    memset(&adrs, 0, sizeof(adrs));
-    xmss_adrs_set_layer(&adrs, 0);
-    xmss_adrs_set_tree(&adrs, 0);
+    bds_advance(p, state, bds_k, idx, sk);
 
-    bds_round(p, state, bds_k, (uint32_t)idx, sk_seed, pub_seed, &adrs);
+    return ret;
+}
 
-    /* Run treehash updates: (h - bds_k) / 2 updates per signature */
-    if (p->tree_height > bds_k) {
-        bds_treehash_update(p, state, bds_k, (p->tree_height - bds_k) / 2,
-                            sk_seed, pub_seed, &adrs);
-    }
+/* ====================================================================
+ * xmss_sign() / xmss_sign_checked()
+ * ==================================================================== */
+
+int xmss_sign(const xmss_params *p, uint8_t *sig,
+              const uint8_t *msg, size_t msglen,
+              uint8_t *sk, xmss_bds_state *state, uint32_t bds_k)
+{
+    return sign_bds(p, sig, msg, msglen, sk, state, bds_k, 0);
+}
+
+int xmss_sign_checked(const xmss_params *p, uint8_t *sig,
+                      const uint8_t *msg, size_t msglen,
+                      uint8_t *sk, xmss_bds_state *state, uint32_t bds_k)
+{
+    return sign_bds(p, sig, msg, msglen, sk, state, bds_k, 1);
+}
+
+/* ====================================================================
+ * xmss_skip() - Consume an index without signing
+ * ==================================================================== */
+
+int xmss_skip(const xmss_params *p, uint8_t *sk, xmss_bds_state *state,
+              uint32_t bds_k)
+{
+    uint64_t idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
 
+    if (idx > p->idx_max) {
+        return XMSS_ERR_EXHAUSTED;
+    }
+    ull_to_bytes(sk + sk_off_idx(p), p->idx_bytes, idx + 1);
+    bds_advance(p, state, bds_k, idx, sk);
     return XMSS_OK;
 }
+
+/* ====================================================================
+ * xmss_retune() - Switch the BDS state to another bds_k in place
+ * ==================================================================== */
+
+int xmss_retune(const xmss_params *p, const uint8_t *sk, xmss_bds_state *state,
+                uint32_t bds_k, uint32_t new_k)
+{
+    uint64_t idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
+    xmss_adrs_t adrs;
+
+    if ((bds_k & 1) || bds_k > p->tree_height ||
+        (new_k & 1) || new_k > p->tree_height || new_k > XMSS_MAX_BDS_K) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (idx > p->idx_max) {
+        return XMSS_ERR_EXHAUSTED;
+    }
+    if (new_k == bds_k) {
+        return XMSS_OK;
+    }
+
+    memset(&adrs, 0, sizeof(adrs));
+    xmss_adrs_set_layer(&adrs, 0);
+    xmss_adrs_set_tree(&adrs, 0);
+    return bds_retune(p, state, bds_k, new_k, (uint32_t)idx,
+                      sk + sk_off_seed(p), sk + sk_off_pub_seed(p), &adrs);
+}
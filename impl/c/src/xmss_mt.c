@@ -24,17 +24,11 @@
 #include "treehash.h"
 #include "bds.h"
 #include "sk_offsets.h"
+#include "verify_batch.h"
 
-/* ====================================================================
- * deep_state_swap() - Swap two BDS states in place
- * ==================================================================== */
-static void deep_state_swap(xmss_bds_state *a, xmss_bds_state *b)
-{
-    xmss_bds_state tmp;
-    memcpy(&tmp, a, sizeof(xmss_bds_state));
-    memcpy(a, b, sizeof(xmss_bds_state));
-    memcpy(b, &tmp, sizeof(xmss_bds_state));
-}
+static void layer_root(const xmss_params *p, uint8_t *node, uint32_t layer,
+                       uint64_t idx_tree, uint32_t idx_leaf,
+                       const uint8_t *sig, const uint8_t *seed);
 
 /* ====================================================================
  * xmss_mt_keygen() - Algorithm 15: XMSS-MT Key Generation
@@ -44,83 +38,207 @@ int xmss_mt_keygen(const xmss_params *p, uint8_t *pk, uint8_t *sk,
                   xmss_mt_state *state, uint32_t bds_k,
                   xmss_randombytes_fn randombytes)
 {
-    uint8_t  root[XMSS_MAX_N];
-    uint8_t  seeds[3 * XMSS_MAX_N];
-    xmss_adrs_t adrs;
-    uint32_t i;
+    xmss_keygen_ctx kc;
     int ret;
 
-    /* Validate parameters */
+    /* Every layer's tree 0 in one step; next trees start at leaf 0 and
+     * are grown during signing */
+    ret = xmss_mt_keygen_begin(p, &kc, sk, state, bds_k, randombytes);
+    if (ret != XMSS_OK) {
+        return ret;
+    }
+    xmss_mt_keygen_step(p, &kc, pk, sk, state, bds_k,
+                        p->d << p->tree_height);
+    return XMSS_OK;
+}
+
+/* ====================================================================
+ * sign_root() - WOTS+-sign the root of tree @tree of @layer at layer+1,
+ * as the boundary swap in xmss_mt_sign() does
+ * ==================================================================== */
+
+static void sign_root(const xmss_params *p, uint8_t *wots_sig,
+                      const uint8_t *root, uint32_t layer, uint64_t tree,
+                      const uint8_t *sk)
+{
+    xmss_adrs_t adrs;
+    uint32_t th = p->tree_height;
+
+    memset(&adrs, 0, sizeof(adrs));
+    xmss_adrs_set_layer(&adrs, layer + 1);
+    xmss_adrs_set_tree(&adrs, tree >> th);
+    xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_OTS);
+    xmss_adrs_set_ots(&adrs, (uint32_t)(tree & (((uint64_t)1 << th) - 1)));
+    wots_sign(p, wots_sig, root,
+              sk + sk_off_seed(p), sk + sk_off_pub_seed(p), &adrs);
+}
+
+/* ====================================================================
+ * xmss_mt_keygen_begin() / xmss_mt_keygen_step() - xmss_mt_keygen() in
+ * steps
+ *
+ * Each layer's tree 0 is grown with bds_state_build() in bds[layer] and
+ * sealed into the form bds_treehash_init() leaves; kc->trees counts the
+ * layers done.
+ * ==================================================================== */
+
+int xmss_mt_keygen_begin(const xmss_params *p, xmss_keygen_ctx *kc,
+                         uint8_t *sk, xmss_mt_state *state, uint32_t bds_k,
+                         xmss_randombytes_fn randombytes)
+{
+    uint8_t seeds[3 * XMSS_MAX_N];
+
     if (p->d < 2 || p->d > XMSS_MAX_D) {
         return XMSS_ERR_PARAMS;
     }
     if ((bds_k & 1) || bds_k > p->tree_height) {
         return XMSS_ERR_PARAMS;
     }
+    if (randombytes(seeds, 3 * p->n) != 0) {
+        return XMSS_ERR_ENTROPY;
+    }
 
-    /* Sample 3n random bytes: SK_SEED, SK_PRF, SEED */
-    ret = randombytes(seeds, 3 * p->n);
-    if (ret != 0) { return XMSS_ERR_ENTROPY; }
-
-    /* Zero entire state */
     memset(state, 0, sizeof(*state));
+    kc->trees = 0;
 
-    /* Build trees bottom-up, signing each root at the layer above */
-    memset(&adrs, 0, sizeof(adrs));
+    ull_to_bytes(sk, 4, p->oid);
+    ull_to_bytes(sk + sk_off_idx(p), p->idx_bytes, 0);
+    memcpy(sk + sk_off_seed(p),     seeds,          p->n);
+    memcpy(sk + sk_off_prf(p),      seeds + p->n,   p->n);
+    memset(sk + sk_off_root(p),     0,              p->n);
+    memcpy(sk + sk_off_pub_seed(p), seeds + 2*p->n, p->n);
 
-    for (i = 0; i < p->d - 1; i++) {
-        xmss_adrs_set_layer(&adrs, i);
-        xmss_adrs_set_tree(&adrs, 0);
+    xmss_memzero(seeds, sizeof(seeds));
+    return XMSS_OK;
+}
 
-        bds_treehash_init(p, root, &state->bds[i], bds_k,
-                          seeds,           /* SK_SEED */
-                          seeds + 2*p->n,  /* SEED */
-                          &adrs);
+int xmss_mt_keygen_step(const xmss_params *p, xmss_keygen_ctx *kc,
+                        uint8_t *pk, uint8_t *sk, xmss_mt_state *state,
+                        uint32_t bds_k, uint32_t leaves)
+{
+    xmss_bds_state *bds;
+    xmss_adrs_t adrs;
+    uint32_t i, before;
+    uint32_t th = p->tree_height;
+
+    if (leaves == 0) {
+        return XMSS_ERR_PARAMS;
+    }
+
+    while (kc->trees < p->d && leaves > 0) {
+        i   = kc->trees;
+        bds = &state->bds[i];
 
-        /* Sign this layer's root at layer i+1 */
         memset(&adrs, 0, sizeof(adrs));
-        xmss_adrs_set_layer(&adrs, i + 1);
-        xmss_adrs_set_tree(&adrs, 0);
-        xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_OTS);
-        xmss_adrs_set_ots(&adrs, 0);
+        xmss_adrs_set_layer(&adrs, i);
+        before = bds->next_leaf;
+        if (bds_state_build(p, bds, bds_k, leaves,
+                            sk + sk_off_seed(p), sk + sk_off_pub_seed(p),
+                            &adrs) > 0) {
+            break;
+        }
+        leaves -= bds->next_leaf - before;
+
+        bds_state_seal(p, bds, bds_k);
+        if (i + 1 < p->d) {
+            memcpy(state->roots[i], bds->stack[0], p->n);
+            sign_root(p, state->wots_sigs[i], bds->stack[0], i, 0, sk);
+        } else {
+            memcpy(sk + sk_off_root(p), bds->stack[0], p->n);
+            ull_to_bytes(pk, 4, p->oid);
+            memcpy(pk + pk_off_root(p), bds->stack[0],          p->n);
+            memcpy(pk + pk_off_seed(p), sk + sk_off_pub_seed(p), p->n);
+        }
+        memset(bds->stack[0], 0, sizeof(bds->stack[0]));
+        bds->stack_levels[0] = 0;
+        bds->stack_offset    = 0;
+        bds->next_leaf       = 0;
+        kc->trees++;
+    }
 
-        wots_sign(p, state->wots_sigs[i], root,
-                  seeds, seeds + 2*p->n, &adrs);
+    if (kc->trees == p->d) {
+        return 0;
     }
+    return (int)((p->d - kc->trees) * ((uint32_t)1 << th) -
+                 state->bds[kc->trees].next_leaf);
+}
 
-    /* Top layer: just build the tree, no WOTS sig needed */
-    memset(&adrs, 0, sizeof(adrs));
-    xmss_adrs_set_layer(&adrs, p->d - 1);
-    xmss_adrs_set_tree(&adrs, 0);
+/* ====================================================================
+ * xmss_mt_next_build() - Next tree of a layer, in one call or in steps
+ *
+ * The BDS state is left as bds_state_update() leaves it after the last
+ * leaf (root on the shared stack, next_leaf = 2^th), so it can be used
+ * as state->bds[d + layer] as well as swapped straight into bds[layer].
+ * ==================================================================== */
 
-    bds_treehash_init(p, root, &state->bds[p->d - 1], bds_k,
-                      seeds,           /* SK_SEED */
-                      seeds + 2*p->n,  /* SEED */
-                      &adrs);
+int xmss_mt_next_begin(const xmss_params *p, uint32_t layer, uint64_t tree,
+                       uint32_t bds_k, xmss_mt_next_tree *out)
+{
+    uint32_t th = p->tree_height;
 
-    /* Initialise "next" BDS states for tree_idx=1 at layers 0..d-2.
-     * These are pre-computed so the next tree is ready when a boundary
-     * is crossed.  We don't fully build them here; they start at
-     * next_leaf=0 and get built incrementally during signing. */
-    for (i = 0; i < p->d - 1; i++) {
-        state->bds[p->d + i].next_leaf = 0;
-        state->bds[p->d + i].stack_offset = 0;
+    if (p->d < 2 || layer + 1 >= p->d) {
+        return XMSS_ERR_PARAMS;
+    }
+    if ((bds_k & 1) || bds_k > th) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (tree >= ((uint64_t)1 << (p->h - (layer + 1) * th))) {
+        return XMSS_ERR_PARAMS;
     }
 
-    /* Serialise PK: OID(4) | root(n) | SEED(n) */
-    ull_to_bytes(pk, 4, p->oid);
-    memcpy(pk + pk_off_root(p), root, p->n);
-    memcpy(pk + pk_off_seed(p), seeds + 2*p->n, p->n);
+    memset(out, 0, sizeof(*out));
+    out->tree  = tree;
+    out->layer = layer;
+    return XMSS_OK;
+}
 
-    /* Serialise SK: OID(4) | idx(idx_bytes) | SK_SEED(n) | SK_PRF(n) | root(n) | SEED(n) */
-    ull_to_bytes(sk, 4, p->oid);
-    ull_to_bytes(sk + sk_off_idx(p), p->idx_bytes, 0);
-    memcpy(sk + sk_off_seed(p),     seeds,          p->n);
-    memcpy(sk + sk_off_prf(p),      seeds + p->n,   p->n);
-    memcpy(sk + sk_off_root(p),     root,            p->n);
-    memcpy(sk + sk_off_pub_seed(p), seeds + 2*p->n, p->n);
+int xmss_mt_next_step(const xmss_params *p, const uint8_t *sk,
+                      uint32_t bds_k, xmss_mt_next_tree *out, uint32_t leaves)
+{
+    xmss_adrs_t adrs;
+    uint32_t left;
 
-    xmss_memzero(seeds, sizeof(seeds));
+    if (leaves == 0) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (out->bds.next_leaf == (uint32_t)1 << p->tree_height) {
+        return 0;
+    }
+
+    memset(&adrs, 0, sizeof(adrs));
+    xmss_adrs_set_layer(&adrs, out->layer);
+    xmss_adrs_set_tree(&adrs, out->tree);
+    left = bds_state_build(p, &out->bds, bds_k, leaves,
+                           sk + sk_off_seed(p), sk + sk_off_pub_seed(p), &adrs);
+    if (left > 0) {
+        return (int)left;
+    }
+
+    bds_state_seal(p, &out->bds, bds_k);
+    sign_root(p, out->wots_sig, out->bds.stack[0], out->layer, out->tree, sk);
+    return 0;
+}
+
+int xmss_mt_next_build(const xmss_params *p, const uint8_t *sk,
+                       uint32_t layer, uint64_t tree, uint32_t bds_k,
+                       xmss_mt_next_tree *out)
+{
+    int ret = xmss_mt_next_begin(p, layer, tree, bds_k, out);
+
+    if (ret != XMSS_OK) {
+        return ret;
+    }
+    (void)xmss_mt_next_step(p, sk, bds_k, out, (uint32_t)1 << p->tree_height);
+    return XMSS_OK;
+}
+
+int xmss_mt_next_install(const xmss_params *p, xmss_mt_state *state,
+                         const xmss_mt_next_tree *nt)
+{
+    if (p->d < 2 || nt->layer + 1 >= p->d) {
+        return XMSS_ERR_PARAMS;
+    }
+    memcpy(&state->bds[p->d + nt->layer], &nt->bds, sizeof(xmss_bds_state));
     return XMSS_OK;
 }
 
@@ -128,22 +246,107 @@ int xmss_mt_keygen(const xmss_params *p, uint8_t *pk, uint8_t *sk,
  * xmss_mt_sign() - Algorithm 16: XMSS-MT Signature Generation
  * ==================================================================== */
 
+static int mt_sign(const xmss_params *p, uint8_t *sig,
+                   const uint8_t *msg, size_t msglen,
+                   uint8_t *sk, xmss_mt_state *state, uint32_t bds_k,
+                   uint32_t ext_layers,
+                   const xmss_mt_next_tree *const *next, int check);
+
 int xmss_mt_sign(const xmss_params *p, uint8_t *sig,
                 const uint8_t *msg, size_t msglen,
                 uint8_t *sk, xmss_mt_state *state, uint32_t bds_k)
+{
+    return mt_sign(p, sig, msg, msglen, sk, state, bds_k, 0, NULL, 0);
+}
+
+int xmss_mt_sign_checked(const xmss_params *p, uint8_t *sig,
+                         const uint8_t *msg, size_t msglen,
+                         uint8_t *sk, xmss_mt_state *state, uint32_t bds_k)
+{
+    return mt_sign(p, sig, msg, msglen, sk, state, bds_k, 0, NULL, 1);
+}
+
+int xmss_mt_sign_ext(const xmss_params *p, uint8_t *sig,
+                     const uint8_t *msg, size_t msglen,
+                     uint8_t *sk, xmss_mt_state *state, uint32_t bds_k,
+                     uint32_t ext_layers,
+                     const xmss_mt_next_tree *const *next)
+{
+    return mt_sign(p, sig, msg, msglen, sk, state, bds_k, ext_layers, next, 0);
+}
+
+/* ====================================================================
+ * mt_advance() - Move every layer's BDS state on from idx to idx + 1
+ *
+ * Shared by mt_sign() and xmss_mt_skip(); each layer is stepped by
+ * bds_layer_advance(), as in HSS.  The swapped-in tree's root is signed
+ * here, so the state stays complete without a signature.
+ * ==================================================================== */
+static void mt_advance(const xmss_params *p, const uint8_t *sk,
+                       xmss_mt_state *state, uint32_t bds_k, uint64_t idx,
+                       uint32_t ext_layers,
+                       const xmss_mt_next_tree *const *next)
+{
+    xmss_adrs_t ots_addr;
+    bds_walk w;
+    uint32_t i, external;
+    uint32_t th = p->tree_height;
+    uint32_t wots_sig_bytes = p->len * p->n;
+
+    const uint8_t *sk_seed  = sk + sk_off_seed(p);
+    const uint8_t *pub_seed = sk + sk_off_pub_seed(p);
+
+    bds_walk_begin(p, &w, bds_k);
+    for (i = 0; i < p->d; i++) {
+        external = (ext_layers >> i) & 1U;
+        if (!bds_layer_advance(p, &w, &state->bds[i],
+                               i + 1 < p->d ? &state->bds[p->d + i] : NULL,
+                               external,
+                               external && next != NULL && next[i] != NULL ?
+                                   &next[i]->bds : NULL,
+                               bds_k, idx, i, sk_seed, pub_seed, sk_seed, pub_seed)) {
+            continue;
+        }
+        if (external) {
+            /* The externally built tree's root signature (checked above) */
+            memcpy(state->wots_sigs[i], next[i]->wots_sig, wots_sig_bytes);
+        } else {
+            /* Sign the completed tree's root at layer i+1 */
+            memset(&ots_addr, 0, sizeof(ots_addr));
+            xmss_adrs_set_layer(&ots_addr, i + 1);
+            xmss_adrs_set_tree(&ots_addr, (idx + 1) >> ((i + 2) * th));
+            xmss_adrs_set_type(&ots_addr, XMSS_ADRS_TYPE_OTS);
+            xmss_adrs_set_ots(&ots_addr,
+                (uint32_t)(((idx >> ((i + 1) * th)) + 1) & (((uint64_t)1 << th) - 1)));
+
+            wots_sign(p, state->wots_sigs[i],
+                      state->bds[i].stack[0],
+                      sk_seed, pub_seed, &ots_addr);
+        }
+        memcpy(state->roots[i], state->bds[i].stack[0], p->n);
+    }
+}
+
+/* ====================================================================
+ * mt_sign() - Algorithm 16 with BDS, external next trees and, with check
+ * set, the fault check of xmss_mt_sign_checked() before the state moves
+ * ==================================================================== */
+static int mt_sign(const xmss_params *p, uint8_t *sig,
+                   const uint8_t *msg, size_t msglen,
+                   uint8_t *sk, xmss_mt_state *state, uint32_t bds_k,
+                   uint32_t ext_layers,
+                   const xmss_mt_next_tree *const *next, int check)
 {
     uint64_t idx;
     uint64_t idx_tree;
     uint32_t idx_leaf;
     uint8_t  r[XMSS_MAX_N];
     uint8_t  m_hash[XMSS_MAX_N];
-    xmss_adrs_t adrs;
     xmss_adrs_t ots_addr;
     uint32_t i, j;
-    uint32_t updates;
-    int needswap_upto = -1;
     uint32_t th = p->tree_height;
     uint32_t wots_sig_bytes = p->len * p->n;
+    int ret = XMSS_OK;
 
     const uint8_t *sk_seed  = sk + sk_off_seed(p);
     const uint8_t *sk_prf   = sk + sk_off_prf(p);
@@ -157,6 +360,22 @@ int xmss_mt_sign(const xmss_params *p, uint8_t *sig,
         return XMSS_ERR_EXHAUSTED;
     }
 
+    /* External layers: the tree each boundary crossed here swaps in */
+    if (ext_layers >> (p->d - 1) != 0) {
+        return XMSS_ERR_PARAMS;
+    }
+    for (i = 0; i + 1 < p->d; i++) {
+        if (((ext_layers >> i) & 1U) == 0 || idx >= ((uint64_t)1 << p->h) - 1 ||
+            ((idx + 1) & (((uint64_t)1 << ((i + 1) * th)) - 1)) != 0) {
+            continue;
+        }
+        if (next == NULL || next[i] == NULL || next[i]->layer != i ||
+            next[i]->tree != (idx + 1) >> ((i + 1) * th) ||
+            next[i]->bds.next_leaf != (uint32_t)1 << th) {
+            return XMSS_ERR_PARAMS;
+        }
+    }
+
     /* Increment index in SK */
     ull_to_bytes(sk + sk_off_idx(p), p->idx_bytes, idx + 1);
 
@@ -205,86 +424,53 @@ int xmss_mt_sign(const xmss_params *p, uint8_t *sig,
         }
     }
 
-    /* ---- Update BDS states ---- */
-    updates = (th - bds_k) >> 1;
-
-    /* Mandatory update for NEXT_0 (layer 0 next tree) */
-    idx_tree = idx >> th;
-    idx_leaf = (uint32_t)(idx & (((uint64_t)1 << th) - 1));
-
-    memset(&adrs, 0, sizeof(adrs));
-    xmss_adrs_set_layer(&adrs, 0);
-    xmss_adrs_set_tree(&adrs, idx_tree + 1);
-
-    if ((1 + idx_tree) * ((uint64_t)1 << th) + idx_leaf < ((uint64_t)1 << p->h)) {
-        bds_state_update(p, &state->bds[p->d], bds_k, sk_seed, pub_seed, &adrs);
-    }
-
-    /* Per-layer state updates */
-    for (i = 0; i < p->d; i++) {
-        /* Check if we're NOT at a tree boundary at layer i */
-        if (!(((idx + 1) & (((uint64_t)1 << ((i + 1) * th)) - 1)) == 0)) {
-            /* Not at boundary: advance BDS state */
-            idx_leaf = (uint32_t)((idx >> (th * i)) & (((uint64_t)1 << th) - 1));
-            idx_tree = idx >> (th * (i + 1));
-
-            memset(&adrs, 0, sizeof(adrs));
-            xmss_adrs_set_layer(&adrs, i);
-            xmss_adrs_set_tree(&adrs, idx_tree);
-
-            if ((int)i == needswap_upto + 1) {
-                bds_round(p, &state->bds[i], bds_k, idx_leaf,
-                          sk_seed, pub_seed, &adrs);
-            }
-
-            bds_treehash_update(p, &state->bds[i], bds_k, updates,
-                                sk_seed, pub_seed, &adrs);
-
-            /* Update "next" tree for this layer (if it exists and i > 0) */
-            memset(&adrs, 0, sizeof(adrs));
-            xmss_adrs_set_layer(&adrs, i);
-            xmss_adrs_set_tree(&adrs, idx_tree + 1);
-
-            if (i > 0 && updates > 0 &&
-                (1 + idx_tree) * ((uint64_t)1 << th) + idx_leaf <
-                ((uint64_t)1 << (p->h - th * i))) {
-                if (state->bds[p->d + i].next_leaf < ((uint32_t)1 << th)) {
-                    bds_state_update(p, &state->bds[p->d + i], bds_k,
-                                     sk_seed, pub_seed, &adrs);
-                    updates--;
-                }
+    /* ---- Fault check ---- */
+    /* Layer 0 every time, against its tree's cached root; layer i above
+     * it when its reduced signature is new, i.e. on the first index of a
+     * layer i-1 tree.  The top layer ends at the root in the SK. */
+    if (check) {
+        uint8_t  node[XMSS_MAX_N];
+        const uint8_t *sig_ptr = sig + p->idx_bytes + p->n;
+        int      bad = bytes_to_ull(sig, p->idx_bytes) != idx ||
+                       ct_memcmp(sig + p->idx_bytes, r, p->n) != 0;
+
+        memcpy(node, m_hash, p->n);
+        for (i = 0; i < p->d; i++) {
+            if (i > 0 && (idx & (((uint64_t)1 << (i * th)) - 1)) != 0) {
+                break;
             }
+            layer_root(p, node, i, idx >> ((i + 1) * th),
+                       (uint32_t)((idx >> (i * th)) & (((uint64_t)1 << th) - 1)),
+                       sig_ptr, pub_seed);
+            bad |= ct_memcmp(node, i + 1 < p->d ? state->roots[i] : root, p->n) != 0;
+            sig_ptr += (p->len + th) * p->n;
         }
-        else if (idx < ((uint64_t)1 << p->h) - 1) {
-            /* At tree boundary: swap current/next BDS states */
-            deep_state_swap(&state->bds[p->d + i], &state->bds[i]);
+        if (bad) {
+            xmss_memzero(sig, p->sig_bytes);
+            ret = XMSS_ERR_FAULT;
+        }
+    }
 
-            /* Sign the completed tree's root at layer i+1 */
-            memset(&ots_addr, 0, sizeof(ots_addr));
-            xmss_adrs_set_layer(&ots_addr, i + 1);
-            xmss_adrs_set_tree(&ots_addr, (idx + 1) >> ((i + 2) * th));
-            xmss_adrs_set_type(&ots_addr, XMSS_ADRS_TYPE_OTS);
-            xmss_adrs_set_ots(&ots_addr,
-                (uint32_t)(((idx >> ((i + 1) * th)) + 1) & (((uint64_t)1 << th) - 1)));
+    /* ---- Update BDS states ---- */
+    mt_advance(p, sk, state, bds_k, idx, ext_layers, next);
 
-            wots_sign(p, state->wots_sigs[i],
-                      state->bds[i].stack[0],
-                      sk_seed, pub_seed, &ots_addr);
+    return ret;
+}
 
-            /* Reset the swapped-in "next" state for future use */
-            state->bds[p->d + i].stack_offset = 0;
-            state->bds[p->d + i].next_leaf = 0;
+/* ====================================================================
+ * xmss_mt_skip() - Consume an index without signing
+ * ==================================================================== */
 
-            if (updates > 0) { updates--; }
-            needswap_upto = (int)i;
+int xmss_mt_skip(const xmss_params *p, uint8_t *sk, xmss_mt_state *state,
+                 uint32_t bds_k)
+{
+    uint64_t idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
 
-            /* Mark all treehash instances as completed for swapped state */
-            for (j = 0; j < th - bds_k; j++) {
-                state->bds[i].treehash[j].completed = 1;
-            }
-        }
+    if (idx > p->idx_max) {
+        return XMSS_ERR_EXHAUSTED;
     }
-
+    ull_to_bytes(sk + sk_off_idx(p), p->idx_bytes, idx + 1);
+    mt_advance(p, sk, state, bds_k, idx, 0, NULL);
     return XMSS_OK;
 }
 
@@ -302,41 +488,113 @@ uint64_t xmss_mt_remaining_sigs(const xmss_params *p, const uint8_t *sk)
 }
 
 /* ====================================================================
- * xmss_mt_verify() - Algorithm 17: XMSS-MT Signature Verification
+ * layer_pk_root() - Tree root from a layer's recovered WOTS+ public key
+ * (overwritten by the L-tree) and its auth path (at sig + len*n)
  * ==================================================================== */
+static void layer_pk_root(const xmss_params *p, uint8_t *node, uint32_t layer,
+                          uint64_t idx_tree, uint32_t idx_leaf,
+                          uint8_t *wots_pk, const uint8_t *sig,
+                          const uint8_t *seed)
+{
+    uint8_t  leaf[XMSS_MAX_N];
+    xmss_adrs_t adrs;
 
-int xmss_mt_verify(const xmss_params *p,
-                  const uint8_t *msg, size_t msglen,
-                  const uint8_t *sig, const uint8_t *pk)
+    /* Compute leaf from WOTS+ pk via l_tree */
+    memset(&adrs, 0, sizeof(adrs));
+    xmss_adrs_set_layer(&adrs, layer);
+    xmss_adrs_set_tree(&adrs, idx_tree);
+    xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_LTREE);
+    xmss_adrs_set_ltree(&adrs, idx_leaf);
+
+    l_tree(p, leaf, wots_pk, seed, &adrs);
+
+    /* Walk auth path to compute root */
+    memset(&adrs, 0, sizeof(adrs));
+    xmss_adrs_set_layer(&adrs, layer);
+    xmss_adrs_set_tree(&adrs, idx_tree);
+
+    compute_root(p, node, leaf, idx_leaf, sig + p->len * p->n, seed, &adrs);
+}
+
+static void layer_ots_adrs(xmss_adrs_t *adrs, uint32_t layer,
+                           uint64_t idx_tree, uint32_t idx_leaf)
+{
+    memset(adrs, 0, sizeof(*adrs));
+    xmss_adrs_set_layer(adrs, layer);
+    xmss_adrs_set_tree(adrs, idx_tree);
+    xmss_adrs_set_type(adrs, XMSS_ADRS_TYPE_OTS);
+    xmss_adrs_set_ots(adrs, idx_leaf);
+}
+
+/* ====================================================================
+ * layer_root() - One layer of Algorithm 17
+ *
+ * node is the message signed at this layer (m_hash or the root of the
+ * layer below) on entry and this layer's tree root on return; sig points
+ * at the layer's reduced signature (WOTS+ signature || auth path).
+ * ==================================================================== */
+static void layer_root(const xmss_params *p, uint8_t *node, uint32_t layer,
+                       uint64_t idx_tree, uint32_t idx_leaf,
+                       const uint8_t *sig, const uint8_t *seed)
 {
-    uint64_t idx;
-    uint32_t idx_leaf;
-    uint8_t  r[XMSS_MAX_N];
-    uint8_t  m_hash[XMSS_MAX_N];
     uint8_t  wots_pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
-    uint8_t  leaf[XMSS_MAX_N];
-    uint8_t  computed_root[XMSS_MAX_N];
     xmss_adrs_t adrs;
-    uint32_t i;
-    uint32_t th = p->tree_height;
-    uint32_t wots_sig_bytes = p->len * p->n;
 
-    const uint8_t *pk_root = pk + pk_off_root(p);
-    const uint8_t *pk_seed = pk + pk_off_seed(p);
-    const uint8_t *sig_ptr;
+    /* Recover WOTS+ public key from signature */
+    layer_ots_adrs(&adrs, layer, idx_tree, idx_leaf);
+    wots_pk_from_sig(p, wots_pk, sig, node, seed, &adrs);
+
+    layer_pk_root(p, node, layer, idx_tree, idx_leaf, wots_pk, sig, seed);
+}
 
-    /* Validate PK OID matches params */
-    if ((uint32_t)bytes_to_ull(pk, 4) != p->oid) { return XMSS_ERR_VERIFY; }
+/* ====================================================================
+ * mt_sig_roots() - The d-layer walk for up to WOTS_SCHED_JOBS signatures
+ * under one SEED; each layer's WOTS+ chains share the lane scheduler
+ *
+ * node[j] is m_hash of signature j on entry and its top root on return.
+ * ==================================================================== */
+static void mt_sig_roots(const xmss_params *p, uint8_t node[][XMSS_MAX_N],
+                         const uint64_t *idx, const uint8_t *const *sig,
+                         const uint8_t *seed, uint32_t count)
+{
+    uint8_t        wots_pk[WOTS_SCHED_JOBS][XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    uint8_t       *pks[WOTS_SCHED_JOBS];
+    const uint8_t *sigs_wots[WOTS_SCHED_JOBS];
+    const uint8_t *msgs[WOTS_SCHED_JOBS];
+    xmss_adrs_t    adrs[WOTS_SCHED_JOBS];
+    uint32_t       i, j;
+    uint32_t       th = p->tree_height;
 
-    /* Extract index */
-    idx = bytes_to_ull(sig, p->idx_bytes);
-    if (idx > p->idx_max) { return XMSS_ERR_VERIFY; }
+    for (i = 0; i < p->d; i++) {
+        for (j = 0; j < count; j++) {
+            layer_ots_adrs(&adrs[j], i, idx[j] >> ((i + 1) * th),
+                           (uint32_t)((idx[j] >> (i * th)) & (((uint64_t)1 << th) - 1)));
+            pks[j]       = wots_pk[j];
+            sigs_wots[j] = sig[j] + p->idx_bytes + p->n + i * (p->len + th) * p->n;
+            msgs[j]      = node[j];
+        }
+        wots_pk_from_sig_multi(p, pks, sigs_wots, msgs, seed, adrs, count, NULL);
 
-    /* Extract r */
-    memcpy(r, sig + p->idx_bytes, p->n);
+        for (j = 0; j < count; j++) {
+            layer_pk_root(p, node[j], i, idx[j] >> ((i + 1) * th),
+                          (uint32_t)((idx[j] >> (i * th)) & (((uint64_t)1 << th) - 1)),
+                          wots_pk[j], sigs_wots[j], seed);
+        }
+    }
+}
 
-    /* m_hash = H_msg(r, root, idx, msg) */
-    xmss_H_msg(p, m_hash, r, pk_root, idx, msg, msglen);
+/* ====================================================================
+ * mt_verify_mhash() - Algorithm 17 once m_hash = H_msg(r, root, idx, M) is known
+ * ==================================================================== */
+static int mt_verify_mhash(const xmss_params *p, const uint8_t *m_hash,
+                           uint64_t idx, const uint8_t *sig, const uint8_t *pk)
+{
+    uint32_t idx_leaf;
+    uint8_t  computed_root[XMSS_MAX_N];
+    uint32_t i;
+    uint32_t th = p->tree_height;
+
+    const uint8_t *sig_ptr;
 
     /* Iterate through d layers */
     sig_ptr = sig + p->idx_bytes + p->n;
@@ -346,37 +604,151 @@ int xmss_mt_verify(const xmss_params *p,
         idx_leaf = (uint32_t)(idx & (((uint64_t)1 << th) - 1));
         idx >>= th;
 
-        /* Recover WOTS+ public key from signature */
-        memset(&adrs, 0, sizeof(adrs));
-        xmss_adrs_set_layer(&adrs, i);
-        xmss_adrs_set_tree(&adrs, idx);
-        xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_OTS);
-        xmss_adrs_set_ots(&adrs, idx_leaf);
+        layer_root(p, computed_root, i, idx, idx_leaf, sig_ptr, pk + pk_off_seed(p));
+        sig_ptr += (p->len + th) * p->n;
+    }
 
-        wots_pk_from_sig(p, wots_pk, sig_ptr, computed_root, pk_seed, &adrs);
-        sig_ptr += wots_sig_bytes;
+    /* Constant-time compare (J6) */
+    if (ct_memcmp(computed_root, pk + pk_off_root(p), p->n) != 0) {
+        return XMSS_ERR_VERIFY;
+    }
+    return XMSS_OK;
+}
 
-        /* Compute leaf from WOTS+ pk via l_tree */
-        memset(&adrs, 0, sizeof(adrs));
-        xmss_adrs_set_layer(&adrs, i);
-        xmss_adrs_set_tree(&adrs, idx);
-        xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_LTREE);
-        xmss_adrs_set_ltree(&adrs, idx_leaf);
+/* ====================================================================
+ * xmss_mt_verify() - Algorithm 17: XMSS-MT Signature Verification
+ * ==================================================================== */
+
+int xmss_mt_verify(const xmss_params *p,
+                  const uint8_t *msg, size_t msglen,
+                  const uint8_t *sig, const uint8_t *pk)
+{
+    uint64_t idx;
+    uint8_t  m_hash[XMSS_MAX_N];
+
+    if (xmss_verify_decode(p, sig, pk, &idx) != XMSS_OK) {
+        return XMSS_ERR_VERIFY;
+    }
+
+    /* m_hash = H_msg(r, root, idx, msg) */
+    xmss_H_msg(p, m_hash, sig + p->idx_bytes, pk + pk_off_root(p), idx,
+               msg, msglen);
+
+    return mt_verify_mhash(p, m_hash, idx, sig, pk);
+}
+
+/* ====================================================================
+ * xmss_mt_verify_batch() - Algorithm 17 over many signatures
+ *
+ * Same chunking as xmss_verify_batch(): multi-buffer H_msg per chunk,
+ * then the d-layer walk per item, or per pair of items under one public
+ * key with each layer's chains on the scheduler (mt_sig_roots()).
+ * ==================================================================== */
+
+int xmss_mt_verify_batch(const xmss_params *p, size_t count,
+                         const uint8_t *const *msgs, const size_t *msglens,
+                         const uint8_t *const *sigs, const uint8_t *const *pks,
+                         int *results)
+{
+    xmss_verify_chunk c;
+    uint8_t           nodes[WOTS_SCHED_JOBS][XMSS_MAX_N];
+    size_t            base, i;
+    uint32_t          j, run;
+    int               all = XMSS_OK;
+    int               rc;
+
+    /* J5: count / XMSS_VERIFY_CHUNK chunks of at most XMSS_VERIFY_CHUNK items */
+    for (base = 0; base < count; base += XMSS_VERIFY_CHUNK) {
+        size_t end = (count - base < XMSS_VERIFY_CHUNK) ? count : base + XMSS_VERIFY_CHUNK;
+
+        if (xmss_verify_chunk_hash(p, &c, base, end, msgs, msglens,
+                                   sigs, pks, results) != XMSS_OK) {
+            all = XMSS_ERR_VERIFY;
+        }
+
+        /* Runs of items under the same public key share the chain lanes */
+        for (j = 0; j < c.count; j += run) {
+            const uint8_t *sg[WOTS_SCHED_JOBS];
+            uint64_t       ix[WOTS_SCHED_JOBS];
+            uint32_t       r;
+
+            run = xmss_verify_chunk_run(p, &c, j, base, pks);
+            if (run == 1) {
+                i  = base + c.slot[j];
+                rc = mt_verify_mhash(p, c.m_hash + j * p->n, c.in[j].idx, sigs[i], pks[i]);
+                if (results) { results[i] = rc; }
+                if (rc != XMSS_OK) { all = XMSS_ERR_VERIFY; }
+                continue;
+            }
+            for (r = 0; r < run; r++) {
+                memcpy(nodes[r], c.m_hash + (j + r) * p->n, p->n);
+                sg[r] = sigs[base + c.slot[j + r]];
+                ix[r] = c.in[j + r].idx;
+            }
+            mt_sig_roots(p, nodes, ix, sg, pks[base + c.slot[j]] + pk_off_seed(p), run);
+            for (r = 0; r < run; r++) {
+                i  = base + c.slot[j + r];
+                rc = ct_memcmp(nodes[r], pks[i] + pk_off_root(p), p->n) != 0
+                     ? XMSS_ERR_VERIFY : XMSS_OK;
+                if (results) { results[i] = rc; }
+                if (rc != XMSS_OK) { all = XMSS_ERR_VERIFY; }
+            }
+        }
+    }
+    return all;
+}
+
+/* ====================================================================
+ * xmss_mt_retune() - Switch every layer's BDS state to another bds_k
+ *
+ * Current trees are converted in place at their layer's leaf; the
+ * partial next trees depend on bds_k in every node they captured, so
+ * each is rebuilt to the same progress with bds_state_build().
+ * ==================================================================== */
+
+int xmss_mt_retune(const xmss_params *p, const uint8_t *sk,
+                   xmss_mt_state *state, uint32_t bds_k, uint32_t new_k)
+{
+    uint64_t idx = bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
+    uint32_t th = p->tree_height;
+    uint64_t mask = ((uint64_t)1 << th) - 1;
+    uint32_t i, nl;
+    int      ret;
+    xmss_adrs_t adrs;
 
-        l_tree(p, leaf, wots_pk, pk_seed, &adrs);
+    if ((bds_k & 1) || bds_k > th ||
+        (new_k & 1) || new_k > th || new_k > XMSS_MAX_BDS_K) {
+        return XMSS_ERR_PARAMS;
+    }
+    if (idx > p->idx_max) {
+        return XMSS_ERR_EXHAUSTED;
+    }
+    if (new_k == bds_k) {
+        return XMSS_OK;
+    }
 
-        /* Walk auth path to compute root */
+    for (i = 0; i < p->d; i++) {
         memset(&adrs, 0, sizeof(adrs));
         xmss_adrs_set_layer(&adrs, i);
-        xmss_adrs_set_tree(&adrs, idx);
-
-        compute_root(p, computed_root, leaf, idx_leaf, sig_ptr, pk_seed, &adrs);
-        sig_ptr += th * p->n;
+        xmss_adrs_set_tree(&adrs, idx >> (th * (i + 1)));
+        ret = bds_retune(p, &state->bds[i], bds_k, new_k,
+                         (uint32_t)((idx >> (th * i)) & mask),
+                         sk + sk_off_seed(p), sk + sk_off_pub_seed(p), &adrs);
+        if (ret != XMSS_OK) {
+            return ret;
+        }
     }
 
-    /* Constant-time compare (J6) */
-    if (ct_memcmp(computed_root, pk_root, p->n) != 0) {
-        return XMSS_ERR_VERIFY;
+    for (i = 0; i + 1 < p->d; i++) {
+        nl = state->bds[p->d + i].next_leaf;
+        memset(&state->bds[p->d + i], 0, sizeof(xmss_bds_state));
+
+        memset(&adrs, 0, sizeof(adrs));
+        xmss_adrs_set_layer(&adrs, i);
+        xmss_adrs_set_tree(&adrs, (idx >> (th * (i + 1))) + 1);
+        (void)bds_state_build(p, &state->bds[p->d + i], new_k, nl,
+                              sk + sk_off_seed(p), sk + sk_off_pub_seed(p),
+                              &adrs);
     }
     return XMSS_OK;
 }
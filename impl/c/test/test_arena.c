@@ -0,0 +1,137 @@
+/**
+ * test_arena.c - Hugepage / NUMA key-state arena (arena.h)
+ *
+ * Tests:
+ * - Size rounding, backing (hugetlb or THP fallback), NUMA node reporting
+ * - Alignment, zeroed memory, full-arena and bad-alignment failures
+ * - Packing xmss_mt_state objects page-aligned without overlap
+ * - reset() wipes and keeps the mapping; destroy() is idempotent
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../include/xmss/arena.h"
+
+static int all_zero(const uint8_t *p, size_t len)
+{
+    size_t i;
+    uint8_t acc = 0;
+    for (i = 0; i < len; i++) { acc |= p[i]; }
+    return acc == 0;
+}
+
+static void test_init(void)
+{
+    xmss_arena         a;
+    xmss_arena_stats_t st;
+    int                here = xmss_arena_current_node();
+
+    TEST_INT("size 0 rejected", xmss_arena_init(&a, 0, XMSS_ARENA_NODE_ANY),
+             XMSS_ERR_PARAMS);
+
+    TEST_INT("init local node", xmss_arena_init(&a, 1, XMSS_ARENA_NODE_LOCAL), XMSS_OK);
+    xmss_arena_stats(&a, &st);
+    TEST("mapped rounded to one hugepage", st.mapped == XMSS_ARENA_HUGEPAGE);
+    TEST("backing is hugetlb or THP",
+         st.backing == XMSS_ARENA_BACKING_HUGETLB || st.backing == XMSS_ARENA_BACKING_THP);
+    TEST("base hugepage-aligned",
+         ((uintptr_t)a.base % XMSS_ARENA_HUGEPAGE) == 0);
+    TEST("current node reported", here >= 0);
+    TEST("bound to caller's node (or unbound without NUMA)",
+         st.node == here || st.node == -1);
+    printf("  (backing=%s node=%d)\n",
+           st.backing == XMSS_ARENA_BACKING_HUGETLB ? "hugetlb" : "thp", st.node);
+    xmss_arena_destroy(&a);
+
+    TEST_INT("init unbound", xmss_arena_init(&a, XMSS_ARENA_HUGEPAGE + 1,
+                                             XMSS_ARENA_NODE_ANY), XMSS_OK);
+    xmss_arena_stats(&a, &st);
+    TEST("unbound arena reports node -1", st.node == -1);
+    TEST("mapped rounded to two hugepages", st.mapped == 2 * XMSS_ARENA_HUGEPAGE);
+    xmss_arena_destroy(&a);
+}
+
+static void test_alloc(void)
+{
+    xmss_arena         a;
+    xmss_arena_stats_t st;
+    uint8_t           *p, *q;
+
+    xmss_arena_init(&a, 1, XMSS_ARENA_NODE_LOCAL);
+
+    p = (uint8_t *)xmss_arena_alloc(&a, 1, 0);
+    q = (uint8_t *)xmss_arena_alloc(&a, 100, 0);
+    TEST("default alignment 64", p && q && ((uintptr_t)q % 64) == 0 && q > p);
+    q = (uint8_t *)xmss_arena_alloc(&a, 8, 4096);
+    TEST("explicit 4096 alignment", q && ((uintptr_t)q % 4096) == 0);
+    TEST("non power-of-two alignment rejected", xmss_arena_alloc(&a, 8, 48) == NULL);
+    TEST("oversized request rejected",
+         xmss_arena_alloc(&a, XMSS_ARENA_HUGEPAGE, 0) == NULL);
+
+    xmss_arena_stats(&a, &st);
+    TEST_INT("allocs counted", (long long)st.allocs, 3LL);
+    TEST_INT("failures counted", (long long)st.failed, 2LL);
+    TEST_INT("used = last end", (long long)st.used, (long long)(4096 + 8));
+    xmss_arena_destroy(&a);
+}
+
+static void test_states(void)
+{
+    xmss_arena         a;
+    xmss_arena_stats_t st;
+    xmss_mt_state     *s[64];
+    size_t             n = 0, i, want;
+    int                ok_align = 1, ok_zero = 1, ok_sep = 1;
+
+    xmss_arena_init(&a, 4 * XMSS_ARENA_HUGEPAGE, XMSS_ARENA_NODE_LOCAL);
+
+    while (n < 64 && (s[n] = xmss_arena_mt_state(&a)) != NULL) {
+        ok_align = ok_align && ((uintptr_t)s[n] % 4096) == 0;
+        ok_zero  = ok_zero && all_zero((const uint8_t *)s[n], sizeof(xmss_mt_state));
+        memset(s[n], (int)(n + 1), sizeof(xmss_mt_state));
+        n++;
+    }
+    /* Page-rounded stride, except the last state needs no trailing padding */
+    want = 1 + (4 * XMSS_ARENA_HUGEPAGE - sizeof(xmss_mt_state)) /
+               ((sizeof(xmss_mt_state) + 4095) & ~(size_t)4095);
+    TEST_INT("mt states per 8 MB arena", (long long)n, (long long)want);
+    TEST("mt states page-aligned", ok_align);
+    TEST("mt states start zeroed", ok_zero);
+    for (i = 0; i < n; i++) {
+        const uint8_t *b = (const uint8_t *)s[i];
+        ok_sep = ok_sep && b[0] == (uint8_t)(i + 1) &&
+                 b[sizeof(xmss_mt_state) - 1] == (uint8_t)(i + 1);
+    }
+    TEST("mt states do not overlap", ok_sep);
+
+    /* reset wipes, keeps the mapping and the high-water mark */
+    xmss_arena_reset(&a);
+    xmss_arena_stats(&a, &st);
+    TEST_INT("reset: used 0", (long long)st.used, 0LL);
+    TEST("reset: peak kept", st.peak >= n * sizeof(xmss_mt_state));
+    s[0] = xmss_arena_mt_state(&a);
+    TEST("reset: reused state is zeroed",
+         s[0] && all_zero((const uint8_t *)s[0], sizeof(xmss_mt_state)));
+    TEST("reset: bds state fits after", xmss_arena_bds_state(&a) != NULL);
+
+    xmss_arena_destroy(&a);
+    TEST("destroy clears handle", a.base == NULL && a.st.mapped == 0);
+    xmss_arena_destroy(&a);
+    TEST("destroy is idempotent", a.base == NULL);
+}
+
+int main(void)
+{
+    printf("=== test_arena ===\n");
+
+    printf("--- init ---\n");
+    test_init();
+    printf("--- alloc ---\n");
+    test_alloc();
+    printf("--- key states ---\n");
+    test_states();
+
+    return tests_done();
+}
@@ -0,0 +1,237 @@
+/**
+ * test_cxx_mt_builder.cpp - Background next-tree builder (mt_builder.hpp)
+ *
+ * Tests:
+ *   1. Whole key lifetime through mt_builder: every signature equals
+ *      plain xmss_mt_sign()'s, then the key reports exhaustion
+ *   2. Builder attached mid-life to a subset of layers and stopped
+ *      mid-tree; plain signing continues the same sequence
+ *   3. xmss_mt_sign_ext() / xmss_mt_next_build() argument checks; a
+ *      missing, wrong or partly built next tree leaves sk untouched
+ *   4. A key whose bds_k no next tree can begin with is refused
+ *   5. Worst sign latency with and without the builder (printed only)
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+#include "../include/xmss/mt_builder.hpp"
+
+using sig_list = std::vector<std::vector<std::uint8_t>>;
+
+static xmss::params custom_mt(std::uint32_t h, std::uint32_t d)
+{
+    xmss_params p;
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, h, d);
+    return xmss::params(p);
+}
+
+static xmss::mt_keypair make_key(const xmss::params &p, std::uint32_t bds_k)
+{
+    test_rng_reset(0x88);
+    return xmss::mt_private_key::generate(p, bds_k, test_randombytes);
+}
+
+static std::string msg_for(std::size_t i)
+{
+    return "mt-builder-" + std::to_string(i);
+}
+
+/* Every signature of a fresh key, signed inline */
+static sig_list reference(const xmss::params &p, std::uint32_t bds_k)
+{
+    xmss::mt_keypair kp = make_key(p, bds_k);
+    sig_list sigs;
+    while (kp.priv.remaining() > 0) {
+        sigs.push_back(kp.priv.sign(xmss::as_bytes(msg_for(sigs.size()))));
+    }
+    return sigs;
+}
+
+static void test_lifetime(const char *name, const xmss::params &p, std::uint32_t bds_k,
+                          const sig_list &ref)
+{
+    xmss::mt_keypair kp = make_key(p, bds_k);
+    bool same = true, verified = true, exhausted = false;
+    char label[96];
+
+    {
+        xmss::mt_builder b(kp.priv);
+        for (std::size_t i = 0; i < ref.size(); i++) {
+            std::vector<std::uint8_t> sig = b.sign(xmss::as_bytes(msg_for(i)));
+            same = same && sig == ref[i];
+            if (i % 13 == 0 || i + 1 == ref.size()) {
+                verified = verified && kp.pub.verify(xmss::as_bytes(msg_for(i)), sig);
+            }
+        }
+        try {
+            b.sign(xmss::as_bytes("one too many"));
+        } catch (const xmss::error &e) {
+            exhausted = e.code() == XMSS_ERR_EXHAUSTED;
+        }
+        std::printf("  %s: %llu boundary stalls\n", name, (unsigned long long)b.stalls());
+    }
+    std::snprintf(label, sizeof(label), "%s: all %zu signatures match inline signing",
+                  name, ref.size());
+    TEST(label, same);
+    std::snprintf(label, sizeof(label), "%s: signatures verify", name);
+    TEST(label, verified);
+    std::snprintf(label, sizeof(label), "%s: exhausted after the last index", name);
+    TEST(label, exhausted);
+}
+
+static void test_handback(const char *name, const xmss::params &p, std::uint32_t bds_k,
+                          std::uint32_t layers, const sig_list &ref)
+{
+    xmss::mt_keypair kp = make_key(p, bds_k);
+    std::size_t i = 0;
+    bool same = true;
+    char label[96];
+
+    for (; i < 5; i++) {
+        same = same && kp.priv.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+    }
+    {
+        xmss::mt_builder b(kp.priv, layers);
+        for (; i < 37; i++) {
+            same = same && b.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+        }
+    }
+    for (; i < ref.size(); i++) {
+        same = same && kp.priv.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+    }
+    std::snprintf(label, sizeof(label), "%s: attach at 5, stop at 37, continue inline", name);
+    TEST(label, same);
+}
+
+static void test_bad_bds_k(const xmss::params &p)
+{
+    xmss::mt_keypair kp = make_key(p, 0);
+    xmss::priority_pool pool(1);
+
+    /* restore() takes bds_k on trust; the builder must not */
+    for (std::uint32_t k : { 3u, p.c_ptr()->tree_height + 2 }) {
+        xmss::mt_private_key bad =
+            xmss::mt_private_key::restore(p, k, kp.priv.sk_bytes(), kp.priv.state());
+        int thread_rc = XMSS_OK, pool_rc = XMSS_OK;
+        char label[96];
+
+        try {
+            xmss::mt_builder b(bad);
+        } catch (const xmss::error &e) {
+            thread_rc = e.code();
+        }
+        try {
+            xmss::mt_builder b(bad, pool);
+        } catch (const xmss::error &e) {
+            pool_rc = e.code();
+        }
+        std::snprintf(label, sizeof(label), "bds_k=%u refused (thread and pool)", (unsigned)k);
+        TEST(label, thread_rc == XMSS_ERR_PARAMS && pool_rc == XMSS_ERR_PARAMS);
+    }
+}
+
+static void test_c_api(void)
+{
+    xmss::params p = custom_mt(6, 3);            /* tree height 2 */
+    xmss::mt_keypair kp = make_key(p, 0);
+    const xmss_params *cp = p.c_ptr();
+    std::vector<std::uint8_t> sig(p.sig_bytes()), sk_before;
+    xmss_mt_next_tree nt;
+    const xmss_mt_next_tree *next[XMSS_MAX_D - 1] = {};
+    const char *m = "x";
+
+    TEST_INT("next_build: top layer rejected",
+             xmss_mt_next_build(cp, kp.priv.sk_data(), 2, 0, 0, &nt), XMSS_ERR_PARAMS);
+    TEST_INT("next_build: tree past the layer rejected",
+             xmss_mt_next_build(cp, kp.priv.sk_data(), 0, 16, 0, &nt), XMSS_ERR_PARAMS);
+    TEST_INT("next_build: odd bds_k rejected",
+             xmss_mt_next_build(cp, kp.priv.sk_data(), 0, 1, 1, &nt), XMSS_ERR_PARAMS);
+    TEST_INT("sign_ext: top-layer bit rejected",
+             xmss_mt_sign_ext(cp, sig.data(), (const std::uint8_t *)m, 1, kp.priv.sk_data(),
+                              kp.priv.state_data(), 0, 4u, next), XMSS_ERR_PARAMS);
+
+    /* idx 0..2 need nothing; idx 3 ends layer 0's tree 0 */
+    for (int i = 0; i < 3; i++) {
+        TEST_INT("sign_ext: no boundary, no next tree needed",
+                 xmss_mt_sign_ext(cp, sig.data(), (const std::uint8_t *)m, 1,
+                                  kp.priv.sk_data(), kp.priv.state_data(), 0, 1u, nullptr),
+                 XMSS_OK);
+    }
+    sk_before.assign(kp.priv.sk_data(), kp.priv.sk_data() + p.sk_bytes());
+    TEST_INT("sign_ext: missing next tree at boundary",
+             xmss_mt_sign_ext(cp, sig.data(), (const std::uint8_t *)m, 1, kp.priv.sk_data(),
+                              kp.priv.state_data(), 0, 1u, next), XMSS_ERR_PARAMS);
+    xmss_mt_next_build(cp, kp.priv.sk_data(), 0, 2, 0, &nt);
+    next[0] = &nt;
+    TEST_INT("sign_ext: wrong next tree at boundary",
+             xmss_mt_sign_ext(cp, sig.data(), (const std::uint8_t *)m, 1, kp.priv.sk_data(),
+                              kp.priv.state_data(), 0, 1u, next), XMSS_ERR_PARAMS);
+    xmss_mt_next_begin(cp, 0, 1, 0, &nt);
+    xmss_mt_next_step(cp, kp.priv.sk_data(), 0, &nt, 1);
+    TEST_INT("sign_ext: partly built next tree at boundary",
+             xmss_mt_sign_ext(cp, sig.data(), (const std::uint8_t *)m, 1, kp.priv.sk_data(),
+                              kp.priv.state_data(), 0, 1u, next), XMSS_ERR_PARAMS);
+    TEST("sign_ext: rejected calls leave sk untouched",
+         std::memcmp(sk_before.data(), kp.priv.sk_data(), p.sk_bytes()) == 0);
+    xmss_mt_next_build(cp, kp.priv.sk_data(), 0, 1, 0, &nt);
+    TEST_INT("sign_ext: right next tree accepted",
+             xmss_mt_sign_ext(cp, sig.data(), (const std::uint8_t *)m, 1, kp.priv.sk_data(),
+                              kp.priv.state_data(), 0, 1u, next), XMSS_OK);
+    TEST("sign_ext: boundary signature verifies",
+         kp.pub.verify(xmss::as_bytes("x"), xmss::bytes_view(sig.data(), sig.size())));
+}
+
+static void latency(void)
+{
+    xmss::params p = custom_mt(6, 2);            /* tree height 3 */
+    double worst[2] = { 0, 0 };
+
+    for (int mode = 0; mode < 2; mode++) {
+        xmss::mt_keypair kp = make_key(p, 0);
+        xmss::mt_builder b(kp.priv, mode ? ~0u : 0u);
+        for (std::size_t i = 0; i < 24; i++) {
+            auto t0 = std::chrono::steady_clock::now();
+            b.sign(xmss::as_bytes(msg_for(i)));
+            std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+            worst[mode] = dt.count() > worst[mode] ? dt.count() : worst[mode];
+        }
+    }
+    std::printf("  worst sign latency (ms): inline %.1f, builder %.1f\n", worst[0], worst[1]);
+}
+
+int main(void)
+{
+    std::printf("=== test_cxx_mt_builder ===\n");
+
+    xmss::params p63 = custom_mt(6, 3);
+    xmss::params p62 = custom_mt(6, 2);
+
+    std::printf("--- whole lifetime ---\n");
+    sig_list ref63k0 = reference(p63, 0);
+    sig_list ref63k2 = reference(p63, 2);
+    sig_list ref62k2 = reference(p62, 2);
+    test_lifetime("6/3 k=0", p63, 0, ref63k0);
+    test_lifetime("6/3 k=2", p63, 2, ref63k2);
+    test_lifetime("6/2 k=2", p62, 2, ref62k2);
+
+    std::printf("--- hand back ---\n");
+    test_handback("6/3 k=0 all layers", p63, 0, ~0u, ref63k0);
+    test_handback("6/3 k=2 layer 1 only", p63, 2, 2u, ref63k2);
+    test_handback("6/2 k=2 layer 0", p62, 2, 1u, ref62k2);
+
+    std::printf("--- C API ---\n");
+    test_c_api();
+
+    std::printf("--- bad bds_k ---\n");
+    test_bad_bds_k(p63);
+
+    std::printf("--- latency ---\n");
+    latency();
+
+    return tests_done();
+}
@@ -0,0 +1,485 @@
+/**
+ * test_cxx_pool.cpp - Priority worker pool (pool.hpp) and stepped builds
+ *
+ * Tests:
+ *   1. xmss_keygen_step() / xmss_mt_keygen_step() / xmss_mt_next_step()
+ *      in uneven steps: keys, state and next trees byte-identical to the
+ *      one-call functions
+ *   2. Class order: queued interactive, advance and bulk tasks run
+ *      highest class first
+ *   3. A step task yields to interactive work at a step boundary; a
+ *      throwing one-shot task is recorded and dropped, a throwing step
+ *      task fails its future, and the worker carries on
+ *   4. generate_async() equals generate() for the same entropy
+ *   5. mt_builder on a one-worker pool shared with a bulk keygen, and
+ *      with signing itself running as a pool task: every signature
+ *      equals inline signing
+ *   6. verify_batch() through at(priority::interactive)
+ *   7. Interactive task latency behind a keygen, FIFO vs priority pool
+ *      (printed only)
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_utils.h"
+#include "../include/xmss/mt_builder.hpp"
+#include "../include/xmss/pool.hpp"
+
+using sig_list = std::vector<std::vector<std::uint8_t>>;
+
+static xmss::params custom(std::uint32_t h, std::uint32_t d)
+{
+    xmss_params p;
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, h, d);
+    return xmss::params(p);
+}
+
+static std::string msg_for(std::size_t i)
+{
+    return "pool-" + std::to_string(i);
+}
+
+/* ------------------------------------------------------------------ */
+/* 1. Stepped C API                                                    */
+/* ------------------------------------------------------------------ */
+
+static void test_stepped_xmss(std::uint32_t h, std::uint32_t bds_k)
+{
+    xmss::params p = custom(h, 1);
+    const xmss_params *cp = p.c_ptr();
+    std::vector<std::uint8_t> pk1(p.pk_bytes()), sk1(p.sk_bytes());
+    std::vector<std::uint8_t> pk2(p.pk_bytes()), sk2(p.sk_bytes());
+    std::unique_ptr<xmss_bds_state> s1(new xmss_bds_state), s2(new xmss_bds_state);
+    xmss_keygen_ctx kc;
+    std::uint32_t step = 1;
+    int left, calls = 0;
+    char label[96];
+
+    test_rng_reset(0x51);
+    xmss_keygen(cp, pk1.data(), sk1.data(), s1.get(), bds_k, test_randombytes);
+    std::memset(s2.get(), 0xA5, sizeof(*s2));
+    test_rng_reset(0x51);
+    xmss_keygen_begin(cp, &kc, sk2.data(), s2.get(), bds_k, test_randombytes);
+    while ((left = xmss_keygen_step(cp, &kc, pk2.data(), sk2.data(), s2.get(),
+                                    bds_k, step)) > 0) {
+        step = step % 7 + 1;
+        calls++;
+    }
+    std::snprintf(label, sizeof(label), "XMSS h=%u k=%u: %d steps, key and state identical",
+                  h, bds_k, calls + 1);
+    TEST(label, left == 0 && pk1 == pk2 && sk1 == sk2 &&
+                std::memcmp(s1.get(), s2.get(), sizeof(*s1)) == 0);
+}
+
+static void test_stepped_mt(std::uint32_t h, std::uint32_t d, std::uint32_t bds_k)
+{
+    xmss::params p = custom(h, d);
+    const xmss_params *cp = p.c_ptr();
+    std::vector<std::uint8_t> pk1(p.pk_bytes()), sk1(p.sk_bytes());
+    std::vector<std::uint8_t> pk2(p.pk_bytes()), sk2(p.sk_bytes());
+    std::unique_ptr<xmss_mt_state> s1(new xmss_mt_state), s2(new xmss_mt_state);
+    std::unique_ptr<xmss_mt_next_tree> n1(new xmss_mt_next_tree), n2(new xmss_mt_next_tree);
+    xmss_keygen_ctx kc;
+    std::uint32_t step = 3;
+    int left, calls = 0;
+    bool next_same = true;
+    char label[96];
+
+    test_rng_reset(0x52);
+    xmss_mt_keygen(cp, pk1.data(), sk1.data(), s1.get(), bds_k, test_randombytes);
+    std::memset(s2.get(), 0x5A, sizeof(*s2));
+    test_rng_reset(0x52);
+    xmss_mt_keygen_begin(cp, &kc, sk2.data(), s2.get(), bds_k, test_randombytes);
+    while ((left = xmss_mt_keygen_step(cp, &kc, pk2.data(), sk2.data(), s2.get(),
+                                       bds_k, step)) > 0) {
+        step = step % 9 + 1;
+        calls++;
+    }
+    std::snprintf(label, sizeof(label), "XMSS-MT %u/%u k=%u: %d steps, key and state identical",
+                  h, d, bds_k, calls + 1);
+    TEST(label, left == 0 && pk1 == pk2 && sk1 == sk2 &&
+                std::memcmp(s1.get(), s2.get(), sizeof(*s1)) == 0);
+
+    for (std::uint32_t layer = 0; layer + 1 < d; layer++) {
+        xmss_mt_next_build(cp, sk1.data(), layer, 1, bds_k, n1.get());
+        std::memset(n2.get(), 0x3C, sizeof(*n2));
+        xmss_mt_next_begin(cp, layer, 1, bds_k, n2.get());
+        while (xmss_mt_next_step(cp, sk1.data(), bds_k, n2.get(), 5) > 0) {
+        }
+        next_same = next_same && std::memcmp(n1.get(), n2.get(), sizeof(*n1)) == 0;
+    }
+    std::snprintf(label, sizeof(label), "XMSS-MT %u/%u k=%u: stepped next trees identical",
+                  h, d, bds_k);
+    TEST(label, next_same);
+}
+
+static void test_stepped_args(void)
+{
+    xmss::params p = custom(6, 3);
+    const xmss_params *cp = p.c_ptr();
+    std::vector<std::uint8_t> pk(p.pk_bytes()), sk(p.sk_bytes());
+    std::unique_ptr<xmss_mt_state> st(new xmss_mt_state);
+    xmss_mt_next_tree nt;
+    xmss_keygen_ctx kc;
+
+    test_rng_reset(0x53);
+    TEST_INT("keygen_begin: odd bds_k rejected",
+             xmss_mt_keygen_begin(cp, &kc, sk.data(), st.get(), 1, test_randombytes),
+             XMSS_ERR_PARAMS);
+    TEST_INT("keygen_begin: accepted",
+             xmss_mt_keygen_begin(cp, &kc, sk.data(), st.get(), 0, test_randombytes), XMSS_OK);
+    TEST_INT("keygen_step: zero leaves rejected",
+             xmss_mt_keygen_step(cp, &kc, pk.data(), sk.data(), st.get(), 0, 0),
+             XMSS_ERR_PARAMS);
+    TEST_INT("keygen_step: 3 layers x 4 leaves left after one",
+             xmss_mt_keygen_step(cp, &kc, pk.data(), sk.data(), st.get(), 0, 1), 11);
+    TEST_INT("next_begin: top layer rejected", xmss_mt_next_begin(cp, 2, 0, 0, &nt),
+             XMSS_ERR_PARAMS);
+    TEST_INT("next_begin: accepted", xmss_mt_next_begin(cp, 1, 1, 0, &nt), XMSS_OK);
+    TEST_INT("next_step: zero leaves rejected",
+             xmss_mt_next_step(cp, sk.data(), 0, &nt, 0), XMSS_ERR_PARAMS);
+    TEST_INT("next_step: finishes", xmss_mt_next_step(cp, sk.data(), 0, &nt, 4), 0);
+    TEST_INT("next_step: complete tree is a no-op",
+             xmss_mt_next_step(cp, sk.data(), 0, &nt, 4), 0);
+}
+
+/* ------------------------------------------------------------------ */
+/* 2-3. Scheduling                                                     */
+/* ------------------------------------------------------------------ */
+
+static void test_class_order(void)
+{
+    xmss::priority_pool pool(1);
+    std::promise<void> gate;
+    std::shared_future<void> open = gate.get_future().share();
+    std::mutex mu;
+    std::string order;
+    auto note = [&](char c) {
+        std::lock_guard<std::mutex> lock(mu);
+        order += c;
+    };
+
+    /* Hold the only worker while the three classes queue up */
+    pool.post(xmss::priority::interactive, [open] { open.wait(); });
+    while (pool.steps(xmss::priority::interactive) == 0) {
+        std::this_thread::yield();
+    }
+    pool.post(xmss::priority::bulk, [&] { note('b'); });
+    pool.post(xmss::priority::advance, [&] { note('a'); });
+    std::future<void> f = pool.post_steps(xmss::priority::bulk, [&] { note('B'); return false; });
+    pool.at(xmss::priority::advance).execute([&] { note('A'); });
+    pool.execute([&] { note('i'); });
+    gate.set_value();
+    f.wait();
+
+    std::lock_guard<std::mutex> lock(mu);
+    TEST("queued tasks run by class, FIFO within a class", order == "iaAbB");
+}
+
+static void test_preemption(void)
+{
+    xmss::priority_pool pool(1);
+    std::atomic<std::uint64_t> bulk_steps{ 0 };
+    std::atomic<bool> served{ false };
+    std::uint64_t at_serve = 0;
+
+    /* Runs until the interactive task has been served */
+    std::future<void> bulk = pool.post_steps(xmss::priority::bulk, [&] {
+        bulk_steps.fetch_add(1);
+        return !served.load() && bulk_steps.load() < 100000000u;
+    });
+    while (bulk_steps.load() == 0) {
+        std::this_thread::yield();
+    }
+    std::future<void> inter = pool.post_steps(xmss::priority::interactive, [&] {
+        at_serve = bulk_steps.load();
+        served.store(true);
+        return false;
+    });
+    inter.wait();
+    bulk.wait();
+
+    TEST("interactive task served while the step task was still running",
+         at_serve > 0 && bulk_steps.load() < 100000000u);
+    TEST("step task set aside at a step boundary", pool.preemptions() >= 1);
+}
+
+static void test_throwing_tasks(void)
+{
+    xmss::priority_pool pool(1);
+    bool caught = false;
+    std::atomic<bool> ran{ false };
+
+    pool.post(xmss::priority::bulk, [] { throw std::runtime_error("one-shot"); });
+    std::future<void> f = pool.post_steps(xmss::priority::bulk, []() -> bool {
+        throw std::runtime_error("step");
+    });
+    try {
+        f.get();
+    } catch (const std::runtime_error &e) {
+        caught = std::strcmp(e.what(), "step") == 0;
+    }
+    std::future<void> after = pool.post_steps(xmss::priority::bulk, [&ran] {
+        ran.store(true);
+        return false;
+    });
+    after.wait();
+
+    TEST("throwing step task fails its future", caught);
+    TEST("throwing one-shot task recorded, not rethrown", pool.failures() == 1 &&
+         pool.last_error() != nullptr);
+    TEST("worker still runs tasks afterwards", ran.load());
+}
+
+/* ------------------------------------------------------------------ */
+/* 4. generate_async()                                                 */
+/* ------------------------------------------------------------------ */
+
+template <class Traits>
+static void test_generate_async(const char *name, const xmss::params &p, std::uint32_t bds_k)
+{
+    using state_type = typename Traits::state_type;
+    xmss::priority_pool pool(2);
+    char label[96];
+
+    test_rng_reset(0x54);
+    xmss::basic_keypair<Traits> ref = xmss::basic_private_key<Traits>::generate(p, bds_k,
+                                                                                test_randombytes);
+    test_rng_reset(0x54);
+    std::future<xmss::basic_keypair<Traits>> fut =
+        xmss::generate_async<Traits>(pool, p, bds_k, test_randombytes);
+    xmss::basic_keypair<Traits> kp = fut.get();
+
+    bool same = std::equal(ref.pub.bytes().begin(), ref.pub.bytes().end(),
+                           kp.pub.bytes().begin()) &&
+                std::equal(ref.priv.sk_bytes().begin(), ref.priv.sk_bytes().end(),
+                           kp.priv.sk_bytes().begin()) &&
+                std::memcmp(&ref.priv.state(), &kp.priv.state(), sizeof(state_type)) == 0;
+    std::snprintf(label, sizeof(label), "%s: generate_async equals generate", name);
+    TEST(label, same);
+
+    std::vector<std::uint8_t> sig = kp.priv.sign(xmss::as_bytes("async"));
+    std::snprintf(label, sizeof(label), "%s: signature verifies", name);
+    TEST(label, kp.pub.verify(xmss::as_bytes("async"), sig));
+    std::snprintf(label, sizeof(label), "%s: keygen ran in bulk steps", name);
+    TEST(label, pool.steps(xmss::priority::bulk) > 1);
+}
+
+/* ------------------------------------------------------------------ */
+/* 5. mt_builder on the pool                                           */
+/* ------------------------------------------------------------------ */
+
+static xmss::mt_keypair make_mt(const xmss::params &p, std::uint32_t bds_k)
+{
+    test_rng_reset(0x55);
+    return xmss::mt_private_key::generate(p, bds_k, test_randombytes);
+}
+
+static sig_list reference(const xmss::params &p, std::uint32_t bds_k)
+{
+    xmss::mt_keypair kp = make_mt(p, bds_k);
+    sig_list sigs;
+    while (kp.priv.remaining() > 0) {
+        sigs.push_back(kp.priv.sign(xmss::as_bytes(msg_for(sigs.size()))));
+    }
+    return sigs;
+}
+
+static void test_builder_on_pool(const char *name, const xmss::params &p,
+                                 std::uint32_t bds_k, const sig_list &ref)
+{
+    xmss::priority_pool pool(1);
+    xmss::mt_keypair kp = make_mt(p, bds_k);
+    bool same = true, same_task = true;
+    std::uint64_t stalls, stalls_task;
+    std::size_t i = 0, half = ref.size() / 2;
+    char label[96];
+
+    /* Bulk keygen on the same worker throughout */
+    test_rng_reset(0x56);
+    std::future<xmss::mt_keypair> bg =
+        xmss::generate_async<xmss::multi_tree>(pool, custom(10, 2), 0, test_randombytes);
+
+    {
+        xmss::mt_builder b(kp.priv, pool);
+        for (; i < half; i++) {
+            same = same && b.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+        }
+        stalls = b.stalls();
+
+        /* Signing as an interactive task: the builder cannot get the
+         * worker, so boundary signatures finish the trees themselves */
+        pool.post_steps(xmss::priority::interactive, [&] {
+            for (; i < ref.size(); i++) {
+                same_task = same_task && b.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+            }
+            return false;
+        }).wait();
+        stalls_task = b.stalls() - stalls;
+    }
+    bg.wait();
+
+    std::printf("  %s: %llu + %llu boundary stalls\n", name, (unsigned long long)stalls,
+                (unsigned long long)stalls_task);
+    std::snprintf(label, sizeof(label), "%s: signatures match inline signing", name);
+    TEST(label, same);
+    std::snprintf(label, sizeof(label), "%s: ... also signing inside a pool task", name);
+    TEST(label, same_task && i == ref.size());
+    std::snprintf(label, sizeof(label), "%s: builder ran at advance priority", name);
+    TEST(label, pool.steps(xmss::priority::advance) > 0);
+}
+
+static void test_builder_stop(const xmss::params &p, const sig_list &ref)
+{
+    xmss::priority_pool pool(2);
+    xmss::mt_keypair kp = make_mt(p, 2);
+    std::size_t i = 0;
+    bool same = true;
+
+    for (; i < 3; i++) {
+        same = same && kp.priv.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+    }
+    {
+        xmss::mt_builder b(kp.priv, pool, 2u);
+        for (; i < 29; i++) {
+            same = same && b.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+        }
+        b.stop();
+        b.stop();
+    }
+    for (; i < ref.size(); i++) {
+        same = same && kp.priv.sign(xmss::as_bytes(msg_for(i))) == ref[i];
+    }
+    TEST("pool builder: attach at 3, stop at 29, continue inline", same);
+}
+
+/* ------------------------------------------------------------------ */
+/* 6. verify_batch() on the pool                                       */
+/* ------------------------------------------------------------------ */
+
+static void test_verify_batch(void)
+{
+    xmss::params p = custom(6, 2);
+    xmss::mt_keypair kp = make_mt(p, 0);
+    xmss::priority_pool pool(2);
+    xmss::priority_pool::executor ex = pool.at(xmss::priority::interactive);
+    sig_list sigs;
+    std::vector<std::string> msgs;
+    std::vector<xmss::verify_item> items;
+
+    for (std::size_t i = 0; i < 20; i++) {
+        msgs.push_back(msg_for(i));
+        sigs.push_back(kp.priv.sign(xmss::as_bytes(msgs.back())));
+    }
+    sigs[7][p.sig_bytes() / 2] ^= 1;
+    for (std::size_t i = 0; i < 20; i++) {
+        items.push_back({ xmss::as_bytes(msgs[i]), sigs[i], kp.pub.bytes() });
+    }
+    std::vector<bool> ok = xmss::verify_batch(ex, p, items).get();
+    bool expect = ok.size() == 20;
+    for (std::size_t i = 0; i < ok.size(); i++) {
+        expect = expect && ok[i] == (i != 7);
+    }
+    TEST("verify_batch on at(interactive): only the tampered item fails", expect);
+}
+
+/* ------------------------------------------------------------------ */
+/* 7. Latency behind a keygen (printed only)                           */
+/* ------------------------------------------------------------------ */
+
+static double time_task(const std::function<void(std::function<void()>)> &post)
+{
+    std::promise<void> ran;
+    std::future<void>  f = ran.get_future();
+    auto t0 = std::chrono::steady_clock::now();
+
+    post([&ran] { ran.set_value(); });
+    f.wait();
+    std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+    return dt.count();
+}
+
+static void latency(void)
+{
+    xmss::params p = custom(10, 2);
+    double fifo, prio;
+
+    {
+        xmss::thread_pool pool(1);
+        std::atomic<bool> started{ false };
+
+        pool.execute([&started, p] {
+            started.store(true);
+            test_rng_reset(0x57);
+            (void)xmss::mt_private_key::generate(p, 0, test_randombytes);
+        });
+        while (!started.load()) {
+            std::this_thread::yield();
+        }
+        fifo = time_task([&pool](std::function<void()> t) { pool.execute(std::move(t)); });
+    }
+    {
+        xmss::priority_pool pool(1);
+
+        test_rng_reset(0x57);
+        std::future<xmss::mt_keypair> bg =
+            xmss::generate_async<xmss::multi_tree>(pool, p, 0, test_randombytes);
+        while (pool.steps(xmss::priority::bulk) == 0) {
+            std::this_thread::yield();
+        }
+        prio = time_task([&pool](std::function<void()> t) { pool.execute(std::move(t)); });
+        bg.wait();
+    }
+    std::printf("  task wait behind an XMSS-MT 10/2 keygen (ms): FIFO %.2f, priority %.2f\n",
+                fifo, prio);
+}
+
+int main(void)
+{
+    std::printf("=== test_cxx_pool ===\n");
+
+    std::printf("--- stepped builds ---\n");
+    test_stepped_xmss(8, 0);
+    test_stepped_xmss(9, 4);
+    test_stepped_mt(10, 2, 0);
+    test_stepped_mt(9, 3, 2);
+    test_stepped_mt(12, 3, 4);
+    test_stepped_args();
+
+    std::printf("--- scheduling ---\n");
+    test_class_order();
+    test_preemption();
+    test_throwing_tasks();
+
+    std::printf("--- generate_async ---\n");
+    test_generate_async<xmss::single_tree>("XMSS h=8 k=2", custom(8, 1), 2);
+    test_generate_async<xmss::multi_tree>("XMSS-MT 10/2 k=0", custom(10, 2), 0);
+
+    std::printf("--- mt_builder on the pool ---\n");
+    xmss::params p63 = custom(6, 3);
+    sig_list ref63k0 = reference(p63, 0);
+    sig_list ref63k2 = reference(p63, 2);
+    test_builder_on_pool("6/3 k=0", p63, 0, ref63k0);
+    test_builder_on_pool("6/3 k=2", p63, 2, ref63k2);
+    test_builder_stop(p63, ref63k2);
+
+    std::printf("--- verify_batch ---\n");
+    test_verify_batch();
+
+    std::printf("--- latency ---\n");
+    latency();
+
+    return tests_done();
+}
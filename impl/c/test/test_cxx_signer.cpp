@@ -0,0 +1,261 @@
+/**
+ * test_cxx_signer.cpp - Tests for the signer runtime (signer.hpp)
+ *
+ * Tests:
+ *   1. mpsc_ring: capacity rounding, full/empty, FIFO, concurrent producers
+ *   2. signer_service: concurrent producers get distinct, valid signatures
+ *   3. Commit hook runs once per batch before signatures are released
+ *   4. Callback submit; key handed back by release() continues the sequence
+ *   5. Failed commit withholds the batch (XMSS_ERR_IO to callbacks);
+ *      submit after shutdown throws
+ *   6. Producers racing shutdown: every accepted request completes
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_utils.h"
+#include "../include/xmss/signer.hpp"
+
+static std::uint32_t sig_idx(const std::vector<std::uint8_t> &sig)
+{
+    return (std::uint32_t)sig[0] << 24 | (std::uint32_t)sig[1] << 16 |
+           (std::uint32_t)sig[2] << 8 | sig[3];
+}
+
+static void test_ring(void)
+{
+    xmss::mpsc_ring<int> ring(5);
+    TEST_INT("ring capacity rounded to pow2", ring.capacity(), 8);
+
+    int v = 0;
+    TEST("empty ring pops nothing", !ring.try_pop(v));
+    for (int i = 0; i < 8; i++) {
+        int x = i;
+        ring.try_push(x);
+    }
+    int extra = 99;
+    TEST("full ring rejects push", !ring.try_push(extra));
+    TEST_INT("rejected value untouched", extra, 99);
+
+    bool fifo = true;
+    for (int i = 0; i < 8; i++) {
+        fifo = fifo && ring.try_pop(v) && v == i;
+    }
+    TEST("ring is FIFO", fifo);
+    TEST("ring drained", !ring.ready());
+
+    /* 4 producers x 5000 items through a 64-slot ring */
+    xmss::mpsc_ring<int> mp(64);
+    const int per = 5000;
+    std::vector<std::thread> prod;
+    for (int t = 0; t < 4; t++) {
+        prod.emplace_back([&mp, t] {
+            for (int i = 0; i < per; i++) {
+                int x = t * per + i;
+                while (!mp.try_push(x)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::vector<int> last(4, -1);
+    bool ordered = true;
+    long long sum = 0;
+    for (int got = 0; got < 4 * per;) {
+        if (mp.try_pop(v)) {
+            std::size_t t = (std::size_t)(v / per);
+            ordered = ordered && v > last[t];
+            last[t] = v;
+            sum += v;
+            got++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread &th : prod) {
+        th.join();
+    }
+    TEST("per-producer order preserved", ordered);
+    TEST("every item delivered once", sum == (long long)(4 * per) * (4 * per - 1) / 2);
+}
+
+static void test_service(void)
+{
+    xmss::params p = xmss::params::from_oid(OID_XMSS_SHA2_10_256);
+
+    test_rng_reset(0x516E);
+    xmss::keypair kp = xmss::private_key::generate(p, 2, test_randombytes);
+
+    std::atomic<int> commits{ 0 };
+    std::atomic<std::uint32_t> committed_remaining{ 0 };
+    std::atomic<bool> released_before_commit{ false };
+
+    xmss::signer_service::options opt;
+    opt.queue_capacity = 8;
+    opt.max_batch      = 4;
+    opt.commit = [&](const xmss::private_key &k) {
+        commits++;
+        committed_remaining = (std::uint32_t)k.remaining();
+    };
+
+    const std::size_t producers = 3, per = 12;
+    std::vector<std::string> msgs;
+    for (std::size_t i = 0; i < producers * per; i++) {
+        msgs.push_back("msg-" + std::to_string(i));
+    }
+    std::vector<std::vector<std::uint8_t>> sigs(msgs.size());
+
+    std::optional<xmss::private_key> back;
+    {
+        xmss::signer_service svc(std::move(kp.priv), opt);
+        std::vector<std::thread> prod;
+        for (std::size_t t = 0; t < producers; t++) {
+            prod.emplace_back([&, t] {
+                for (std::size_t i = t * per; i < (t + 1) * per; i++) {
+                    auto fut = svc.submit(xmss::as_bytes(msgs[i]));
+                    sigs[i] = fut.get();
+                    /* Our batch was committed before we saw its signature */
+                    if ((std::uint32_t)1024 - sig_idx(sigs[i]) - 1 < committed_remaining) {
+                        released_before_commit = true;
+                    }
+                }
+            });
+        }
+        for (std::thread &th : prod) {
+            th.join();
+        }
+        TEST_INT("service signature count", svc.signatures(), producers * per);
+        TEST("batches <= signatures", svc.batches() <= svc.signatures());
+        TEST_INT("one commit per batch", commits.load(), svc.batches());
+
+        /* Callback flavour */
+        std::atomic<int> cb_rc{ 1 };
+        std::vector<std::uint8_t> cb_sig;
+        std::promise<void> done;
+        svc.submit(xmss::as_bytes("callback"), [&](int rc, xmss::bytes_view s) {
+            cb_rc = rc;
+            cb_sig.assign(s.data(), s.data() + s.size());
+            done.set_value();
+        });
+        done.get_future().wait();
+        TEST_INT("callback rc", cb_rc.load(), XMSS_OK);
+        TEST("callback sig verifies", kp.pub.verify(xmss::as_bytes("callback"), cb_sig));
+
+        back.emplace(svc.release());
+
+        int code = 0;
+        try {
+            (void)svc.submit(xmss::as_bytes("late"));
+        } catch (const std::logic_error &) {
+            code = 1;
+        }
+        TEST("submit after shutdown throws", code == 1);
+    }
+
+    TEST("no signature released before its commit", !released_before_commit.load());
+
+    std::set<std::uint32_t> idx;
+    bool all_valid = true;
+    for (std::size_t i = 0; i < msgs.size(); i++) {
+        idx.insert(sig_idx(sigs[i]));
+        all_valid = all_valid && kp.pub.verify(xmss::as_bytes(msgs[i]), sigs[i]);
+    }
+    TEST_INT("indices distinct", idx.size(), msgs.size());
+    TEST_INT("indices contiguous", *idx.rbegin(), msgs.size() - 1);
+    TEST("all service signatures verify", all_valid);
+
+    /* Released key continues after the callback signature */
+    std::vector<std::uint8_t> next = back->sign(xmss::as_bytes("after"));
+    TEST_INT("released key next idx", sig_idx(next), msgs.size() + 1);
+    TEST("released key sig verifies", kp.pub.verify(xmss::as_bytes("after"), next));
+
+    /* A throwing commit hook withholds the batch's signatures */
+    {
+        xmss::signer_service::options bad;
+        bad.commit = [](const xmss::private_key &) {
+            throw std::runtime_error("disk full");
+        };
+        xmss::signer_service svc(std::move(*back), bad);
+        auto fut = svc.submit(xmss::as_bytes("lost"));
+        bool threw = false;
+        try {
+            (void)fut.get();
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        TEST("commit failure propagates to future", threw);
+
+        std::atomic<int> cb_rc{ 1 };
+        std::promise<void> done;
+        svc.submit(xmss::as_bytes("lost too"), [&](int rc, xmss::bytes_view) {
+            cb_rc = rc;
+            done.set_value();
+        });
+        done.get_future().wait();
+        TEST_INT("commit failure is XMSS_ERR_IO to callbacks", cb_rc.load(), XMSS_ERR_IO);
+        back.emplace(svc.release());
+    }
+
+    /* Producers keep submitting while shutdown() runs */
+    {
+        using future_t = std::future<std::vector<std::uint8_t>>;
+        xmss::signer_service::options opt2;
+        opt2.queue_capacity = 4;
+        opt2.max_batch      = 2;
+        xmss::signer_service svc(std::move(*back), opt2);
+        std::vector<std::vector<future_t>> futs(4);
+        std::atomic<int> started{ 0 };
+        std::vector<std::thread> prod;
+        for (std::size_t t = 0; t < futs.size(); t++) {
+            prod.emplace_back([&, t] {
+                started++;
+                try {
+                    for (;;) {
+                        future_t f;
+                        if (svc.try_submit(xmss::as_bytes("race"), f)) {
+                            futs[t].push_back(std::move(f));
+                        }
+                    }
+                } catch (const std::logic_error &) {
+                }
+            });
+        }
+        while (started.load() < (int)futs.size() || svc.signatures() < 8) {
+            std::this_thread::yield();
+        }
+        svc.shutdown();
+        for (std::thread &th : prod) {
+            th.join();
+        }
+        std::size_t accepted = 0, ready = 0;
+        for (std::vector<future_t> &v : futs) {
+            for (future_t &f : v) {
+                accepted++;
+                ready += f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }
+        }
+        TEST("shutdown race: every accepted request completed", ready == accepted);
+        TEST_INT("shutdown race: all signed", svc.signatures(), accepted);
+    }
+}
+
+int main(void)
+{
+    printf("=== test_cxx_signer ===\n");
+
+    printf("--- mpsc_ring ---\n");
+    test_ring();
+
+    printf("--- signer_service ---\n");
+    test_service();
+
+    return tests_done();
+}
@@ -0,0 +1,162 @@
+/**
+ * test_cxx_wrapper.cpp - Tests for the header-only C++17 wrapper (xmss.hpp)
+ *
+ * Tests:
+ *   1. Move-only key types (compile-time checks)
+ *   2. params factories and error reporting
+ *   3. XMSS keygen -> span sign into caller buffer -> verify
+ *   4. Key move keeps signing from the same state
+ *   5. verify_batch on a thread_pool (valid + tampered items)
+ *   6. sign_batch delivers in-order signatures through a future
+ *   7. XMSS-MT keygen -> sign -> verify
+ */
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "test_utils.h"
+#include "../include/xmss/xmss.hpp"
+
+static_assert(!std::is_copy_constructible_v<xmss::private_key>,
+              "private_key must not be copyable");
+static_assert(!std::is_copy_assignable_v<xmss::mt_private_key>,
+              "mt_private_key must not be copy-assignable");
+static_assert(std::is_nothrow_move_constructible_v<xmss::mt_private_key>,
+              "mt_private_key must be cheaply movable");
+
+static void test_params(void)
+{
+    xmss::params p = xmss::params::from_oid(OID_XMSS_SHA2_10_256);
+    TEST_INT("params oid", p.oid(), OID_XMSS_SHA2_10_256);
+    TEST("params not mt", !p.is_mt());
+
+    xmss::params q = xmss::params::from_name("XMSSMT-SHA2_20/2_256");
+    TEST("from_name mt", q.is_mt());
+    TEST_INT("from_name mt oid", q.oid(), OID_XMSS_MT_SHA2_20_2_256);
+
+    int code = 0;
+    try {
+        (void)xmss::params::from_oid(0xFFFFu);
+    } catch (const xmss::error &e) {
+        code = e.code();
+    }
+    TEST_INT("unknown oid throws XMSS_ERR_PARAMS", code, XMSS_ERR_PARAMS);
+}
+
+static void test_xmss_roundtrip(void)
+{
+    xmss::params p = xmss::params::from_oid(OID_XMSS_SHA2_10_256);
+
+    test_rng_reset(0x5EED);
+    xmss::keypair kp = xmss::private_key::generate(p, 2, test_randombytes);
+    TEST_INT("remaining after keygen", kp.priv.remaining(), 1024);
+
+    /* Zero-copy: sign straight into a caller-owned buffer */
+    std::vector<std::uint8_t> sig(p.sig_bytes());
+    std::size_t written = kp.priv.sign(xmss::as_bytes("hello"), sig);
+    TEST_INT("sign wrote sig_bytes", written, p.sig_bytes());
+    TEST("verify span sig", kp.pub.verify(xmss::as_bytes("hello"), sig));
+    TEST("verify wrong msg fails", !kp.pub.verify(xmss::as_bytes("hellO"), sig));
+    TEST("verify short sig fails",
+         !kp.pub.verify(xmss::as_bytes("hello"),
+                        xmss::bytes_view(sig.data(), sig.size() - 1)));
+
+    /* Undersized output buffer is an error, not an overflow */
+    {
+        std::array<std::uint8_t, 16> tiny{};
+        int code = 0;
+        try {
+            kp.priv.sign(xmss::as_bytes("x"), tiny);
+        } catch (const xmss::error &e) {
+            code = e.code();
+        }
+        TEST_INT("undersized sig buffer rejected", code, XMSS_ERR_PARAMS);
+        TEST_INT("rejected sign did not consume an index", kp.priv.remaining(), 1023);
+    }
+
+    /* Moving the key transfers the state; signing continues at idx 1 */
+    xmss::private_key moved = std::move(kp.priv);
+    std::vector<std::uint8_t> sig2 = moved.sign(xmss::as_bytes("second"));
+    TEST_INT("moved key signs next index", sig2[3], 1);
+    TEST("moved key sig verifies", kp.pub.verify(xmss::as_bytes("second"), sig2));
+
+    /* The moved-from key throws instead of dereferencing a null state */
+    {
+        bool threw = false;
+        try {
+            (void)kp.priv.sign(xmss::as_bytes("after move"));
+        } catch (const std::logic_error &) {
+            threw = true;
+        }
+        TEST("moved-from key: sign throws logic_error", threw);
+        threw = false;
+        try {
+            (void)kp.priv.remaining();
+        } catch (const std::logic_error &) {
+            threw = true;
+        }
+        TEST("moved-from key: remaining throws logic_error", threw);
+    }
+
+    /* Batch verify on a pool: two good, one tampered */
+    {
+        xmss::thread_pool pool(2);
+        std::vector<std::uint8_t> bad = sig2;
+        bad[bad.size() / 2] ^= 1;
+        std::vector<xmss::verify_item> items = {
+            { xmss::as_bytes("hello"),  sig,  kp.pub.bytes() },
+            { xmss::as_bytes("second"), bad,  kp.pub.bytes() },
+            { xmss::as_bytes("second"), sig2, kp.pub.bytes() },
+        };
+        std::vector<bool> ok = xmss::verify_batch(pool, p, items).get();
+        TEST_INT("verify_batch size", ok.size(), 3);
+        TEST("verify_batch [0] valid", ok[0]);
+        TEST("verify_batch [1] tampered", !ok[1]);
+        TEST("verify_batch [2] valid", ok[2]);
+
+        std::vector<bool> none = xmss::verify_batch(pool, p, {}).get();
+        TEST("verify_batch empty", none.empty());
+    }
+
+    /* Batch sign: sequential, in order, delivered through a future */
+    {
+        xmss::inline_executor ex;
+        std::vector<xmss::bytes_view> msgs = { xmss::as_bytes("a"), xmss::as_bytes("b") };
+        std::vector<std::vector<std::uint8_t>> sigs = xmss::sign_batch(ex, moved, msgs).get();
+        TEST_INT("sign_batch count", sigs.size(), 2);
+        TEST_INT("sign_batch first idx", sigs[0][3], 2);
+        TEST("sign_batch [0] verifies", kp.pub.verify(xmss::as_bytes("a"), sigs[0]));
+        TEST("sign_batch [1] verifies", kp.pub.verify(xmss::as_bytes("b"), sigs[1]));
+    }
+}
+
+static void test_mt_roundtrip(void)
+{
+    xmss::params p = xmss::params::mt_from_oid(OID_XMSS_MT_SHA2_20_2_256);
+
+    test_rng_reset(0xC0FFEE);
+    xmss::mt_keypair kp = xmss::mt_private_key::generate(p, 0, test_randombytes);
+    std::vector<std::uint8_t> sig = kp.priv.sign(xmss::as_bytes("mt"));
+    TEST("mt sig verifies", xmss::verify(p, xmss::as_bytes("mt"), sig, kp.pub.bytes()));
+    TEST("mt sig wrong msg fails", !kp.pub.verify(xmss::as_bytes("MT"), sig));
+}
+
+int main(void)
+{
+    printf("=== test_cxx_wrapper ===\n");
+
+    printf("--- params ---\n");
+    test_params();
+
+    printf("--- XMSS roundtrip ---\n");
+    test_xmss_roundtrip();
+
+    printf("--- XMSS-MT roundtrip ---\n");
+    test_mt_roundtrip();
+
+    return tests_done();
+}
@@ -0,0 +1,514 @@
+/**
+ * test_flashlog.c - Append-only key-state log for NOR flash (flashlog.h)
+ *
+ * Tests, on the file-backed stand-in device:
+ * - xmss_skip() / xmss_mt_skip() leave a key that signs exactly like one
+ *   that signed the skipped indices; MT state serialisation round trips
+ * - init() geometry checks
+ * - XMSS and XMSS-MT: signatures match plain signing of a twin key; load()
+ *   returns a key that signs exactly like the live one
+ * - a power cut after every few programmed bytes, erase included: load()
+ *   succeeds, never hands out a released index again and gives up at most
+ *   @reserve indices; the log keeps working afterwards
+ * - erases are spread evenly over the sectors; a foreign parameter set or bds_k
+ *   is rejected; an exhausted key stays exhausted after load()
+ *
+ * Also prints programmed bytes per signature next to rewriting the whole
+ * key state (informational).
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../include/xmss/flashlog.h"
+#include "sk_offsets.h"
+#include "utils.h"
+
+#define LOG_PATH   "test_flashlog.bin"
+#define SECTOR     4096U
+#define SECTORS    4U
+#define PROG       16U
+#define BDS_K      2U
+#define SIG_MAX    8192U   /* the n = 32, h = 6 sets below */
+
+static uint8_t work[1U << 16];
+
+static uint64_t sk_idx(const xmss_params *p, const uint8_t *sk)
+{
+    return bytes_to_ull(sk + sk_off_idx(p), p->idx_bytes);
+}
+
+/* Keys are XMSS or XMSS-MT; state points at the matching type */
+typedef struct {
+    uint8_t pk[4 + 2 * XMSS_MAX_N];
+    uint8_t sk[4 + 8 + 4 * XMSS_MAX_N];
+    void   *state;
+    size_t  state_size;
+} key_t_;
+
+static void key_gen(const xmss_params *p, key_t_ *k, uint32_t bds_k)
+{
+    k->state_size = p->d > 1 ? sizeof(xmss_mt_state) : sizeof(xmss_bds_state);
+    k->state      = calloc(1, k->state_size);
+    test_rng_reset(92);
+    if (p->d > 1) {
+        xmss_mt_keygen(p, k->pk, k->sk, (xmss_mt_state *)k->state, bds_k, test_randombytes);
+    } else {
+        xmss_keygen(p, k->pk, k->sk, (xmss_bds_state *)k->state, bds_k, test_randombytes);
+    }
+}
+
+static void key_copy(key_t_ *dst, const key_t_ *src)
+{
+    memcpy(dst->pk, src->pk, sizeof(dst->pk));
+    memcpy(dst->sk, src->sk, sizeof(dst->sk));
+    memcpy(dst->state, src->state, src->state_size);
+}
+
+static void key_dup(key_t_ *dst, const key_t_ *src)
+{
+    dst->state_size = src->state_size;
+    dst->state      = calloc(1, src->state_size);
+    key_copy(dst, src);
+}
+
+static int plain_sign(const xmss_params *p, key_t_ *k, uint8_t *sig,
+                      const uint8_t *m, size_t len, uint32_t bds_k)
+{
+    return p->d > 1 ? xmss_mt_sign(p, sig, m, len, k->sk, (xmss_mt_state *)k->state, bds_k)
+                    : xmss_sign(p, sig, m, len, k->sk, (xmss_bds_state *)k->state, bds_k);
+}
+
+static int skip(const xmss_params *p, key_t_ *k, uint32_t bds_k)
+{
+    return p->d > 1 ? xmss_mt_skip(p, k->sk, (xmss_mt_state *)k->state, bds_k)
+                    : xmss_skip(p, k->sk, (xmss_bds_state *)k->state, bds_k);
+}
+
+static int verify(const xmss_params *p, const key_t_ *k, const uint8_t *sig,
+                  const uint8_t *m, size_t len)
+{
+    return p->d > 1 ? xmss_mt_verify(p, m, len, sig, k->pk)
+                    : xmss_verify(p, m, len, sig, k->pk);
+}
+
+static int fl_format(xmss_flashlog *fl, const key_t_ *k)
+{
+    return fl->p.d > 1 ? xmss_mt_flashlog_format(fl, k->sk, (const xmss_mt_state *)k->state)
+                       : xmss_flashlog_format(fl, k->sk, (const xmss_bds_state *)k->state);
+}
+
+static int fl_load(xmss_flashlog *fl, key_t_ *k)
+{
+    return fl->p.d > 1 ? xmss_mt_flashlog_load(fl, k->sk, (xmss_mt_state *)k->state)
+                       : xmss_flashlog_load(fl, k->sk, (xmss_bds_state *)k->state);
+}
+
+static int fl_sign(xmss_flashlog *fl, key_t_ *k, uint8_t *sig, const uint8_t *m, size_t len)
+{
+    return fl->p.d > 1 ? xmss_mt_flashlog_sign(fl, sig, m, len, k->sk, (xmss_mt_state *)k->state)
+                       : xmss_flashlog_sign(fl, sig, m, len, k->sk, (xmss_bds_state *)k->state);
+}
+
+static void msg_for(uint8_t *m, uint64_t i)
+{
+    memset(m, 0, 32);
+    ull_to_bytes(m, 8, i);
+}
+
+/* Twin (plain signing, behind or level with k) catches up with k by
+ * skipping, then both sign the same message: equal signatures mean k's
+ * state is exactly the one plain signing would have */
+static int signs_like_twin(const xmss_params *p, key_t_ *k, key_t_ *twin,
+                           uint32_t bds_k, int via_log, xmss_flashlog *fl)
+{
+    uint8_t  sig_a[SIG_MAX], sig_b[SIG_MAX], m[32];
+    uint64_t idx = sk_idx(p, k->sk);
+    int      ra, rb;
+
+    while (sk_idx(p, twin->sk) < idx) {
+        if (skip(p, twin, bds_k) != XMSS_OK) { return 0; }
+    }
+    msg_for(m, 1000 + idx);
+    ra = via_log ? fl_sign(fl, k, sig_a, m, 32) : plain_sign(p, k, sig_a, m, 32, bds_k);
+    rb = plain_sign(p, twin, sig_b, m, 32, bds_k);
+    return ra == XMSS_OK && rb == XMSS_OK &&
+           memcmp(sig_a, sig_b, p->sig_bytes) == 0 &&
+           verify(p, k, sig_a, m, 32) == XMSS_OK;
+}
+
+/* ====================================================================
+ * Core support: skip and MT state serialisation
+ * ==================================================================== */
+
+static void test_skip(const xmss_params *p, const char *name)
+{
+    key_t_   a, b;
+    uint8_t  sig[SIG_MAX], m[32];
+    uint8_t *buf;
+    uint64_t i;
+    int      ok = 1;
+    char     label[96];
+
+    printf("\n%s: skip\n", name);
+    key_gen(p, &a, BDS_K);
+    key_dup(&b, &a);
+
+    /* a signs everything, b skips every third index: the states and
+     * signatures must agree wherever both sign */
+    for (i = 0; i + 1 < p->idx_max; i++) {
+        msg_for(m, i);
+        if (plain_sign(p, &a, sig, m, 32, BDS_K) != XMSS_OK) { ok = 0; break; }
+        if (i % 3 == 0) {
+            ok &= skip(p, &b, BDS_K) == XMSS_OK;
+        } else {
+            uint8_t sig_b[SIG_MAX];
+            ok &= plain_sign(p, &b, sig_b, m, 32, BDS_K) == XMSS_OK &&
+                  memcmp(sig, sig_b, p->sig_bytes) == 0;
+        }
+    }
+    snprintf(label, sizeof(label), "%s: skip keeps the state of signing", name);
+    TEST(label, ok && memcmp(a.sk, b.sk, p->sk_bytes) == 0 &&
+                memcmp(a.state, b.state, a.state_size) == 0);
+
+    while (sk_idx(p, b.sk) <= p->idx_max) { skip(p, &b, BDS_K); }
+    snprintf(label, sizeof(label), "%s: skip past the last index exhausted", name);
+    TEST_INT(label, skip(p, &b, BDS_K), XMSS_ERR_EXHAUSTED);
+
+    if (p->d > 1) {
+        xmss_mt_state *st = (xmss_mt_state *)calloc(1, sizeof(xmss_mt_state));
+        key_t_ c;
+
+        buf = (uint8_t *)malloc(xmss_mt_state_bytes(p, BDS_K));
+        key_gen(p, &c, BDS_K);
+        for (i = 0; i < (1U << p->tree_height) + 1; i++) {
+            skip(p, &c, BDS_K);
+        }
+        TEST_INT("MT state serialise", xmss_mt_state_serialize(p, buf, (const xmss_mt_state *)c.state, BDS_K), XMSS_OK);
+        TEST_INT("MT state deserialise", xmss_mt_state_deserialize(p, st, buf, BDS_K), XMSS_OK);
+        memcpy(c.state, st, sizeof(*st));
+        free(a.state);
+        key_gen(p, &a, BDS_K);
+        TEST("MT state round trip signs like the original", signs_like_twin(p, &c, &a, BDS_K, 0, NULL));
+        TEST_INT("MT state serialise rejects odd bds_k", xmss_mt_state_serialize(p, buf, st, 1), XMSS_ERR_PARAMS);
+        free(buf);
+        free(st);
+        free(c.state);
+    }
+    free(a.state);
+    free(b.state);
+}
+
+/* ====================================================================
+ * init() argument checks
+ * ==================================================================== */
+
+static void test_init(const xmss_params *p, xmss_flash_file *f)
+{
+    xmss_flashlog  fl;
+    xmss_flash_dev dev = f->dev;
+    xmss_params    lms;
+
+    printf("\ninit checks\n");
+    TEST_INT("init accepts the test geometry",
+             xmss_flashlog_init(&fl, &f->dev, p, BDS_K, 1, 0, work), XMSS_OK);
+    TEST_INT("reserve 0 rejected", xmss_flashlog_init(&fl, &f->dev, p, BDS_K, 0, 0, work), XMSS_ERR_PARAMS);
+    TEST_INT("odd bds_k rejected", xmss_flashlog_init(&fl, &f->dev, p, 1, 1, 0, work), XMSS_ERR_PARAMS);
+
+    dev.sectors = 1;
+    TEST_INT("one sector rejected", xmss_flashlog_init(&fl, &dev, p, BDS_K, 1, 0, work), XMSS_ERR_PARAMS);
+    dev = f->dev;
+    dev.prog_bytes = 24;
+    TEST_INT("non power of two program unit rejected",
+             xmss_flashlog_init(&fl, &dev, p, BDS_K, 1, 0, work), XMSS_ERR_PARAMS);
+    dev = f->dev;
+    dev.sector_bytes = 512;
+    TEST_INT("sector smaller than a snapshot rejected",
+             xmss_flashlog_init(&fl, &dev, p, BDS_K, 1, 0, work), XMSS_ERR_PARAMS);
+
+    lms = *p;
+    lms.func = XMSS_FUNC_LMS_SHA256;
+    TEST_INT("LMS parameter set rejected",
+             xmss_flashlog_init(&fl, &f->dev, &lms, BDS_K, 1, 0, work), XMSS_ERR_PARAMS);
+
+    TEST_INT("XMSS log refuses an MT format",
+             (xmss_flashlog_init(&fl, &f->dev, p, BDS_K, 1, 0, work),
+              xmss_mt_flashlog_format(&fl, NULL, NULL)), XMSS_ERR_PARAMS);
+    TEST("work buffer covers a snapshot",
+         xmss_flashlog_work_bytes(p, BDS_K) <= sizeof(work) &&
+         xmss_flashlog_work_bytes(p, BDS_K) >= p->sk_bytes + xmss_bds_serialized_size(p, BDS_K));
+}
+
+/* ====================================================================
+ * Lifetime: twin equality, reload, wear, exhaustion
+ * ==================================================================== */
+
+static void test_lifetime(const xmss_params *p, const char *name, xmss_flash_file *f,
+                          uint32_t reserve, uint32_t snap_interval)
+{
+    xmss_flashlog fl;
+    key_t_   k, twin, back;
+    uint8_t  sig[SIG_MAX], sig_t[SIG_MAX], m[32];
+    uint64_t i, total = p->idx_max + 1;
+    uint32_t s, emin = UINT32_MAX, emax = 0;
+    int      same = 1, ok = 1;
+    char     label[128];
+
+    printf("\n%s: lifetime, reserve %u, snapshot every %u\n", name,
+           (unsigned)reserve, (unsigned)snap_interval);
+    key_gen(p, &k, BDS_K);
+    key_dup(&twin, &k);
+    key_dup(&back, &k);
+    memset(f->erase_count, 0, sizeof(f->erase_count));
+
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, reserve, snap_interval, work);
+    snprintf(label, sizeof(label), "%s: format", name);
+    TEST_INT(label, fl_format(&fl, &k), XMSS_OK);
+
+    for (i = 0; i < total; i++) {
+        msg_for(m, i);
+        ok   &= fl_sign(&fl, &k, sig, m, 32) == XMSS_OK;
+        same &= plain_sign(p, &twin, sig_t, m, 32, BDS_K) == XMSS_OK &&
+                memcmp(sig, sig_t, p->sig_bytes) == 0;
+
+        /* Reload from flash halfway and twice near the end: the
+         * recovered key continues exactly like the live one */
+        if (i == total / 2 || i + 3 == total || i + 2 == total) {
+            xmss_flashlog fl2;
+            xmss_flashlog_init(&fl2, &f->dev, p, BDS_K, reserve, snap_interval, work);
+            ok &= fl_load(&fl2, &back) == XMSS_OK;
+            ok &= sk_idx(p, back.sk) >= i + 1 && sk_idx(p, back.sk) <= i + reserve;
+            /* Continue on the reloaded key; the twin skips what was given up */
+            key_copy(&k, &back);
+            while (sk_idx(p, twin.sk) < sk_idx(p, k.sk)) { skip(p, &twin, BDS_K); }
+            same &= memcmp(k.state, twin.state, k.state_size) == 0;
+            fl = fl2;
+            i = sk_idx(p, k.sk) - 1;
+        }
+    }
+    snprintf(label, sizeof(label), "%s: every signature signed", name);
+    TEST(label, ok);
+    snprintf(label, sizeof(label), "%s: signatures and reloaded states match plain signing", name);
+    TEST(label, same);
+    snprintf(label, sizeof(label), "%s: exhausted through the log", name);
+    TEST_INT(label, fl_sign(&fl, &k, sig, m, 32), XMSS_ERR_EXHAUSTED);
+
+    for (s = 0; s < SECTORS; s++) {
+        if (f->erase_count[s] < emin) { emin = f->erase_count[s]; }
+        if (f->erase_count[s] > emax) { emax = f->erase_count[s]; }
+    }
+    printf("  erases per sector %u..%u\n", (unsigned)emin, (unsigned)emax);
+    snprintf(label, sizeof(label), "%s: erases spread evenly over the sectors", name);
+    TEST(label, emax - emin <= 1);
+
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, reserve, snap_interval, work);
+    snprintf(label, sizeof(label), "%s: exhausted key loads exhausted", name);
+    TEST(label, fl_load(&fl, &back) == XMSS_OK && sk_idx(p, back.sk) == total &&
+                fl_sign(&fl, &back, sig, m, 32) == XMSS_ERR_EXHAUSTED);
+
+    free(k.state);
+    free(twin.state);
+    free(back.state);
+}
+
+/* Write volume with reservations: bytes per signature well under one
+ * state rewrite */
+static void test_volume(const xmss_params *p, xmss_flash_file *f)
+{
+    xmss_flashlog         fl;
+    xmss_flashlog_stats_t st;
+    key_t_   k;
+    uint8_t  sig[SIG_MAX], m[32];
+    uint32_t i, full;
+
+    printf("\nwrite volume\n");
+    key_gen(p, &k, BDS_K);
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, 8, 0, work);
+    fl_format(&fl, &k);
+    for (i = 0; i < 48; i++) {
+        msg_for(m, i);
+        fl_sign(&fl, &k, sig, m, 32);
+    }
+    xmss_flashlog_stats(&fl, &st);
+    full = p->sk_bytes + fl.state_bytes;
+    printf("  reserve 8: %.1f bytes programmed per signature, full state rewrite %u\n",
+           (double)st.prog_bytes / (double)st.signatures, (unsigned)full);
+    TEST_INT("reserve 8: one index record per 8 signatures", st.index_records, 6);
+    TEST("reserve 8: under a tenth of a state rewrite per signature",
+         st.prog_bytes * 10 < (uint64_t)full * st.signatures);
+    free(k.state);
+}
+
+/* ====================================================================
+ * Power cuts
+ * ==================================================================== */
+
+/* Sign through the log until a write fails at byte @cut, then reload:
+ * no released index may come back, at most @reserve are lost, and the
+ * recovered key signs like plain signing from there on, across further
+ * sector changes */
+static int cut_run(const xmss_params *p, xmss_flash_file *f, const key_t_ *fresh,
+                   uint64_t cut, uint32_t reserve, uint32_t snap_interval,
+                   uint32_t nsigs, uint64_t *lost)
+{
+    xmss_flashlog fl;
+    key_t_   k, twin;
+    uint8_t  sig[SIG_MAX], m[32];
+    uint64_t next = 0, i, idx;
+    int      ok = 1, rc;
+
+    key_dup(&k, fresh);
+    key_dup(&twin, fresh);
+
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, reserve, snap_interval, work);
+    f->cut_after = UINT64_MAX;
+    ok &= fl_format(&fl, &k) == XMSS_OK;
+    f->cut_after = cut;
+    for (i = 0; i < nsigs; i++) {
+        msg_for(m, i);
+        idx = sk_idx(p, k.sk);
+        rc  = fl_sign(&fl, &k, sig, m, 32);
+        if (rc != XMSS_OK) {
+            ok &= rc == XMSS_ERR_IO && fl_sign(&fl, &k, sig, m, 32) == XMSS_ERR_IO;
+            break;
+        }
+        next = idx + 1;                     /* released */
+    }
+
+    /* Power back */
+    f->cut_after = UINT64_MAX;
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, reserve, snap_interval, work);
+    ok &= fl_load(&fl, &k) == XMSS_OK;
+    idx = sk_idx(p, k.sk);
+    ok &= idx >= next && idx <= next + reserve;
+    *lost = idx - next;
+
+    /* Carries on through further rollovers, then reloads again */
+    for (i = 0; ok && i < 8 && sk_idx(p, k.sk) + 1 < p->idx_max; i++) {
+        ok &= signs_like_twin(p, &k, &twin, BDS_K, 1, &fl);
+    }
+    idx = sk_idx(p, k.sk);
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, reserve, snap_interval, work);
+    ok &= fl_load(&fl, &k) == XMSS_OK && sk_idx(p, k.sk) >= idx &&
+          sk_idx(p, k.sk) <= idx + reserve;
+
+    free(k.state);
+    free(twin.state);
+    return ok;
+}
+
+static void test_power_cuts(const xmss_params *p, const char *name, xmss_flash_file *f,
+                            uint32_t reserve, uint32_t snap_interval, uint32_t nsigs,
+                            uint32_t points)
+{
+    xmss_flashlog         fl;
+    xmss_flashlog_stats_t st;
+    key_t_   fresh, k;
+    uint8_t  sig[SIG_MAX], m[32];
+    uint64_t total, cut, step, lost, max_lost = 0;
+    uint32_t i, runs = 0, bad = 0;
+    char     label[128];
+
+    printf("\n%s: power cuts, reserve %u, snapshot every %u\n", name,
+           (unsigned)reserve, (unsigned)snap_interval);
+    key_gen(p, &fresh, BDS_K);
+
+    /* Bytes a clean run programs after format */
+    key_dup(&k, &fresh);
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, reserve, snap_interval, work);
+    fl_format(&fl, &k);
+    xmss_flashlog_stats(&fl, &st);
+    total = st.prog_bytes;
+    for (i = 0; i < nsigs; i++) {
+        msg_for(m, i);
+        fl_sign(&fl, &k, sig, m, 32);
+    }
+    xmss_flashlog_stats(&fl, &st);
+    total = st.prog_bytes - total;
+    free(k.state);
+
+    /* Odd step: cuts land inside records as well as between them */
+    step = (total / points) | 1U;
+    for (cut = 0; cut <= total; cut += step) {
+        if (!cut_run(p, f, &fresh, cut, reserve, snap_interval, nsigs, &lost)) {
+            if (bad < 5) { printf("  cut at byte %llu failed\n", (unsigned long long)cut); }
+            bad++;
+        }
+        if (lost > max_lost) { max_lost = lost; }
+        runs++;
+    }
+    printf("  %u cut points over %llu bytes, at most %llu indices given up\n",
+           (unsigned)runs, (unsigned long long)total, (unsigned long long)max_lost);
+    snprintf(label, sizeof(label), "%s: every power cut recovers without index reuse", name);
+    TEST(label, bad == 0 && runs >= 20);
+    snprintf(label, sizeof(label), "%s: at most reserve indices given up", name);
+    TEST(label, max_lost <= reserve);
+    free(fresh.state);
+}
+
+/* ====================================================================
+ * Foreign logs
+ * ==================================================================== */
+
+static void test_foreign(const xmss_params *p, xmss_flash_file *f)
+{
+    xmss_flashlog fl;
+    xmss_params   other;
+    key_t_        k;
+
+    printf("\nforeign logs\n");
+    key_gen(p, &k, BDS_K);
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, 1, 0, work);
+    fl_format(&fl, &k);
+
+    xmss_flashlog_init(&fl, &f->dev, p, 0, 1, 0, work);
+    TEST_INT("other bds_k rejected", fl_load(&fl, &k), XMSS_ERR_PARAMS);
+
+    xmss_params_custom(&other, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 8, 1);
+    xmss_flashlog_init(&fl, &f->dev, &other, BDS_K, 1, 0, work);
+    TEST_INT("other parameter set under the same OID rejected", fl_load(&fl, &k), XMSS_ERR_PARAMS);
+
+    xmss_params_from_name(&other, "XMSS-SHA2_10_256");
+    xmss_flashlog_init(&fl, &f->dev, &other, BDS_K, 1, 0, work);
+    TEST_INT("other OID rejected", fl_load(&fl, &k), XMSS_ERR_PARAMS);
+
+    f->dev.erase(f->dev.ctx, 0);
+    xmss_flashlog_init(&fl, &f->dev, p, BDS_K, 1, 0, work);
+    TEST_INT("erased device rejected", fl_load(&fl, &k), XMSS_ERR_PARAMS);
+    free(k.state);
+}
+
+int main(void)
+{
+    xmss_params     p, mt;
+    xmss_flash_file f;
+
+    printf("=== test_flashlog ===\n");
+
+    xmss_params_custom(&p,  OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 6, 1);
+    xmss_params_custom(&mt, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 6, 2);
+
+    remove(LOG_PATH);
+    if (xmss_flash_file_open(&f, LOG_PATH, SECTOR, SECTORS, PROG) != XMSS_OK) {
+        printf("  FAIL: cannot open %s\n", LOG_PATH);
+        return 1;
+    }
+
+    test_skip(&p, "XMSS h6");
+    test_skip(&mt, "XMSS-MT h6/d2");
+    test_init(&p, &f);
+    test_lifetime(&p, "XMSS h6", &f, 1, 1);
+    test_lifetime(&p, "XMSS h6", &f, 5, 0);
+    test_lifetime(&mt, "XMSS-MT h6/d2", &f, 3, 5);
+    test_volume(&p, &f);
+    test_power_cuts(&p, "XMSS h6", &f, 1, 3, 20, 50);
+    test_power_cuts(&p, "XMSS h6", &f, 4, 0, 20, 30);
+    test_power_cuts(&mt, "XMSS-MT h6/d2", &f, 2, 4, 16, 30);
+    test_foreign(&p, &f);
+
+    xmss_flash_file_close(&f);
+    remove(LOG_PATH);
+    return tests_done();
+}
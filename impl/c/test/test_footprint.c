@@ -0,0 +1,395 @@
+/**
+ * test_footprint.c - Peak stack per public API and key-state bytes
+ *
+ * Each API call runs on a thread whose stack is a painted static buffer;
+ * the deepest byte that no longer holds the paint is its peak stack use
+ * (minus the thread start-up baseline).  Peaks are checked against the
+ * budgets below so a frame that grows shows up as a failing test rather
+ * than as a stack overflow in a signer thread or on an embedded target.
+ *
+ * Also prints the per-key state bytes for every (OID, bds_k): the fixed
+ * in-memory structs and the serialized BDS payload that actually varies.
+ *
+ * Budgets were measured with GCC 12 on x86-64 in a Release build
+ * (-O3, as CI builds), XMSS_HASH_LANES=4, and scale with the lane count.
+ * Release is the larger case here: inlining merges frames, and the
+ * tightest peak (batch verify, n=64) is 31.0 KB against 13.8 KB with no
+ * -O flag.  Debug builds enable ASan and only report.
+ *
+ * Every frame is sized by the XMSS_MAX_* bounds (no VLAs, no recursion),
+ * so the peak depends on the hash instance (function and n) and on XMSS
+ * vs XMSS-MT, not on h or d (XMSSMT h=60/d=12 peaks byte-for-byte where
+ * h=20/d=4 does).  The stack checks therefore walk all registered OIDs
+ * and measure one per (XMSS or MT, function, n) class: the set with the
+ * lowest tree height, which keeps keygen short.
+ */
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../include/xmss/params.h"
+#include "../include/xmss/xmss.h"
+#include "../include/xmss/tune.h"
+
+#define FP_STACK_BYTES (4U * 1024U * 1024U)
+#define FP_PAINT       0xA5U
+
+#if defined(__SANITIZE_ADDRESS__)
+#define FP_ENFORCE 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define FP_ENFORCE 0
+#endif
+#endif
+#ifndef FP_ENFORCE
+#define FP_ENFORCE 1
+#endif
+
+/*
+ * Stack budgets in bytes (measured peak + ~15%).  Keygen holds the lane
+ * buffers of the leaf pipeline, about 9 KB per lane; with one lane the
+ * scalar WOTS+ key buffer dominates instead.  Verify holds the WOTS+
+ * chain scheduler's per-lane state, and batch verify a second WOTS+ key
+ * for the signature paired with it on the scheduler.
+ */
+#define FP_KB                  1024U
+#define FP_LANE_KEYGEN         (6U * FP_KB + XMSS_HASH_LANES * 10U * FP_KB)
+#define FP_LANE_SCHED          (XMSS_HASH_LANES * 128U)
+#define FP_BUDGET_KEYGEN       (FP_LANE_KEYGEN > 36U * FP_KB ? FP_LANE_KEYGEN : 36U * FP_KB)
+#define FP_BUDGET_SIGN         (24U * FP_KB)
+#define FP_BUDGET_VERIFY       (16U * FP_KB + FP_LANE_SCHED)
+#define FP_BUDGET_VERIFY_BATCH (32U * FP_KB + FP_LANE_SCHED)
+
+/* Key-state struct budgets (sizes are fixed by the XMSS_MAX_* bounds) */
+#define FP_BUDGET_BDS_STATE    (6U * FP_KB)
+#define FP_BUDGET_MT_STATE     (224U * FP_KB)
+
+/* Signatures per measured sign call: enough BDS updates to reach the
+ * treehash leaf path, and for MT (h/d = 5) one subtree switch */
+#define FP_SIGNS               16U
+#define FP_MT_SIGNS            40U
+
+static uint8_t fp_stack[FP_STACK_BYTES] __attribute__((aligned(4096)));
+
+/* One measured call */
+typedef enum {
+    FP_NONE = 0,
+    FP_KEYGEN, FP_SIGN, FP_SIGN_CHECKED, FP_VERIFY, FP_VERIFY_BATCH,
+    FP_MT_KEYGEN, FP_MT_SIGN, FP_MT_SIGN_CHECKED, FP_MT_VERIFY, FP_MT_VERIFY_BATCH
+} fp_api;
+
+static const char *api_name[] = {
+    "(thread)", "xmss_keygen", "xmss_sign", "xmss_sign_checked", "xmss_verify",
+    "xmss_verify_batch", "xmss_mt_keygen", "xmss_mt_sign", "xmss_mt_sign_checked",
+    "xmss_mt_verify", "xmss_mt_verify_batch"
+};
+
+static const size_t api_budget[] = {
+    0, FP_BUDGET_KEYGEN, FP_BUDGET_SIGN, FP_BUDGET_SIGN, FP_BUDGET_VERIFY,
+    FP_BUDGET_VERIFY_BATCH, FP_BUDGET_KEYGEN, FP_BUDGET_SIGN, FP_BUDGET_SIGN,
+    FP_BUDGET_VERIFY, FP_BUDGET_VERIFY_BATCH
+};
+
+typedef struct {
+    fp_api             api;
+    const xmss_params *p;
+    uint8_t           *pk, *sk, *sig;
+    void              *state;
+    int                ret;
+} fp_job;
+
+static const uint8_t fp_msg[] = "footprint";
+
+static void *fp_run(void *arg)
+{
+    fp_job       *j = (fp_job *)arg;
+    const uint8_t *msgs[2];
+    size_t        lens[2];
+    const uint8_t *sigs[2], *pks[2];
+    int           res[2];
+    uint32_t      i;
+
+    msgs[0] = msgs[1] = fp_msg;
+    lens[0] = lens[1] = sizeof(fp_msg);
+    sigs[0] = sigs[1] = j->sig;
+    pks[0]  = pks[1]  = j->pk;
+
+    switch (j->api) {
+    case FP_KEYGEN:
+        j->ret = xmss_keygen(j->p, j->pk, j->sk, (xmss_bds_state *)j->state, 0,
+                             test_randombytes);
+        break;
+    case FP_SIGN:
+        for (i = 0, j->ret = XMSS_OK; i < FP_SIGNS && j->ret == XMSS_OK; i++) {
+            j->ret = xmss_sign(j->p, j->sig, fp_msg, sizeof(fp_msg), j->sk,
+                               (xmss_bds_state *)j->state, 0);
+        }
+        break;
+    case FP_SIGN_CHECKED:
+        for (i = 0, j->ret = XMSS_OK; i < FP_SIGNS && j->ret == XMSS_OK; i++) {
+            j->ret = xmss_sign_checked(j->p, j->sig, fp_msg, sizeof(fp_msg), j->sk,
+                                       (xmss_bds_state *)j->state, 0);
+        }
+        break;
+    case FP_VERIFY:
+        j->ret = xmss_verify(j->p, fp_msg, sizeof(fp_msg), j->sig, j->pk);
+        break;
+    case FP_VERIFY_BATCH:
+        j->ret = xmss_verify_batch(j->p, 2, msgs, lens, sigs, pks, res);
+        if (j->ret == XMSS_OK && (res[0] != XMSS_OK || res[1] != XMSS_OK)) {
+            j->ret = XMSS_ERR_VERIFY;
+        }
+        break;
+    case FP_MT_KEYGEN:
+        j->ret = xmss_mt_keygen(j->p, j->pk, j->sk, (xmss_mt_state *)j->state, 0,
+                                test_randombytes);
+        break;
+    case FP_MT_SIGN:
+        for (i = 0, j->ret = XMSS_OK; i < FP_MT_SIGNS && j->ret == XMSS_OK; i++) {
+            j->ret = xmss_mt_sign(j->p, j->sig, fp_msg, sizeof(fp_msg), j->sk,
+                                  (xmss_mt_state *)j->state, 0);
+        }
+        break;
+    case FP_MT_SIGN_CHECKED:
+        for (i = 0, j->ret = XMSS_OK; i < FP_MT_SIGNS && j->ret == XMSS_OK; i++) {
+            j->ret = xmss_mt_sign_checked(j->p, j->sig, fp_msg, sizeof(fp_msg), j->sk,
+                                          (xmss_mt_state *)j->state, 0);
+        }
+        break;
+    case FP_MT_VERIFY:
+        j->ret = xmss_mt_verify(j->p, fp_msg, sizeof(fp_msg), j->sig, j->pk);
+        break;
+    case FP_MT_VERIFY_BATCH:
+        j->ret = xmss_mt_verify_batch(j->p, 2, msgs, lens, sigs, pks, res);
+        if (j->ret == XMSS_OK && (res[0] != XMSS_OK || res[1] != XMSS_OK)) {
+            j->ret = XMSS_ERR_VERIFY;
+        }
+        break;
+    default:
+        j->ret = XMSS_OK;
+        break;
+    }
+    return NULL;
+}
+
+/* Run j on the painted stack; returns bytes of stack touched. */
+static size_t fp_measure(fp_job *j)
+{
+    pthread_attr_t attr;
+    pthread_t      t;
+    size_t         i;
+
+    memset(fp_stack, FP_PAINT, sizeof(fp_stack));
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, fp_stack, sizeof(fp_stack));
+    if (pthread_create(&t, &attr, fp_run, j) != 0) {
+        pthread_attr_destroy(&attr);
+        j->ret = -100;
+        return 0;
+    }
+    pthread_join(t, NULL);
+    pthread_attr_destroy(&attr);
+
+    /* Stacks grow down: the lowest repainted byte marks the peak */
+    for (i = 0; i < sizeof(fp_stack) && fp_stack[i] == FP_PAINT; i++) {
+    }
+    return sizeof(fp_stack) - i;
+}
+
+static const char *func_name(uint8_t func)
+{
+    return func == XMSS_FUNC_SHA2 ? "SHA2" :
+           func == XMSS_FUNC_SHAKE128 ? "SHAKE128" : "SHAKE256";
+}
+
+static size_t fp_base;
+
+/* Measure one call: its return code, then its peak against the budget. */
+static void fp_check(fp_api api, const char *variant, const xmss_params *p,
+                     uint8_t *pk, uint8_t *sk, uint8_t *sig, void *state)
+{
+    fp_job j;
+    size_t used;
+    char   label[128];
+
+    j.api = api; j.p = p; j.pk = pk; j.sk = sk; j.sig = sig; j.state = state;
+    used = fp_measure(&j);
+    used = used > fp_base ? used - fp_base : 0;
+
+    printf("  %-22s %-8s n=%-2u h=%-2u d=%-2u %-8s %7zu / %7zu bytes\n",
+           api_name[api], func_name(p->func), (unsigned)p->n, (unsigned)p->h,
+           (unsigned)p->d, variant, used, api_budget[api]);
+    snprintf(label, sizeof(label), "%s 0x%08x %s: returns OK", api_name[api],
+             (unsigned)p->oid, variant);
+    TEST_INT(label, j.ret, XMSS_OK);
+    if (FP_ENFORCE) {
+        snprintf(label, sizeof(label), "%s 0x%08x %s: within stack budget",
+                 api_name[api], (unsigned)p->oid, variant);
+        TEST(label, used <= api_budget[api]);
+    }
+}
+
+/* Re-run keygen with the leaf pipeline switched to one leaf at a time */
+static void fp_check_scalar_keygen(fp_api api, const xmss_params *p,
+                                   uint8_t *pk, uint8_t *sk, void *state)
+{
+    xmss_backend_info b, c;
+
+    xmss_backend_get(&b);
+    c = b;
+    c.leaf_lanes = 1;
+    xmss_backend_set(&c);
+    fp_check(api, "scalar", p, pk, sk, NULL, state);
+    xmss_backend_set(&b);
+}
+
+/* Registered parameter set i (0 .. FP_REGISTERED-1); returns 0 if it exists */
+#define FP_REGISTERED 64U
+
+static int fp_params(xmss_params *p, uint32_t i)
+{
+    return i < 32 ? xmss_params_from_oid(p, i + 1)
+                  : xmss_mt_params_from_oid(p, OID_XMSS_MT_PREFIX | (i - 31));
+}
+
+static void test_xmss_stack(uint32_t oid)
+{
+    xmss_test_ctx c;
+    fp_api        api;
+
+    if (xmss_test_ctx_init(&c, oid) != 0) {
+        TEST("ctx init", 0);
+        return;
+    }
+    test_rng_reset(1);
+    if (oid == OID_XMSS_SHA2_10_256) {
+        fp_check_scalar_keygen(FP_KEYGEN, &c.p, c.pk, c.sk, c.state);
+    }
+    for (api = FP_KEYGEN; api <= FP_VERIFY_BATCH; api++) {
+        fp_check(api, "", &c.p, c.pk, c.sk, c.sig, c.state);
+    }
+    xmss_test_ctx_free(&c);
+}
+
+static void test_mt_stack(uint32_t oid)
+{
+    xmss_mt_test_ctx c;
+    fp_api           api;
+
+    if (xmss_mt_test_ctx_init(&c, oid) != 0) {
+        TEST("ctx init", 0);
+        return;
+    }
+    test_rng_reset(2);
+    for (api = FP_MT_KEYGEN; api <= FP_MT_VERIFY_BATCH; api++) {
+        fp_check(api, "", &c.p, c.pk, c.sk, c.sig, c.state);
+    }
+    xmss_mt_test_ctx_free(&c);
+}
+
+/* Measure the lowest-tree set of every (XMSS or MT, function, n) class */
+#define FP_MAX_CLASSES 16U
+
+static void test_stacks(void)
+{
+    xmss_params rep[FP_MAX_CLASSES], p;
+    uint32_t    covered[FP_MAX_CLASSES];
+    uint32_t    i, c, nc = 0, oids = 0;
+
+    for (i = 0; i < FP_REGISTERED; i++) {
+        if (fp_params(&p, i) != 0) {
+            continue;
+        }
+        oids++;
+        for (c = 0; c < nc; c++) {
+            if ((rep[c].d > 1) == (p.d > 1) && rep[c].func == p.func && rep[c].n == p.n) {
+                break;
+            }
+        }
+        if (c == nc) {
+            if (nc == FP_MAX_CLASSES) {
+                TEST("parameter classes fit FP_MAX_CLASSES", 0);
+                return;
+            }
+            rep[nc] = p;
+            covered[nc++] = 0;
+        } else if (p.tree_height < rep[c].tree_height ||
+                   (p.tree_height == rep[c].tree_height && p.h < rep[c].h)) {
+            rep[c] = p;
+        }
+        covered[c]++;
+    }
+
+    for (c = 0; c < nc; c++) {
+        printf("  0x%08x: %s %-8s n=%-2u, stands for %u registered OIDs\n",
+               (unsigned)rep[c].oid, rep[c].d > 1 ? "XMSS-MT" : "XMSS   ",
+               func_name(rep[c].func), (unsigned)rep[c].n, (unsigned)covered[c]);
+        if (rep[c].d == 1) {
+            test_xmss_stack(rep[c].oid);
+        } else {
+            test_mt_stack(rep[c].oid);
+        }
+    }
+    TEST_INT("every registered OID has a measured class", (long long)oids, 44LL);
+}
+
+/* One row per (OID, bds_k); returns 0 if a payload exceeds its struct. */
+static int state_rows(const xmss_params *p)
+{
+    uint32_t k, bds, payload;
+    size_t   mem = p->d == 1 ? sizeof(xmss_bds_state) : sizeof(xmss_mt_state);
+    int      ok = 1;
+
+    for (k = 0; k <= XMSS_MAX_BDS_K && k <= p->tree_height; k += 2) {
+        bds     = xmss_bds_serialized_size(p, k);
+        payload = (2 * p->d - 1) * bds + (p->d - 1) * p->len * p->n;
+        printf("  0x%08x %-8s n=%-2u h=%-2u d=%-2u k=%u  sk %4u  bds %6u  "
+               "state %7u  (struct %zu)\n",
+               (unsigned)p->oid, func_name(p->func), (unsigned)p->n,
+               (unsigned)p->h, (unsigned)p->d, (unsigned)k, (unsigned)p->sk_bytes,
+               (unsigned)bds, (unsigned)payload, mem);
+        ok = ok && payload <= mem;
+    }
+    return ok;
+}
+
+static void test_state_bytes(void)
+{
+    xmss_params p;
+    uint32_t    i, rows = 0;
+    int         ok = 1;
+
+    for (i = 0; i < FP_REGISTERED; i++) {
+        if (fp_params(&p, i) == 0) {
+            ok = state_rows(&p) && ok;
+            rows++;
+        }
+    }
+    TEST_INT("parameter sets reported", (long long)rows, 44LL);
+    TEST("serialized state fits the in-memory struct", ok);
+    TEST("sizeof(xmss_bds_state) within budget", sizeof(xmss_bds_state) <= FP_BUDGET_BDS_STATE);
+    TEST("sizeof(xmss_mt_state) within budget", sizeof(xmss_mt_state) <= FP_BUDGET_MT_STATE);
+}
+
+int main(void)
+{
+    fp_job j;
+
+    printf("=== test_footprint ===\n");
+
+    memset(&j, 0, sizeof(j));
+    fp_base = fp_measure(&j);
+    printf("--- peak stack per call / budget (XMSS_HASH_LANES=%u, thread baseline %zu) ---\n",
+           (unsigned)XMSS_HASH_LANES, fp_base);
+    test_stacks();
+
+    printf("--- key state bytes per (OID, bds_k): sizeof(xmss_bds_state) %zu, "
+           "sizeof(xmss_mt_state) %zu ---\n",
+           sizeof(xmss_bds_state), sizeof(xmss_mt_state));
+    test_state_bytes();
+
+    return tests_done();
+}
@@ -0,0 +1,529 @@
+/**
+ * test_hss.c - LMS / HSS engine (hss.h)
+ *
+ * Tests:
+ * - xmss_hss_params(): RFC 8554 sizes, unsupported types and bounds
+ * - signatures pass an independent RFC 8554 verifier written here over
+ *   plain SHA-256 (no hash_iface.h, treehash or BDS code)
+ * - whole lifetime of a two-level key: every signature verifies, is the
+ *   same for bds_k 0 and 2 and with the lane kernels off, then exhaustion
+ * - state serialised mid-life and restored signs the same sequence
+ * - W2 and W8 single trees; a corrupted field anywhere, a wrong message
+ *   or a wrong key is rejected
+ * - xmss_hss_verify_any() on an H10/W2 level over an H5/W8 one (both
+ *   verifiers accept; xmss_hss_verify() holds to one type pair), and on
+ *   truncated, extended or retyped signatures
+ *
+ * Also prints verify time against XMSS-MT at the same n, w and shape.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_utils.h"
+#include "sha2_local.h"
+#include "../include/xmss/hss.h"
+#include "../include/xmss/tune.h"
+
+#define SK_MAX (4 + 8 + 4 * 32)
+
+/* ====================================================================
+ * Reference verifier: RFC 8554 Algorithms 4b, 6a, 6b, straight from the
+ * text with one-shot SHA-256.
+ * ==================================================================== */
+static uint32_t rd32(const uint8_t *b)
+{
+    return (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+}
+
+static void wr32(uint8_t *b, uint32_t v)
+{
+    b[0] = (uint8_t)(v >> 24); b[1] = (uint8_t)(v >> 16);
+    b[2] = (uint8_t)(v >> 8);  b[3] = (uint8_t)v;
+}
+
+static uint32_t coef(const uint8_t *S, uint32_t i, uint32_t w)
+{
+    return ((1u << w) - 1) & (uint32_t)(S[i * w / 8] >> (8 - (w * (i % (8 / w)) + w)));
+}
+
+/* Returns the LMS root implied by sig over msg, 0 on malformed input */
+static int ref_lms_root(uint8_t *root, const uint8_t *I, const uint8_t *sig,
+                        const uint8_t *msg, size_t msglen, uint32_t *sig_len)
+{
+    static const uint32_t ots_w[5] = { 0, 1, 2, 4, 8 }, ots_p[5] = { 0, 265, 133, 67, 34 };
+    static const uint32_t ots_ls[5] = { 0, 7, 6, 4, 0 };
+    uint32_t q = rd32(sig), ots = rd32(sig + 4), w, p, h, type, i, j, r, sum = 0;
+    uint8_t  Q[34], tmp[32], *buf, *z;
+    const uint8_t *C = sig + 8, *y = sig + 40;
+
+    if (ots < 2 || ots > 4) { return 0; }
+    w = ots_w[ots]; p = ots_p[ots];
+    type = rd32(sig + 40 + 32 * p);
+    if (type < 5 || type > 8) { return 0; }
+    h = 5 * (type - 4);
+    if (q >= (1u << h)) { return 0; }
+
+    /* Q = H(I || u32str(q) || u16str(D_MESG) || C || message) */
+    buf = malloc(22 + 32 + msglen + 32 * p);
+    memcpy(buf, I, 16); wr32(buf + 16, q); buf[20] = 0x81; buf[21] = 0x81;
+    memcpy(buf + 22, C, 32); memcpy(buf + 54, msg, msglen);
+    sha256_local(Q, buf, 54 + msglen);
+    for (i = 0; i < 256 / w; i++) { sum += (1u << w) - 1 - coef(Q, i, w); }
+    sum <<= ots_ls[ots];
+    Q[32] = (uint8_t)(sum >> 8); Q[33] = (uint8_t)sum;
+
+    /* Kc = H(I || u32str(q) || u16str(D_PBLC) || z[0] || ... || z[p-1]) */
+    z = buf + 22;
+    for (i = 0; i < p; i++) {
+        uint32_t a = coef(Q, i, w);
+        memcpy(tmp, y + 32 * i, 32);
+        for (j = a; j < (1u << w) - 1; j++) {
+            uint8_t blk[55];
+            memcpy(blk, I, 16); wr32(blk + 16, q);
+            blk[20] = (uint8_t)(i >> 8); blk[21] = (uint8_t)i; blk[22] = (uint8_t)j;
+            memcpy(blk + 23, tmp, 32);
+            sha256_local(tmp, blk, 55);
+        }
+        memcpy(z + 32 * i, tmp, 32);
+    }
+    buf[20] = 0x80; buf[21] = 0x80;
+    sha256_local(tmp, buf, 22 + 32 * p);
+
+    /* Leaf, then up the path (Algorithm 6a step 4) */
+    {
+        uint8_t nb[22 + 64];
+        const uint8_t *path = sig + 44 + 32 * p;
+        r = (1u << h) + q;
+        memcpy(nb, I, 16); wr32(nb + 16, r); nb[20] = 0x82; nb[21] = 0x82;
+        memcpy(nb + 22, tmp, 32);
+        sha256_local(tmp, nb, 54);
+        for (i = 0; i < h; i++) {
+            wr32(nb + 16, r / 2); nb[20] = 0x83; nb[21] = 0x83;
+            if (r & 1) {
+                memcpy(nb + 22, path + 32 * i, 32); memcpy(nb + 54, tmp, 32);
+            } else {
+                memcpy(nb + 22, tmp, 32); memcpy(nb + 54, path + 32 * i, 32);
+            }
+            sha256_local(tmp, nb, 86);
+            r /= 2;
+        }
+    }
+    free(buf);
+    memcpy(root, tmp, 32);
+    *sig_len = 8 + 32 + 32 * p + 4 + 32 * h;
+    return 1;
+}
+
+/* Algorithm 6b, HSS_verify; 1 if valid */
+static int ref_hss_verify(const uint8_t *pk, const uint8_t *msg, size_t msglen,
+                          const uint8_t *sig)
+{
+    static const uint32_t ots_p[5] = { 0, 265, 133, 67, 34 };
+    uint32_t L = rd32(pk), nspk = rd32(sig), i, len, ots, p;
+    const uint8_t *pub = pk + 4, *s = sig + 4;
+    uint8_t  root[32];
+
+    if (nspk + 1 != L) { return 0; }
+    for (i = 0; i <= nspk; i++) {
+        /* The signed child public key follows the LMS signature */
+        ots = rd32(s + 4);
+        if (ots < 2 || ots > 4 || rd32(pub + 4) != ots) { return 0; }
+        p = ots_p[ots];
+        if (rd32(pub) != rd32(s + 40 + 32 * p)) { return 0; }
+        len = 8 + 32 + 32 * p + 4 + 32 * 5 * (rd32(pub) - 4);
+        if (!(i < nspk ? ref_lms_root(root, pub + 8, s, s + len, 56, &len)
+                       : ref_lms_root(root, pub + 8, s, msg, msglen, &len)) ||
+            memcmp(root, pub + 24, 32) != 0) {
+            return 0;
+        }
+        pub = s + len;
+        s  += len + 56;
+    }
+    return 1;
+}
+
+/* ==================================================================== */
+
+typedef struct {
+    xmss_params     p;
+    uint8_t         pk[64];
+    uint8_t         sk[SK_MAX];
+    xmss_hss_state *st;
+    uint32_t        bds_k;
+} key_t_;
+
+static void key_gen(key_t_ *k, const xmss_params *p, uint32_t bds_k)
+{
+    k->p     = *p;
+    k->bds_k = bds_k;
+    k->st    = calloc(1, sizeof(xmss_hss_state));
+    test_rng_reset(90);
+    xmss_hss_keygen(p, k->pk, k->sk, k->st, bds_k, test_randombytes);
+}
+
+static int key_sign(key_t_ *k, uint8_t *sig, uint32_t i)
+{
+    uint8_t m[8];
+    memset(m, (int)i, sizeof(m));
+    wr32(m, i);
+    return xmss_hss_sign(&k->p, sig, m, sizeof(m), k->sk, k->st, k->bds_k);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void test_params(void)
+{
+    xmss_params p, keep;
+
+    TEST_INT("params: L=1 H5/W8", xmss_hss_params(&p, 1, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W8),
+             XMSS_OK);
+    TEST_INT("params: H5/W8 signature is 4 + 1292 bytes", p.sig_bytes, 4 + 1292);
+    TEST_INT("params: public key is 60 bytes", p.pk_bytes, 60);
+    xmss_hss_params(&p, 1, LMS_SHA256_M32_H10, LMOTS_SHA256_N32_W4);
+    TEST_INT("params: H10/W4 signature is 4 + 2508 bytes", p.sig_bytes, 4 + 2508);
+    xmss_hss_params(&p, 2, LMS_SHA256_M32_H10, LMOTS_SHA256_N32_W4);
+    TEST_INT("params: L=2 H10/W4 signature", p.sig_bytes, 4 + 2 * 2508 + 56);
+    TEST("params: L=2 H10/W4 has 2^20 signatures", p.idx_max == (1u << 20) - 1);
+    xmss_hss_params(&p, 1, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W2);
+    TEST_INT("params: W2 has p = 133", p.len, 133);
+
+    keep = p;
+    TEST_INT("params: H25 rejected",
+             xmss_hss_params(&p, 1, LMS_SHA256_M32_H20 + 1, LMOTS_SHA256_N32_W4), XMSS_ERR_PARAMS);
+    TEST_INT("params: W1 rejected",
+             xmss_hss_params(&p, 1, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W2 - 1), XMSS_ERR_PARAMS);
+    TEST_INT("params: L = 0 rejected",
+             xmss_hss_params(&p, 0, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W4), XMSS_ERR_PARAMS);
+    TEST_INT("params: L = 9 rejected",
+             xmss_hss_params(&p, 9, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W4), XMSS_ERR_PARAMS);
+    TEST_INT("params: L * H > 60 rejected",
+             xmss_hss_params(&p, 4, LMS_SHA256_M32_H20, LMOTS_SHA256_N32_W4), XMSS_ERR_PARAMS);
+    TEST("params: rejected calls leave p untouched", memcmp(&p, &keep, sizeof(p)) == 0);
+}
+
+/* Two levels of H5/W4: 1024 signatures */
+static void test_lifetime(void)
+{
+    xmss_params p;
+    xmss_backend_info bi, scalar;
+    key_t_   a, b, c, r;
+    uint8_t *sig_a, *sig_b, *sig_c, *blob;
+    uint32_t i, n;
+    int      ok = 1, same = 1, ref = 1, restored = 1;
+
+    xmss_hss_params(&p, 2, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W4);
+    sig_a = malloc(p.sig_bytes); sig_b = malloc(p.sig_bytes); sig_c = malloc(p.sig_bytes);
+
+    xmss_backend_get(&bi);
+    scalar = bi;
+    scalar.leaf_lanes = 1;
+
+    key_gen(&a, &p, 0);
+    key_gen(&b, &p, 2);
+    xmss_backend_set(&scalar);
+    key_gen(&c, &p, 0);
+    xmss_backend_set(&bi);
+    TEST("lifetime: same pk for bds_k 0, 2 and scalar leaves",
+         memcmp(a.pk, b.pk, p.pk_bytes) == 0 && memcmp(a.pk, c.pk, p.pk_bytes) == 0);
+    TEST_INT("lifetime: remaining at start", (long long)xmss_hss_remaining_sigs(&p, a.sk), 1024);
+
+    blob = malloc(xmss_hss_state_bytes(&p, 2));
+    n = (uint32_t)(p.idx_max + 1);
+    for (i = 0; i < n; i++) {
+        uint8_t m[8];
+        memset(m, (int)i, sizeof(m));
+        wr32(m, i);
+
+        ok = ok && key_sign(&a, sig_a, i) == XMSS_OK;
+        ok = ok && key_sign(&b, sig_b, i) == XMSS_OK;
+        if (i % 64 == 0) {
+            xmss_backend_set(&scalar);
+        }
+        ok = ok && key_sign(&c, sig_c, i) == XMSS_OK;
+        xmss_backend_set(&bi);
+        same = same && memcmp(sig_a, sig_b, p.sig_bytes) == 0 &&
+                       memcmp(sig_a, sig_c, p.sig_bytes) == 0;
+        ok = ok && xmss_hss_verify(&p, m, sizeof(m), sig_a, a.pk) == XMSS_OK;
+        if (i % 97 == 0 || i % 32 == 31 || i + 1 == n) {
+            ref = ref && ref_hss_verify(a.pk, m, sizeof(m), sig_a);
+        }
+
+        /* Round-trip b's state at 37, then keep signing with the copy */
+        if (i == 37) {
+            r = b;
+            r.st = calloc(1, sizeof(xmss_hss_state));
+            restored = xmss_hss_state_serialize(&p, blob, b.st, 2) == XMSS_OK &&
+                       xmss_hss_state_deserialize(&p, r.st, blob, 2) == XMSS_OK;
+            free(b.st);
+            b = r;
+        }
+    }
+    TEST("lifetime: every index signs and verifies", ok);
+    TEST("lifetime: bds_k 0 / 2 / scalar leaves give identical signatures", same);
+    TEST("lifetime: independent RFC 8554 verifier accepts", ref);
+    TEST("lifetime: serialised state restored at 37 continues the sequence", restored && same);
+    TEST_INT("lifetime: remaining at end", (long long)xmss_hss_remaining_sigs(&p, a.sk), 0);
+    TEST_INT("lifetime: exhausted", key_sign(&a, sig_a, n), XMSS_ERR_EXHAUSTED);
+
+    free(blob);
+    free(a.st); free(b.st); free(c.st);
+    free(sig_a); free(sig_b); free(sig_c);
+}
+
+static void test_single(const char *name, uint32_t ots)
+{
+    xmss_params p;
+    key_t_   k;
+    uint8_t *sig;
+    uint8_t  m[8];
+    uint32_t i;
+    int      ok = 1;
+    char     label[96];
+
+    xmss_hss_params(&p, 1, LMS_SHA256_M32_H5, ots);
+    sig = malloc(p.sig_bytes);
+    key_gen(&k, &p, 2);
+    for (i = 0; i < 5; i++) {
+        memset(m, (int)i, sizeof(m));
+        wr32(m, i);
+        ok = ok && key_sign(&k, sig, i) == XMSS_OK &&
+             xmss_hss_verify(&p, m, sizeof(m), sig, k.pk) == XMSS_OK &&
+             ref_hss_verify(k.pk, m, sizeof(m), sig);
+    }
+    snprintf(label, sizeof(label), "%s: sign, verify and reference verify", name);
+    TEST(label, ok);
+    free(k.st);
+    free(sig);
+}
+
+/* Flip one byte in every field of a two-level signature */
+static void test_reject(void)
+{
+    xmss_params p, other;
+    key_t_   k, k2;
+    uint8_t *sig;
+    uint8_t  m[8], pk[64];
+    uint32_t lsig, off, flips = 0, caught = 0;
+    uint32_t at[12];
+
+    xmss_hss_params(&p, 2, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W4);
+    sig = malloc(p.sig_bytes);
+    key_gen(&k, &p, 0);
+    key_sign(&k, sig, 0);
+    key_sign(&k, sig, 1);
+    memset(m, 1, sizeof(m));
+    wr32(m, 1);
+    TEST_INT("reject: genuine signature verifies", xmss_hss_verify(&p, m, sizeof(m), sig, k.pk),
+             XMSS_OK);
+
+    lsig = 4 + 4 + 32 + p.len * 32 + 4 + 5 * 32;
+    at[0] = 3;                                   /* Nspk */
+    for (off = 0; off < 2; off++) {
+        uint32_t b = 4 + off * (lsig + 56);
+        at[1 + 5 * off] = b + 3;                 /* q */
+        at[2 + 5 * off] = b + 7;                 /* LM-OTS type */
+        at[3 + 5 * off] = b + 8;                 /* C */
+        at[4 + 5 * off] = b + 40 + 32 * 33;      /* y */
+        at[5 + 5 * off] = b + lsig - 1;          /* path */
+    }
+    at[11] = 4 + lsig + 30;                      /* child public key (I) */
+    for (off = 0; off < 12; off++) {
+        sig[at[off]] ^= 0x01;
+        flips++;
+        caught += xmss_hss_verify(&p, m, sizeof(m), sig, k.pk) == XMSS_ERR_VERIFY;
+        sig[at[off]] ^= 0x01;
+    }
+    TEST("reject: a flipped bit in any field fails", caught == flips);
+
+    m[7] ^= 1;
+    TEST_INT("reject: wrong message", xmss_hss_verify(&p, m, sizeof(m), sig, k.pk),
+             XMSS_ERR_VERIFY);
+    TEST("reject: reference verifier also rejects it", !ref_hss_verify(k.pk, m, sizeof(m), sig));
+    m[7] ^= 1;
+    memcpy(pk, k.pk, p.pk_bytes);
+    pk[3] = 1;
+    TEST_INT("reject: L in the public key differs", xmss_hss_verify(&p, m, sizeof(m), sig, pk),
+             XMSS_ERR_VERIFY);
+
+    test_rng_reset(91);
+    k2.st = calloc(1, sizeof(xmss_hss_state));
+    xmss_hss_keygen(&p, k2.pk, k2.sk, k2.st, 0, test_randombytes);
+    TEST_INT("reject: another key", xmss_hss_verify(&p, m, sizeof(m), sig, k2.pk),
+             XMSS_ERR_VERIFY);
+
+    xmss_hss_params(&other, 2, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W8);
+    TEST_INT("reject: other LM-OTS type", xmss_hss_verify(&other, m, sizeof(m), sig, k.pk),
+             XMSS_ERR_VERIFY);
+    TEST_INT("keygen: odd bds_k rejected",
+             xmss_hss_keygen(&p, k2.pk, k2.sk, k2.st, 1, test_randombytes), XMSS_ERR_PARAMS);
+    TEST_INT("keygen: XMSS parameter set rejected",
+             (xmss_params_custom(&other, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 10, 2),
+              xmss_hss_keygen(&other, k2.pk, k2.sk, k2.st, 0, test_randombytes)),
+             XMSS_ERR_PARAMS);
+
+    free(k.st); free(k2.st);
+    free(sig);
+}
+
+/*
+ * Two levels of different types (RFC 8554 allows it; Appendix F Test Case
+ * 2 is H10/W8 over H5/W4): an H10/W2 tree signs an H5/W8 tree's public
+ * key, assembled by hand from two single-level keys.
+ */
+static void test_mixed(void)
+{
+    xmss_params pt, pb, uni;
+    key_t_   top, bot;
+    uint8_t *ts, *bs, *sig;
+    uint8_t  pk[4 + XMSS_HSS_LMS_PUB_BYTES], m[8];
+    size_t   len;
+
+    xmss_hss_params(&pt, 1, LMS_SHA256_M32_H10, LMOTS_SHA256_N32_W2);
+    xmss_hss_params(&pb, 1, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W8);
+    xmss_hss_params(&uni, 2, LMS_SHA256_M32_H10, LMOTS_SHA256_N32_W2);
+    ts  = malloc(pt.sig_bytes);
+    bs  = malloc(pb.sig_bytes);
+    len = 4 + (pt.sig_bytes - 4) + XMSS_HSS_LMS_PUB_BYTES + (pb.sig_bytes - 4);
+    /* Room for len + 1 and for uni's longer fixed length, zero-padded */
+    sig = calloc(len + 1 > uni.sig_bytes ? len + 1 : uni.sig_bytes, 1);
+
+    key_gen(&top, &pt, 0);
+    bot.p     = pb;
+    bot.bds_k = 0;
+    bot.st    = calloc(1, sizeof(xmss_hss_state));
+    test_rng_reset(92);                          /* own I and seed */
+    xmss_hss_keygen(&pb, bot.pk, bot.sk, bot.st, 0, test_randombytes);
+    xmss_hss_sign(&pt, ts, bot.pk + 4, XMSS_HSS_LMS_PUB_BYTES, top.sk, top.st, 0);
+    key_sign(&bot, bs, 0);
+    memset(m, 0, sizeof(m));
+
+    wr32(pk, 2);
+    memcpy(pk + 4, top.pk + 4, XMSS_HSS_LMS_PUB_BYTES);
+    wr32(sig, 1);
+    memcpy(sig + 4, ts + 4, pt.sig_bytes - 4);
+    memcpy(sig + pt.sig_bytes, bot.pk + 4, XMSS_HSS_LMS_PUB_BYTES);
+    memcpy(sig + pt.sig_bytes + XMSS_HSS_LMS_PUB_BYTES, bs + 4, pb.sig_bytes - 4);
+
+    TEST("mixed: reference verifier accepts H10/W2 over H5/W8",
+         ref_hss_verify(pk, m, sizeof(m), sig));
+    TEST_INT("mixed: verify_any accepts", xmss_hss_verify_any(m, sizeof(m), sig, len, pk,
+             sizeof(pk)), XMSS_OK);
+    TEST_INT("mixed: single-type verify rejects it (named restriction)",
+             xmss_hss_verify(&uni, m, sizeof(m), sig, pk),
+             XMSS_ERR_VERIFY);
+    TEST_INT("mixed: one byte short", xmss_hss_verify_any(m, sizeof(m), sig, len - 1, pk,
+             sizeof(pk)), XMSS_ERR_VERIFY);
+    TEST_INT("mixed: one byte over", xmss_hss_verify_any(m, sizeof(m), sig, len + 1, pk,
+             sizeof(pk)), XMSS_ERR_VERIFY);
+    m[0] ^= 1;
+    TEST_INT("mixed: wrong message", xmss_hss_verify_any(m, sizeof(m), sig, len, pk,
+             sizeof(pk)), XMSS_ERR_VERIFY);
+    m[0] ^= 1;
+    sig[pt.sig_bytes + 7] = LMOTS_SHA256_N32_W4;  /* child pub's LM-OTS type */
+    TEST_INT("mixed: child type changed", xmss_hss_verify_any(m, sizeof(m), sig, len, pk,
+             sizeof(pk)), XMSS_ERR_VERIFY);
+    sig[pt.sig_bytes + 7] = LMOTS_SHA256_N32_W8;
+    sig[pt.sig_bytes + 3] = 9;                   /* LMS_SHA256_M32_H25: unsupported */
+    TEST_INT("mixed: unsupported child type", xmss_hss_verify_any(m, sizeof(m), sig, len, pk,
+             sizeof(pk)), XMSS_ERR_VERIFY);
+    sig[pt.sig_bytes + 3] = LMS_SHA256_M32_H5;
+    TEST_INT("mixed: restored signature verifies", xmss_hss_verify_any(m, sizeof(m), sig, len,
+             pk, sizeof(pk)), XMSS_OK);
+
+    free(top.st); free(bot.st);
+    free(ts); free(bs); free(sig);
+}
+
+/* verify_any agrees with xmss_hss_verify on a uniform key */
+static void test_any_uniform(void)
+{
+    xmss_params p;
+    key_t_   k;
+    uint8_t *sig;
+    uint8_t  m[8];
+
+    xmss_hss_params(&p, 2, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W4);
+    sig = malloc(p.sig_bytes);
+    key_gen(&k, &p, 0);
+    key_sign(&k, sig, 0);
+    memset(m, 0, sizeof(m));
+    TEST_INT("uniform: verify_any accepts", xmss_hss_verify_any(m, sizeof(m), sig, p.sig_bytes,
+             k.pk, p.pk_bytes), XMSS_OK);
+    sig[p.sig_bytes - 1] ^= 1;
+    TEST_INT("uniform: verify_any rejects a flipped path bit",
+             xmss_hss_verify_any(m, sizeof(m), sig, p.sig_bytes, k.pk, p.pk_bytes),
+             XMSS_ERR_VERIFY);
+    free(k.st);
+    free(sig);
+}
+
+/* Verify cost against XMSS-MT with the same n, w and tree shape */
+static void bench(void)
+{
+    xmss_params hp, xp;
+    key_t_   k;
+    xmss_mt_state *xs = calloc(1, sizeof(xmss_mt_state));
+    uint8_t  xpk[4 + 64], xsk[4 + 8 + 4 * 64];
+    uint8_t *hsig, *xsig;
+    const uint8_t m[4] = { 1, 2, 3, 4 };
+    uint64_t t0, t_hss, t_xmss;
+    int      i;
+
+    xmss_hss_params(&hp, 2, LMS_SHA256_M32_H5, LMOTS_SHA256_N32_W4);
+    xmss_params_custom(&xp, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 10, 2);
+    hsig = malloc(hp.sig_bytes);
+    xsig = malloc(xp.sig_bytes);
+    key_gen(&k, &hp, 0);
+    xmss_hss_sign(&hp, hsig, m, sizeof(m), k.sk, k.st, 0);
+    xmss_mt_keygen(&xp, xpk, xsk, xs, 0, test_randombytes);
+    xmss_mt_sign(&xp, xsig, m, sizeof(m), xsk, xs, 0);
+
+    t0 = now_ns();
+    for (i = 0; i < 20; i++) { xmss_hss_verify(&hp, m, sizeof(m), hsig, k.pk); }
+    t_hss = (now_ns() - t0) / 20;
+    t0 = now_ns();
+    for (i = 0; i < 20; i++) { xmss_mt_verify(&xp, m, sizeof(m), xsig, xpk); }
+    t_xmss = (now_ns() - t0) / 20;
+    printf("  verify, 2 levels of height 5, w=16: HSS %llu us, XMSS-MT %llu us\n",
+           (unsigned long long)(t_hss / 1000), (unsigned long long)(t_xmss / 1000));
+
+    free(k.st); free(xs);
+    free(hsig); free(xsig);
+}
+
+int main(void)
+{
+    printf("=== test_hss ===\n");
+
+    printf("--- params ---\n");
+    test_params();
+
+    printf("--- lifetime (L=2, H5, W4) ---\n");
+    test_lifetime();
+
+    printf("--- single trees ---\n");
+    test_single("H5/W2", LMOTS_SHA256_N32_W2);
+    test_single("H5/W8", LMOTS_SHA256_N32_W8);
+
+    printf("--- rejection ---\n");
+    test_reject();
+
+    printf("--- mixed types per level ---\n");
+    test_mixed();
+    test_any_uniform();
+
+    printf("--- verify cost ---\n");
+    bench();
+
+    return tests_done();
+}
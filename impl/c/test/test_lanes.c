@@ -0,0 +1,343 @@
+/**
+ * test_lanes.c - Multi-lane (word-interleaved) pipeline vs scalar path
+ *
+ * For each parameter set, every lane of F/H/PRF_keygen, WOTS+ keygen,
+ * the L-tree and treehash_gen_leaves() must match the scalar functions
+ * with that lane's address.  SHA2-256 exercises the native lane kernel;
+ * SHA2-512 and SHAKE exercise the per-lane fallback.
+ *
+ * xmss_H_msg_multi() must match xmss_H_msg() for a batch of messages
+ * whose lengths straddle every padding boundary of the block sizes.
+ *
+ * wots_pk_from_sig_multi() (the chain scheduler) must recover the WOTS+
+ * public key of one and of two signatures, for w = 4, 16 and 256; its
+ * lane utilisation is printed and must stay high.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../include/xmss/params.h"
+#include "../include/xmss/types.h"
+#include "../src/hash/hash_iface.h"
+#include "../src/wots.h"
+#include "../src/ltree.h"
+#include "../src/treehash.h"
+#include "../src/address.h"
+
+static void fill(uint8_t *buf, uint32_t len, uint8_t base)
+{
+    uint32_t i;
+    for (i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(base + 7 * i);
+    }
+}
+
+static void test_oid(uint32_t oid, const char *name)
+{
+    xmss_params  p;
+    uint8_t      sk_seed[XMSS_MAX_N], seed[XMSS_MAX_N];
+    uint8_t      in[XMSS_HASH_LANES][XMSS_MAX_N], in2[XMSS_HASH_LANES][XMSS_MAX_N];
+    uint8_t      got[XMSS_MAX_N], want[XMSS_MAX_N];
+    xmss_adrs_t  adrs[XMSS_HASH_LANES];
+    xmss_lanes_t a, b, c;
+    char         label[96];
+    uint32_t     l;
+    int          ok;
+
+    if (xmss_params_from_oid(&p, oid) != 0) {
+        printf("FAIL: cannot get params for %s\n", name);
+        test_fail++;
+        return;
+    }
+    printf("--- %s ---\n", name);
+
+    fill(sk_seed, p.n, 0x11);
+    fill(seed, p.n, 0x22);
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        fill(in[l], p.n, (uint8_t)(0x40 + l));
+        fill(in2[l], p.n, (uint8_t)(0x80 + l));
+        memset(&adrs[l], 0, sizeof(adrs[l]));
+        xmss_adrs_set_layer(&adrs[l], 1);
+        xmss_adrs_set_type(&adrs[l], XMSS_ADRS_TYPE_OTS);
+        xmss_adrs_set_ots(&adrs[l], 5 + l);
+        xmss_adrs_set_chain(&adrs[l], 3);
+        xmss_adrs_set_hash(&adrs[l], 2 * l);
+        xmss_lanes_load(&p, &a, l, in[l]);
+        xmss_lanes_load(&p, &b, l, in2[l]);
+    }
+
+    /* load/store round trip */
+    ok = 1;
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        xmss_lanes_store(&p, got, &a, l);
+        ok = ok && memcmp(got, in[l], p.n) == 0;
+    }
+    snprintf(label, sizeof(label), "%s: lanes load/store round trip", name);
+    TEST(label, ok);
+
+    /* F */
+    xmss_F_lanes(&p, &c, seed, adrs, &a);
+    ok = 1;
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        xmss_F(&p, want, seed, &adrs[l], in[l]);
+        xmss_lanes_store(&p, got, &c, l);
+        ok = ok && memcmp(got, want, p.n) == 0;
+    }
+    snprintf(label, sizeof(label), "%s: F lanes == scalar F", name);
+    TEST(label, ok);
+
+    /* F in place */
+    c = a;
+    xmss_F_lanes(&p, &c, seed, adrs, &c);
+    ok = 1;
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        xmss_F(&p, want, seed, &adrs[l], in[l]);
+        xmss_lanes_store(&p, got, &c, l);
+        ok = ok && memcmp(got, want, p.n) == 0;
+    }
+    snprintf(label, sizeof(label), "%s: F lanes in place", name);
+    TEST(label, ok);
+
+    /* H */
+    xmss_H_lanes(&p, &c, seed, adrs, &a, &b);
+    ok = 1;
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        xmss_H(&p, want, seed, &adrs[l], in[l], in2[l]);
+        xmss_lanes_store(&p, got, &c, l);
+        ok = ok && memcmp(got, want, p.n) == 0;
+    }
+    snprintf(label, sizeof(label), "%s: H lanes == scalar H", name);
+    TEST(label, ok);
+
+    /* PRF_keygen */
+    xmss_PRF_keygen_lanes(&p, &c, sk_seed, seed, adrs);
+    ok = 1;
+    for (l = 0; l < XMSS_HASH_LANES; l++) {
+        xmss_PRF_keygen(&p, want, sk_seed, seed, &adrs[l]);
+        xmss_lanes_store(&p, got, &c, l);
+        ok = ok && memcmp(got, want, p.n) == 0;
+    }
+    snprintf(label, sizeof(label), "%s: PRF_keygen lanes == scalar", name);
+    TEST(label, ok);
+
+    /* WOTS+ keygen + L-tree, lane by lane */
+    {
+        static xmss_lanes_t pk_lanes[XMSS_MAX_WOTS_LEN];
+        static uint8_t      pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+        uint8_t             leaves[XMSS_HASH_LANES][XMSS_MAX_N];
+        uint8_t             few[XMSS_HASH_LANES][XMSS_MAX_N];
+        xmss_adrs_t         ots[XMSS_HASH_LANES], lt[XMSS_HASH_LANES];
+        xmss_adrs_t         base, s;
+        uint32_t            i;
+        int                 pk_ok = 1, root_ok = 1, leaf_ok = 1, few_ok = 1;
+
+        memset(&base, 0, sizeof(base));
+        xmss_adrs_set_layer(&base, 1);
+        xmss_adrs_set_tree(&base, 3);
+
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            ots[l] = base;
+            xmss_adrs_set_type(&ots[l], XMSS_ADRS_TYPE_OTS);
+            xmss_adrs_set_ots(&ots[l], 8 + l);
+            lt[l] = base;
+            xmss_adrs_set_type(&lt[l], XMSS_ADRS_TYPE_LTREE);
+            xmss_adrs_set_ltree(&lt[l], 8 + l);
+        }
+        wots_gen_pk_lanes(&p, pk_lanes, sk_seed, seed, ots);
+
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            s = ots[l];
+            wots_gen_pk(&p, pk, sk_seed, seed, &s);
+            for (i = 0; i < p.len; i++) {
+                xmss_lanes_store(&p, got, &pk_lanes[i], l);
+                pk_ok = pk_ok && memcmp(got, pk + i * p.n, p.n) == 0;
+            }
+        }
+        snprintf(label, sizeof(label), "%s: WOTS+ pk lanes == scalar", name);
+        TEST(label, pk_ok);
+
+        l_tree_lanes(&p, &c, pk_lanes, seed, lt);
+        treehash_gen_leaves(&p, leaves, sk_seed, seed, 8, XMSS_HASH_LANES, &base);
+        for (l = 0; l < XMSS_HASH_LANES; l++) {
+            s = ots[l];
+            wots_gen_pk(&p, pk, sk_seed, seed, &s);
+            s = lt[l];
+            l_tree(&p, want, pk, seed, &s);
+            xmss_lanes_store(&p, got, &c, l);
+            root_ok = root_ok && memcmp(got, want, p.n) == 0;
+            leaf_ok = leaf_ok && memcmp(leaves[l], want, p.n) == 0;
+        }
+        snprintf(label, sizeof(label), "%s: L-tree lanes == scalar", name);
+        TEST(label, root_ok);
+        snprintf(label, sizeof(label), "%s: treehash_gen_leaves == scalar", name);
+        TEST(label, leaf_ok);
+
+        /* A short batch computes only its own leaves, the same ones */
+        for (i = 1; i <= 2 && i <= XMSS_HASH_LANES; i++) {
+            memset(few, 0xEE, sizeof(few));
+            treehash_gen_leaves(&p, few, sk_seed, seed, 8, i, &base);
+            for (l = 0; l < XMSS_HASH_LANES; l++) {
+                few_ok = few_ok && (l < i ? memcmp(few[l], leaves[l], p.n) == 0
+                                          : few[l][0] == 0xEE);
+            }
+        }
+        snprintf(label, sizeof(label), "%s: treehash_gen_leaves count 1, 2", name);
+        TEST(label, few_ok);
+    }
+}
+
+/* Lengths around the 64/128-byte SHA-2 blocks and 136/168-byte SHAKE rates,
+ * counted after the 3n + 32-byte key prefix for n = 32. */
+static const size_t hmsg_lens[] = {
+    0, 1, 55, 56, 63, 64, 111, 112, 127, 128, 135, 136, 167, 168, 1000, 5000,
+    3, 17
+};
+#define HMSG_COUNT (sizeof(hmsg_lens) / sizeof(hmsg_lens[0]))
+
+static void test_hmsg_multi(uint32_t oid, const char *name)
+{
+    static uint8_t  msg[5000 + HMSG_COUNT];
+    xmss_params     p;
+    xmss_hmsg_input in[HMSG_COUNT];
+    uint8_t         r[HMSG_COUNT][XMSS_MAX_N], root[XMSS_MAX_N];
+    uint8_t         got[HMSG_COUNT * XMSS_MAX_N], want[XMSS_MAX_N];
+    char            label[96];
+    uint32_t        i;
+    int             ok = 1;
+
+    if (xmss_params_from_oid(&p, oid) != 0) {
+        printf("FAIL: cannot get params for %s\n", name);
+        test_fail++;
+        return;
+    }
+
+    fill(msg, (uint32_t)sizeof(msg), 0x5A);
+    fill(root, p.n, 0x33);
+    for (i = 0; i < HMSG_COUNT; i++) {
+        fill(r[i], p.n, (uint8_t)(0x10 * i));
+        in[i].r      = r[i];
+        in[i].root   = root;
+        in[i].idx    = 1000 + i;
+        in[i].msg    = msg + i;     /* distinct bytes per lane */
+        in[i].msglen = hmsg_lens[i];
+    }
+
+    xmss_H_msg_multi(&p, got, in, HMSG_COUNT);
+    for (i = 0; i < HMSG_COUNT; i++) {
+        xmss_H_msg(&p, want, in[i].r, in[i].root, in[i].idx, in[i].msg, in[i].msglen);
+        ok = ok && memcmp(got + i * p.n, want, p.n) == 0;
+    }
+    snprintf(label, sizeof(label), "%s: H_msg_multi == scalar H_msg", name);
+    TEST(label, ok);
+
+    /* Fewer messages than lanes */
+    xmss_H_msg_multi(&p, got, in + 4, 1);
+    xmss_H_msg(&p, want, in[4].r, in[4].root, in[4].idx, in[4].msg, in[4].msglen);
+    snprintf(label, sizeof(label), "%s: H_msg_multi single message", name);
+    TEST(label, memcmp(got, want, p.n) == 0);
+}
+
+/* Chain scheduler: recovered keys, and lane utilisation over many
+ * message hashes */
+static void test_chain_sched(const xmss_params *p, const char *name)
+{
+    static uint8_t   pk[WOTS_SCHED_JOBS][XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    static uint8_t   sig[WOTS_SCHED_JOBS][XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    static uint8_t   want[WOTS_SCHED_JOBS][XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    uint8_t          sk_seed[XMSS_MAX_N], seed[XMSS_MAX_N], msg[WOTS_SCHED_JOBS][XMSS_MAX_N];
+    uint8_t         *pks[WOTS_SCHED_JOBS];
+    const uint8_t   *sigs[WOTS_SCHED_JOBS], *msgs[WOTS_SCHED_JOBS];
+    xmss_adrs_t      adrs[WOTS_SCHED_JOBS], s;
+    wots_sched_stats one, two;
+    char             label[96];
+    uint32_t         r, j;
+    int              ok1 = 1, ok2 = 1;
+
+    fill(sk_seed, p->n, 0x11);
+    fill(seed, p->n, 0x22);
+    memset(&one, 0, sizeof(one));
+    memset(&two, 0, sizeof(two));
+
+    /* r = 0 and 1: all-zero and all-one message hashes (longest and
+     * shortest message chains), then spread values */
+    for (r = 0; r < 24; r++) {
+        for (j = 0; j < WOTS_SCHED_JOBS; j++) {
+            if (r < 2) {
+                memset(msg[j], r == 0 ? 0x00 : 0xFF, p->n);
+            } else {
+                fill(msg[j], p->n, (uint8_t)(37 * r + 101 * j));
+            }
+            memset(&adrs[j], 0, sizeof(adrs[j]));
+            xmss_adrs_set_layer(&adrs[j], 2);
+            xmss_adrs_set_type(&adrs[j], XMSS_ADRS_TYPE_OTS);
+            xmss_adrs_set_ots(&adrs[j], 3 * r + j);
+            s = adrs[j];
+            wots_sign(p, sig[j], msg[j], sk_seed, seed, &s);
+            s = adrs[j];
+            wots_gen_pk(p, want[j], sk_seed, seed, &s);
+            pks[j]  = pk[j];
+            sigs[j] = sig[j];
+            msgs[j] = msg[j];
+        }
+        memset(pk, 0, sizeof(pk));
+        wots_pk_from_sig_multi(p, pks, sigs, msgs, seed, adrs, 1, &one);
+        ok1 = ok1 && memcmp(pk[0], want[0], p->len * p->n) == 0;
+
+        memset(pk, 0, sizeof(pk));
+        wots_pk_from_sig_multi(p, pks, sigs, msgs, seed, adrs, WOTS_SCHED_JOBS, &two);
+        for (j = 0; j < WOTS_SCHED_JOBS; j++) {
+            ok2 = ok2 && memcmp(pk[j], want[j], p->len * p->n) == 0;
+        }
+    }
+    snprintf(label, sizeof(label), "%s: scheduler recovers the WOTS+ pk", name);
+    TEST(label, ok1);
+    snprintf(label, sizeof(label), "%s: scheduler recovers %u pks at once", name,
+             (unsigned)WOTS_SCHED_JOBS);
+    TEST(label, ok2);
+
+    printf("  %s: lane utilisation %.1f%% (1 signature), %.1f%% (%u)\n", name,
+           100.0 * (double)one.steps / (double)(one.rounds * XMSS_HASH_LANES),
+           100.0 * (double)two.steps / (double)(two.rounds * XMSS_HASH_LANES),
+           (unsigned)WOTS_SCHED_JOBS);
+    /* One signature leaves a tail of about w/2 rounds; a second one
+     * fills it (matters for wide XMSS_HASH_LANES builds) */
+    snprintf(label, sizeof(label), "%s: lane utilisation >= 85%% / 95%%", name);
+    TEST(label, one.steps * 100 >= one.rounds * XMSS_HASH_LANES * 85 &&
+                two.steps * 100 >= two.rounds * XMSS_HASH_LANES * 95);
+}
+
+static void test_chain_sched_sets(void)
+{
+    xmss_params p;
+
+    xmss_params_from_oid(&p, OID_XMSS_SHA2_10_256);
+    test_chain_sched(&p, "SHA2_10_256");
+    xmss_params_from_oid(&p, OID_XMSS_SHAKE_10_512);
+    test_chain_sched(&p, "SHAKE_10_512");
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 4, 10, 1);
+    test_chain_sched(&p, "SHA2 n32 w4");
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 256, 10, 1);
+    test_chain_sched(&p, "SHA2 n32 w256");
+}
+
+int main(void)
+{
+    printf("=== test_lanes (XMSS_HASH_LANES=%u) ===\n", (unsigned)XMSS_HASH_LANES);
+
+    test_oid(OID_XMSS_SHA2_10_256,  "SHA2_10_256");
+    test_oid(OID_XMSS_SHA2_10_512,  "SHA2_10_512");
+    test_oid(OID_XMSS_SHAKE_10_256, "SHAKE_10_256");
+
+    printf("--- H_msg multi-buffer ---\n");
+    test_hmsg_multi(OID_XMSS_SHA2_10_256,  "SHA2_10_256");
+    test_hmsg_multi(OID_XMSS_SHA2_10_512,  "SHA2_10_512");
+    test_hmsg_multi(OID_XMSS_SHAKE_10_256, "SHAKE_10_256");
+    test_hmsg_multi(OID_XMSS_SHAKE_10_512, "SHAKE_10_512");
+
+    printf("--- WOTS+ chain scheduler ---\n");
+    test_chain_sched_sets();
+
+    return tests_done();
+}
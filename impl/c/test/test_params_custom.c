@@ -0,0 +1,253 @@
+/**
+ * test_params_custom.c - Private-use parameter sets (xmss_params_custom)
+ *
+ * Tests:
+ * - Validation: OID range, hash/n pairing, w, h/d bounds, WOTS+ length
+ * - Derived fields for w = 4 / 256 and equality with the RFC derivation
+ * - XMSS roundtrip for each w: signatures do not depend on bds_k,
+ *   every index verifies, tamper and OID mismatch fail, 2^h exhausts
+ * - XMSS-MT roundtrip with small per-tree heights through exhaustion
+ * - Odd h - bds_k and bds_k == tree_height (BDS update budget rounding)
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../include/xmss/xmss.h"
+#include "../include/xmss/params.h"
+
+#define OID_A (OID_XMSS_PRIVATE_MIN + 1U)
+
+static void test_validation(void)
+{
+    xmss_params p, r;
+
+    TEST_INT("RFC-range oid rejected",
+             xmss_params_custom(&p, 0x0000000DU, XMSS_FUNC_SHA2, 32, 16, 10, 1), XMSS_ERR_PARAMS);
+    TEST_INT("oid below private range rejected",
+             xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN - 1U, XMSS_FUNC_SHA2, 32, 16, 10, 1),
+             XMSS_ERR_PARAMS);
+    TEST_INT("oid 0xFFFFFFFF accepted",
+             xmss_params_custom(&p, 0xFFFFFFFFU, XMSS_FUNC_SHA2, 32, 16, 10, 1), XMSS_OK);
+    TEST_INT("NULL params rejected",
+             xmss_params_custom(NULL, OID_A, XMSS_FUNC_SHA2, 32, 16, 10, 1), XMSS_ERR_PARAMS);
+
+    TEST_INT("SHA2 n=24 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 24, 16, 10, 1), XMSS_ERR_PARAMS);
+    TEST_INT("SHAKE128 n=64 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHAKE128, 64, 16, 10, 1), XMSS_ERR_PARAMS);
+    TEST_INT("SHAKE256 n=32 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHAKE256, 32, 16, 10, 1), XMSS_ERR_PARAMS);
+    TEST_INT("unknown func rejected",
+             xmss_params_custom(&p, OID_A, 3, 32, 16, 10, 1), XMSS_ERR_PARAMS);
+
+    TEST_INT("w=8 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 8, 10, 1), XMSS_ERR_PARAMS);
+    TEST_INT("w=4 n=64 exceeds XMSS_MAX_WOTS_LEN",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 64, 4, 10, 1), XMSS_ERR_PARAMS);
+
+    TEST_INT("h=0 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 0, 1), XMSS_ERR_PARAMS);
+    TEST_INT("d=0 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 10, 0), XMSS_ERR_PARAMS);
+    TEST_INT("d not dividing h rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 10, 3), XMSS_ERR_PARAMS);
+    TEST_INT("XMSS h=21 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 21, 1), XMSS_ERR_PARAMS);
+    TEST_INT("tree height 21 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 42, 2), XMSS_ERR_PARAMS);
+    TEST_INT("h=64 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 64, 16), XMSS_ERR_PARAMS);
+    TEST_INT("d=13 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 26, 13), XMSS_ERR_PARAMS);
+    TEST_INT("MT tree height 1 rejected",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 4, 4), XMSS_ERR_PARAMS);
+    TEST_INT("MT h=16 rejected (index would wrap)",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 16, 2), XMSS_ERR_PARAMS);
+    TEST_INT("XMSS h=8 accepted",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 8, 1), XMSS_OK);
+    TEST_INT("XMSS h=1 accepted",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 16, 1, 1), XMSS_OK);
+    TEST_INT("h=60 d=12 w=256 accepted",
+             xmss_params_custom(&p, OID_A, XMSS_FUNC_SHAKE256, 64, 256, 60, 12), XMSS_OK);
+
+    /* Failure leaves the output alone */
+    memset(&p, 0xA5, sizeof(p));
+    r = p;
+    xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 8, 10, 1);
+    TEST_BYTES("rejected call leaves params", &p, &r, sizeof(p));
+}
+
+/* Field-wise, since the struct has padding; the OID is expected to differ */
+static int same_shape(const xmss_params *a, const xmss_params *b)
+{
+    return a->func == b->func && a->n == b->n && a->w == b->w &&
+           a->log2_w == b->log2_w && a->len1 == b->len1 && a->len2 == b->len2 &&
+           a->len == b->len && a->h == b->h && a->tree_height == b->tree_height &&
+           a->d == b->d && a->pad_len == b->pad_len && a->idx_bytes == b->idx_bytes &&
+           a->idx_max == b->idx_max && a->sig_bytes == b->sig_bytes &&
+           a->pk_bytes == b->pk_bytes && a->sk_bytes == b->sk_bytes;
+}
+
+static void test_derivation(void)
+{
+    xmss_params p, rfc;
+
+    xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 256, 8, 1);
+    TEST_INT("w=256 log2_w", (long long)p.log2_w, 8);
+    TEST_INT("w=256 len1",   (long long)p.len1, 32);
+    TEST_INT("w=256 len2",   (long long)p.len2, 2);
+    TEST_INT("w=256 sig_bytes", (long long)p.sig_bytes, 4 + 32 * (1 + 34 + 8));
+
+    xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 4, 8, 1);
+    TEST_INT("w=4 len1", (long long)p.len1, 128);
+    TEST_INT("w=4 len2", (long long)p.len2, 5);
+    TEST_INT("w=4 len",  (long long)p.len, XMSS_MAX_WOTS_LEN);
+
+    xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, 256, 27, 3);
+    TEST_INT("MT idx_bytes", (long long)p.idx_bytes, 4);
+    TEST_INT("MT tree_height", (long long)p.tree_height, 9);
+    TEST_INT("MT sig_bytes", (long long)p.sig_bytes, 4 + 32 + 3 * 34 * 32 + 27 * 32);
+
+    /* An RFC tuple derives exactly the RFC set apart from the OID */
+    xmss_params_from_oid(&rfc, OID_XMSS_SHAKE_16_256);
+    xmss_params_custom(&p, OID_A, XMSS_FUNC_SHAKE128, 32, 16, 16, 1);
+    TEST("RFC tuple == XMSS-SHAKE_16_256", same_shape(&p, &rfc));
+    xmss_mt_params_from_oid(&rfc, OID_XMSS_MT_SHA2_20_4_512);
+    xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 64, 16, 20, 4);
+    TEST("RFC tuple == XMSSMT-SHA2_20/4_512", same_shape(&p, &rfc));
+}
+
+static void test_xmss(uint32_t w, uint32_t h, uint32_t bds_k)
+{
+    xmss_params     p, other;
+    xmss_bds_state *state = (xmss_bds_state *)malloc(sizeof(xmss_bds_state));
+    xmss_bds_state *plain = (xmss_bds_state *)malloc(sizeof(xmss_bds_state));
+    uint8_t        *pk, *sk, *pk0, *sk0, *sig, *sig0;
+    uint8_t         msg[32];
+    uint32_t        i, leaves, ok = 1, same = 1;
+    char            label[96];
+
+    xmss_params_custom(&p, OID_A, XMSS_FUNC_SHA2, 32, w, h, 1);
+    pk   = (uint8_t *)malloc(p.pk_bytes);
+    pk0  = (uint8_t *)malloc(p.pk_bytes);
+    sk   = (uint8_t *)malloc(p.sk_bytes);
+    sk0  = (uint8_t *)malloc(p.sk_bytes);
+    sig  = (uint8_t *)malloc(p.sig_bytes);
+    sig0 = (uint8_t *)malloc(p.sig_bytes);
+    if (!state || !plain || !pk || !pk0 || !sk || !sk0 || !sig || !sig0) {
+        TEST("alloc", 0);
+        return;
+    }
+
+    /* Same seed with and without retained nodes: identical keys and sigs */
+    test_rng_reset(7);
+    snprintf(label, sizeof(label), "w=%u h=%u k=%u keygen", w, h, bds_k);
+    TEST_INT(label, xmss_keygen(&p, pk, sk, state, bds_k, test_randombytes), XMSS_OK);
+    test_rng_reset(7);
+    xmss_keygen(&p, pk0, sk0, plain, 0, test_randombytes);
+    snprintf(label, sizeof(label), "w=%u h=%u: pk independent of bds_k", w, h);
+    TEST_BYTES(label, pk, pk0, p.pk_bytes);
+
+    leaves = 1U << h;
+    for (i = 0; i < leaves; i++) {
+        memset(msg, (int)i, sizeof(msg));
+        if (xmss_sign(&p, sig, msg, sizeof(msg), sk, state, bds_k) != XMSS_OK ||
+            xmss_verify(&p, msg, sizeof(msg), sig, pk) != XMSS_OK) {
+            ok = 0;
+        }
+        if (i < 8 && bds_k != 0) {
+            xmss_sign(&p, sig0, msg, sizeof(msg), sk0, plain, 0);
+            same &= memcmp(sig, sig0, p.sig_bytes) == 0;
+        }
+    }
+    snprintf(label, sizeof(label), "w=%u h=%u: all %u indices sign+verify", w, h, leaves);
+    TEST(label, ok);
+    snprintf(label, sizeof(label), "w=%u h=%u: signatures independent of bds_k", w, h);
+    TEST(label, same);
+
+    snprintf(label, sizeof(label), "w=%u h=%u: exhausted", w, h);
+    TEST_INT(label, xmss_sign(&p, sig, msg, sizeof(msg), sk, state, bds_k), XMSS_ERR_EXHAUSTED);
+
+    /* Index 0 again: good under p, not under another OID with the same
+     * shape, and not once a chain value is flipped */
+    memset(msg, 0, sizeof(msg));
+    test_rng_reset(7);
+    xmss_keygen(&p, pk0, sk0, plain, 0, test_randombytes);
+    xmss_sign(&p, sig, msg, sizeof(msg), sk0, plain, 0);
+    snprintf(label, sizeof(label), "w=%u h=%u: index 0 verifies", w, h);
+    TEST_INT(label, xmss_verify(&p, msg, sizeof(msg), sig, pk), XMSS_OK);
+    xmss_params_custom(&other, OID_A + 1U, XMSS_FUNC_SHA2, 32, w, h, 1);
+    snprintf(label, sizeof(label), "w=%u h=%u: other private OID rejects", w, h);
+    TEST_INT(label, xmss_verify(&other, msg, sizeof(msg), sig, pk), XMSS_ERR_VERIFY);
+    sig[p.idx_bytes + p.n + 3] ^= 1;
+    snprintf(label, sizeof(label), "w=%u h=%u: tampered chain fails", w, h);
+    TEST_INT(label, xmss_verify(&p, msg, sizeof(msg), sig, pk), XMSS_ERR_VERIFY);
+
+    free(state); free(plain); free(pk); free(pk0); free(sk); free(sk0); free(sig); free(sig0);
+}
+
+static void test_mt(uint8_t func, uint32_t w, uint32_t h, uint32_t d, uint32_t bds_k)
+{
+    xmss_params    p;
+    xmss_mt_state *state = (xmss_mt_state *)malloc(sizeof(xmss_mt_state));
+    uint8_t       *pk, *sk, *sig;
+    uint8_t        msg[16];
+    uint32_t       i, leaves, ok = 1;
+    char           label[96];
+
+    xmss_params_custom(&p, OID_A, func, 32, w, h, d);
+    pk  = (uint8_t *)malloc(p.pk_bytes);
+    sk  = (uint8_t *)malloc(p.sk_bytes);
+    sig = (uint8_t *)malloc(p.sig_bytes);
+    if (!state || !pk || !sk || !sig) {
+        TEST("alloc", 0);
+        return;
+    }
+
+    test_rng_reset(11);
+    snprintf(label, sizeof(label), "MT w=%u h=%u/%u keygen", w, h, d);
+    TEST_INT(label, xmss_mt_keygen(&p, pk, sk, state, bds_k, test_randombytes), XMSS_OK);
+
+    leaves = 1U << h;
+    for (i = 0; i < leaves; i++) {
+        memset(msg, (int)(i * 3), sizeof(msg));
+        if (xmss_mt_sign(&p, sig, msg, sizeof(msg), sk, state, bds_k) != XMSS_OK ||
+            xmss_mt_verify(&p, msg, sizeof(msg), sig, pk) != XMSS_OK) {
+            ok = 0;
+        }
+    }
+    snprintf(label, sizeof(label), "MT w=%u h=%u/%u: all %u indices sign+verify", w, h, d, leaves);
+    TEST(label, ok);
+    snprintf(label, sizeof(label), "MT w=%u h=%u/%u: exhausted", w, h, d);
+    TEST_INT(label, xmss_mt_sign(&p, sig, msg, sizeof(msg), sk, state, bds_k),
+             XMSS_ERR_EXHAUSTED);
+
+    free(state); free(pk); free(sk); free(sig);
+}
+
+int main(void)
+{
+    printf("=== test_params_custom ===\n");
+
+    printf("--- validation ---\n");
+    test_validation();
+    printf("--- derivation ---\n");
+    test_derivation();
+    printf("--- XMSS roundtrip ---\n");
+    test_xmss(4,   6, 2);
+    test_xmss(16,  6, 4);
+    test_xmss(256, 4, 0);
+    test_xmss(16,  1, 0);
+    test_xmss(16,  2, 2);
+    test_xmss(16,  5, 2);   /* h - bds_k odd */
+    test_xmss(16,  3, 2);
+    printf("--- XMSS-MT roundtrip ---\n");
+    test_mt(XMSS_FUNC_SHA2,     256, 4, 2, 0);
+    test_mt(XMSS_FUNC_SHAKE128,   4, 6, 2, 2);  /* tree_height - bds_k odd */
+    test_mt(XMSS_FUNC_SHA2,      16, 6, 3, 2);  /* bds_k == tree_height */
+
+    return tests_done();
+}
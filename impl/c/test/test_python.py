@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""
+test_python.py - CPython extension (python/xmssmodule.c)
+
+Tests:
+- params(), generate() with a fixed seed is deterministic
+- sign/verify round trip through bytes, bytearray, memoryview and slices
+- wrong-length and tampered inputs fail; exhaustion raises xmss.Error
+- restore() from secret_key + export_state() continues the same sequence,
+  for XMSS and for XMSS-MT (whole hypertree state)
+- export() snapshots taken while another thread signs restore to a key
+  that never reissues an index and whose signatures verify
+- verify_batch() across native threads matches verify() item by item
+- the GIL is released: Python code runs while a batch verifies
+"""
+import sys
+import threading
+
+import xmss
+
+passed = 0
+failed = 0
+
+
+def check(name, cond):
+    global passed, failed
+    if cond:
+        passed += 1
+        print("  PASS: %s" % name)
+    else:
+        failed += 1
+        print("  FAIL: %s" % name)
+
+
+def test_params():
+    p = xmss.params("XMSS-SHA2_10_256")
+    check("params n/h/d", (p["n"], p["h"], p["d"]) == (32, 10, 1))
+    check("params sizes", (p["sig_bytes"], p["pk_bytes"], p["sk_bytes"]) == (2500, 68, 136))
+    m = xmss.params("XMSSMT-SHA2_20/4_256")
+    check("mt params", (m["h"], m["d"], m["tree_height"]) == (20, 4, 5))
+    try:
+        xmss.params("XMSS-MD5_1_1")
+        check("unknown name rejected", False)
+    except ValueError:
+        check("unknown name rejected", True)
+
+
+def test_roundtrip(name, seed):
+    key = xmss.generate(name, seed=seed)
+    again = xmss.generate(name, seed=seed)
+    check("%s: seeded keygen deterministic" % name, key.public_key == again.public_key)
+    p = xmss.params(name)
+    check("%s: remaining" % name, key.remaining == 1 << p["h"])
+
+    msg = bytearray(b"zero-copy message " * 10)
+    sig = key.sign(msg)
+    check("%s: signature length" % name, len(sig) == p["sig_bytes"])
+    check("%s: verify bytearray" % name, xmss.verify(name, msg, sig, key.public_key))
+    check("%s: verify memoryview" % name,
+          xmss.verify(name, memoryview(bytes(msg)), memoryview(sig), key.public_key))
+    check("%s: verify slice view" % name,
+          xmss.verify(name, memoryview(b"xx" + bytes(msg))[2:], sig, key.public_key))
+    check("%s: wrong message fails" % name, not xmss.verify(name, b"other", sig, key.public_key))
+    check("%s: short signature fails" % name,
+          not xmss.verify(name, msg, sig[:-1], key.public_key))
+    check("%s: index advanced" % name, key.remaining == (1 << p["h"]) - 1)
+    return key
+
+
+def test_restore():
+    name = "XMSS-SHA2_10_256"
+    seed = bytes(range(96))
+    a = xmss.generate(name, bds_k=2, seed=seed)
+    for i in range(3):
+        a.sign(b"m%d" % i)
+    b = xmss.restore(name, a.secret_key, a.export_state(), bds_k=2)
+    check("restore: public key", b.public_key == a.public_key)
+    check("restore: same next signature", a.sign(b"next") == b.sign(b"next"))
+
+    # XMSS-MT: sign across a bottom-tree boundary (2^5 leaves) so the
+    # restored state carries next trees and cached WOTS signatures
+    mt_name = "XMSSMT-SHA2_20/4_256"
+    mt = xmss.generate(mt_name, bds_k=2, seed=seed)
+    for i in range(33):
+        mt.sign(b"m%d" % i)
+    st = mt.export_state()
+    check("mt export_state length", len(st) < 64 * 1024)
+    mb = xmss.restore(mt_name, mt.secret_key, st, bds_k=2)
+    check("mt restore: public key", mb.public_key == mt.public_key)
+    check("mt restore: remaining", mb.remaining == mt.remaining)
+    same = all(mt.sign(b"n%d" % i) == mb.sign(b"n%d" % i) for i in range(3))
+    check("mt restore: same next signatures", same)
+    check("mt restore: state round-trips", mb.export_state() == mt.export_state())
+    try:
+        xmss.restore(mt_name, mt.secret_key, st[:-1], bds_k=2)
+        check("mt restore length checked", False)
+    except ValueError:
+        check("mt restore length checked", True)
+    try:
+        xmss.restore(name, a.secret_key[:-1], a.export_state(), bds_k=2)
+        check("restore length checked", False)
+    except ValueError:
+        check("restore length checked", True)
+    for bad in (3, 12):
+        try:
+            xmss.generate(name, bds_k=bad, seed=seed)
+            check("generate rejects bds_k=%d" % bad, False)
+        except ValueError:
+            check("generate rejects bds_k=%d" % bad, True)
+
+
+def test_export_threaded():
+    # XMSS signatures start with the 4-byte big-endian leaf index
+    name = "XMSS-SHA2_10_256"
+    key = xmss.generate(name, bds_k=2, seed=bytes(range(2, 98)))
+    issued = []
+    stop = threading.Event()
+
+    def signer():
+        while not stop.is_set() and len(issued) < 400:
+            issued.append(int.from_bytes(key.sign(b"t")[:4], "big"))
+
+    t = threading.Thread(target=signer)
+    t.start()
+    reused = bad = snaps = 0
+    while snaps < 40 and t.is_alive():
+        before = max(issued, default=-1)
+        sk, st = key.export()
+        copy = xmss.restore(name, sk, st, bds_k=2)
+        sig = copy.sign(b"copy")
+        reused += int.from_bytes(sig[:4], "big") <= before
+        bad += not xmss.verify(name, b"copy", sig, key.public_key)
+        snaps += 1
+    stop.set()
+    t.join()
+    check("export under signing: %d snapshots, no reissued index" % snaps,
+          snaps > 0 and reused == 0)
+    check("export under signing: restored signatures verify", bad == 0)
+
+
+def test_exhausted():
+    # Bump the SK index field to 2^h and restore: the key must refuse to sign
+    name = "XMSS-SHA2_10_256"
+    key = xmss.generate(name, seed=bytes(96))
+    sk = bytearray(key.secret_key)
+    sk[4:8] = (1 << 10).to_bytes(4, "big")
+    spent = xmss.restore(name, bytes(sk), key.export_state())
+    try:
+        spent.sign(b"x")
+        check("exhausted key raises", False)
+    except xmss.Error as e:
+        check("exhausted key raises", e.args[0] == xmss.ERR_EXHAUSTED)
+
+
+def test_batch(name, key):
+    msgs = [b"batch item %d" % i for i in range(37)]
+    sigs = [key.sign(m) for m in msgs]
+    pks = [key.public_key] * len(msgs)
+    sigs[5] = bytes(len(sigs[5]))                   # garbage
+    msgs[20] = b"tampered"
+    sigs[33] = sigs[33][:-3]                        # wrong length
+    want = [xmss.verify(name, m, s, k) for m, s, k in zip(msgs, sigs, pks)]
+    for threads in (1, 3, 0):
+        got = xmss.verify_batch(name, msgs, sigs, pks, threads=threads)
+        check("%s: batch threads=%d matches verify" % (name, threads), got == want)
+    check("%s: batch flags the bad items" % name,
+          [i for i, ok in enumerate(want) if not ok] == [5, 20, 33])
+    check("%s: empty batch" % name, xmss.verify_batch(name, [], [], []) == [])
+    try:
+        xmss.verify_batch(name, msgs, sigs[:-1], pks)
+        check("%s: length mismatch rejected" % name, False)
+    except ValueError:
+        check("%s: length mismatch rejected" % name, True)
+
+
+def test_gil_released(name, key):
+    msg = b"gil"
+    sig = key.sign(msg)
+    n = 48
+    done = threading.Event()
+    ticks = [0]
+
+    def worker():
+        xmss.verify_batch(name, [msg] * n, [sig] * n, [key.public_key] * n, threads=1)
+        done.set()
+
+    t = threading.Thread(target=worker)
+    t.start()
+    while not done.is_set():
+        ticks[0] += 1
+    t.join()
+    # With the GIL held for the whole batch this loop would barely run
+    check("GIL released during verify_batch (%d ticks)" % ticks[0], ticks[0] > 1000)
+
+
+def main():
+    print("=== test_python ===")
+    print("--- params ---")
+    test_params()
+    print("--- round trip ---")
+    k1 = test_roundtrip("XMSS-SHA2_10_256", bytes(range(96)))
+    k2 = test_roundtrip("XMSSMT-SHAKE_20/4_256", bytes(range(1, 97)))
+    print("--- restore / exhaustion ---")
+    test_restore()
+    test_export_threaded()
+    test_exhausted()
+    print("--- verify_batch ---")
+    test_batch("XMSS-SHA2_10_256", k1)
+    test_batch("XMSSMT-SHAKE_20/4_256", k2)
+    test_gil_released("XMSS-SHA2_10_256", k1)
+
+    print("Results: %d passed, %d failed" % (passed, failed))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,333 @@
+/**
+ * test_retune.c - Switching a key's bds_k in place
+ *
+ * Tests:
+ * - xmss_retune() on XMSS h=6 at indices across the tree (first, mid-tree,
+ *   last) for each pair of bds_k values: the key's first signatures match
+ *   those of a twin generated with the new bds_k and verify, its auth path
+ *   matches the twin's at every remaining index, and its state survives
+ *   serialization at the new size
+ * - retuning twice in the life of an h=8 key
+ * - xmss_mt_retune() on XMSS-MT h=10/d=2 and h=12/d=3 at and around tree
+ *   boundaries, with partly and wholly built next trees
+ * - XMSS_ERR_PARAMS for invalid bds_k values, XMSS_ERR_EXHAUSTED for a
+ *   used-up key, and no change when the value does not change
+ *
+ * Also prints the cost of a retune against keygen.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_utils.h"
+#include "../include/xmss/xmss.h"
+
+#define SK_MAX (4 + 8 + 4 * XMSS_MAX_N)
+#define PK_MAX (4 + 2 * XMSS_MAX_N)
+
+/* Indices signed and verified after a retune; the rest compare state */
+#define SIGNED 4
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+/* Advance both keys up to @count indices: the first few are signed (the
+ * signatures must match and verify), the rest skipped with the auth paths
+ * compared, which is what decides every later signature.  1 if all agree */
+static int xmss_same(const xmss_params *p, const uint8_t *pk,
+                     uint8_t *sk_a, xmss_bds_state *a, uint32_t k_a,
+                     uint8_t *sk_b, xmss_bds_state *b, uint32_t k_b,
+                     uint32_t count)
+{
+    uint8_t *sig_a = malloc(p->sig_bytes), *sig_b = malloc(p->sig_bytes);
+    uint8_t  m[8];
+    uint32_t i;
+    int      ok = 1;
+
+    for (i = 0; i < count && xmss_remaining_sigs(p, sk_b) > 0; i++) {
+        if (i < SIGNED) {
+            memset(m, (int)i, sizeof(m));
+            ok = ok && xmss_sign(p, sig_a, m, sizeof(m), sk_a, a, k_a) == XMSS_OK;
+            ok = ok && xmss_sign(p, sig_b, m, sizeof(m), sk_b, b, k_b) == XMSS_OK;
+            ok = ok && memcmp(sig_a, sig_b, p->sig_bytes) == 0;
+            ok = ok && xmss_verify(p, m, sizeof(m), sig_a, pk) == XMSS_OK;
+        } else {
+            ok = ok && memcmp(a->auth, b->auth, sizeof(a->auth)) == 0;
+            xmss_skip(p, sk_a, a, k_a);
+            xmss_skip(p, sk_b, b, k_b);
+        }
+    }
+    free(sig_a); free(sig_b);
+    return ok;
+}
+
+static int mt_same(const xmss_params *p, const uint8_t *pk,
+                   uint8_t *sk_a, xmss_mt_state *a, uint32_t k_a,
+                   uint8_t *sk_b, xmss_mt_state *b, uint32_t k_b,
+                   uint32_t count)
+{
+    uint8_t *sig_a = malloc(p->sig_bytes), *sig_b = malloc(p->sig_bytes);
+    uint8_t  m[8];
+    uint32_t i, l;
+    int      ok = 1;
+
+    for (i = 0; i < count && xmss_mt_remaining_sigs(p, sk_b) > 0; i++) {
+        if (i < SIGNED) {
+            memset(m, (int)i, sizeof(m));
+            ok = ok && xmss_mt_sign(p, sig_a, m, sizeof(m), sk_a, a, k_a) == XMSS_OK;
+            ok = ok && xmss_mt_sign(p, sig_b, m, sizeof(m), sk_b, b, k_b) == XMSS_OK;
+            ok = ok && memcmp(sig_a, sig_b, p->sig_bytes) == 0;
+            ok = ok && xmss_mt_verify(p, m, sizeof(m), sig_a, pk) == XMSS_OK;
+        } else {
+            for (l = 0; l < p->d; l++) {
+                ok = ok && memcmp(a->bds[l].auth, b->bds[l].auth,
+                                  sizeof(a->bds[l].auth)) == 0;
+            }
+            for (l = 0; l + 1 < p->d; l++) {
+                ok = ok && memcmp(a->wots_sigs[l], b->wots_sigs[l], p->len * p->n) == 0;
+            }
+            xmss_mt_skip(p, sk_a, a, k_a);
+            xmss_mt_skip(p, sk_b, b, k_b);
+        }
+    }
+    free(sig_a); free(sig_b);
+    return ok;
+}
+
+/* Key with @old_k skipped to @at and retuned to @new_k, against a twin
+ * generated with @new_k; the retuned state is serialized and read back
+ * when @roundtrip is set */
+static int xmss_case(const xmss_params *p, uint32_t old_k, uint32_t new_k,
+                     uint32_t at, int roundtrip)
+{
+    xmss_bds_state *a = calloc(1, sizeof(*a)), *b = calloc(1, sizeof(*b));
+    uint8_t         pk[PK_MAX], pk_b[PK_MAX], sk_a[SK_MAX], sk_b[SK_MAX];
+    uint8_t        *buf;
+    uint32_t        i;
+    int             ok = 1;
+
+    test_rng_reset(96);
+    xmss_keygen(p, pk, sk_a, a, old_k, test_randombytes);
+    test_rng_reset(96);
+    xmss_keygen(p, pk_b, sk_b, b, new_k, test_randombytes);
+    for (i = 0; i < at; i++) {
+        xmss_skip(p, sk_a, a, old_k);
+        xmss_skip(p, sk_b, b, new_k);
+    }
+
+    ok = ok && xmss_retune(p, sk_a, a, old_k, new_k) == XMSS_OK;
+    if (roundtrip) {
+        buf = malloc(xmss_bds_serialized_size(p, new_k));
+        ok = ok && xmss_bds_serialize(p, buf, a, new_k) == XMSS_OK;
+        memset(a, 0xA5, sizeof(*a));
+        ok = ok && xmss_bds_deserialize(p, a, buf, new_k) == XMSS_OK;
+        free(buf);
+    }
+    ok = ok && xmss_same(p, pk, sk_a, a, new_k, sk_b, b, new_k, ~0U);
+
+    free(a); free(b);
+    return ok;
+}
+
+static void test_xmss(void)
+{
+    static const uint32_t pairs[][2] = {
+        { 2, 0 }, { 2, 4 }, { 0, 4 }, { 4, 2 }, { 4, 0 }, { 0, 2 }
+    };
+    static const uint32_t at[] = { 0, 1, 21, 32, 63 };
+    xmss_params     p;
+    xmss_bds_state *a = calloc(1, sizeof(*a)), *b = calloc(1, sizeof(*b));
+    uint8_t         pk[PK_MAX], pk_b[PK_MAX], sk_a[SK_MAX], sk_b[SK_MAX];
+    uint32_t        i, j;
+    uint8_t         usage;
+    int             ok;
+    char            name[64];
+
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 4, 6, 1);
+
+    for (i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        ok = 1;
+        for (j = 0; j < sizeof(at) / sizeof(at[0]); j++) {
+            ok = ok && xmss_case(&p, pairs[i][0], pairs[i][1], at[j], (at[j] & 1) != 0);
+        }
+        snprintf(name, sizeof(name), "xmss h=6: bds_k %u -> %u signs as the twin",
+                 (unsigned)pairs[i][0], (unsigned)pairs[i][1]);
+        TEST(name, ok);
+    }
+
+    /* Twice in one life: 2 -> 4 at 50, 4 -> 0 at 90 */
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 4, 8, 1);
+    test_rng_reset(97);
+    xmss_keygen(&p, pk, sk_a, a, 2, test_randombytes);
+    test_rng_reset(97);
+    xmss_keygen(&p, pk_b, sk_b, b, 0, test_randombytes);
+    ok = xmss_same(&p, pk, sk_a, a, 2, sk_b, b, 0, 50);
+    ok = ok && xmss_retune(&p, sk_a, a, 2, 4) == XMSS_OK;
+    ok = ok && xmss_same(&p, pk, sk_a, a, 4, sk_b, b, 0, 40);
+    ok = ok && xmss_retune(&p, sk_a, a, 4, 0) == XMSS_OK;
+    ok = ok && xmss_same(&p, pk, sk_a, a, 0, sk_b, b, 0, ~0U);
+    TEST("xmss h=8: retuned twice, signs to the end", ok);
+
+    /* Errors */
+    test_rng_reset(98);
+    xmss_keygen(&p, pk, sk_a, a, 2, test_randombytes);
+    memcpy(b, a, sizeof(*a));
+    TEST_INT("xmss: odd new_k", xmss_retune(&p, sk_a, a, 2, 3), XMSS_ERR_PARAMS);
+    TEST_INT("xmss: new_k > XMSS_MAX_BDS_K", xmss_retune(&p, sk_a, a, 2, 6), XMSS_ERR_PARAMS);
+    TEST_INT("xmss: new_k > h", xmss_retune(&p, sk_a, a, 2, 10), XMSS_ERR_PARAMS);
+    TEST_INT("xmss: odd bds_k", xmss_retune(&p, sk_a, a, 1, 2), XMSS_ERR_PARAMS);
+    TEST_INT("xmss: same bds_k", xmss_retune(&p, sk_a, a, 2, 2), XMSS_OK);
+    TEST("xmss: state untouched by refused or no-op retunes",
+         memcmp(a, b, sizeof(*a)) == 0);
+    usage = a->treehash[0].stack_usage;
+    a->treehash[0].stack_usage = 200;
+    memcpy(b, a, sizeof(*a));
+    TEST_INT("xmss: corrupt stack usage", xmss_retune(&p, sk_a, a, 2, 4), XMSS_ERR_PARAMS);
+    TEST("xmss: corrupt state untouched", memcmp(a, b, sizeof(*a)) == 0);
+    a->treehash[0].stack_usage = usage;
+    for (i = 0; i <= p.idx_max; i++) {
+        xmss_skip(&p, sk_a, a, 2);
+    }
+    TEST_INT("xmss: exhausted", xmss_retune(&p, sk_a, a, 2, 4), XMSS_ERR_EXHAUSTED);
+
+    free(a); free(b);
+}
+
+/* XMSS-MT counterpart of xmss_case(); signs @count indices after @at */
+static int mt_case(const xmss_params *p, uint32_t old_k, uint32_t new_k,
+                   uint32_t at, uint32_t count, int roundtrip)
+{
+    xmss_mt_state *a = calloc(1, sizeof(*a)), *b = calloc(1, sizeof(*b));
+    uint8_t        pk[PK_MAX], pk_b[PK_MAX], sk_a[SK_MAX], sk_b[SK_MAX];
+    uint8_t       *buf;
+    uint32_t       i;
+    int            ok = 1;
+
+    test_rng_reset(99);
+    xmss_mt_keygen(p, pk, sk_a, a, old_k, test_randombytes);
+    test_rng_reset(99);
+    xmss_mt_keygen(p, pk_b, sk_b, b, new_k, test_randombytes);
+    for (i = 0; i < at; i++) {
+        xmss_mt_skip(p, sk_a, a, old_k);
+        xmss_mt_skip(p, sk_b, b, new_k);
+    }
+
+    ok = ok && xmss_mt_retune(p, sk_a, a, old_k, new_k) == XMSS_OK;
+    if (roundtrip) {
+        buf = malloc(xmss_mt_state_bytes(p, new_k));
+        ok = ok && xmss_mt_state_serialize(p, buf, a, new_k) == XMSS_OK;
+        memset(a, 0xA5, sizeof(*a));
+        ok = ok && xmss_mt_state_deserialize(p, a, buf, new_k) == XMSS_OK;
+        free(buf);
+    }
+    ok = ok && mt_same(p, pk, sk_a, a, new_k, sk_b, b, new_k, count);
+
+    free(a); free(b);
+    return ok;
+}
+
+static void test_mt(void)
+{
+    static const uint32_t pairs_2[][2] = { { 0, 2 }, { 4, 0 } };
+    static const uint32_t at_2[] = { 0, 3, 31, 32, 97 };
+    static const uint32_t pairs_3[][2] = { { 0, 4 }, { 4, 2 } };
+    static const uint32_t at_3[] = { 255, 256 };
+    xmss_params    p;
+    xmss_mt_state *a = calloc(1, sizeof(*a));
+    uint8_t        pk[PK_MAX], sk[SK_MAX];
+    uint32_t       i, j;
+    int            ok;
+    char           name[64];
+
+    /* Tree height 5: 70 signatures cross two layer-0 boundaries */
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 4, 10, 2);
+    for (i = 0; i < sizeof(pairs_2) / sizeof(pairs_2[0]); i++) {
+        ok = 1;
+        for (j = 0; j < sizeof(at_2) / sizeof(at_2[0]); j++) {
+            ok = ok && mt_case(&p, pairs_2[i][0], pairs_2[i][1], at_2[j], 70,
+                               (at_2[j] & 1) != 0);
+        }
+        snprintf(name, sizeof(name), "xmss-mt h=10/d=2: bds_k %u -> %u signs as the twin",
+                 (unsigned)pairs_2[i][0], (unsigned)pairs_2[i][1]);
+        TEST(name, ok);
+    }
+
+    /* Tree height 4: 256 is a layer-1 boundary */
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 4, 12, 3);
+    for (i = 0; i < sizeof(pairs_3) / sizeof(pairs_3[0]); i++) {
+        ok = 1;
+        for (j = 0; j < sizeof(at_3) / sizeof(at_3[0]); j++) {
+            ok = ok && mt_case(&p, pairs_3[i][0], pairs_3[i][1], at_3[j], 40,
+                               (at_3[j] & 1) != 0);
+        }
+        snprintf(name, sizeof(name), "xmss-mt h=12/d=3: bds_k %u -> %u signs as the twin",
+                 (unsigned)pairs_3[i][0], (unsigned)pairs_3[i][1]);
+        TEST(name, ok);
+    }
+
+    /* Errors: tree height 4 bounds new_k */
+    test_rng_reset(100);
+    xmss_mt_keygen(&p, pk, sk, a, 2, test_randombytes);
+    TEST_INT("xmss-mt: new_k > tree height", xmss_mt_retune(&p, sk, a, 2, 6), XMSS_ERR_PARAMS);
+    TEST_INT("xmss-mt: odd new_k", xmss_mt_retune(&p, sk, a, 2, 1), XMSS_ERR_PARAMS);
+    memset(sk + 4, 0xFF, p.idx_bytes);
+    TEST_INT("xmss-mt: exhausted", xmss_mt_retune(&p, sk, a, 2, 4), XMSS_ERR_EXHAUSTED);
+
+    free(a);
+}
+
+/* Keygen against a retune 2 -> 4 at the first index and mid-tree */
+static void bench(uint32_t h)
+{
+    xmss_params     p;
+    xmss_bds_state *st = calloc(1, sizeof(*st));
+    uint8_t         pk[PK_MAX], sk[SK_MAX];
+    uint64_t        t0, t_keygen, t_first, t_mid;
+    uint32_t        i;
+
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, h, 1);
+    test_rng_reset(101);
+    t0 = now_us();
+    xmss_keygen(&p, pk, sk, st, 2, test_randombytes);
+    t_keygen = now_us() - t0;
+
+    t0 = now_us();
+    xmss_retune(&p, sk, st, 2, 4);
+    t_first = now_us() - t0;
+
+    for (i = 0; i < (1U << (h - 1)); i++) {
+        xmss_skip(&p, sk, st, 4);
+    }
+    t0 = now_us();
+    xmss_retune(&p, sk, st, 4, 2);
+    t_mid = now_us() - t0;
+
+    printf("  xmss h=%u: keygen %llu us, retune at 0 %llu us, at 2^%u %llu us\n",
+           (unsigned)h, (unsigned long long)t_keygen, (unsigned long long)t_first,
+           (unsigned)(h - 1), (unsigned long long)t_mid);
+    free(st);
+}
+
+int main(void)
+{
+    printf("=== test_retune ===\n");
+
+    printf("--- XMSS ---\n");
+    test_xmss();
+
+    printf("--- XMSS-MT ---\n");
+    test_mt();
+
+    printf("--- cost ---\n");
+    bench(10);
+
+    return tests_done();
+}
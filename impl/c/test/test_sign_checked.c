@@ -0,0 +1,236 @@
+/**
+ * test_sign_checked.c - Verify-after-sign fault check
+ *
+ * Tests:
+ * - xmss_sign_checked() / xmss_mt_sign_checked() produce the same
+ *   signatures as the unchecked calls over a whole key lifetime
+ *   (XMSS h=5; XMSS-MT h=6/d=3, crossing every layer boundary)
+ * - a fault injected into the state (auth node, cached WOTS+ signature,
+ *   cached root) gives XMSS_ERR_FAULT, a zeroed signature and an advanced
+ *   index; with the state restored from a clean twin the next index signs
+ *
+ * Also prints the cost of the check against sign + full verify.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_utils.h"
+#include "../include/xmss/xmss.h"
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+static int all_zero(const uint8_t *b, size_t len)
+{
+    size_t i;
+    uint8_t acc = 0;
+    for (i = 0; i < len; i++) { acc |= b[i]; }
+    return acc == 0;
+}
+
+static void test_xmss(void)
+{
+    xmss_params     p;
+    xmss_bds_state *a = calloc(1, sizeof(*a)), *b = calloc(1, sizeof(*b));
+    uint8_t         pk[4 + 2 * XMSS_MAX_N], pk_b[4 + 2 * XMSS_MAX_N];
+    uint8_t         sk_a[4 + 8 + 4 * XMSS_MAX_N], sk_b[4 + 8 + 4 * XMSS_MAX_N];
+    uint8_t        *sig_a, *sig_b, m[8];
+    uint32_t        i;
+    int             ok = 1, same = 1, rc;
+
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 5, 1);
+    sig_a = malloc(p.sig_bytes);
+    sig_b = malloc(p.sig_bytes);
+    test_rng_reset(91);
+    xmss_keygen(&p, pk, sk_a, a, 2, test_randombytes);
+    test_rng_reset(91);
+    xmss_keygen(&p, pk_b, sk_b, b, 2, test_randombytes);
+
+    for (i = 0; i <= p.idx_max; i++) {
+        memset(m, (int)i, sizeof(m));
+        ok = ok && xmss_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 2) == XMSS_OK;
+        xmss_sign(&p, sig_b, m, sizeof(m), sk_b, b, 2);
+        same = same && memcmp(sig_a, sig_b, p.sig_bytes) == 0;
+        ok = ok && xmss_verify(&p, m, sizeof(m), sig_a, pk) == XMSS_OK;
+    }
+    TEST("xmss: every checked signature is OK and verifies", ok);
+    TEST("xmss: checked signatures match xmss_sign()", same);
+    TEST_INT("xmss: exhausted", xmss_sign_checked(&p, sig_a, m, 1, sk_a, a, 2),
+             XMSS_ERR_EXHAUSTED);
+
+    /* Fault in the auth path before index 6; b is a clean twin in lockstep
+     * (BDS builds later nodes from this one, so the state is restored from
+     * b rather than by flipping the bit back) */
+    test_rng_reset(91);
+    xmss_keygen(&p, pk, sk_a, a, 2, test_randombytes);
+    test_rng_reset(91);
+    xmss_keygen(&p, pk_b, sk_b, b, 2, test_randombytes);
+    for (i = 0; i < 6; i++) {
+        xmss_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 2);
+        xmss_sign(&p, sig_b, m, sizeof(m), sk_b, b, 2);
+    }
+    a->auth[2][5] ^= 0x10;
+    rc = xmss_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 2);
+    xmss_sign(&p, sig_b, m, sizeof(m), sk_b, b, 2);
+    TEST_INT("xmss fault: auth node flip detected", rc, XMSS_ERR_FAULT);
+    TEST("xmss fault: signature zeroed", all_zero(sig_a, p.sig_bytes));
+    TEST("xmss fault: index advanced", memcmp(sk_a, sk_b, p.sk_bytes) == 0);
+
+    memcpy(a, b, sizeof(*a));
+    rc = xmss_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 2);
+    xmss_sign(&p, sig_b, m, sizeof(m), sk_b, b, 2);
+    TEST("xmss fault: restored state signs the next index",
+         rc == XMSS_OK && memcmp(sig_a, sig_b, p.sig_bytes) == 0 &&
+         xmss_verify(&p, m, sizeof(m), sig_a, pk) == XMSS_OK);
+
+    free(a); free(b);
+    free(sig_a); free(sig_b);
+}
+
+static void test_mt(void)
+{
+    xmss_params    p;
+    xmss_mt_state *a = calloc(1, sizeof(*a)), *b = calloc(1, sizeof(*b));
+    uint8_t        pk[4 + 2 * XMSS_MAX_N], pk_b[4 + 2 * XMSS_MAX_N];
+    uint8_t        sk_a[4 + 8 + 4 * XMSS_MAX_N], sk_b[4 + 8 + 4 * XMSS_MAX_N];
+    uint8_t       *sig_a, *sig_b, m[8];
+    uint32_t       i;
+    int            ok = 1, same = 1, rc;
+
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 6, 3);
+    sig_a = malloc(p.sig_bytes);
+    sig_b = malloc(p.sig_bytes);
+    test_rng_reset(92);
+    xmss_mt_keygen(&p, pk, sk_a, a, 0, test_randombytes);
+    test_rng_reset(92);
+    xmss_mt_keygen(&p, pk_b, sk_b, b, 0, test_randombytes);
+
+    for (i = 0; i <= p.idx_max; i++) {
+        memset(m, (int)i, sizeof(m));
+        ok = ok && xmss_mt_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 0) == XMSS_OK;
+        xmss_mt_sign(&p, sig_b, m, sizeof(m), sk_b, b, 0);
+        same = same && memcmp(sig_a, sig_b, p.sig_bytes) == 0;
+        ok = ok && xmss_mt_verify(&p, m, sizeof(m), sig_a, pk) == XMSS_OK;
+    }
+    TEST("mt: every checked signature is OK and verifies", ok);
+    TEST("mt: checked signatures match xmss_mt_sign()", same);
+
+    /* Faults injected into a, with b signing in lockstep as the clean
+     * reference that a is restored from after each one */
+    test_rng_reset(92);
+    xmss_mt_keygen(&p, pk, sk_a, a, 0, test_randombytes);
+    test_rng_reset(92);
+    xmss_mt_keygen(&p, pk_b, sk_b, b, 0, test_randombytes);
+    for (i = 0; i < 16; i++) {
+        xmss_mt_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 0);
+        xmss_mt_sign(&p, sig_b, m, sizeof(m), sk_b, b, 0);
+    }
+
+    /* Top-layer cached WOTS+ signature, at index 16 where that part of
+     * the signature is new and gets checked */
+    a->wots_sigs[1][40] ^= 0x01;
+    rc = xmss_mt_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 0);
+    xmss_mt_sign(&p, sig_b, m, sizeof(m), sk_b, b, 0);
+    TEST_INT("mt fault: cached top-layer WOTS+ signature flip detected", rc, XMSS_ERR_FAULT);
+    TEST("mt fault: signature zeroed", all_zero(sig_a, p.sig_bytes));
+    memcpy(a, b, sizeof(*a));
+
+    /* Bottom-layer auth node */
+    a->bds[0].auth[0][0] ^= 0x80;
+    rc = xmss_mt_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 0);
+    xmss_mt_sign(&p, sig_b, m, sizeof(m), sk_b, b, 0);
+    TEST_INT("mt fault: layer-0 auth node flip detected", rc, XMSS_ERR_FAULT);
+    memcpy(a, b, sizeof(*a));
+
+    /* A corrupted cached root fails the check rather than passing it */
+    a->roots[0][3] ^= 0x01;
+    rc = xmss_mt_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 0);
+    xmss_mt_sign(&p, sig_b, m, sizeof(m), sk_b, b, 0);
+    TEST_INT("mt fault: cached root mismatch reported", rc, XMSS_ERR_FAULT);
+    memcpy(a, b, sizeof(*a));
+
+    rc = xmss_mt_sign_checked(&p, sig_a, m, sizeof(m), sk_a, a, 0);
+    xmss_mt_sign(&p, sig_b, m, sizeof(m), sk_b, b, 0);
+    TEST("mt fault: restored state signs the next index",
+         rc == XMSS_OK && memcmp(sig_a, sig_b, p.sig_bytes) == 0 &&
+         xmss_mt_verify(&p, m, sizeof(m), sig_a, pk) == XMSS_OK);
+    TEST_INT("mt fault: index advanced over the failed calls",
+             (long long)xmss_mt_remaining_sigs(&p, sk_a), (long long)(p.idx_max + 1 - 20));
+
+    free(a); free(b);
+    free(sig_a); free(sig_b);
+}
+
+/* µs per call: sign and checked sign of the same indices on twin keys,
+ * and a full verify of the same signature */
+static void bench(const char *name, uint32_t h, uint32_t d)
+{
+    xmss_params p;
+    void       *st[2];
+    uint8_t     pk[4 + 2 * XMSS_MAX_N], sk[2][4 + 8 + 4 * XMSS_MAX_N], *sig, m[32];
+    uint64_t    t0, t_sign = 0, t_checked = 0, t_verify = 0;
+    uint32_t    i, k, n = 64;
+
+    xmss_params_custom(&p, OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, h, d);
+    sig = malloc(p.sig_bytes);
+    memset(m, 7, sizeof(m));
+    for (k = 0; k < 2; k++) {
+        st[k] = calloc(1, d > 1 ? sizeof(xmss_mt_state) : sizeof(xmss_bds_state));
+        test_rng_reset(93);
+        if (d > 1) {
+            xmss_mt_keygen(&p, pk, sk[k], (xmss_mt_state *)st[k], 0, test_randombytes);
+        } else {
+            xmss_keygen(&p, pk, sk[k], (xmss_bds_state *)st[k], 0, test_randombytes);
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        t0 = now_us();
+        if (d > 1) { xmss_mt_sign(&p, sig, m, sizeof(m), sk[0], (xmss_mt_state *)st[0], 0); }
+        else       { xmss_sign(&p, sig, m, sizeof(m), sk[0], (xmss_bds_state *)st[0], 0); }
+        t_sign += now_us() - t0;
+
+        t0 = now_us();
+        if (d > 1) { xmss_mt_sign_checked(&p, sig, m, sizeof(m), sk[1], (xmss_mt_state *)st[1], 0); }
+        else       { xmss_sign_checked(&p, sig, m, sizeof(m), sk[1], (xmss_bds_state *)st[1], 0); }
+        t_checked += now_us() - t0;
+
+        t0 = now_us();
+        if (d > 1) { xmss_mt_verify(&p, m, sizeof(m), sig, pk); }
+        else       { xmss_verify(&p, m, sizeof(m), sig, pk); }
+        t_verify += now_us() - t0;
+    }
+    printf("  %s: sign %llu us, checked %llu us (check %lld us), full verify %llu us\n", name,
+           (unsigned long long)(t_sign / n), (unsigned long long)(t_checked / n),
+           ((long long)t_checked - (long long)t_sign) / (long long)n,
+           (unsigned long long)(t_verify / n));
+
+    free(st[0]); free(st[1]);
+    free(sig);
+}
+
+int main(void)
+{
+    printf("=== test_sign_checked ===\n");
+
+    printf("--- XMSS ---\n");
+    test_xmss();
+
+    printf("--- XMSS-MT ---\n");
+    test_mt();
+
+    printf("--- cost ---\n");
+    bench("xmss h=10", 10, 1);
+    bench("xmss-mt h=20/d=4", 20, 4);
+
+    return tests_done();
+}
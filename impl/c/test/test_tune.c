@@ -0,0 +1,196 @@
+/**
+ * test_tune.c - Backend selection and startup autotuner (tune.h)
+ *
+ * Tests:
+ * - Build defaults and availability reported by xmss_backend_get()
+ * - xmss_backend_set() rejects unsupported widths / Keccak kernels
+ * - Scalar (leaf_lanes = 1) and lane pipelines produce identical leaves
+ * - xmss_autotune() measures, writes the cache, then hits it; entries for
+ *   other OIDs survive; foreign-host and corrupt entries are re-measured
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../include/xmss/tune.h"
+#include "../include/xmss/params.h"
+#include "../src/treehash.h"
+#include "../src/address.h"
+
+#define CACHE "test_tune.cache"
+
+static void write_file(const char *text)
+{
+    FILE *f = fopen(CACHE, "w");
+    if (f != NULL) {
+        fputs(text, f);
+        fclose(f);
+    }
+}
+
+static int count_lines(void)
+{
+    char  line[256];
+    int   n = 0;
+    FILE *f = fopen(CACHE, "r");
+    if (f == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static void test_defaults(void)
+{
+    xmss_backend_info b, c;
+
+    xmss_backend_get(&b);
+    TEST_INT("default lanes", (long long)b.leaf_lanes, (long long)XMSS_HASH_LANES);
+    TEST_INT("max lanes", (long long)b.max_lanes, (long long)XMSS_HASH_LANES);
+    TEST_INT("default source", (long long)b.source, (long long)XMSS_TUNE_DEFAULT);
+    TEST("generic keccak always available",
+         (b.keccak_avail >> XMSS_KECCAK_GENERIC) & 1U);
+#ifdef XMSS_USE_OPENSSL
+    TEST_INT("sha2 provider", (long long)b.sha2, (long long)XMSS_SHA2_LIBCRYPTO);
+#else
+    TEST_INT("sha2 provider", (long long)b.sha2, (long long)XMSS_SHA2_PORTABLE);
+#endif
+
+    c = b;
+    c.leaf_lanes = 3;
+    TEST_INT("lanes 3 rejected", xmss_backend_set(&c), XMSS_ERR_PARAMS);
+    c.leaf_lanes = 0;
+    TEST_INT("lanes 0 rejected", xmss_backend_set(&c), XMSS_ERR_PARAMS);
+    c = b;
+    c.keccak = 7;
+    TEST_INT("unknown keccak rejected", xmss_backend_set(&c), XMSS_ERR_PARAMS);
+    if (((b.keccak_avail >> XMSS_KECCAK_ARM64_SHA3) & 1U) == 0) {
+        c.keccak = XMSS_KECCAK_ARM64_SHA3;
+        TEST_INT("unavailable keccak rejected", xmss_backend_set(&c), XMSS_ERR_PARAMS);
+    }
+    xmss_backend_get(&c);
+    TEST("rejected set leaves selection alone",
+         c.leaf_lanes == b.leaf_lanes && c.source == XMSS_TUNE_DEFAULT);
+
+    c = b;
+    c.leaf_lanes = 1;
+    c.source     = XMSS_TUNE_DEFAULT;
+    TEST_INT("pin scalar", xmss_backend_set(&c), XMSS_OK);
+    xmss_backend_get(&c);
+    TEST("pinned", c.leaf_lanes == 1 && c.source == XMSS_TUNE_PINNED && c.oid == 0);
+    TEST_INT("restore", xmss_backend_set(&b), XMSS_OK);
+}
+
+static void test_equivalence(uint32_t oid, const char *name)
+{
+    xmss_params       p;
+    xmss_backend_info b, c;
+    xmss_adrs_t       adrs;
+    uint8_t           sk_seed[XMSS_MAX_N], seed[XMSS_MAX_N];
+    uint8_t           lanes[XMSS_HASH_LANES][XMSS_MAX_N];
+    uint8_t           scalar[XMSS_HASH_LANES][XMSS_MAX_N];
+    uint32_t          k;
+    char              label[96];
+
+    xmss_params_from_oid(&p, oid);
+    memset(&adrs, 0, sizeof(adrs));
+    xmss_adrs_set_layer(&adrs, 1);
+    test_rng_reset(1);
+    test_randombytes(sk_seed, p.n);
+    test_randombytes(seed, p.n);
+
+    /* Only the first n bytes of each leaf are written */
+    memset(lanes, 0, sizeof(lanes));
+    memset(scalar, 0, sizeof(scalar));
+
+    xmss_backend_get(&b);
+    for (k = 0; k < 2; k++) {
+        if (((b.keccak_avail >> k) & 1U) == 0) {
+            continue;
+        }
+        c = b;
+        c.keccak = k;
+        c.leaf_lanes = XMSS_HASH_LANES;
+        xmss_backend_set(&c);
+        treehash_gen_leaves(&p, lanes, sk_seed, seed, 5, XMSS_HASH_LANES, &adrs);
+        c.leaf_lanes = 1;
+        xmss_backend_set(&c);
+        treehash_gen_leaves(&p, scalar, sk_seed, seed, 5, XMSS_HASH_LANES, &adrs);
+
+        snprintf(label, sizeof(label), "%s keccak=%u: scalar == lanes", name, (unsigned)k);
+        TEST_BYTES(label, scalar, lanes, sizeof(lanes));
+    }
+    xmss_backend_set(&b);
+}
+
+static void test_autotune(void)
+{
+    xmss_params       p, q;
+    xmss_backend_info r1, r2;
+    uint32_t          i, measured = 0;
+
+    remove(CACHE);
+    xmss_params_from_oid(&p, OID_XMSS_SHA2_10_256);
+    xmss_params_from_oid(&q, OID_XMSS_SHAKE_10_256);
+
+    TEST_INT("NULL params rejected", xmss_autotune(NULL, CACHE, NULL), XMSS_ERR_PARAMS);
+
+    TEST_INT("autotune (no cache)", xmss_autotune(&p, CACHE, &r1), XMSS_OK);
+    TEST_INT("first run measured", (long long)r1.source, (long long)XMSS_TUNE_MEASURED);
+    TEST_INT("tuned oid recorded", (long long)r1.oid, (long long)OID_XMSS_SHA2_10_256);
+    for (i = 0; i < XMSS_TUNE_CANDIDATES; i++) {
+        measured += r1.ns_per_leaf[i] != 0;
+    }
+    TEST("scalar and lanes both timed", measured == (XMSS_HASH_LANES > 1 ? 2U : 1U));
+    printf("  (lanes=%u keccak=%u: %llu ns/leaf scalar, %llu ns/leaf lanes)\n",
+           (unsigned)r1.leaf_lanes, (unsigned)r1.keccak,
+           (unsigned long long)r1.ns_per_leaf[r1.keccak],
+           (unsigned long long)r1.ns_per_leaf[2 + r1.keccak]);
+    TEST_INT("cache written", count_lines(), 1);
+
+    TEST_INT("autotune (cached)", xmss_autotune(&p, CACHE, &r2), XMSS_OK);
+    TEST_INT("second run cached", (long long)r2.source, (long long)XMSS_TUNE_CACHED);
+    TEST("cached choice matches",
+         r2.leaf_lanes == r1.leaf_lanes && r2.keccak == r1.keccak);
+
+    TEST_INT("second oid", xmss_autotune(&q, CACHE, &r2), XMSS_OK);
+    TEST_INT("second oid measured", (long long)r2.source, (long long)XMSS_TUNE_MEASURED);
+    TEST_INT("both oids cached", count_lines(), 2);
+    xmss_autotune(&p, CACHE, &r2);
+    TEST_INT("first oid still cached", (long long)r2.source, (long long)XMSS_TUNE_CACHED);
+
+    /* Another host's entry for the same OID must not be trusted */
+    write_file("xmss-tune v1 oid=0x00000001 host=L99-k1-s0-c1 lanes=1 keccak=0\n");
+    xmss_autotune(&p, CACHE, &r2);
+    TEST_INT("foreign host re-measured", (long long)r2.source, (long long)XMSS_TUNE_MEASURED);
+    TEST_INT("foreign entry replaced", count_lines(), 1);
+
+    /* Garbage is ignored and dropped on rewrite */
+    write_file("not a cache\nxmss-tune v1 oid=0x00000001 host=\n\n");
+    xmss_autotune(&p, CACHE, &r2);
+    TEST_INT("corrupt cache re-measured", (long long)r2.source, (long long)XMSS_TUNE_MEASURED);
+    TEST_INT("corrupt lines dropped", count_lines(), 1);
+
+    TEST_INT("no cache path", xmss_autotune(&p, NULL, &r2), XMSS_OK);
+    TEST_INT("no cache path measures", (long long)r2.source, (long long)XMSS_TUNE_MEASURED);
+    remove(CACHE);
+}
+
+int main(void)
+{
+    printf("=== test_tune ===\n");
+
+    printf("--- defaults / set ---\n");
+    test_defaults();
+    printf("--- scalar vs lanes ---\n");
+    test_equivalence(OID_XMSS_SHA2_10_256,  "SHA2_10_256");
+    test_equivalence(OID_XMSS_SHAKE_10_256, "SHAKE_10_256");
+    printf("--- autotune ---\n");
+    test_autotune();
+
+    return tests_done();
+}
@@ -0,0 +1,323 @@
+/**
+ * test_vstore.c - Memory-mapped verify-context store (vstore.h)
+ *
+ * Tests:
+ * - open() checks: long path, missing file read-only, foreign file,
+ *   layout mismatch, second writer
+ * - XMSS, XMSS-MT and a private parameter set: signatures verify through
+ *   the store and through xmss_verify() on the mapped context directly;
+ *   tampered signatures and unknown keys fail
+ * - add(): duplicates are no-ops, conflicting sets / OIDs and read-only
+ *   handles are refused
+ * - many keys: the table grows, every key is found after growth and after
+ *   reopening; a reader sees in-place appends at once and a grown table
+ *   after refresh()
+ * - a damaged record is not handed to the verifier
+ *
+ * Also prints the cold open and lookup times for the large store against
+ * rebuilding the table from the key list (informational).
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "test_utils.h"
+#include "../include/xmss/vstore.h"
+#include "utils.h"
+
+#define MANY 50000U
+
+static char store_path[] = "xmss_vstore_XXXXXX";
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+/* Fake but well-formed public key number i of set p */
+static void synth_pk(const xmss_params *p, uint8_t *pk, uint32_t i)
+{
+    test_rng_reset(0x5EED0000ULL + i);
+    ull_to_bytes(pk, 4, p->oid);
+    test_randombytes(pk + 4, 2 * p->n);
+}
+
+typedef struct {
+    xmss_params p;
+    uint8_t     pk[XMSS_VSTORE_PK_MAX];
+    uint8_t    *sig;
+} signed_key;
+
+static void make_key(signed_key *k, const xmss_params *p, const uint8_t *msg, size_t len)
+{
+    uint8_t *sk = (uint8_t *)malloc(p->sk_bytes);
+
+    k->p   = *p;
+    k->sig = (uint8_t *)malloc(p->sig_bytes);
+    test_rng_reset(p->oid ^ p->h);
+    if (p->d > 1) {
+        xmss_mt_state *st = (xmss_mt_state *)malloc(sizeof(xmss_mt_state));
+        xmss_mt_keygen(p, k->pk, sk, st, 0, test_randombytes);
+        xmss_mt_sign(p, k->sig, msg, len, sk, st, 0);
+        free(st);
+    } else {
+        xmss_bds_state *st = (xmss_bds_state *)malloc(sizeof(xmss_bds_state));
+        xmss_keygen(p, k->pk, sk, st, 0, test_randombytes);
+        xmss_sign(p, k->sig, msg, len, sk, st, 0);
+        free(st);
+    }
+    free(sk);
+}
+
+static void test_open(void)
+{
+    xmss_vstore vs;
+    char        longpath[XMSS_VSTORE_PATH_MAX + 1];
+    uint8_t     junk[4096];
+    int         fd;
+
+    memset(longpath, 'a', sizeof(longpath) - 1);
+    longpath[sizeof(longpath) - 1] = '\0';
+    TEST_INT("over-long path rejected", xmss_vstore_open(&vs, longpath, 0), XMSS_ERR_PARAMS);
+    TEST_INT("missing file read-only", xmss_vstore_open(&vs, store_path, 0), XMSS_ERR_IO);
+
+    memset(junk, 0x5A, sizeof(junk));
+    fd = open(store_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    TEST("foreign file written", fd >= 0 && write(fd, junk, sizeof(junk)) == (ssize_t)sizeof(junk));
+    close(fd);
+    TEST_INT("foreign file rejected", xmss_vstore_open(&vs, store_path, 0), XMSS_ERR_IO);
+    TEST_INT("foreign file not taken over", xmss_vstore_open(&vs, store_path, XMSS_VSTORE_WRITE),
+             XMSS_ERR_IO);
+    unlink(store_path);
+
+    TEST_INT("create", xmss_vstore_open(&vs, store_path, XMSS_VSTORE_WRITE), XMSS_OK);
+    TEST_INT("empty store", xmss_vstore_count(&vs), 0);
+    {
+        xmss_vstore other;
+        TEST_INT("second writer refused",
+                 xmss_vstore_open(&other, store_path, XMSS_VSTORE_WRITE), XMSS_ERR_IO);
+        TEST_INT("reader alongside the writer", xmss_vstore_open(&other, store_path, 0), XMSS_OK);
+        xmss_vstore_close(&other);
+    }
+    xmss_vstore_close(&vs);
+    xmss_vstore_close(&vs);
+
+    /* Record size is part of the layout: a different build's store is refused */
+    fd = open(store_path, O_RDWR);
+    {
+        uint32_t rec = 1;
+        TEST("header patched", fd >= 0 && pwrite(fd, &rec, 4, 12) == 4);
+    }
+    close(fd);
+    TEST_INT("layout mismatch rejected", xmss_vstore_open(&vs, store_path, 0), XMSS_ERR_IO);
+    unlink(store_path);
+}
+
+static void test_verify(void)
+{
+    static const uint8_t msg[] = "verify through the store";
+    xmss_params  sets[3];
+    signed_key   keys[3];
+    xmss_vstore  vs, rd;
+    uint8_t      pk[XMSS_VSTORE_PK_MAX];
+    uint32_t     i;
+
+    xmss_params_custom(&sets[0], OID_XMSS_PRIVATE_MIN, XMSS_FUNC_SHA2, 32, 16, 5, 1);
+    xmss_params_custom(&sets[1], OID_XMSS_PRIVATE_MIN + 1, XMSS_FUNC_SHA2, 32, 16, 6, 2);
+    xmss_params_custom(&sets[2], OID_XMSS_PRIVATE_MIN + 2, XMSS_FUNC_SHAKE128, 32, 4, 4, 1);
+    for (i = 0; i < 3; i++) {
+        make_key(&keys[i], &sets[i], msg, sizeof(msg));
+    }
+
+    xmss_vstore_open(&vs, store_path, XMSS_VSTORE_WRITE);
+    xmss_vstore_open(&rd, store_path, 0);
+    for (i = 0; i < 3; i++) {
+        TEST_INT("add", xmss_vstore_add(&vs, &sets[i], keys[i].pk), XMSS_OK);
+    }
+    TEST_INT("duplicate add is a no-op", xmss_vstore_add(&vs, &sets[0], keys[0].pk), XMSS_OK);
+    TEST_INT("count", xmss_vstore_count(&vs), 3);
+    TEST_INT("same key under another set refused",
+             xmss_vstore_add(&vs, &sets[1], keys[0].pk), XMSS_ERR_PARAMS);
+    memcpy(pk, keys[0].pk, sets[0].pk_bytes);
+    pk[3] ^= 1;
+    TEST_INT("OID mismatch refused", xmss_vstore_add(&vs, &sets[0], pk), XMSS_ERR_PARAMS);
+    TEST_INT("read-only add refused", xmss_vstore_add(&rd, &sets[0], keys[0].pk),
+             XMSS_ERR_PARAMS);
+
+    for (i = 0; i < 3; i++) {
+        const uint8_t   *sig = keys[i].sig;
+        const xmss_vctx *c   = xmss_vstore_find(&rd, keys[i].pk, sets[i].pk_bytes);
+
+        TEST("reader sees the append", c != NULL);
+        TEST_INT("verify through the store",
+                 xmss_vstore_verify(&rd, msg, sizeof(msg), sig, keys[i].pk, sets[i].pk_bytes),
+                 XMSS_OK);
+        if (c != NULL) {
+            TEST_INT("verify on the mapped context",
+                     c->params.d > 1 ? xmss_mt_verify(&c->params, msg, sizeof(msg), sig, c->pk)
+                                     : xmss_verify(&c->params, msg, sizeof(msg), sig, c->pk),
+                     XMSS_OK);
+        }
+        keys[i].sig[sets[i].idx_bytes + 3] ^= 1;
+        TEST_INT("tampered signature fails",
+                 xmss_vstore_verify(&rd, msg, sizeof(msg), sig, keys[i].pk, sets[i].pk_bytes),
+                 XMSS_ERR_VERIFY);
+        keys[i].sig[sets[i].idx_bytes + 3] ^= 1;
+    }
+    memcpy(pk, keys[1].pk, sets[1].pk_bytes);
+    pk[10] ^= 1;
+    TEST("unknown key not found", xmss_vstore_find(&rd, pk, sets[1].pk_bytes) == NULL);
+    TEST_INT("unknown key fails verification",
+             xmss_vstore_verify(&rd, msg, sizeof(msg), keys[1].sig, pk, sets[1].pk_bytes),
+             XMSS_ERR_VERIFY);
+    TEST("wrong length not found",
+         xmss_vstore_find(&rd, keys[0].pk, sets[0].pk_bytes - 1) == NULL);
+
+    xmss_vstore_close(&rd);
+    xmss_vstore_close(&vs);
+    for (i = 0; i < 3; i++) {
+        free(keys[i].sig);
+    }
+}
+
+static void test_many(void)
+{
+    xmss_params p;
+    xmss_vstore vs, rd;
+    uint8_t     pk[XMSS_VSTORE_PK_MAX];
+    uint32_t    i, found = 0, grown_seen;
+    uint64_t    t0, t_open, t_find, t_build;
+
+    xmss_params_from_oid(&p, OID_XMSS_SHA2_20_256);
+
+    xmss_vstore_open(&vs, store_path, XMSS_VSTORE_WRITE);
+    xmss_vstore_open(&rd, store_path, 0);
+
+    /* First three keys are from test_verify(); fill to just before growth */
+    for (i = 0; xmss_vstore_count(&vs) < 32; i++) {
+        synth_pk(&p, pk, i);
+        xmss_vstore_add(&vs, &p, pk);
+    }
+    TEST("reader sees appends in place", xmss_vstore_find(&rd, pk, p.pk_bytes) != NULL);
+    for (; i < MANY; i++) {
+        synth_pk(&p, pk, i);
+        if (xmss_vstore_add(&vs, &p, pk) != XMSS_OK) {
+            break;
+        }
+    }
+    TEST_INT("all keys added", xmss_vstore_count(&vs), MANY + 3);
+    TEST("stale reader keeps the old table", xmss_vstore_count(&rd) == 32 &&
+         xmss_vstore_find(&rd, pk, p.pk_bytes) == NULL);
+    synth_pk(&p, pk, 0);
+    TEST("stale reader still finds old keys", xmss_vstore_find(&rd, pk, p.pk_bytes) != NULL);
+    TEST_INT("refresh", xmss_vstore_refresh(&rd), XMSS_OK);
+    grown_seen = xmss_vstore_count(&rd);
+    TEST_INT("refreshed reader sees the grown table", grown_seen, MANY + 3);
+    TEST_INT("refresh without a change", xmss_vstore_refresh(&rd), XMSS_OK);
+    xmss_vstore_close(&rd);
+
+    for (i = 0; i < MANY; i++) {
+        synth_pk(&p, pk, i);
+        found += xmss_vstore_find(&vs, pk, p.pk_bytes) != NULL;
+    }
+    TEST_INT("every key found after growth", found, MANY);
+    xmss_vstore_close(&vs);
+
+    /* Cold start: open and look up against rebuilding from the key list */
+    t0 = now_us();
+    TEST_INT("reopen read-only", xmss_vstore_open(&rd, store_path, 0), XMSS_OK);
+    t_open = now_us() - t0;
+    TEST_INT("count survives reopen", xmss_vstore_count(&rd), MANY + 3);
+
+    found = 0;
+    t0 = now_us();
+    for (i = 0; i < MANY; i++) {
+        synth_pk(&p, pk, i);
+        found += xmss_vstore_find(&rd, pk, p.pk_bytes) != NULL;
+    }
+    t_find = now_us() - t0;
+    TEST_INT("every key found after reopen", found, MANY);
+
+    {
+        xmss_vstore tmp;
+        char        tmp_path[sizeof(store_path) + 2];
+
+        snprintf(tmp_path, sizeof(tmp_path), "%s.b", store_path);
+        unlink(tmp_path);
+        t0 = now_us();
+        xmss_vstore_open(&tmp, tmp_path, XMSS_VSTORE_WRITE);
+        for (i = 0; i < MANY; i++) {
+            xmss_params q;
+            synth_pk(&p, pk, i);
+            xmss_params_from_oid(&q, (uint32_t)bytes_to_ull(pk, 4));
+            xmss_vstore_add(&tmp, &q, pk);
+        }
+        xmss_vstore_close(&tmp);
+        t_build = now_us() - t0;
+        unlink(tmp_path);
+    }
+    printf("  (%u keys: open %llu us, %u lookups %llu us; rebuild from list %llu us)\n",
+           MANY + 3, (unsigned long long)t_open, MANY, (unsigned long long)t_find,
+           (unsigned long long)t_build);
+    xmss_vstore_close(&rd);
+}
+
+static void test_damaged(void)
+{
+    xmss_params      p;
+    xmss_vstore      vs;
+    uint8_t          pk[XMSS_VSTORE_PK_MAX];
+    const xmss_vctx *c;
+
+    xmss_params_from_oid(&p, OID_XMSS_SHA2_20_256);
+    synth_pk(&p, pk, 7);
+
+    xmss_vstore_open(&vs, store_path, XMSS_VSTORE_WRITE);
+    c = xmss_vstore_find(&vs, pk, p.pk_bytes);
+    TEST("key present", c != NULL);
+    if (c != NULL) {
+        /* The writer's mapping is shared and writable: scribble as a bad disk would */
+        xmss_vctx *w = (xmss_vctx *)(uintptr_t)c;
+        w->params.len = XMSS_MAX_WOTS_LEN + 1;
+        TEST("out-of-range record withheld", xmss_vstore_find(&vs, pk, p.pk_bytes) == NULL);
+        w->params.len = p.len;
+        TEST("restored record found", xmss_vstore_find(&vs, pk, p.pk_bytes) != NULL);
+    }
+    xmss_vstore_close(&vs);
+}
+
+int main(void)
+{
+    int fd;
+
+    printf("=== test_vstore ===\n");
+
+    fd = mkstemp(store_path);
+    if (fd >= 0) {
+        close(fd);
+    }
+    unlink(store_path);
+
+    printf("--- open ---\n");
+    test_open();
+
+    printf("--- verify ---\n");
+    test_verify();
+
+    printf("--- many keys ---\n");
+    test_many();
+
+    printf("--- damaged record ---\n");
+    test_damaged();
+
+    unlink(store_path);
+    return tests_done();
+}
@@ -9,6 +9,7 @@
  * - Verify with wrong message fails
  * - Index increment in SK
  * - Sequential signing: 20 signatures all verify
+ * - Batch verification: per-item results match xmss_verify()
  */
 #include <stdio.h>
 #include <stdint.h>
@@ -329,6 +330,84 @@ static void test_remaining_sigs(uint32_t oid, const char *name)
     xmss_test_ctx_free(&t);
 }
 
+/* Batch verification across two chunks, with a tampered item and an
+ * item whose public key carries the wrong OID. */
+#define BATCH_N 20
+
+static void test_verify_batch(uint32_t oid, const char *name)
+{
+    xmss_test_ctx  t;
+    static uint8_t msgs[BATCH_N][300];
+    uint8_t       *sigs, *bad_pk;
+    const uint8_t *mp[BATCH_N], *sp[BATCH_N], *pp[BATCH_N];
+    size_t         lens[BATCH_N];
+    int            results[BATCH_N];
+    char           label[128];
+    int            i, rc, ok;
+
+    xmss_test_ctx_init(&t, oid);
+    sigs   = (uint8_t *)malloc((size_t)BATCH_N * t.p.sig_bytes);
+    bad_pk = (uint8_t *)malloc(t.p.pk_bytes);
+    test_rng_reset(0xBA7C4ULL);
+    rc = xmss_keygen(&t.p, t.pk, t.sk, t.state, 0, test_randombytes);
+    snprintf(label, sizeof(label), "%s: batch keygen", name);
+    TEST_INT(label, rc, XMSS_OK);
+    if (rc != XMSS_OK) { goto done; }
+
+    for (i = 0; i < BATCH_N; i++) {
+        lens[i] = (size_t)(i * 15);
+        memset(msgs[i], 0xA0 + i, sizeof(msgs[i]));
+        sp[i] = sigs + (size_t)i * t.p.sig_bytes;
+        rc = xmss_sign(&t.p, sigs + (size_t)i * t.p.sig_bytes, msgs[i], lens[i],
+                       t.sk, t.state, 0);
+        if (rc != XMSS_OK) { break; }
+        mp[i] = msgs[i];
+        pp[i] = t.pk;
+    }
+    /* Item 0 is the empty message, passed as NULL */
+    mp[0] = NULL;
+    snprintf(label, sizeof(label), "%s: batch sign %d messages", name, BATCH_N);
+    TEST_INT(label, rc, XMSS_OK);
+    if (rc != XMSS_OK) { goto done; }
+
+    rc = xmss_verify_batch(&t.p, BATCH_N, mp, lens, sp, pp, results);
+    ok = 1;
+    for (i = 0; i < BATCH_N; i++) { ok = ok && results[i] == XMSS_OK; }
+    snprintf(label, sizeof(label), "%s: batch all valid", name);
+    TEST(label, rc == XMSS_OK && ok);
+
+    /* Tamper one message in the second chunk; wrong OID in the first */
+    memcpy(bad_pk, t.pk, t.p.pk_bytes);
+    bad_pk[3] ^= 0x01;
+    pp[5] = bad_pk;
+    msgs[17][0] ^= 0x01;
+
+    rc = xmss_verify_batch(&t.p, BATCH_N, mp, lens, sp, pp, results);
+    snprintf(label, sizeof(label), "%s: batch with bad items fails", name);
+    TEST_INT(label, rc, XMSS_ERR_VERIFY);
+    ok = 1;
+    for (i = 0; i < BATCH_N; i++) {
+        int want = xmss_verify(&t.p, mp[i], lens[i], sp[i], pp[i]);
+        ok = ok && results[i] == want;
+        ok = ok && (results[i] == XMSS_OK) == (i != 5 && i != 17);
+    }
+    snprintf(label, sizeof(label), "%s: batch per-item == xmss_verify", name);
+    TEST(label, ok);
+
+    /* NULL results, empty batch */
+    rc = xmss_verify_batch(&t.p, 5, mp, lens, sp, pp, NULL);
+    snprintf(label, sizeof(label), "%s: batch without results array", name);
+    TEST_INT(label, rc, XMSS_OK);
+    rc = xmss_verify_batch(&t.p, 0, mp, lens, sp, pp, NULL);
+    snprintf(label, sizeof(label), "%s: empty batch", name);
+    TEST_INT(label, rc, XMSS_OK);
+
+done:
+    free(sigs);
+    free(bad_pk);
+    xmss_test_ctx_free(&t);
+}
+
 int main(void)
 {
     printf("=== test_xmss ===\n");
@@ -356,5 +435,9 @@ int main(void)
     test_remaining_sigs(OID_XMSS_SHA2_10_256,  "XMSS-SHA2_10_256");
     test_remaining_sigs(OID_XMSS_SHAKE_10_256, "XMSS-SHAKE_10_256");
 
+    printf("\n--- batch verification ---\n");
+    test_verify_batch(OID_XMSS_SHA2_10_256,  "XMSS-SHA2_10_256");
+    test_verify_batch(OID_XMSS_SHAKE_10_256, "XMSS-SHAKE_10_256");
+
     return tests_done();
 }
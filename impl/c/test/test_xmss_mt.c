@@ -9,6 +9,7 @@
  * - Sequential signing: 5 signatures all verify
  * - Tree boundary crossing: 1024 signatures (crosses layer-0 tree)
  * - Message boundaries: empty and 64-byte messages
+ * - Batch verification: per-item results match xmss_mt_verify()
  */
 #include <stdio.h>
 #include <stdint.h>
@@ -376,6 +377,69 @@ static void test_remaining_sigs(void)
     xmss_mt_test_ctx_free(&t);
 }
 
+/* Batch verification: 18 items (two chunks), one tampered signature and
+ * one public key with the wrong OID. */
+#define MT_BATCH_N 18
+
+static void test_verify_batch(void)
+{
+    xmss_mt_test_ctx t;
+    static uint8_t   msgs[MT_BATCH_N][200];
+    uint8_t         *sigs, *bad_pk;
+    const uint8_t   *mp[MT_BATCH_N], *sp[MT_BATCH_N], *pp[MT_BATCH_N];
+    size_t           lens[MT_BATCH_N];
+    int              results[MT_BATCH_N];
+    int              i, rc, ok;
+
+    printf("\n--- batch verification ---\n");
+
+    xmss_mt_test_ctx_init(&t, TEST_OID);
+    sigs   = (uint8_t *)malloc((size_t)MT_BATCH_N * t.p.sig_bytes);
+    bad_pk = (uint8_t *)malloc(t.p.pk_bytes);
+    test_rng_reset(0xBA7C5ULL);
+    rc = xmss_mt_keygen(&t.p, t.pk, t.sk, t.state, 0, test_randombytes);
+    TEST_INT("MT batch: keygen", rc, XMSS_OK);
+    if (rc != XMSS_OK) { goto done; }
+
+    for (i = 0; i < MT_BATCH_N; i++) {
+        lens[i] = (size_t)(i * 11);
+        memset(msgs[i], 0x30 + i, sizeof(msgs[i]));
+        sp[i] = sigs + (size_t)i * t.p.sig_bytes;
+        rc = xmss_mt_sign(&t.p, sigs + (size_t)i * t.p.sig_bytes, msgs[i], lens[i],
+                          t.sk, t.state, 0);
+        if (rc != XMSS_OK) { break; }
+        mp[i] = msgs[i];
+        pp[i] = t.pk;
+    }
+    TEST_INT("MT batch: sign", rc, XMSS_OK);
+    if (rc != XMSS_OK) { goto done; }
+
+    rc = xmss_mt_verify_batch(&t.p, MT_BATCH_N, mp, lens, sp, pp, results);
+    ok = 1;
+    for (i = 0; i < MT_BATCH_N; i++) { ok = ok && results[i] == XMSS_OK; }
+    TEST("MT batch: all valid", rc == XMSS_OK && ok);
+
+    memcpy(bad_pk, t.pk, t.p.pk_bytes);
+    bad_pk[0] ^= 0x80;
+    pp[2] = bad_pk;
+    sigs[16 * t.p.sig_bytes + t.p.sig_bytes - 1] ^= 0x01;
+
+    rc = xmss_mt_verify_batch(&t.p, MT_BATCH_N, mp, lens, sp, pp, results);
+    TEST_INT("MT batch: bad items fail the batch", rc, XMSS_ERR_VERIFY);
+    ok = 1;
+    for (i = 0; i < MT_BATCH_N; i++) {
+        int want = xmss_mt_verify(&t.p, mp[i], lens[i], sp[i], pp[i]);
+        ok = ok && results[i] == want;
+        ok = ok && (results[i] == XMSS_OK) == (i != 2 && i != 16);
+    }
+    TEST("MT batch: per-item == xmss_mt_verify", ok);
+
+done:
+    free(sigs);
+    free(bad_pk);
+    xmss_mt_test_ctx_free(&t);
+}
+
 int main(void)
 {
     printf("=== test_xmss_mt ===\n");
@@ -392,6 +456,7 @@ int main(void)
     test_bds_k2();
     test_cross_key();
     test_remaining_sigs();
+    test_verify_batch();
 
     return tests_done();
 }
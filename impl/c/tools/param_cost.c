@@ -0,0 +1,316 @@
+/**
+ * param_cost.c - Size and CPU cost per candidate parameter set
+ *
+ * For choosing a private parameter set (xmss_params_custom()): for each
+ * candidate prints the signature and key sizes next to verify, amortised
+ * sign and keygen cost on this host, so bandwidth can be traded against CPU.
+ *
+ * Costs are built from timed primitives rather than full runs, so h = 60
+ * candidates cost no more to report than h = 8 ones:
+ *
+ *   leaf    one WOTS+ key pair + L-tree (treehash_gen_leaves(), lane pipeline)
+ *   wsign   wots_sign() of a random digest          (mean over WOTS_ROUNDS)
+ *   wver    wots_pk_from_sig() + l_tree()            (mean over WOTS_ROUNDS)
+ *   H, Hmsg one tree node / one 32-byte message digest
+ *
+ *   verify  = Hmsg + d * (wver + tree_height * H)
+ *   sign    = PRF + Hmsg + wsign + L * (leaf + H)
+ *             L = 1/2 (bds_round left leaf) + ceil((tree_height - k) / 2)
+ *                 treehash updates [+ 1 for the XMSS-MT layer-0 next tree]
+ *   keygen  = d * 2^tree_height * (leaf + H)
+ *
+ * Sign is an upper estimate: treehash instances that are already complete
+ * skip their update.  -m also runs real keygen / sign / verify on
+ * candidates with at most MEASURE_LEAVES leaves per keygen.
+ *
+ * Usage:
+ *     xmss_param_cost [-k bds_k] [-m] [SPEC ...]
+ *
+ * SPEC is FUNC_h_bits[_wW] or FUNC_h/d_bits[_wW], FUNC SHA2 or SHAKE, bits
+ * 256 or 512, w 4, 16 (default) or 256; e.g. SHA2_8_256_w4,
+ * SHAKE_20/4_256_w256.  Without SPECs a SHA2_*_256 sweep is printed.
+ */
+#define _POSIX_C_SOURCE 200112L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/xmss/xmss.h"
+#include "../include/xmss/params.h"
+#include "../src/hash/hash_iface.h"
+#include "../src/treehash.h"
+#include "../src/wots.h"
+#include "../src/ltree.h"
+#include "../src/address.h"
+
+#define WOTS_ROUNDS     8U
+#define LEAF_ROUNDS     2U
+#define MEASURE_LEAVES  1024U
+#define MEASURE_SIGS    16U
+#define MAX_SIG_BYTES   (8U + XMSS_MAX_N + XMSS_MAX_D * XMSS_MAX_WOTS_LEN * XMSS_MAX_N + \
+                         XMSS_MAX_FULL_H * XMSS_MAX_N)
+
+static const char *default_specs[] = {
+    "SHA2_8_256",   "SHA2_10_256",  "SHA2_16_256",  "SHA2_20_256",
+    "SHA2_20/2_256", "SHA2_20/4_256", "SHA2_30/3_256", "SHA2_60/6_256",
+};
+
+typedef struct {
+    double leaf, wsign, wver, h, hmsg, prf;   /* ns */
+} prim_cost;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Deterministic filler for seeds, digests and signatures (not secret) */
+static uint64_t fill_state = 0x9E3779B97F4A7C15ULL;
+
+static void fill(uint8_t *buf, size_t len)
+{
+    size_t i;
+    for (i = 0; i < len; i++) {
+        fill_state ^= fill_state << 13;
+        fill_state ^= fill_state >> 7;
+        fill_state ^= fill_state << 17;
+        buf[i] = (uint8_t)fill_state;
+    }
+}
+
+static int fill_randombytes(uint8_t *buf, size_t len)
+{
+    fill(buf, len);
+    return 0;
+}
+
+/* Parse a SPEC into params under a private-use OID; 0 on success */
+static int parse_spec(xmss_params *p, const char *spec)
+{
+    char     func[8];
+    unsigned h, d = 1, bits, w = 16;
+    uint32_t n;
+    uint8_t  f;
+    int      got;
+
+    got = sscanf(spec, "%7[A-Z0-9]_%u/%u_%u_w%u", func, &h, &d, &bits, &w);
+    if (got < 4) {
+        d = 1;
+        w = 16;
+        got = sscanf(spec, "%7[A-Z0-9]_%u_%u_w%u", func, &h, &bits, &w);
+        if (got < 3) {
+            return -1;
+        }
+    }
+    n = bits / 8;
+    if (strcmp(func, "SHA2") == 0) {
+        f = XMSS_FUNC_SHA2;
+    } else if (strcmp(func, "SHAKE") == 0) {
+        f = (n == 32) ? XMSS_FUNC_SHAKE128 : XMSS_FUNC_SHAKE256;
+    } else {
+        return -1;
+    }
+    return xmss_params_custom(p, OID_XMSS_PRIVATE_MIN, f, n, w, h, d);
+}
+
+static void time_primitives(const xmss_params *p, prim_cost *c)
+{
+    static uint8_t leaves[XMSS_HASH_LANES][XMSS_MAX_N];
+    static uint8_t sig[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    static uint8_t pk[XMSS_MAX_WOTS_LEN * XMSS_MAX_N];
+    uint8_t        sk_seed[XMSS_MAX_N], seed[XMSS_MAX_N], digest[XMSS_MAX_N];
+    uint8_t        node[2 * XMSS_MAX_N], out[XMSS_MAX_N], msg[32];
+    xmss_adrs_t    adrs;
+    uint64_t       t, best = UINT64_MAX, sum;
+    uint32_t       r;
+
+    fill(sk_seed, sizeof(sk_seed));
+    fill(seed, sizeof(seed));
+    memset(&adrs, 0, sizeof(adrs));
+
+    /* Leaves: warm-up batch, then the fastest of LEAF_ROUNDS */
+    treehash_gen_leaves(p, leaves, sk_seed, seed, 0, XMSS_HASH_LANES, &adrs);
+    for (r = 0; r < LEAF_ROUNDS; r++) {
+        t = now_ns();
+        treehash_gen_leaves(p, leaves, sk_seed, seed, (r + 1) * XMSS_HASH_LANES,
+                            XMSS_HASH_LANES, &adrs);
+        t = now_ns() - t;
+        best = t < best ? t : best;
+    }
+    c->leaf = (double)best / XMSS_HASH_LANES;
+
+    /* WOTS+ sign and verify-side recovery depend on the digest; average */
+    sum = 0;
+    for (r = 0; r < WOTS_ROUNDS; r++) {
+        fill(digest, p->n);
+        xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_OTS);
+        xmss_adrs_set_ots(&adrs, r);
+        t = now_ns();
+        wots_sign(p, sig, digest, sk_seed, seed, &adrs);
+        sum += now_ns() - t;
+    }
+    c->wsign = (double)sum / WOTS_ROUNDS;
+
+    sum = 0;
+    for (r = 0; r < WOTS_ROUNDS; r++) {
+        fill(digest, p->n);
+        fill(sig, p->len * p->n);
+        t = now_ns();
+        xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_OTS);
+        xmss_adrs_set_ots(&adrs, r);
+        wots_pk_from_sig(p, pk, sig, digest, seed, &adrs);
+        xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_LTREE);
+        xmss_adrs_set_ltree(&adrs, r);
+        l_tree(p, out, pk, seed, &adrs);
+        sum += now_ns() - t;
+    }
+    c->wver = (double)sum / WOTS_ROUNDS;
+
+    fill(node, sizeof(node));
+    fill(msg, sizeof(msg));
+    xmss_adrs_set_type(&adrs, XMSS_ADRS_TYPE_HASH);
+    t = now_ns();
+    for (r = 0; r < 64; r++) {
+        xmss_H(p, out, seed, &adrs, node, node + p->n);
+    }
+    c->h = (double)(now_ns() - t) / 64;
+    t = now_ns();
+    for (r = 0; r < 64; r++) {
+        xmss_H_msg(p, out, seed, node, r, msg, sizeof(msg));
+    }
+    c->hmsg = (double)(now_ns() - t) / 64;
+    t = now_ns();
+    for (r = 0; r < 64; r++) {
+        xmss_PRF_idx(p, out, sk_seed, r);
+    }
+    c->prf = (double)(now_ns() - t) / 64;
+}
+
+/* Real keygen + MEASURE_SIGS sign/verify; mean us per op, 0 on failure */
+static int measure(const xmss_params *p, uint32_t bds_k, double *sign_us, double *verify_us)
+{
+    static xmss_mt_state mt;
+    static xmss_bds_state bds;
+    static uint8_t       sig[MAX_SIG_BYTES];
+    uint8_t              pk[4 + 2 * XMSS_MAX_N], sk[8 + 4 + 4 * XMSS_MAX_N];
+    uint8_t              msg[32];
+    uint64_t             ts = 0, tv = 0, t;
+    uint32_t             i;
+    int                  ok;
+
+    ok = (p->d == 1)
+        ? xmss_keygen(p, pk, sk, &bds, bds_k, fill_randombytes) == XMSS_OK
+        : xmss_mt_keygen(p, pk, sk, &mt, bds_k, fill_randombytes) == XMSS_OK;
+    for (i = 0; ok && i < MEASURE_SIGS; i++) {
+        fill(msg, sizeof(msg));
+        t = now_ns();
+        ok = (p->d == 1)
+            ? xmss_sign(p, sig, msg, sizeof(msg), sk, &bds, bds_k) == XMSS_OK
+            : xmss_mt_sign(p, sig, msg, sizeof(msg), sk, &mt, bds_k) == XMSS_OK;
+        ts += now_ns() - t;
+        t = now_ns();
+        ok = ok && ((p->d == 1)
+            ? xmss_verify(p, msg, sizeof(msg), sig, pk) == XMSS_OK
+            : xmss_mt_verify(p, msg, sizeof(msg), sig, pk) == XMSS_OK);
+        tv += now_ns() - t;
+    }
+    *sign_us   = (double)ts / MEASURE_SIGS / 1e3;
+    *verify_us = (double)tv / MEASURE_SIGS / 1e3;
+    return ok;
+}
+
+static void report(const char *spec, uint32_t bds_k, int do_measure)
+{
+    xmss_params p;
+    prim_cost   c;
+    uint32_t    th, u;
+    double      per_leaf, verify, sign, keygen, leaves, ms, mv;
+    char        name[40];
+
+    if (parse_spec(&p, spec) != 0) {
+        printf("%-22s  (invalid: see xmss_params_custom())\n", spec);
+        return;
+    }
+    th = p.tree_height;
+    if (bds_k > th || (bds_k & 1U)) {
+        printf("%-22s  (bds_k %u not usable with tree height %u)\n", spec, bds_k, th);
+        return;
+    }
+    time_primitives(&p, &c);
+
+    u = (th - bds_k + 1) / 2;
+    if (p.d > 1 && u == 0) {
+        u = 1;
+    }
+    per_leaf = c.leaf + c.h;
+    leaves   = 0.5 + u + (p.d > 1 ? 1.0 : 0.0);
+    verify   = c.hmsg + p.d * (c.wver + th * c.h);
+    sign     = c.prf + c.hmsg + c.wsign + leaves * per_leaf;
+    keygen   = (double)p.d * (double)(1ULL << th) * per_leaf;
+
+    if (p.d == 1) {
+        snprintf(name, sizeof(name), "%s_%u_%u_w%u", p.func == XMSS_FUNC_SHA2 ? "SHA2" : "SHAKE",
+                 p.h, p.n * 8, p.w);
+    } else {
+        snprintf(name, sizeof(name), "%s_%u/%u_%u_w%u", p.func == XMSS_FUNC_SHA2 ? "SHA2" : "SHAKE",
+                 p.h, p.d, p.n * 8, p.w);
+    }
+    printf("%-22s %4u %7u %4u %10.1f %10.1f %12.1f", name, p.len, p.sig_bytes,
+           p.pk_bytes, verify / 1e3, sign / 1e3, keygen / 1e6);
+
+    if (do_measure && (uint64_t)p.d << th <= MEASURE_LEAVES) {
+        if (measure(&p, bds_k, &ms, &mv)) {
+            printf("  %9.1f %9.1f", mv, ms);
+        } else {
+            printf("  %19s", "(failed)");
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t bds_k = 0;
+    int      do_measure = 0, i, specs = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            bds_k = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-m") == 0) {
+            do_measure = 1;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-k bds_k] [-m] [SPEC ...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("XMSS_HASH_LANES=%u  bds_k=%u  (times in us; keygen in ms)\n",
+           (unsigned)XMSS_HASH_LANES, bds_k);
+    printf("%-22s %4s %7s %4s %10s %10s %12s%s\n", "set", "len", "sig B", "pk B",
+           "verify", "sign~", "keygen", do_measure ? "  verify(m)   sign(m)" : "");
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-k") == 0) {
+            i++;
+        } else if (argv[i][0] != '-') {
+            report(argv[i], bds_k, do_measure);
+            specs++;
+        }
+    }
+    if (specs == 0) {
+        static const char *ws[] = { "_w4", "_w16", "_w256" };
+        char   spec[40];
+        size_t s, w;
+        for (s = 0; s < sizeof(default_specs) / sizeof(default_specs[0]); s++) {
+            for (w = 0; w < 3; w++) {
+                snprintf(spec, sizeof(spec), "%s%s", default_specs[s], ws[w]);
+                report(spec, bds_k, do_measure);
+            }
+        }
+    }
+    return 0;
+}
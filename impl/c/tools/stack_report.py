@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+stack_report.py - Worst-case static stack per public API from GCC output
+
+Reads the .su (-fstack-usage) and, when present, .ci (-fcallgraph-info=su)
+files that a -DXMSS_STACK_USAGE=ON build leaves next to its objects, and
+prints:
+
+  - for each root function, the deepest call chain and its summed frames;
+  - the largest individual frames.
+
+Without .ci files (clang) only the frame table is printed.  Calls that
+leave the library (libc, the caller's randombytes callback) are not
+counted and are listed as external.
+
+Usage:
+    tools/stack_report.py BUILD_DIR [--root NAME ...] [--top N] [--max BYTES]
+
+--max makes the script exit 1 if any root's chain exceeds BYTES, so it
+can gate a CI job next to test_footprint (which measures the real peak).
+"""
+import argparse
+import os
+import re
+import sys
+
+DEFAULT_ROOTS = [
+    "xmss_keygen", "xmss_sign", "xmss_verify", "xmss_verify_batch",
+    "xmss_mt_keygen", "xmss_mt_sign", "xmss_mt_verify", "xmss_mt_verify_batch",
+]
+
+SU_LINE = re.compile(r"^(?P<file>[^:]+):\d+:\d+:(?P<func>\S+)\s+(?P<bytes>\d+)\s+(?P<kind>\S+)")
+CI_NODE = re.compile(r'node: \{ title: "(?P<title>[^"]+)" label: "(?P<label>[^"]*)"')
+CI_EDGE = re.compile(r'edge: \{ sourcename: "(?P<src>[^"]+)" targetname: "(?P<dst>[^"]+)"')
+CI_BYTES = re.compile(r"\\n(\d+) bytes \((\w+)")
+
+
+def find_files(root, suffix):
+    out = []
+    for dirpath, _, names in os.walk(root):
+        for name in names:
+            if name.endswith(suffix):
+                out.append(os.path.join(dirpath, name))
+    return sorted(out)
+
+
+def load_su(paths):
+    """[(bytes, kind, func, file)] for every function frame."""
+    frames = []
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                m = SU_LINE.match(line)
+                if m:
+                    frames.append((int(m["bytes"]), m["kind"], m["func"],
+                                   os.path.basename(m["file"])))
+    return frames
+
+
+def load_ci(paths):
+    """Nodes keyed (unit, title) -> (bytes, kind) and per-unit edges."""
+    nodes, edges, defined = {}, {}, {}
+    for path in paths:
+        unit = os.path.basename(path)
+        with open(path) as f:
+            text = f.read()
+        for m in CI_NODE.finditer(text):
+            b = CI_BYTES.search(m["label"])
+            if b:
+                nodes[(unit, m["title"])] = (int(b.group(1)), b.group(2))
+                defined.setdefault(m["title"], []).append(unit)
+        for m in CI_EDGE.finditer(text):
+            edges.setdefault((unit, m["src"]), []).append(m["dst"])
+    return nodes, edges, defined
+
+
+def resolve(unit, name, nodes, defined):
+    """A static in the calling unit wins over an external definition."""
+    if (unit, name) in nodes:
+        return (unit, name)
+    units = defined.get(name)
+    return (units[0], name) if units else None
+
+
+def deepest(key, nodes, edges, defined, memo, active, external):
+    """(total bytes, chain) of the deepest path from key; no cycles expected."""
+    if key in memo:
+        return memo[key]
+    if key in active:
+        return (0, [key[1] + " (cycle)"])
+    active.add(key)
+    own, kind = nodes[key]
+    best = (0, [])
+    for callee in edges.get(key, []):
+        k = resolve(key[0], callee, nodes, defined)
+        if k is None:
+            external.add(callee)
+            continue
+        sub = deepest(k, nodes, edges, defined, memo, active, external)
+        if sub[0] > best[0]:
+            best = sub
+    active.discard(key)
+    # Statics are titled "path/unit.c:name"; keep the name
+    name = key[1].rsplit(":", 1)[-1]
+    if kind != "static":
+        name = "%s [%s]" % (name, kind)
+    memo[key] = (own + best[0], ["%s %d" % (name, own)] + best[1])
+    return memo[key]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("build_dir")
+    ap.add_argument("--root", action="append", help="root function (repeatable)")
+    ap.add_argument("--top", type=int, default=15, help="largest frames to list")
+    ap.add_argument("--max", type=int, default=0, help="fail if a root exceeds this")
+    args = ap.parse_args()
+
+    su = find_files(args.build_dir, ".su")
+    ci = find_files(args.build_dir, ".ci")
+    if not su:
+        print("no .su files under %s (configure with -DXMSS_STACK_USAGE=ON)"
+              % args.build_dir, file=sys.stderr)
+        return 2
+
+    status = 0
+    if ci:
+        nodes, edges, defined = load_ci(ci)
+        memo, external = {}, set()
+        print("Worst-case static stack per API (bytes, deepest chain):")
+        for root in args.root or DEFAULT_ROOTS:
+            key = resolve("", root, nodes, defined)
+            if key is None:
+                print("  %-22s (not found)" % root)
+                continue
+            total, chain = deepest(key, nodes, edges, defined, memo, set(), external)
+            flag = ""
+            if args.max and total > args.max:
+                flag, status = "  OVER BUDGET", 1
+            print("  %-22s %8d%s" % (root, total, flag))
+            print("      " + " -> ".join(chain))
+        if external:
+            print("External calls not counted: " + ", ".join(sorted(external)))
+    else:
+        print("no .ci files (GCC -fcallgraph-info=su); frame table only")
+
+    frames = sorted(load_su(su), reverse=True)
+    print("\nLargest frames:")
+    for b, kind, func, fname in frames[:args.top]:
+        print("  %8d  %-8s %-32s %s" % (b, kind, func, fname))
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())